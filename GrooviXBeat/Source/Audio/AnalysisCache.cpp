@@ -0,0 +1,465 @@
+/*
+    AnalysisCache - Persistent store of per-sample analysis results
+*/
+
+#include "AnalysisCache.h"
+#include "DSPWorkerPool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char entryMagic[4] = { 'G', 'X', 'A', 'N' };
+    const char indexMagic[4] = { 'G', 'X', 'A', 'S' };
+    const char* const entryExtension = ".gxana";
+    const char* const indexExtension = ".gxsrc";
+
+    // How stale an entry's modification time may get before load() refreshes it
+    const juce::RelativeTime touchInterval = juce::RelativeTime::hours(1.0);
+
+    // Write under a unique name and rename over the target (ReplaceFile on
+    // Windows, rename() elsewhere), so a reader on another thread or a crash
+    // mid-write sees the old file or the new one, never a partial or missing one.
+    template <typename WriteFn>
+    bool writeAtomically(const juce::File& target, WriteFn&& write)
+    {
+        if (!target.getParentDirectory().createDirectory())
+            return false;
+
+        const auto tempFile = target.getSiblingFile(target.getFileNameWithoutExtension()
+                                                    + "_" + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64())
+                                                    + ".tmp");
+        bool written = false;
+        {
+            juce::FileOutputStream out(tempFile);
+            if (!out.openedOk())
+                return false;
+
+            write(out);
+            out.flush();
+            written = out.getStatus().wasOk();
+        }
+
+        if (!written || !tempFile.replaceFileIn(target))
+        {
+            tempFile.deleteFile();
+            return false;
+        }
+
+        return true;
+    }
+
+    juce::uint64 mix64(juce::uint64 h)
+    {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+}
+
+//==============================================================================
+// Location
+
+juce::CriticalSection& AnalysisCache::getLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+juce::CriticalSection& AnalysisCache::getIndexLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+juce::File& AnalysisCache::getDirectoryStorage()
+{
+    static juce::File directory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                      .getChildFile("GrooviXBeat")
+                                      .getChildFile("AnalysisCache");
+    return directory;
+}
+
+void AnalysisCache::setDirectory(const juce::File& directory)
+{
+    const juce::ScopedLock sl(getLock());
+    getDirectoryStorage() = directory;
+}
+
+juce::File AnalysisCache::getDirectory()
+{
+    const juce::ScopedLock sl(getLock());
+    return getDirectoryStorage();
+}
+
+juce::File AnalysisCache::getEntryFile(const juce::String& key)
+{
+    return getDirectory().getChildFile(key + entryExtension);
+}
+
+juce::File AnalysisCache::getIndexFile(const juce::File& source)
+{
+    return getDirectory().getChildFile(juce::SHA256(source.getFullPathName().toUTF8()).toHexString() + indexExtension);
+}
+
+//==============================================================================
+// Entries
+
+bool AnalysisCache::load(const juce::String& key, Entry& entry, bool includePeaks)
+{
+    if (key.isEmpty())
+        return false;
+
+    const auto file = getEntryFile(key);
+    juce::FileInputStream in(file);
+    if (!in.openedOk())
+        return false;
+
+    char magic[sizeof(entryMagic)] = {};
+    if (in.read(magic, (int)sizeof(magic)) != (int)sizeof(magic)
+        || std::memcmp(magic, entryMagic, sizeof(entryMagic)) != 0
+        || in.readInt() != formatVersion)
+        return false;
+
+    Entry loaded;
+    loaded.sampleRate       = in.readDouble();
+    loaded.numChannels      = in.readInt();
+    loaded.numSamples       = in.readInt();
+    loaded.bpm              = in.readDouble();
+    loaded.loudness.rmsDb   = in.readDouble();
+    loaded.loudness.lufs    = in.readDouble();
+    const int numTransients = in.readInt();
+
+    if (loaded.sampleRate <= 0.0 || loaded.numChannels <= 0 || loaded.numSamples <= 0
+        || numTransients < 0 || in.getNumBytesRemaining() < (juce::int64)numTransients * (juce::int64)sizeof(double))
+        return false;
+
+    loaded.transients.resize((size_t)numTransients);
+    for (auto& t : loaded.transients)
+        t = in.readDouble();
+
+    // Peaks last, so summary reads (the library browser) stop here.
+    if (includePeaks)
+    {
+        const juce::int64 peakBytes = in.readInt64();
+        if (peakBytes < 0 || peakBytes > in.getNumBytesRemaining())
+            return false;  // truncated
+
+        loaded.peaks.setSize((size_t)peakBytes);
+        if (in.read(loaded.peaks.getData(), (int)peakBytes) != (int)peakBytes)
+            return false;
+    }
+
+    entry = std::move(loaded);
+
+    // Recently used entries survive trim().  trim() only needs a rough age,
+    // so an entry read again within touchInterval is not rewritten.
+    const auto now = juce::Time::getCurrentTime();
+    if (now - file.getLastModificationTime() > touchInterval)
+        file.setLastModificationTime(now);
+    return true;
+}
+
+void AnalysisCache::store(const juce::String& key, const Entry& entry)
+{
+    if (key.isEmpty() || entry.numSamples <= 0)
+        return;
+
+    const auto file = getEntryFile(key);
+
+    const bool stored = writeAtomically(file, [&entry](juce::OutputStream& out)
+    {
+        out.write(entryMagic, sizeof(entryMagic));
+        out.writeInt(formatVersion);
+        out.writeDouble(entry.sampleRate);
+        out.writeInt(entry.numChannels);
+        out.writeInt(entry.numSamples);
+        out.writeDouble(entry.bpm);
+        out.writeDouble(entry.loudness.rmsDb);
+        out.writeDouble(entry.loudness.lufs);
+        out.writeInt((int)entry.transients.size());
+        for (double t : entry.transients)
+            out.writeDouble(t);
+        out.writeInt64((juce::int64)entry.peaks.getSize());
+        out.write(entry.peaks.getData(), entry.peaks.getSize());
+    });
+
+    if (!stored)
+        return;
+
+    DBG("AnalysisCache: Stored " + key.substring(0, 12) + " (" + juce::String(entry.bpm, 1) + " BPM, "
+        + juce::String(static_cast<int>(entry.transients.size())) + " transients, "
+        + juce::String(entry.loudness.lufs, 1) + " LUFS)");
+
+    trim();
+}
+
+//==============================================================================
+// Source index
+
+bool AnalysisCache::readIndex(const juce::File& file, IndexRecord& record)
+{
+    if (!file.existsAsFile())
+        return false;
+
+    juce::FileInputStream in(getIndexFile(file));
+    if (!in.openedOk())
+        return false;
+
+    char magic[sizeof(indexMagic)] = {};
+    if (in.read(magic, (int)sizeof(magic)) != (int)sizeof(magic)
+        || std::memcmp(magic, indexMagic, sizeof(indexMagic)) != 0
+        || in.readInt() != formatVersion)
+        return false;
+
+    record.size        = in.readInt64();
+    record.mtime       = in.readInt64();
+    record.key         = in.readString();
+    record.originPath  = in.readString();
+    record.originSize  = in.readInt64();
+    record.originMtime = in.readInt64();
+
+    // Size and mtime as recorded: a rewrite in place is a different content.
+    return record.size == file.getSize()
+        && record.mtime == file.getLastModificationTime().toMilliseconds();
+}
+
+void AnalysisCache::writeIndex(const juce::File& file, const IndexRecord& record)
+{
+    writeAtomically(getIndexFile(file), [&record](juce::OutputStream& out)
+    {
+        out.write(indexMagic, sizeof(indexMagic));
+        out.writeInt(formatVersion);
+        out.writeInt64(record.size);
+        out.writeInt64(record.mtime);
+        out.writeString(record.key);
+        out.writeString(record.originPath);
+        out.writeInt64(record.originSize);
+        out.writeInt64(record.originMtime);
+    });
+}
+
+void AnalysisCache::rememberSource(const juce::File& file, const juce::String& key)
+{
+    if (key.isEmpty() || !file.existsAsFile())
+        return;
+
+    // Read-modify-write of the index; the lock is re-entered for the origin.
+    const juce::ScopedLock sl(getIndexLock());
+
+    // An untouched copy also stands for the file it was copied from.
+    IndexRecord previous;
+    if (readIndex(file, previous) && previous.key.isEmpty() && previous.originPath.isNotEmpty())
+    {
+        const juce::File origin(previous.originPath);
+        if (origin.getSize() == previous.originSize
+            && origin.getLastModificationTime().toMilliseconds() == previous.originMtime)
+            rememberSource(origin, key);
+    }
+
+    IndexRecord record;
+    record.size = file.getSize();
+    record.mtime = file.getLastModificationTime().toMilliseconds();
+    record.key = key;
+    writeIndex(file, record);
+}
+
+juce::String AnalysisCache::getKeyFor(const juce::File& file)
+{
+    const juce::ScopedLock sl(getIndexLock());
+
+    IndexRecord record;
+    return readIndex(file, record) ? record.key : juce::String();
+}
+
+void AnalysisCache::linkSources(const juce::File& source, const juce::File& copy)
+{
+    if (!source.existsAsFile() || !copy.existsAsFile() || source == copy)
+        return;
+
+    const juce::ScopedLock sl(getIndexLock());
+
+    if (auto key = getKeyFor(source); key.isNotEmpty())
+    {
+        rememberSource(copy, key);
+        return;
+    }
+
+    if (auto key = getKeyFor(copy); key.isNotEmpty())
+    {
+        rememberSource(source, key);
+        return;
+    }
+
+    IndexRecord record;
+    record.size = copy.getSize();
+    record.mtime = copy.getLastModificationTime().toMilliseconds();
+    record.originPath = source.getFullPathName();
+    record.originSize = source.getSize();
+    record.originMtime = source.getLastModificationTime().toMilliseconds();
+    writeIndex(copy, record);
+}
+
+bool AnalysisCache::loadForFile(const juce::File& file, Entry& entry, bool includePeaks)
+{
+    return load(getKeyFor(file), entry, includePeaks);
+}
+
+//==============================================================================
+// Maintenance
+
+void AnalysisCache::trim()
+{
+    const juce::ScopedLock sl(getLock());
+
+    auto files = getDirectoryStorage().findChildFiles(juce::File::findFiles, false, juce::String("*") + entryExtension);
+
+    juce::int64 total = 0;
+    for (auto& f : files)
+        total += f.getSize();
+
+    if (total <= maxCacheBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    // Index files pointing at a trimmed entry just miss on the next lookup.
+    for (auto& f : files)
+    {
+        if (total <= maxCacheBytes)
+            break;
+
+        const auto size = f.getSize();
+        if (f.deleteFile())
+            total -= size;
+    }
+}
+
+void AnalysisCache::clear()
+{
+    // Index paths take the directory lock inside the index lock; same order here.
+    const juce::ScopedLock indexLock(getIndexLock());
+    const juce::ScopedLock sl(getLock());
+
+    for (auto* extension : { entryExtension, indexExtension })
+        for (auto& f : getDirectoryStorage().findChildFiles(juce::File::findFiles, false, juce::String("*") + extension))
+            f.deleteFile();
+}
+
+//==============================================================================
+// ContentHash
+
+void AnalysisCache::ContentHash::build(const ChunkedAudio& data, double rate)
+{
+    sampleRate = rate;
+    numChannels = data.getNumChannels();
+    numSamples = numChannels > 0 ? data.getNumSamples() : 0;
+
+    const int numBlocks = (numSamples + blockSize - 1) / blockSize;
+    blockHashes.assign((size_t)numBlocks, 0);
+
+    if (numBlocks == 0)
+        return;
+
+    // Blocks are independent: hash them across the DSP workers.
+    juce::SharedResourcePointer<DSPWorkerPool> workers;
+    workers->parallelFor(numBlocks, [this, &data](int block)
+    {
+        hashBlocks(data, block, block + 1);
+    });
+}
+
+void AnalysisCache::ContentHash::update(const ChunkedAudio& data, int startSample, int length)
+{
+    // A length or layout change moves blocks; only in-place edits take the short path.
+    if (data.getNumSamples() != numSamples || data.getNumChannels() != numChannels)
+    {
+        build(data, sampleRate);
+        return;
+    }
+
+    const int start = juce::jlimit(0, numSamples, startSample);
+    const int end = juce::jlimit(start, numSamples, start + juce::jmax(0, length));
+
+    if (start < end)
+        hashBlocks(data, start / blockSize, (end - 1) / blockSize + 1);
+}
+
+void AnalysisCache::ContentHash::updateFrom(const ChunkedAudio& data, int startSample)
+{
+    if (data.getNumChannels() != numChannels || !isBuilt())
+    {
+        build(data, sampleRate);
+        return;
+    }
+
+    numSamples = data.getNumSamples();
+    const int numBlocks = (numSamples + blockSize - 1) / blockSize;
+    blockHashes.resize((size_t)numBlocks);
+
+    // The block holding the old end may have lost or gained samples.
+    const int firstBlock = juce::jlimit(0, numBlocks, startSample / blockSize);
+    hashBlocks(data, firstBlock, numBlocks);
+}
+
+void AnalysisCache::ContentHash::clear()
+{
+    blockHashes.clear();
+    sampleRate = 0.0;
+    numChannels = 0;
+    numSamples = 0;
+}
+
+void AnalysisCache::ContentHash::hashBlocks(const ChunkedAudio& data, int firstBlock, int endBlock)
+{
+    for (int block = firstBlock; block < endBlock; ++block)
+    {
+        const int start = block * blockSize;
+        const int length = juce::jmin(blockSize, numSamples - start);
+
+        // Four independent lanes keep the multiplies pipelined.
+        juce::uint64 lanes[4] = { 0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL,
+                                  0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL };
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            int i = 0;
+            data.forEachSpan(ch, start, length, [&lanes, &i](const float* samples, int n)
+            {
+                for (int j = 0; j < n; ++j, ++i)
+                {
+                    juce::uint32 bits;
+                    std::memcpy(&bits, samples + j, sizeof(bits));
+
+                    auto& h = lanes[i & 3];
+                    h = (h ^ bits) * 0x9e3779b97f4a7c15ULL;
+                    h ^= h >> 29;
+                }
+            });
+            lanes[ch & 3] ^= mix64((juce::uint64)ch + 1);
+        }
+
+        blockHashes[(size_t)block] = mix64(lanes[0] ^ mix64(lanes[1] ^ mix64(lanes[2] ^ mix64(lanes[3] ^ (juce::uint64)length))));
+    }
+}
+
+juce::String AnalysisCache::ContentHash::getKey() const
+{
+    if (!isBuilt())
+        return {};
+
+    juce::MemoryOutputStream summary;
+    summary.writeInt(numChannels);
+    summary.writeInt(numSamples);
+    summary.writeDouble(sampleRate);
+    for (auto h : blockHashes)
+        summary.writeInt64((juce::int64)h);
+
+    return juce::SHA256(summary.getData(), summary.getDataSize()).toHexString();
+}
@@ -0,0 +1,154 @@
+/*
+    AnalysisCache - Persistent store of per-sample analysis results
+
+    Provides:
+    - One entry per distinct audio content, named from a hash of the decoded
+      samples: detected BPM, transient positions, the waveform peak pyramid
+      and RMS / integrated loudness
+    - A source index from file path (with size and modification time) to
+      content key, so a sample that has not changed is found without
+      decoding or hashing it again (used by the loader and the library browser)
+    - linkSources(): a library sample and its project copy share one entry,
+      whichever of the two gets analysed
+    - ContentHash: per-block hashes of a buffer that edits refresh in place,
+      so the key of an edited buffer costs only the blocks that changed
+
+    Entries are only written by SampleBuffer::storeAnalysis() (on load and
+    when an edited sample is saved); nothing here touches audio.
+
+    All methods are static and may be called from any thread.  Every file is
+    replaced by an atomic rename, so readers never see a partial write; entries
+    are content-addressed (racing stores write the same bytes), and the source
+    index's read-modify-write runs under its own lock.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "SampleDSP.h"
+
+class AnalysisCache
+{
+public:
+    //==============================================================================
+    // Location
+
+    /** Folder holding the store.  Called once at startup with the settings folder. */
+    static void setDirectory(const juce::File& directory);
+    static juce::File getDirectory();
+
+    /** Total size the store is trimmed back to (oldest entries first) after each store. */
+    static constexpr juce::int64 maxCacheBytes = (juce::int64)512 * 1024 * 1024;
+
+    //==============================================================================
+    // Entries
+
+    /** Everything known about one content. */
+    struct Entry
+    {
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        int numSamples = 0;
+        double bpm = 0.0;                  // 0 = not detected on this content
+        std::vector<double> transients;    // seconds
+        SampleDSP::Loudness loudness;
+        juce::MemoryBlock peaks;           // PeakPyramid::writeTo() bytes
+
+        double getDurationSeconds() const  { return sampleRate > 0.0 ? numSamples / sampleRate : 0.0; }
+    };
+
+    /**
+     * Read the entry for a content key.
+     * @param includePeaks If false, the peaks are skipped (summary only, much less I/O)
+     * @return false if there is no valid entry
+     */
+    static bool load(const juce::String& key, Entry& entry, bool includePeaks = true);
+
+    /** Write (or replace) the entry for a content key. */
+    static void store(const juce::String& key, const Entry& entry);
+
+    //==============================================================================
+    // Source index
+
+    /** Record that file currently decodes to the content named key. */
+    static void rememberSource(const juce::File& file, const juce::String& key);
+
+    /** Content key recorded for file, or empty if unknown or the file changed since. */
+    static juce::String getKeyFor(const juce::File& file);
+
+    /**
+     * copy was just made from source.  Shares a known key between the two;
+     * otherwise the first rememberSource() for copy also indexes source,
+     * provided neither file changed in between.
+     */
+    static void linkSources(const juce::File& source, const juce::File& copy);
+
+    /** getKeyFor() then load(). */
+    static bool loadForFile(const juce::File& file, Entry& entry, bool includePeaks = true);
+
+    /** Delete every entry and index file. */
+    static void clear();
+
+    //==============================================================================
+    /**
+     * Hash of a buffer's samples (and layout) in 64k-frame blocks.
+     * build() hashes the blocks in parallel; update() / updateFrom() rehash
+     * only the blocks an edit touched, mirroring PeakPyramid.
+     */
+    class ContentHash
+    {
+    public:
+        void build(const ChunkedAudio& data, double sampleRate);
+
+        /** Samples in [startSample, startSample + length) changed in place. */
+        void update(const ChunkedAudio& data, int startSample, int length);
+
+        /** Everything from startSample on changed or moved. */
+        void updateFrom(const ChunkedAudio& data, int startSample);
+
+        void clear();
+
+        bool isBuilt() const noexcept  { return numSamples > 0; }
+
+        /** Content key (hex); empty until built. */
+        juce::String getKey() const;
+
+    private:
+        static constexpr int blockSize = 65536;
+
+        void hashBlocks(const ChunkedAudio& data, int firstBlock, int endBlock);
+
+        std::vector<juce::uint64> blockHashes;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        int numSamples = 0;
+    };
+
+private:
+    //==============================================================================
+    static void trim();
+
+    static juce::File getEntryFile(const juce::String& key);
+    static juce::File getIndexFile(const juce::File& source);
+
+    /** One source index file. */
+    struct IndexRecord
+    {
+        juce::int64 size = 0;
+        juce::int64 mtime = 0;
+        juce::String key;               // empty until analysed
+        juce::String originPath;        // file this one was copied from, if known
+        juce::int64 originSize = 0;
+        juce::int64 originMtime = 0;
+    };
+
+    static bool readIndex(const juce::File& file, IndexRecord& record);
+    static void writeIndex(const juce::File& file, const IndexRecord& record);
+
+    static constexpr int formatVersion = 1;
+
+    static juce::CriticalSection& getLock();       // directory, trim() and clear()
+    static juce::CriticalSection& getIndexLock();  // source index read-modify-write
+    static juce::File& getDirectoryStorage();
+};
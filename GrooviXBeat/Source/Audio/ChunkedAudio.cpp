@@ -0,0 +1,310 @@
+/*
+    ChunkedAudio - Piece table over shared, fixed-size audio chunks
+*/
+
+#include "ChunkedAudio.h"
+#include <algorithm>
+
+//==============================================================================
+ChunkedAudio::ChunkedAudio(const juce::AudioBuffer<float>& source)
+    : numChannels(source.getNumChannels())
+{
+    const int total = numChannels > 0 ? source.getNumSamples() : 0;
+
+    pieces.reserve((size_t)((total + chunkSize - 1) / chunkSize));
+
+    for (int start = 0; start < total; start += chunkSize)
+    {
+        const int length = juce::jmin(chunkSize, total - start);
+
+        Chunk::Ptr chunk = new Chunk();
+        chunk->samples.setSize(numChannels, length);
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunk->samples.copyFrom(ch, 0, source, ch, start, length);
+
+        pieces.push_back({ chunk, 0, length });
+    }
+
+    updateStarts();
+}
+
+ChunkedAudio ChunkedAudio::silence(int numChannels, int numSamples)
+{
+    ChunkedAudio result;
+    result.numChannels = juce::jmax(0, numChannels);
+
+    if (result.numChannels == 0 || numSamples <= 0)
+        return result;
+
+    Chunk::Ptr zeros = new Chunk();
+    zeros->samples.setSize(result.numChannels, juce::jmin(chunkSize, numSamples));
+    zeros->samples.clear();
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+        result.pieces.push_back({ zeros, 0, juce::jmin(chunkSize, numSamples - start) });
+
+    result.updateStarts();
+    return result;
+}
+
+size_t ChunkedAudio::getSizeInBytes() const
+{
+    ChunkTally tally;
+    tally.add(*this);
+    return tally.getSizeInBytes();
+}
+
+void ChunkedAudio::clear()
+{
+    pieces.clear();
+    pieceStarts.clear();
+    numChannels = 0;
+    numSamples = 0;
+}
+
+//==============================================================================
+// Pieces
+
+size_t ChunkedAudio::findPiece(int position) const
+{
+    // Last piece starting at or before position
+    auto it = std::upper_bound(pieceStarts.begin(), pieceStarts.end(), position);
+    return (size_t)juce::jmax(0, (int)(it - pieceStarts.begin()) - 1);
+}
+
+size_t ChunkedAudio::splitAt(int position)
+{
+    // Index of the piece starting at position, splitting the one across it
+    if (position >= numSamples)
+        return pieces.size();
+
+    const size_t index = findPiece(position);
+    const int offsetInPiece = position - pieceStarts[index];
+
+    if (offsetInPiece == 0)
+        return index;
+
+    Piece tail = pieces[index];
+    tail.offset += offsetInPiece;
+    tail.length -= offsetInPiece;
+    pieces[index].length = offsetInPiece;
+
+    pieces.insert(pieces.begin() + (std::ptrdiff_t)index + 1, std::move(tail));
+    pieceStarts.insert(pieceStarts.begin() + (std::ptrdiff_t)index + 1, position);
+    return index + 1;
+}
+
+void ChunkedAudio::mergeAt(size_t index)
+{
+    // Rejoin pieces[index - 1] and pieces[index] if they are neighbours in one
+    // chunk (e.g. a deleted range put back by undo)
+    if (index == 0 || index >= pieces.size())
+        return;
+
+    auto& before = pieces[index - 1];
+    const auto& after = pieces[index];
+
+    if (before.chunk == after.chunk && before.offset + before.length == after.offset)
+    {
+        before.length += after.length;
+        pieces.erase(pieces.begin() + (std::ptrdiff_t)index);
+        pieceStarts.erase(pieceStarts.begin() + (std::ptrdiff_t)index);
+    }
+}
+
+void ChunkedAudio::updateStarts()
+{
+    pieceStarts.resize(pieces.size());
+
+    int position = 0;
+    for (size_t i = 0; i < pieces.size(); ++i)
+    {
+        pieceStarts[i] = position;
+        position += pieces[i].length;
+    }
+
+    numSamples = position;
+}
+
+//==============================================================================
+// Editing
+
+ChunkedAudio ChunkedAudio::getRange(int startSample, int length) const
+{
+    ChunkedAudio result;
+    result.numChannels = numChannels;
+
+    startSample = juce::jlimit(0, numSamples, startSample);
+    length = juce::jlimit(0, numSamples - startSample, length);
+
+    for (size_t index = findPiece(startSample); length > 0; ++index)
+    {
+        const auto& piece = pieces[index];
+        const int offsetInPiece = startSample - pieceStarts[index];
+        const int n = juce::jmin(length, piece.length - offsetInPiece);
+
+        result.pieces.push_back({ piece.chunk, piece.offset + offsetInPiece, n });
+
+        startSample += n;
+        length -= n;
+    }
+
+    result.updateStarts();
+    return result;
+}
+
+void ChunkedAudio::erase(int startSample, int length)
+{
+    startSample = juce::jlimit(0, numSamples, startSample);
+    length = juce::jlimit(0, numSamples - startSample, length);
+
+    if (length == 0)
+        return;
+
+    const size_t first = splitAt(startSample);
+    const size_t last = splitAt(startSample + length);
+
+    pieces.erase(pieces.begin() + (std::ptrdiff_t)first, pieces.begin() + (std::ptrdiff_t)last);
+    updateStarts();
+    mergeAt(first);
+}
+
+void ChunkedAudio::insert(int position, const ChunkedAudio& source)
+{
+    if (source.numSamples == 0)
+        return;
+
+    if (numSamples == 0)
+    {
+        *this = source;
+        return;
+    }
+
+    // Chunks may have more channels than the sequence uses, never fewer
+    numChannels = juce::jmin(numChannels, source.numChannels);
+
+    const size_t index = splitAt(juce::jlimit(0, numSamples, position));
+
+    pieces.insert(pieces.begin() + (std::ptrdiff_t)index, source.pieces.begin(), source.pieces.end());
+    updateStarts();
+
+    mergeAt(index + source.pieces.size());
+    mergeAt(index);
+}
+
+void ChunkedAudio::replace(int startSample, int length, const ChunkedAudio& replacement)
+{
+    startSample = juce::jlimit(0, numSamples, startSample);
+    length = juce::jlimit(0, numSamples - startSample, length);
+
+    if (startSample == 0 && length == numSamples)
+    {
+        *this = replacement;
+        return;
+    }
+
+    erase(startSample, length);
+    insert(startSample, replacement);
+}
+
+//==============================================================================
+// Reading
+
+const float* ChunkedAudio::getReadPointer(int channel, int startSample, int length, float* scratch) const
+{
+    jassert(channel >= 0 && channel < numChannels);
+    jassert(startSample >= 0 && length >= 0 && startSample + length <= numSamples);
+
+    if (length > 0 && startSample < numSamples)
+    {
+        const size_t index = findPiece(startSample);
+        const auto& piece = pieces[index];
+        const int offsetInPiece = startSample - pieceStarts[index];
+
+        if (offsetInPiece + length <= piece.length)
+            return piece.chunk->samples.getReadPointer(channel, piece.offset + offsetInPiece);
+    }
+
+    float* out = scratch;
+    forEachSpan(channel, startSample, length, [&out](const float* samples, int n)
+    {
+        juce::FloatVectorOperations::copy(out, samples, n);
+        out += n;
+    });
+
+    return scratch;
+}
+
+void ChunkedAudio::copyTo(juce::AudioBuffer<float>& dest, int destStartSample, int sourceStartSample, int length) const
+{
+    const int channelCount = juce::jmin(dest.getNumChannels(), numChannels);
+    int destPosition = destStartSample;
+
+    forEachPiece(sourceStartSample, length, [&](const float* const* channels, int n)
+    {
+        for (int ch = 0; ch < channelCount; ++ch)
+            dest.copyFrom(ch, destPosition, channels[ch], n);
+
+        destPosition += n;
+    });
+}
+
+juce::AudioBuffer<float> ChunkedAudio::flatten() const
+{
+    juce::AudioBuffer<float> result(numChannels, numSamples);
+    copyTo(result, 0, 0, numSamples);
+    return result;
+}
+
+//==============================================================================
+// ChunkTally
+
+size_t ChunkedAudio::ChunkTally::getChunkBytes(const Chunk& chunk)
+{
+    return sizeof(float) * (size_t)chunk.samples.getNumChannels() * (size_t)chunk.samples.getNumSamples();
+}
+
+void ChunkedAudio::ChunkTally::add(const ChunkedAudio& audio)
+{
+    for (const auto& piece : audio.pieces)
+    {
+        const Chunk* chunk = piece.chunk.get();
+        if (excluded.count(chunk) > 0)
+            continue;
+
+        if (uses[chunk]++ == 0)
+            bytes += getChunkBytes(*chunk);
+    }
+}
+
+void ChunkedAudio::ChunkTally::remove(const ChunkedAudio& audio)
+{
+    for (const auto& piece : audio.pieces)
+    {
+        auto it = uses.find(piece.chunk.get());
+        if (it == uses.end())
+            continue;
+
+        if (--it->second == 0)
+        {
+            bytes -= getChunkBytes(*it->first);
+            uses.erase(it);
+        }
+    }
+}
+
+void ChunkedAudio::ChunkTally::exclude(const ChunkedAudio& audio)
+{
+    for (const auto& piece : audio.pieces)
+    {
+        const Chunk* chunk = piece.chunk.get();
+        if (!excluded.insert(chunk).second)
+            continue;
+
+        if (auto it = uses.find(chunk); it != uses.end())
+        {
+            bytes -= getChunkBytes(*chunk);
+            uses.erase(it);
+        }
+    }
+}
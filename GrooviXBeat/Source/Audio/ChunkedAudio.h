@@ -0,0 +1,186 @@
+/*
+    ChunkedAudio - Piece table over shared, fixed-size audio chunks
+
+    Provides:
+    - Audio held as immutable, reference-counted chunks of up to chunkSize
+      frames, and an ordered list of pieces (chunk, offset, length) that
+      make up the sequence
+    - insert() / erase() / replace() that split and splice pieces, so an
+      edit costs the pieces it touches plus any new samples, not a copy of
+      the whole buffer
+    - Copies and getRange() slices share chunks instead of samples (the
+      original kept for reset, the clipboard, undo steps)
+    - Span reads for analysis, playback and export; flatten() for the few
+      callers that need one contiguous buffer
+
+    Chunks are never written after construction, so any number of
+    ChunkedAudio objects (on any thread) can hold the same chunk.  A
+    ChunkedAudio itself is not thread-safe; its owner (SampleBuffer) locks.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class ChunkedAudio
+{
+public:
+    /** Frames per chunk when audio is copied in. */
+    static constexpr int chunkSize = 65536;
+
+    ChunkedAudio() = default;
+
+    /** Copy source into new chunks. */
+    explicit ChunkedAudio(const juce::AudioBuffer<float>& source);
+
+    /** numSamples of silence, all pieces sharing one zero chunk. */
+    static ChunkedAudio silence(int numChannels, int numSamples);
+
+    int getNumChannels() const noexcept    { return numChannels; }
+    int getNumSamples() const noexcept     { return numSamples; }
+    int getNumPieces() const noexcept      { return (int)pieces.size(); }
+
+    /** Sample memory this sequence refers to (chunks shared with others counted in full). */
+    size_t getSizeInBytes() const;
+
+    /** Memory of several sequences with shared chunks counted once (see below). */
+    class ChunkTally;
+
+    void clear();
+
+    //==============================================================================
+    // Editing
+
+    /** [startSample, startSample + length) as a new sequence sharing this one's chunks. */
+    ChunkedAudio getRange(int startSample, int length) const;
+
+    /** Remove [startSample, startSample + length). */
+    void erase(int startSample, int length);
+
+    /**
+     * Insert source (sharing its chunks) before position.  A source with
+     * fewer channels narrows this sequence to its channel count.
+     */
+    void insert(int position, const ChunkedAudio& source);
+
+    /** erase() then insert(); replacing everything takes the replacement as it is. */
+    void replace(int startSample, int length, const ChunkedAudio& replacement);
+
+    //==============================================================================
+    // Reading
+
+    /**
+     * Pointer to numSamples contiguous samples of one channel: straight into
+     * the chunk when the range lies in one piece, otherwise gathered into
+     * scratch (which must hold numSamples floats).
+     */
+    const float* getReadPointer(int channel, int startSample, int numSamples, float* scratch) const;
+
+    /** Call fn(const float* samples, int numSamples) for each contiguous run of a channel's range. */
+    template <typename Fn>
+    void forEachSpan(int channel, int startSample, int length, Fn&& fn) const
+    {
+        forEachPiece(startSample, length, [&fn, channel](const float* const* channels, int n)
+        {
+            fn(channels[channel], n);
+        });
+    }
+
+    /**
+     * Call fn(const float* const* channels, int numSamples) for each
+     * contiguous run of a range, with a pointer per channel.
+     */
+    template <typename Fn>
+    void forEachPiece(int startSample, int length, Fn&& fn) const
+    {
+        startSample = juce::jlimit(0, numSamples, startSample);
+        length = juce::jlimit(0, numSamples - startSample, length);
+
+        if (length == 0)
+            return;
+
+        const float* channels[maxChannels] = {};
+        const int channelCount = juce::jmin(numChannels, (int)maxChannels);
+
+        for (size_t index = findPiece(startSample); length > 0; ++index)
+        {
+            const auto& piece = pieces[index];
+            const int offsetInPiece = startSample - pieceStarts[index];
+            const int n = juce::jmin(length, piece.length - offsetInPiece);
+
+            for (int ch = 0; ch < channelCount; ++ch)
+                channels[ch] = piece.chunk->samples.getReadPointer(ch, piece.offset + offsetInPiece);
+
+            fn(channels, n);
+
+            startSample += n;
+            length -= n;
+        }
+    }
+
+    /** Copy a range into dest (as many channels as both have). */
+    void copyTo(juce::AudioBuffer<float>& dest, int destStartSample, int sourceStartSample, int length) const;
+
+    /** The whole sequence as one contiguous buffer. */
+    juce::AudioBuffer<float> flatten() const;
+
+private:
+    //==============================================================================
+    static constexpr int maxChannels = 64;
+
+    struct Chunk : public juce::ReferenceCountedObject
+    {
+        using Ptr = juce::ReferenceCountedObjectPtr<Chunk>;
+        juce::AudioBuffer<float> samples;   // written once, before the chunk is shared
+    };
+
+    struct Piece
+    {
+        Chunk::Ptr chunk;
+        int offset = 0;
+        int length = 0;
+    };
+
+    std::vector<Piece> pieces;
+    std::vector<int> pieceStarts;   // position of each piece in the sequence
+    int numChannels = 0;
+    int numSamples = 0;
+
+    size_t findPiece(int position) const;
+    size_t splitAt(int position);
+    void mergeAt(size_t index);
+    void updateStarts();
+};
+
+//==============================================================================
+/**
+ * The chunks a set of sequences refers to, each counted once however many
+ * sequences or pieces hold it.  Sequences can be taken out again, so a
+ * caller dropping them one by one (undo history trimming) sees what each
+ * drop actually frees.
+ */
+class ChunkedAudio::ChunkTally
+{
+public:
+    /** Count the chunks audio refers to. */
+    void add(const ChunkedAudio& audio);
+
+    /** Take back an earlier add() of the same audio. */
+    void remove(const ChunkedAudio& audio);
+
+    /** Never count the chunks audio refers to (something else keeps them alive). */
+    void exclude(const ChunkedAudio& audio);
+
+    /** Bytes of the counted chunks, each once. */
+    size_t getSizeInBytes() const noexcept  { return bytes; }
+
+private:
+    static size_t getChunkBytes(const Chunk& chunk);
+
+    std::unordered_map<const Chunk*, int> uses;   // counted chunk -> pieces referring to it
+    std::unordered_set<const Chunk*> excluded;
+    size_t bytes = 0;
+};
@@ -0,0 +1,64 @@
+/*
+    DSPWorkerPool - Process-wide worker threads for long sample DSP operations
+*/
+
+#include "DSPWorkerPool.h"
+
+//==============================================================================
+DSPWorkerPool::DSPWorkerPool()
+    : pool(juce::jmax(1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+DSPWorkerPool::~DSPWorkerPool()
+{
+    pool.removeAllJobs(true, 5000);
+}
+
+int DSPWorkerPool::getNumWorkers() const
+{
+    return pool.getNumThreads();
+}
+
+void DSPWorkerPool::parallelFor(int numTasks, std::function<void(int)> task)
+{
+    if (numTasks <= 1)
+    {
+        if (numTasks == 1)
+            task(0);
+        return;
+    }
+
+    // Shared with the helper jobs: a helper that only starts after the last
+    // task finished finds nothing left to claim and never calls task.
+    struct State
+    {
+        std::function<void(int)> task;
+        int numTasks = 0;
+        std::atomic<int> next { 0 };
+        std::atomic<int> remaining { 0 };
+        juce::WaitableEvent allDone;
+
+        void run()
+        {
+            for (int i = next++; i < numTasks; i = next++)
+            {
+                task(i);
+                if (--remaining == 0)
+                    allDone.signal();
+            }
+        }
+    };
+
+    auto state = std::make_shared<State>();
+    state->task = std::move(task);
+    state->numTasks = numTasks;
+    state->remaining = numTasks;
+
+    const int numHelpers = juce::jmin(numTasks - 1, pool.getNumThreads());
+    for (int i = 0; i < numHelpers; ++i)
+        pool.addJob([state] { state->run(); });
+
+    state->run();
+    state->allDone.wait();
+}
@@ -0,0 +1,41 @@
+/*
+    DSPWorkerPool - Process-wide worker threads for long sample DSP operations
+
+    Provides:
+    - One thread pool (one thread per core, less the caller) shared by every
+      time stretch, resample and analysis pass in the process
+    - parallelFor(): split an operation into tasks, run them on the calling
+      thread and the workers, and return when all are done
+
+    Access it through juce::SharedResourcePointer<DSPWorkerPool>.  Objects
+    that run these operations often (SampleBuffer) hold one, so the threads
+    are not started again for every operation.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+
+class DSPWorkerPool
+{
+public:
+    DSPWorkerPool();
+    ~DSPWorkerPool();
+
+    /** Threads available besides the caller. */
+    int getNumWorkers() const;
+
+    /**
+     * Run task(0) .. task(numTasks - 1), in any order and concurrently.
+     * The calling thread works through the tasks as well, so this keeps
+     * making progress when every worker is busy or when called from a worker.
+     * Blocks until every task has returned.
+     */
+    void parallelFor(int numTasks, std::function<void(int)> task);
+
+private:
+    juce::ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DSPWorkerPool)
+};
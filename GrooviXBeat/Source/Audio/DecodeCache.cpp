@@ -0,0 +1,287 @@
+/*
+    DecodeCache - Persistent on-disk cache of decoded compressed samples
+*/
+
+#include "DecodeCache.h"
+#include "MappedSampleSource.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const char cacheMagic[4] = { 'G', 'X', 'P', 'C' };
+    const char indexMagic[4] = { 'G', 'X', 'P', 'S' };
+    const char* const cacheExtension = ".gxpcm";
+    const char* const indexExtension = ".gxsrc";
+
+    // Write under a unique name and rename over the target (ReplaceFile on
+    // Windows, rename() elsewhere), so a reader on another thread or a crash
+    // mid-write never sees a partial file.
+    template <typename WriteFn>
+    bool writeAtomically(const juce::File& target, WriteFn&& write)
+    {
+        if (!target.getParentDirectory().createDirectory())
+            return false;
+
+        const auto tempFile = target.getSiblingFile(target.getFileNameWithoutExtension()
+                                                    + "_" + juce::String::toHexString(juce::Random::getSystemRandom().nextInt64())
+                                                    + ".tmp");
+        bool written = false;
+        {
+            juce::FileOutputStream out(tempFile);
+            if (!out.openedOk())
+                return false;
+
+            write(out);
+            out.flush();
+            written = out.getStatus().wasOk();
+        }
+
+        if (!written || !tempFile.replaceFileIn(target))
+        {
+            tempFile.deleteFile();
+            return false;
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+// Location
+
+juce::CriticalSection& DecodeCache::getLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+juce::File& DecodeCache::getDirectoryStorage()
+{
+    static juce::File directory = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                      .getChildFile("GrooviXBeat")
+                                      .getChildFile("DecodeCache");
+    return directory;
+}
+
+void DecodeCache::setDirectory(const juce::File& directory)
+{
+    const juce::ScopedLock sl(getLock());
+    getDirectoryStorage() = directory;
+}
+
+juce::File DecodeCache::getDirectory()
+{
+    const juce::ScopedLock sl(getLock());
+    return getDirectoryStorage();
+}
+
+bool DecodeCache::shouldCache(const juce::File& file)
+{
+    // WAV/AIFF decode at memory speed through MappedSampleSource already.
+    return !file.hasFileExtension("wav;wave;bwf;aif;aiff;aifc");
+}
+
+juce::File DecodeCache::getCacheFileFor(const juce::File& file)
+{
+    // Named from the content alone, so a copy in another folder or a file
+    // touched without changing shares the entry.
+    return getDirectory().getChildFile(getContentHash(file) + cacheExtension);
+}
+
+//==============================================================================
+// Source index
+
+juce::File DecodeCache::getIndexFile(const juce::File& source)
+{
+    return getDirectory().getChildFile(juce::SHA256(source.getFullPathName().toUTF8()).toHexString() + indexExtension);
+}
+
+juce::String DecodeCache::getContentHash(const juce::File& file)
+{
+    const auto size = file.getSize();
+    const auto mtime = file.getLastModificationTime().toMilliseconds();
+    const auto indexFile = getIndexFile(file);
+
+    // Unchanged since last hashed: no need to read the whole file again.
+    {
+        juce::FileInputStream in(indexFile);
+        char magic[sizeof(indexMagic)] = {};
+
+        if (in.openedOk()
+            && in.read(magic, (int)sizeof(magic)) == (int)sizeof(magic)
+            && std::memcmp(magic, indexMagic, sizeof(indexMagic)) == 0
+            && in.readInt() == formatVersion
+            && in.readInt64() == size
+            && in.readInt64() == mtime)
+        {
+            const auto hash = in.readString();
+            if (hash.isNotEmpty())
+                return hash;
+        }
+    }
+
+    const auto hash = juce::SHA256(file).toHexString();
+
+    // One whole record per path, so racing writers need no lock.
+    writeAtomically(indexFile, [&](juce::OutputStream& out)
+    {
+        out.write(indexMagic, sizeof(indexMagic));
+        out.writeInt(formatVersion);
+        out.writeInt64(size);
+        out.writeInt64(mtime);
+        out.writeString(hash);
+    });
+
+    return hash;
+}
+
+//==============================================================================
+// Loading
+
+bool DecodeCache::readFile(juce::AudioFormatManager& formatManager,
+                           const juce::File& file,
+                           juce::AudioBuffer<float>& dest,
+                           double& sampleRate)
+{
+    if (!file.existsAsFile())
+        return false;
+
+    const bool cacheable = shouldCache(file);
+    juce::File cacheFile;
+
+    if (cacheable)
+    {
+        cacheFile = getCacheFileFor(file);
+        if (load(cacheFile, file, dest, sampleRate))
+        {
+            // Recently used entries survive trim().
+            cacheFile.setLastModificationTime(juce::Time::getCurrentTime());
+            return true;
+        }
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader = MappedSampleSource::createMappedReader(formatManager, file);
+    if (reader == nullptr)
+        reader.reset(formatManager.createReaderFor(file));
+    if (reader == nullptr)
+        return false;
+
+    const int numSamples = static_cast<int>(reader->lengthInSamples);
+    dest.setSize(static_cast<int>(reader->numChannels), numSamples);
+    reader->read(&dest, 0, numSamples, 0, true, true);
+    sampleRate = reader->sampleRate;
+
+    if (cacheable && numSamples > 0)
+        store(cacheFile, file, dest, sampleRate);
+
+    return true;
+}
+
+bool DecodeCache::load(const juce::File& cacheFile, const juce::File& source,
+                       juce::AudioBuffer<float>& dest, double& sampleRate)
+{
+    if (!cacheFile.existsAsFile())
+        return false;
+
+    juce::MemoryMappedFile mapped(cacheFile, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapped.getData());
+
+    if (data == nullptr || mapped.getSize() < (size_t)dataOffset
+        || std::memcmp(data, cacheMagic, sizeof(cacheMagic)) != 0)
+        return false;
+
+    juce::MemoryInputStream header(data + sizeof(cacheMagic), (size_t)dataOffset - sizeof(cacheMagic), false);
+    const int version          = header.readInt();
+    const int numChannels      = header.readInt();
+    const double rate          = header.readDouble();
+    const juce::int64 samples  = header.readInt64();
+    const juce::int64 srcSize  = header.readInt64();
+
+    if (version != formatVersion || numChannels <= 0 || rate <= 0.0
+        || samples <= 0 || samples > std::numeric_limits<int>::max()
+        || srcSize != source.getSize())
+        return false;
+
+    const size_t channelBytes = (size_t)samples * sizeof(float);
+    if (mapped.getSize() < (size_t)dataOffset + channelBytes * (size_t)numChannels)
+        return false;  // truncated
+
+    dest.setSize(numChannels, (int)samples);
+    for (int ch = 0; ch < numChannels; ++ch)
+        std::memcpy(dest.getWritePointer(ch), data + dataOffset + channelBytes * (size_t)ch, channelBytes);
+
+    sampleRate = rate;
+
+    DBG("DecodeCache: Hit " + source.getFileName());
+    return true;
+}
+
+void DecodeCache::store(const juce::File& cacheFile, const juce::File& source,
+                        const juce::AudioBuffer<float>& data, double sampleRate)
+{
+    const bool stored = writeAtomically(cacheFile, [&](juce::OutputStream& out)
+    {
+        out.write(cacheMagic, sizeof(cacheMagic));
+        out.writeInt(formatVersion);
+        out.writeInt(data.getNumChannels());
+        out.writeDouble(sampleRate);
+        out.writeInt64(data.getNumSamples());
+        out.writeInt64(source.getSize());
+        out.writeRepeatedByte(0, (size_t)(dataOffset - out.getPosition()));
+
+        // Planar native float: every platform we build for is little-endian.
+        for (int ch = 0; ch < data.getNumChannels(); ++ch)
+            out.write(data.getReadPointer(ch), (size_t)data.getNumSamples() * sizeof(float));
+    });
+
+    if (!stored)
+        return;
+
+    DBG("DecodeCache: Stored " + source.getFileName() + " ("
+        + juce::File::descriptionOfSizeInBytes(cacheFile.getSize()) + ")");
+
+    trim();
+}
+
+//==============================================================================
+// Maintenance
+
+void DecodeCache::trim()
+{
+    const juce::ScopedLock sl(getLock());
+
+    auto files = getDirectoryStorage().findChildFiles(juce::File::findFiles, false, juce::String("*") + cacheExtension);
+
+    juce::int64 total = 0;
+    for (auto& f : files)
+        total += f.getSize();
+
+    if (total <= maxCacheBytes)
+        return;
+
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() < b.getLastModificationTime();
+    });
+
+    for (auto& f : files)
+    {
+        if (total <= maxCacheBytes)
+            break;
+
+        const auto size = f.getSize();
+        if (f.deleteFile())
+            total -= size;
+    }
+}
+
+void DecodeCache::clear()
+{
+    const juce::ScopedLock sl(getLock());
+
+    for (auto* extension : { cacheExtension, indexExtension })
+        for (auto& f : getDirectoryStorage().findChildFiles(juce::File::findFiles, false, juce::String("*") + extension))
+            f.deleteFile();
+}
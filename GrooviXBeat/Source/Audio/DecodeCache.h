@@ -0,0 +1,86 @@
+/*
+    DecodeCache - Persistent on-disk cache of decoded compressed samples
+
+    Provides:
+    - readFile(): decode an audio file into a float buffer, reusing the
+      decoded PCM from a previous session for compressed formats (MP3, OGG,
+      FLAC...) instead of running the decoder again
+    - A cache file per distinct content, named from the SHA-256 of the
+      source, in the user settings folder
+    - A source index from file path (with size and modification time) to
+      that hash, so an unchanged source is not read and hashed again
+    - Planar float32 PCM after a fixed header, page aligned so the file can
+      be memory-mapped and copied out channel by channel
+
+    WAV/AIFF are never cached: readFile() reads them through a memory map
+    (see MappedSampleSource), which is already as fast as the cache would be.
+
+    All methods are static and thread-safe; the loaders call them from the
+    message thread, the sample preload pool and SamplerLoadThread.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DecodeCache
+{
+public:
+    //==============================================================================
+    // Location
+
+    /** Folder holding the cache files.  Called once at startup with the settings folder. */
+    static void setDirectory(const juce::File& directory);
+    static juce::File getDirectory();
+
+    /** Total size the cache folder is trimmed back to (oldest files first) after each store. */
+    static constexpr juce::int64 maxCacheBytes = (juce::int64)2 * 1024 * 1024 * 1024;
+
+    //==============================================================================
+    // Loading
+
+    /**
+     * Decode a whole file into dest.
+     * Compressed formats are served from the cache when a valid entry exists,
+     * otherwise decoded with formatManager and stored for next time.
+     * @param formatManager  Formats to decode with (only used on a cache miss)
+     * @param file           Source audio file
+     * @param dest           Receives the samples (resized)
+     * @param sampleRate     Receives the file's sample rate
+     * @return false if the file is missing or cannot be decoded
+     */
+    static bool readFile(juce::AudioFormatManager& formatManager,
+                         const juce::File& file,
+                         juce::AudioBuffer<float>& dest,
+                         double& sampleRate);
+
+    /** True for the formats worth caching (anything that is not WAV/AIFF). */
+    static bool shouldCache(const juce::File& file);
+
+    /**
+     * Cache file for the current content of file (whether or not it exists yet).
+     * Hashes the content only when the source index has no record for the
+     * file's path, size and modification time.
+     */
+    static juce::File getCacheFileFor(const juce::File& file);
+
+    /** Delete every cache file. */
+    static void clear();
+
+private:
+    //==============================================================================
+    static bool load(const juce::File& cacheFile, const juce::File& source,
+                     juce::AudioBuffer<float>& dest, double& sampleRate);
+    static void store(const juce::File& cacheFile, const juce::File& source,
+                      const juce::AudioBuffer<float>& data, double sampleRate);
+    static void trim();
+
+    static juce::File getIndexFile(const juce::File& source);
+    static juce::String getContentHash(const juce::File& file);
+
+    static constexpr int formatVersion = 2;
+    static constexpr int dataOffset = 4096;   // header padded to a page so the PCM is page aligned
+
+    static juce::CriticalSection& getLock();
+    static juce::File& getDirectoryStorage();
+};
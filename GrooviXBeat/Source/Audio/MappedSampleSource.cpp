@@ -0,0 +1,165 @@
+/*
+    MappedSampleSource - Memory-mapped WAV/AIFF playback
+*/
+
+#include "MappedSampleSource.h"
+
+//==============================================================================
+std::unique_ptr<juce::MemoryMappedAudioFormatReader> MappedSampleSource::createMappedReader(juce::AudioFormatManager& formatManager,
+                                                                                            const juce::File& file)
+{
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr)
+        return nullptr;
+
+    if (dynamic_cast<juce::WavAudioFormat*>(format) == nullptr
+        && dynamic_cast<juce::AiffAudioFormat*>(format) == nullptr)
+        return nullptr;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+    if (mapped == nullptr || mapped->lengthInSamples <= 0 || !mapped->mapEntireFile())
+        return nullptr;
+
+    if (mapped->getMappedSection().getLength() < mapped->lengthInSamples)
+        return nullptr;
+
+    return mapped;
+}
+
+//==============================================================================
+MappedSampleSource::MappedSampleSource(std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+                                       juce::TimeSliceThread& thread,
+                                       int readAheadSamples)
+    : reader(std::move(mappedReader)),
+      backgroundThread(thread),
+      totalLength(reader->lengthInSamples),
+      readAhead(juce::jmax(1, readAheadSamples)),
+      samplesPerPage(juce::jmax(1, 4096 / juce::jmax(1, (int)reader->numChannels * (int)reader->bitsPerSample / 8)))
+{
+}
+
+MappedSampleSource::~MappedSampleSource()
+{
+    // Waits for an in-progress useTimeSlice() to finish.
+    backgroundThread.removeTimeSliceClient(this);
+}
+
+void MappedSampleSource::prime(juce::int64 startSample)
+{
+    nextPlayPos = juce::jlimit((juce::int64)0, totalLength, startSample);
+    readPosition.store(nextPlayPos, std::memory_order_relaxed);
+
+    // Fault in the start so the first blocks never wait on the disk.
+    const auto primeSamples = juce::jmin((juce::int64)readAhead, (juce::int64)(primeSeconds * reader->sampleRate));
+    touchedStart = nextPlayPos;
+    touchedEnd   = nextPlayPos + primeSamples;
+    touchRange(touchedStart, touchedEnd);
+
+    backgroundThread.addTimeSliceClient(this);
+}
+
+//==============================================================================
+void MappedSampleSource::prepareToPlay(int, double)
+{
+}
+
+void MappedSampleSource::releaseResources()
+{
+}
+
+void MappedSampleSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (info.numSamples <= 0)
+        return;
+
+    const bool isLoopingNow = looping.load(std::memory_order_relaxed);
+    const int destChannels = info.buffer->getNumChannels();
+
+    int destPos   = info.startSample;
+    int remaining = info.numSamples;
+    juce::int64 pos = nextPlayPos;
+
+    while (remaining > 0)
+    {
+        juce::int64 filePos = pos;
+        if (isLoopingNow && totalLength > 0 && pos >= 0)
+            filePos = pos % totalLength;
+
+        int chunk = remaining;
+
+        if (pos < 0 || totalLength <= 0 || filePos >= totalLength)
+        {
+            // Pre-roll or past the end of a non-looping file: silence.
+            if (pos < 0)
+                chunk = (int)juce::jmin((juce::int64)remaining, -pos);
+
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->clear(ch, destPos, chunk);
+        }
+        else
+        {
+            // Straight from the mapping; mono is duplicated to both sides.
+            chunk = (int)juce::jmin((juce::int64)remaining, totalLength - filePos);
+            reader->read(info.buffer, destPos, chunk, filePos, true, true);
+        }
+
+        destPos   += chunk;
+        remaining -= chunk;
+        pos       += chunk;
+    }
+
+    nextPlayPos = pos;
+    readPosition.store(pos, std::memory_order_release);
+}
+
+void MappedSampleSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextPlayPos = newPosition;
+    readPosition.store(newPosition, std::memory_order_release);
+}
+
+juce::int64 MappedSampleSource::getNextReadPosition() const
+{
+    if (looping.load(std::memory_order_relaxed) && totalLength > 0 && nextPlayPos >= 0)
+        return nextPlayPos % totalLength;
+    return nextPlayPos;
+}
+
+//==============================================================================
+void MappedSampleSource::touchRange(juce::int64 streamStart, juce::int64 streamEnd)
+{
+    const bool isLoopingNow = looping.load(std::memory_order_relaxed);
+
+    for (auto pos = juce::jmax((juce::int64)0, streamStart); pos < streamEnd; pos += samplesPerPage)
+    {
+        auto filePos = pos;
+        if (isLoopingNow && totalLength > 0)
+            filePos = pos % totalLength;
+
+        if (filePos >= totalLength)
+            break;
+
+        reader->touchSample(filePos);
+    }
+}
+
+int MappedSampleSource::useTimeSlice()
+{
+    const auto pos = juce::jmax((juce::int64)0, readPosition.load(std::memory_order_acquire));
+
+    // A seek outside what was touched starts the window again from there.
+    if (pos < touchedStart || pos > touchedEnd)
+        touchedEnd = pos;
+
+    touchedStart = pos;
+    const auto wanted = pos + readAhead;
+
+    if (touchedEnd >= wanted)
+        return 10;
+
+    const auto end = juce::jmin(wanted, touchedEnd + touchChunkSamples);
+    touchRange(touchedEnd, end);
+    touchedEnd = end;
+
+    return touchedEnd >= wanted ? 10 : 0;
+}
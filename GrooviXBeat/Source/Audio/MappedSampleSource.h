@@ -0,0 +1,97 @@
+/*
+    MappedSampleSource - Memory-mapped WAV/AIFF playback
+
+    Provides:
+    - createMappedReader(): opens an uncompressed WAV/AIFF file through
+      juce::MemoryMappedAudioFormatReader with the whole file mapped
+    - MappedSampleSource: a PositionableAudioSource that reads straight from
+      the mapping (the OS page cache), so playback starts without decoding
+      the file and tracks playing the same file share its pages
+    - Page prefetch ahead of the play position on the shared streaming
+      thread, so the audio thread does not wait for page faults
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Plays a memory-mapped reader.
+ *
+ * Threads:
+ * - prime() runs on the message thread before the source is handed to the
+ *   audio thread; it touches the first pages and starts the prefetch.
+ * - getNextAudioBlock()/setNextReadPosition()/setLooping() run on the audio
+ *   thread; they only copy/convert from mapped memory.
+ * - useTimeSlice() runs on the streaming thread and touches the pages the
+ *   audio thread is about to read.
+ */
+class MappedSampleSource : public juce::PositionableAudioSource,
+                           private juce::TimeSliceClient
+{
+public:
+    /**
+     * Map a WAV or AIFF file.  Returns nullptr for other formats, or when the
+     * file cannot be mapped (e.g. compressed WAV); callers then fall back to
+     * a normal reader.
+     */
+    static std::unique_ptr<juce::MemoryMappedAudioFormatReader> createMappedReader(juce::AudioFormatManager& formatManager,
+                                                                                   const juce::File& file);
+
+    /**
+     * @param mappedReader      Reader with the whole file mapped (takes ownership).
+     * @param thread            Thread to prefetch on; must outlive this source.
+     * @param readAheadSamples  How far ahead of the play position to keep pages touched.
+     */
+    MappedSampleSource(std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader,
+                       juce::TimeSliceThread& thread,
+                       int readAheadSamples);
+    ~MappedSampleSource() override;
+
+    /** Touch the pages from startSample on, then start prefetching.  Message thread; call once. */
+    void prime(juce::int64 startSample);
+
+    //==============================================================================
+    // AudioSource
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override;
+
+    //==============================================================================
+    // PositionableAudioSource
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override { return totalLength; }
+    bool isLooping() const override { return looping.load(std::memory_order_relaxed); }
+    void setLooping(bool shouldLoop) override { looping.store(shouldLoop, std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+
+    // Touch one sample per page in [streamStart, streamEnd), wrapping when looping.
+    void touchRange(juce::int64 streamStart, juce::int64 streamEnd);
+
+    static constexpr int touchChunkSamples = 65536;
+    static constexpr double primeSeconds = 0.5;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader;
+    juce::TimeSliceThread& backgroundThread;
+
+    const juce::int64 totalLength;
+    const int readAhead;
+    const int samplesPerPage;
+
+    // Audio thread -> streaming thread (stream positions keep increasing across loop wraps)
+    std::atomic<juce::int64> readPosition { 0 };
+    std::atomic<bool> looping { false };
+
+    // Streaming thread
+    juce::int64 touchedStart = 0;
+    juce::int64 touchedEnd = 0;
+
+    // Audio thread
+    juce::int64 nextPlayPos = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedSampleSource)
+};
@@ -0,0 +1,316 @@
+/*
+    PeakPyramid - Multi-resolution min/max/RMS summary of an audio buffer
+*/
+
+#include "PeakPyramid.h"
+
+//==============================================================================
+PeakPyramid::PeakPyramid()
+{
+}
+
+PeakPyramid::~PeakPyramid()
+{
+}
+
+juce::int64 PeakPyramid::blockSize(int level)
+{
+    juce::int64 size = baseBlockSize;
+    for (int i = 0; i < level; ++i)
+        size *= fanOut;
+    return size;
+}
+
+std::vector<size_t> PeakPyramid::levelSizes(int numSamples)
+{
+    std::vector<size_t> sizes;
+    for (juce::int64 n = ((juce::int64)numSamples + baseBlockSize - 1) / baseBlockSize; ; n = (n + fanOut - 1) / fanOut)
+    {
+        sizes.push_back((size_t)n);
+        if (n <= 1)
+            break;
+    }
+    return sizes;
+}
+
+//==============================================================================
+// Buckets
+
+PeakPyramid::Bucket PeakPyramid::summarise(const float* samples, int numSamples)
+{
+    Bucket bucket;
+    if (numSamples <= 0)
+        return bucket;
+
+    auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+
+    float sumSquares = 0.0f;
+    for (int i = 0; i < numSamples; ++i)
+        sumSquares += samples[i] * samples[i];
+
+    bucket.min = range.getStart();
+    bucket.max = range.getEnd();
+    bucket.sumSquares = sumSquares;
+    return bucket;
+}
+
+PeakPyramid::Bucket PeakPyramid::merge(const Bucket* children, int numChildren)
+{
+    Bucket bucket = children[0];
+
+    for (int i = 1; i < numChildren; ++i)
+    {
+        bucket.min = juce::jmin(bucket.min, children[i].min);
+        bucket.max = juce::jmax(bucket.max, children[i].max);
+        bucket.sumSquares += children[i].sumSquares;
+    }
+
+    return bucket;
+}
+
+void PeakPyramid::Accumulator::add(const Bucket& b)
+{
+    min = juce::jmin(min, b.min);
+    max = juce::jmax(max, b.max);
+    sumSquares += b.sumSquares;
+}
+
+void PeakPyramid::Accumulator::addSamples(const float* samples, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    add(summarise(samples, numSamples));
+}
+
+//==============================================================================
+// Building and updating
+
+void PeakPyramid::build(const ChunkedAudio& data)
+{
+    clear();
+    updateFrom(data, 0);
+}
+
+void PeakPyramid::update(const ChunkedAudio& data, int startSample, int length)
+{
+    // A length or layout change moves buckets; only in-place edits take the short path.
+    if (data.getNumSamples() != numSamples || data.getNumChannels() != (int)channels.size())
+    {
+        build(data);
+        return;
+    }
+
+    const juce::int64 start = juce::jlimit(0, numSamples, startSample);
+    const juce::int64 end = juce::jlimit((juce::int64)0, (juce::int64)numSamples, start + juce::jmax(0, length));
+
+    if (start >= end)
+        return;
+
+    for (int ch = 0; ch < (int)channels.size(); ++ch)
+        rebuildRange(data, ch, start, end);
+}
+
+void PeakPyramid::updateFrom(const ChunkedAudio& data, int startSample)
+{
+    numSamples = data.getNumSamples();
+
+    if (numSamples == 0)
+    {
+        clear();
+        return;
+    }
+
+    if (data.getNumChannels() != (int)channels.size())
+    {
+        channels.assign((size_t)data.getNumChannels(), {});
+        startSample = 0;
+    }
+
+    // Level sizes for the new length; vectors keep the buckets before the edit.
+    const auto sizes = levelSizes(numSamples);
+
+    for (auto& levels : channels)
+    {
+        levels.resize(sizes.size());
+        for (size_t level = 0; level < sizes.size(); ++level)
+            levels[level].resize(sizes[level]);
+    }
+
+    // The bucket holding the new end is rebuilt even when nothing follows it,
+    // since it may have lost samples.
+    const juce::int64 start = juce::jlimit(0, numSamples - 1, startSample);
+
+    for (int ch = 0; ch < (int)channels.size(); ++ch)
+        rebuildRange(data, ch, start, numSamples);
+}
+
+void PeakPyramid::clear()
+{
+    channels.clear();
+    numSamples = 0;
+}
+
+void PeakPyramid::rebuildRange(const ChunkedAudio& data, int channel,
+                               juce::int64 startSample, juce::int64 endSample)
+{
+    auto& levels = channels[(size_t)channel];
+    if (levels.empty())
+        return;
+
+    // Level 0 from the samples (a bucket across a piece boundary is gathered)...
+    float scratch[baseBlockSize];
+    juce::int64 first = startSample / baseBlockSize;
+    juce::int64 last = (endSample - 1) / baseBlockSize;
+
+    for (juce::int64 b = first; b <= last; ++b)
+    {
+        const int offset = (int)(b * baseBlockSize);
+        const int length = juce::jmin(baseBlockSize, numSamples - offset);
+        levels[0][(size_t)b] = summarise(data.getReadPointer(channel, offset, length, scratch), length);
+    }
+
+    // ...then each level above from the one below, for the parents of what changed.
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        const auto& below = levels[level - 1];
+        first /= fanOut;
+        last /= fanOut;
+
+        for (juce::int64 b = first; b <= last; ++b)
+        {
+            const size_t child = (size_t)b * fanOut;
+            levels[level][(size_t)b] = merge(below.data() + child, (int)juce::jmin((size_t)fanOut, below.size() - child));
+        }
+    }
+}
+
+//==============================================================================
+// Serialisation
+
+void PeakPyramid::writeTo(juce::OutputStream& out) const
+{
+    out.writeInt((int)channels.size());
+    out.writeInt(numSamples);
+
+    // Native float triples: every platform we build for is little-endian.
+    for (const auto& levels : channels)
+        for (const auto& level : levels)
+            out.write(level.data(), level.size() * sizeof(Bucket));
+}
+
+bool PeakPyramid::readFrom(juce::InputStream& in, int numChannels, int numSamplesToMatch)
+{
+    clear();
+
+    if (in.readInt() != numChannels || in.readInt() != numSamplesToMatch
+        || numChannels <= 0 || numSamplesToMatch <= 0)
+        return false;
+
+    const auto sizes = levelSizes(numSamplesToMatch);
+    std::vector<std::vector<Level>> restored((size_t)numChannels);
+
+    for (auto& levels : restored)
+    {
+        levels.resize(sizes.size());
+        for (size_t level = 0; level < sizes.size(); ++level)
+        {
+            levels[level].resize(sizes[level]);
+            const int bytes = (int)(sizes[level] * sizeof(Bucket));
+            if (in.read(levels[level].data(), bytes) != bytes)
+                return false;  // truncated
+        }
+    }
+
+    channels = std::move(restored);
+    numSamples = numSamplesToMatch;
+    return true;
+}
+
+//==============================================================================
+// Queries
+
+void PeakPyramid::accumulate(const ChunkedAudio& data, int channel, const std::vector<Level>& levels, int level,
+                             juce::int64 start, juce::int64 end, Accumulator& acc) const
+{
+    if (start >= end)
+        return;
+
+    // Take the whole buckets of the coarsest level that has any inside the
+    // range; the two leftover edges are each under one bucket wide and go one
+    // level down.
+    for (level = juce::jmin(level, (int)levels.size() - 1); level >= 0; --level)
+    {
+        const juce::int64 size = blockSize(level);
+        const juce::int64 first = (start + size - 1) / size;
+        const juce::int64 last = end / size;
+
+        if (first < last)
+        {
+            for (juce::int64 b = first; b < last; ++b)
+                acc.add(levels[(size_t)level][(size_t)b]);
+
+            accumulate(data, channel, levels, level - 1, start, first * size, acc);
+            accumulate(data, channel, levels, level - 1, last * size, end, acc);
+            return;
+        }
+    }
+
+    data.forEachSpan(channel, (int)start, (int)(end - start), [&acc](const float* samples, int n)
+    {
+        acc.addSamples(samples, n);
+    });
+}
+
+std::vector<PeakPyramid::Peak> PeakPyramid::getPeaks(const ChunkedAudio& data, int channel,
+                                                     int startSample, int length, int numPoints) const
+{
+    std::vector<Peak> peaks;
+
+    if (numPoints <= 0 || channel < 0 || channel >= data.getNumChannels())
+        return peaks;
+
+    startSample = juce::jlimit(0, data.getNumSamples(), startSample);
+    length = juce::jlimit(0, data.getNumSamples() - startSample, length);
+
+    peaks.resize((size_t)numPoints);
+    if (length == 0)
+        return peaks;
+
+    // Out of step with the data: still correct, just a scan of the samples.
+    static const std::vector<Level> noLevels;
+    const bool inStep = data.getNumSamples() == numSamples && channel < (int)channels.size();
+    jassert(inStep);
+    const auto& levels = inStep ? channels[(size_t)channel] : noLevels;
+
+    const double samplesPerPoint = static_cast<double>(length) / static_cast<double>(numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const juce::int64 start = startSample + static_cast<juce::int64>(i * samplesPerPoint);
+        const juce::int64 end = juce::jmin((juce::int64)startSample + length,
+                                           startSample + static_cast<juce::int64>((i + 1) * samplesPerPoint));
+
+        if (start >= end)
+            continue;
+
+        Accumulator acc;
+        accumulate(data, channel, levels, (int)levels.size() - 1, start, end, acc);
+
+        auto& peak = peaks[(size_t)i];
+        peak.min = acc.min;
+        peak.max = acc.max;
+        peak.rms = (float)std::sqrt(acc.sumSquares / (double)(end - start));
+    }
+
+    return peaks;
+}
+
+size_t PeakPyramid::getSizeInBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& levels : channels)
+        for (const auto& level : levels)
+            bytes += level.size() * sizeof(Bucket);
+    return bytes;
+}
@@ -0,0 +1,118 @@
+/*
+    PeakPyramid - Multi-resolution min/max/RMS summary of an audio buffer
+
+    Provides:
+    - Per channel, a mip pyramid of min / max / sum-of-squares buckets:
+      64 samples per bucket at the bottom, four times coarser per level
+    - update() / updateFrom(): refresh only the buckets an edit touched
+    - getPeaks(): min/max/RMS frames for any sample range and point count,
+      touching a bounded number of buckets per point instead of every sample
+    - writeTo() / readFrom(): the buckets as bytes, for AnalysisCache
+
+    The pyramid holds no audio and no lock; its owner (SampleBuffer) keeps it
+    in step with the data and passes the data in for queries.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "ChunkedAudio.h"
+
+class PeakPyramid
+{
+public:
+    PeakPyramid();
+    ~PeakPyramid();
+
+    // Copied and swapped along with the buffer it summarises (SampleBuffer working copies)
+    PeakPyramid(const PeakPyramid&) = default;
+    PeakPyramid& operator=(const PeakPyramid&) = default;
+    PeakPyramid(PeakPyramid&&) = default;
+    PeakPyramid& operator=(PeakPyramid&&) = default;
+
+    /** One display frame. */
+    struct Peak
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+    };
+
+    /** Rebuild every level from scratch. */
+    void build(const ChunkedAudio& data);
+
+    /** Samples in [startSample, startSample + length) changed in place. */
+    void update(const ChunkedAudio& data, int startSample, int length);
+
+    /**
+     * Everything from startSample on changed or moved (insert, delete, new
+     * length).  Buckets before startSample are kept.
+     */
+    void updateFrom(const ChunkedAudio& data, int startSample);
+
+    void clear();
+
+    bool isBuilt() const noexcept              { return !channels.empty(); }
+
+    /** Buckets as a flat stream: layout header, then every level of every channel. */
+    void writeTo(juce::OutputStream& out) const;
+
+    /**
+     * Restore buckets written by writeTo().  Fails (and leaves the pyramid
+     * cleared) unless they were built from numChannels x numSamples of data.
+     */
+    bool readFrom(juce::InputStream& in, int numChannels, int numSamples);
+
+    /**
+     * numPoints frames covering [startSample, startSample + length) of one
+     * channel.  Exact: partial buckets at the edges of a point are resolved
+     * from finer levels, and below the bottom level from the samples.
+     * The pyramid must be in step with data.
+     */
+    std::vector<Peak> getPeaks(const ChunkedAudio& data, int channel,
+                               int startSample, int length, int numPoints) const;
+
+    /** Heap used by the buckets. */
+    size_t getSizeInBytes() const;
+
+private:
+    //==============================================================================
+    static constexpr int baseBlockSize = 64;   // samples per bucket on level 0
+    static constexpr int fanOut = 4;           // buckets merged per level
+
+    struct Bucket
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float sumSquares = 0.0f;
+    };
+
+    // Running min/max/energy of a query range.
+    struct Accumulator
+    {
+        float min = std::numeric_limits<float>::max();
+        float max = std::numeric_limits<float>::lowest();
+        double sumSquares = 0.0;
+
+        void add(const Bucket& b);
+        void addSamples(const float* samples, int numSamples);
+    };
+
+    using Level = std::vector<Bucket>;
+
+    static juce::int64 blockSize(int level);
+    static std::vector<size_t> levelSizes(int numSamples);
+    static Bucket summarise(const float* samples, int numSamples);
+    static Bucket merge(const Bucket* children, int numChildren);
+
+    void rebuildRange(const ChunkedAudio& data, int channel,
+                      juce::int64 startSample, juce::int64 endSample);
+    void accumulate(const ChunkedAudio& data, int channel, const std::vector<Level>& levels, int level,
+                    juce::int64 start, juce::int64 end, Accumulator& acc) const;
+
+    std::vector<std::vector<Level>> channels;   // [channel][level][bucket]
+    int numSamples = 0;
+
+    JUCE_LEAK_DETECTOR(PeakPyramid)
+};
@@ -4,11 +4,11 @@
 
 #include "SampleBuffer.h"
 #include "SampleDSP.h"
+#include "SamplePool.h"
 
 //==============================================================================
 SampleBuffer::SampleBuffer()
 {
-    formatManager.registerBasicFormats();
 }
 
 SampleBuffer::~SampleBuffer()
@@ -20,62 +20,130 @@ SampleBuffer::~SampleBuffer()
 
 bool SampleBuffer::loadFromFile(const juce::File& file, double targetSampleRate)
 {
-    juce::ScopedLock sl(lock);
-
     if (!file.existsAsFile())
     {
         DBG("SampleBuffer: File not found: " + file.getFullPathName());
         return false;
     }
 
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-    if (reader == nullptr)
+    // Editable copy of the pooled decode: a file already loaded elsewhere is
+    // not decoded again, and the pool copy is dropped if nobody else uses it.
+    juce::SharedResourcePointer<SamplePool> pool;
+    juce::AudioBuffer<float> tempBuffer;
+    double fileSampleRate = 0.0;
+
+    if (auto shared = pool->get(file.getFullPathName()))
+    {
+        tempBuffer = shared->toFloatBuffer();
+        fileSampleRate = shared->getSampleRate();
+    }
+    else
     {
         DBG("SampleBuffer: Could not create reader for: " + file.getFullPathName());
         return false;
     }
 
-    // Allocate temporary buffer for reading
-    int numChannels = static_cast<int>(reader->numChannels);
-    int numSamples = static_cast<int>(reader->lengthInSamples);
-    double fileSampleRate = reader->sampleRate;
-
-    juce::AudioBuffer<float> tempBuffer(numChannels, numSamples);
-
-    // Read the entire file into memory
-    reader->read(&tempBuffer, 0, numSamples, 0, true, true);
+    pool->purgeUnused();
 
-    // Resample if needed
+    // Resample if needed.  This runs before taking the lock, so the
+    // current contents stay readable meanwhile.
     if (targetSampleRate > 0.0 && std::abs(fileSampleRate - targetSampleRate) > 0.01)
     {
         DBG("SampleBuffer: Resampling from " + juce::String(fileSampleRate) +
             " Hz to " + juce::String(targetSampleRate) + " Hz");
 
-        SampleDSP::resample(tempBuffer, data, fileSampleRate, targetSampleRate);
-        sampleRate = targetSampleRate;
+        juce::AudioBuffer<float> resampled;
+        SampleDSP::resample(tempBuffer, resampled, fileSampleRate, targetSampleRate);
+        tempBuffer = std::move(resampled);
+        fileSampleRate = targetSampleRate;
     }
-    else
+
+    // Split into chunks once; edits from here on share them
+    ChunkedAudio loaded(tempBuffer);
+    tempBuffer.setSize(0, 0);
+
+    // Stored analysis: the source index finds an unchanged file without
+    // hashing it; otherwise the content hash finds the same audio under any name.
+    auto matchesBuffer = [&](const AnalysisCache::Entry& entry)
     {
-        // No resampling needed - use the data directly
-        data = std::move(tempBuffer);
-        sampleRate = fileSampleRate;
+        return entry.numChannels == loaded.getNumChannels()
+            && entry.numSamples == loaded.getNumSamples()
+            && std::abs(entry.sampleRate - fileSampleRate) <= 0.01;
+    };
+
+    AnalysisCache::Entry stored;
+    AnalysisCache::ContentHash loadedHash;
+    juce::String loadedKey = AnalysisCache::getKeyFor(file);
+    const bool indexed = AnalysisCache::load(loadedKey, stored) && matchesBuffer(stored);
+    bool cached = indexed;
+
+    if (!cached)
+    {
+        loadedHash.build(loaded, fileSampleRate);
+        loadedKey = loadedHash.getKey();
+        cached = AnalysisCache::load(loadedKey, stored) && matchesBuffer(stored);
     }
 
-    detectedBPM = 0.0;  // Reset BPM - can be detected later
-    stretchFactor = 1.0;
-    playbackOffset = 0.0;
+    // Otherwise one onset analysis gives both the tempo and the transients
+    SampleDSP::OnsetEnvelope loadedOnsets;
+    double loadedBPM = 0.0;
+    std::vector<double> loadedTransients;
+    SampleDSP::Loudness loadedLoudness;
 
-    // Clear original buffer (fresh load)
-    originalData.setSize(0, 0);
+    if (!cached)
+    {
+        loadedOnsets = SampleDSP::analyzeOnsets(loaded, fileSampleRate);
+        loadedBPM = SampleDSP::detectBPM(loadedOnsets);
+        loadedTransients = SampleDSP::detectTransients(loadedOnsets);
+        loadedLoudness = SampleDSP::measureLoudness(loaded, fileSampleRate);
+    }
 
-    // Detect transients after loading
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    {
+        juce::ScopedLock sl(lock);
 
-    DBG("SampleBuffer: Loaded " + file.getFullPathName() +
-        " (" + juce::String(data.getNumSamples()) + " samples, " +
-        juce::String(sampleRate) + " Hz, " +
-        juce::String(numChannels) + " channels, " +
-        juce::String(static_cast<int>(transients.size())) + " transients)");
+        data = std::move(loaded);
+        dropFlatCopy();
+        sampleRate = fileSampleRate;
+
+        stretchFactor = 1.0;
+        playbackOffset = 0.0;
+
+        // Clear original buffer (fresh load)
+        originalData.clear();
+
+        contentHash = std::move(loadedHash);
+        contentKey = loadedKey;
+
+        if (cached)
+        {
+            applyStoredAnalysis(stored);
+        }
+        else
+        {
+            peakPyramid.build(data);
+
+            // Tempo, transients and loudness were measured before taking the lock
+            onsets = std::move(loadedOnsets);
+            detectedBPM = loadedBPM;
+            bpmDetected = true;
+            transients = std::move(loadedTransients);
+            loudness = loadedLoudness;
+            loudnessValid = true;
+        }
+
+        DBG("SampleBuffer: Loaded " + file.getFullPathName() +
+            " (" + juce::String(data.getNumSamples()) + " samples, " +
+            juce::String(sampleRate) + " Hz, " +
+            juce::String(data.getNumChannels()) + " channels, " +
+            juce::String(detectedBPM, 1) + " BPM, " +
+            juce::String(static_cast<int>(transients.size())) + " transients" +
+            (cached ? ", stored analysis)" : ")"));
+    }
+
+    if (!cached)
+        storeAnalysis(file);
+    else if (!indexed)
+        AnalysisCache::rememberSource(file, loadedKey);
 
     return true;
 }
@@ -119,8 +187,12 @@ bool SampleBuffer::saveToFile(const juce::File& file) const
         return false;
     }
 
-    // Write the buffer
-    bool success = writer->writeFromAudioSampleBuffer(data, 0, data.getNumSamples());
+    // Write piece by piece, straight from the chunks
+    bool success = true;
+    data.forEachPiece(0, data.getNumSamples(), [&](const float* const* channels, int numSamples)
+    {
+        success = success && writer->writeFromFloatArrays(channels, data.getNumChannels(), numSamples);
+    });
 
     // Flush writer to ensure all data is on disk before anyone reads the file
     writer.reset();
@@ -141,14 +213,20 @@ bool SampleBuffer::saveToFile(const juce::File& file) const
 
 void SampleBuffer::loadFromBuffer(const juce::AudioBuffer<float>& source, double sourceSampleRate)
 {
+    // Copy, hash and read the store before taking the lock
+    ChunkedAudio loaded(source);
+    auto stored = lookUpStored(loaded, sourceSampleRate);
+
     juce::ScopedLock sl(lock);
 
-    data.makeCopyOf(source);
+    data = std::move(loaded);
     sampleRate = sourceSampleRate;
     detectedBPM = 0.0;
+    bpmDetected = false;
     stretchFactor = 1.0;
     playbackOffset = 0.0;
-    originalData.setSize(0, 0);
+    originalData.clear();
+    contentReplaced(&stored);
 }
 
 bool SampleBuffer::hasData() const
@@ -161,13 +239,70 @@ void SampleBuffer::clear()
 {
     juce::ScopedLock sl(lock);
 
-    data.setSize(0, 0);
-    originalData.setSize(0, 0);
+    data.clear();
+    originalData.clear();
+    dropFlatCopy();
+    peakPyramid.clear();
+    onsets = {};
+    contentHash.clear();
+    contentKey.clear();
+    loudnessValid = false;
     detectedBPM = 0.0;
+    bpmDetected = false;
     stretchFactor = 1.0;
     playbackOffset = 0.0;
 }
 
+std::unique_ptr<SampleBuffer> SampleBuffer::createWorkingCopy() const
+{
+    auto copy = std::make_unique<SampleBuffer>();
+
+    juce::ScopedLock sl(lock);
+
+    copy->data = data;
+    copy->originalData = originalData;
+    copy->sampleRate = sampleRate;
+    copy->detectedBPM = detectedBPM;
+    copy->stretchFactor = stretchFactor;
+    copy->playbackOffset = playbackOffset;
+    copy->transients = transients;
+    copy->peakPyramid = peakPyramid;
+    copy->onsets = onsets;
+    copy->contentHash = contentHash;
+    copy->contentKey = contentKey;
+    copy->loudness = loudness;
+    copy->loudnessValid = loudnessValid;
+    copy->bpmDetected = bpmDetected;
+
+    return copy;
+}
+
+void SampleBuffer::takeContentFrom(SampleBuffer& other)
+{
+    juce::ScopedLock sl(lock);
+    juce::ScopedLock otherLock(other.lock);
+
+    // Swapped rather than copied: other is about to be dropped and takes the
+    // old content with it
+    std::swap(data, other.data);
+    std::swap(originalData, other.originalData);
+    std::swap(sampleRate, other.sampleRate);
+    std::swap(detectedBPM, other.detectedBPM);
+    std::swap(stretchFactor, other.stretchFactor);
+    std::swap(playbackOffset, other.playbackOffset);
+    std::swap(transients, other.transients);
+    std::swap(peakPyramid, other.peakPyramid);
+    std::swap(onsets, other.onsets);
+    std::swap(contentHash, other.contentHash);
+    std::swap(contentKey, other.contentKey);
+    std::swap(loudness, other.loudness);
+    std::swap(loudnessValid, other.loudnessValid);
+    std::swap(bpmDetected, other.bpmDetected);
+
+    dropFlatCopy();
+    other.dropFlatCopy();
+}
+
 //==============================================================================
 // Buffer Access
 
@@ -175,10 +310,17 @@ const float* SampleBuffer::getReadPointer(int channel) const
 {
     juce::ScopedLock sl(lock);
 
-    if (channel >= 0 && channel < data.getNumChannels())
-        return data.getReadPointer(channel);
+    if (channel < 0 || channel >= data.getNumChannels())
+        return nullptr;
+
+    // Contiguous copy of the pieces, made on first use after an edit
+    if (!flatValid)
+    {
+        flatData = data.flatten();
+        flatValid = true;
+    }
 
-    return nullptr;
+    return flatData.getReadPointer(channel);
 }
 
 void SampleBuffer::copyToBuffer(juce::AudioBuffer<float>& dest, int destStartSample,
@@ -192,12 +334,7 @@ void SampleBuffer::copyToBuffer(juce::AudioBuffer<float>& dest, int destStartSam
     if (samplesToCopy <= 0)
         return;
 
-    int channelsToCopy = juce::jmin(dest.getNumChannels(), data.getNumChannels());
-
-    for (int ch = 0; ch < channelsToCopy; ++ch)
-    {
-        dest.copyFrom(ch, destStartSample, data, ch, sourceStartSample, samplesToCopy);
-    }
+    data.copyTo(dest, destStartSample, sourceStartSample, samplesToCopy);
 }
 
 int SampleBuffer::getNumSamples() const
@@ -236,57 +373,55 @@ std::vector<std::pair<float, float>> SampleBuffer::getWaveformPeaks(int numPoint
 
     peaks.reserve(numPoints);
 
-    const float* channelData = data.getReadPointer(0);  // Use first channel
-    int numSamples = data.getNumSamples();
-    double samplesPerPoint = static_cast<double>(numSamples) / static_cast<double>(numPoints);
-
-    for (int i = 0; i < numPoints; ++i)
-    {
-        int startSample = static_cast<int>(i * samplesPerPoint);
-        int endSample = static_cast<int>((i + 1) * samplesPerPoint);
-        endSample = juce::jmin(endSample, numSamples);
-
-        float minVal = 0.0f;
-        float maxVal = 0.0f;
-
-        for (int s = startSample; s < endSample; ++s)
-        {
-            float sample = channelData[s];
-            if (sample < minVal) minVal = sample;
-            if (sample > maxVal) maxVal = sample;
-        }
-
-        peaks.push_back({ minVal, maxVal });
-    }
+    // Whole buffer, first channel; the range always includes zero, as the
+    // editor draws it around the centre line.
+    for (const auto& frame : peakPyramid.getPeaks(data, 0, 0, data.getNumSamples(), numPoints))
+        peaks.push_back({ juce::jmin(0.0f, frame.min), juce::jmax(0.0f, frame.max) });
 
     return peaks;
 }
 
+std::vector<PeakPyramid::Peak> SampleBuffer::getWaveformFrames(int channel, int startSample, int numSamples,
+                                                               int numPoints) const
+{
+    juce::ScopedLock sl(lock);
+    return peakPyramid.getPeaks(data, channel, startSample, numSamples, numPoints);
+}
+
 //==============================================================================
 // Edit Operations
 
 void SampleBuffer::fadeIn(int startSample, int numSamples)
 {
     juce::ScopedLock sl(lock);
-    SampleDSP::fadeIn(data, startSample, numSamples);
-    // Recalculate transients after fade
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    rewriteRange(startSample, numSamples, [](juce::AudioBuffer<float>& range)
+    {
+        SampleDSP::fadeIn(range, 0, range.getNumSamples());
+    });
 }
 
 void SampleBuffer::fadeOut(int startSample, int numSamples)
 {
     juce::ScopedLock sl(lock);
-    SampleDSP::fadeOut(data, startSample, numSamples);
-    // Recalculate transients after fade
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    rewriteRange(startSample, numSamples, [](juce::AudioBuffer<float>& range)
+    {
+        SampleDSP::fadeOut(range, 0, range.getNumSamples());
+    });
 }
 
 void SampleBuffer::silence(int startSample, int numSamples)
 {
     juce::ScopedLock sl(lock);
-    SampleDSP::silence(data, startSample, numSamples);
-    // Recalculate transients after silence
-    transients = SampleDSP::detectTransients(data, sampleRate);
+
+    startSample = juce::jmax(0, startSample);
+    numSamples = juce::jmin(numSamples, data.getNumSamples() - startSample);
+
+    if (numSamples <= 0)
+        return;
+
+    // Pieces of one shared zero chunk; nothing to copy
+    data.replace(startSample, numSamples, ChunkedAudio::silence(data.getNumChannels(), numSamples));
+    contentChanged(startSample, numSamples);
 }
 
 void SampleBuffer::trim(int startSample, int numSamples)
@@ -301,18 +436,11 @@ void SampleBuffer::trim(int startSample, int numSamples)
     if (numSamples <= 0)
         return;
 
-    // Create new buffer with trimmed data
-    juce::AudioBuffer<float> trimmed(data.getNumChannels(), numSamples);
-
-    for (int ch = 0; ch < data.getNumChannels(); ++ch)
-    {
-        trimmed.copyFrom(ch, 0, data, ch, startSample, numSamples);
-    }
+    // Keep the pieces of the range; no samples are copied
+    data = data.getRange(startSample, numSamples);
 
-    data = std::move(trimmed);
-
-    // Recalculate transients on trimmed buffer
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    // Every sample moved
+    contentChangedFrom(0);
 
     DBG("SampleBuffer: Trimmed to " + juce::String(numSamples) + " samples (" +
         juce::String(static_cast<int>(transients.size())) + " transients)");
@@ -330,26 +458,11 @@ void SampleBuffer::deleteRange(int startSample, int numSamples)
     if (numSamples <= 0 || numSamples >= data.getNumSamples())
         return;
 
-    int newLength = data.getNumSamples() - numSamples;
-    juce::AudioBuffer<float> newBuffer(data.getNumChannels(), newLength);
-
-    for (int ch = 0; ch < data.getNumChannels(); ++ch)
-    {
-        // Copy before deleted range
-        if (startSample > 0)
-            newBuffer.copyFrom(ch, 0, data, ch, 0, startSample);
+    // Drop the pieces of the range; the rest is not copied
+    data.erase(startSample, numSamples);
 
-        // Copy after deleted range
-        int afterStart = startSample + numSamples;
-        int afterLength = data.getNumSamples() - afterStart;
-        if (afterLength > 0)
-            newBuffer.copyFrom(ch, startSample, data, ch, afterStart, afterLength);
-    }
-
-    data = std::move(newBuffer);
-
-    // Recalculate transients
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    // Everything before the deleted range keeps its analysis
+    contentChangedFrom(startSample);
 
     DBG("SampleBuffer: Deleted range, new length " + juce::String(data.getNumSamples()) + " samples");
 }
@@ -364,20 +477,24 @@ juce::AudioBuffer<float> SampleBuffer::copyRange(int startSample, int numSamples
     numSamples = juce::jlimit(0, maxStart - startSample, numSamples);
 
     juce::AudioBuffer<float> result(data.getNumChannels(), numSamples);
-
-    if (numSamples > 0)
-    {
-        for (int ch = 0; ch < data.getNumChannels(); ++ch)
-        {
-            result.copyFrom(ch, 0, data, ch, startSample, numSamples);
-        }
-    }
+    data.copyTo(result, 0, startSample, numSamples);
 
     DBG("SampleBuffer: Copied " + juce::String(numSamples) + " samples");
     return result;
 }
 
+ChunkedAudio SampleBuffer::getRange(int startSample, int numSamples) const
+{
+    juce::ScopedLock sl(lock);
+    return data.getRange(startSample, numSamples);
+}
+
 void SampleBuffer::insertBuffer(const juce::AudioBuffer<float>& source, int insertPosition)
+{
+    insertBuffer(ChunkedAudio(source), insertPosition);
+}
+
+void SampleBuffer::insertBuffer(const ChunkedAudio& source, int insertPosition)
 {
     juce::ScopedLock sl(lock);
 
@@ -387,55 +504,74 @@ void SampleBuffer::insertBuffer(const juce::AudioBuffer<float>& source, int inse
     // Validate insert position
     insertPosition = juce::jlimit(0, data.getNumSamples(), insertPosition);
 
-    int numChannels = juce::jmin(data.getNumChannels(), source.getNumChannels());
-    int newLength = data.getNumSamples() + source.getNumSamples();
+    // Splice the source's pieces in (a source with fewer channels narrows the buffer)
+    data.insert(insertPosition, source);
 
-    juce::AudioBuffer<float> newBuffer(numChannels, newLength);
+    // Everything before the insert point keeps its analysis
+    contentChangedFrom(insertPosition);
 
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        // Copy before insert point
-        if (insertPosition > 0)
-            newBuffer.copyFrom(ch, 0, data, ch, 0, insertPosition);
+    DBG("SampleBuffer: Inserted " + juce::String(source.getNumSamples()) + " samples at position " +
+        juce::String(insertPosition) + ", new length " + juce::String(data.getNumSamples()));
+}
 
-        // Copy inserted data
-        newBuffer.copyFrom(ch, insertPosition, source, ch, 0, source.getNumSamples());
+void SampleBuffer::replaceRange(int startSample, int numSamples, const ChunkedAudio& replacement)
+{
+    // Replacing everything (undo / redo of a stretch or warp): the replacement
+    // may have been analysed before, so read the store before taking the lock
+    StoredLookup stored;
+    if (startSample <= 0 && (numSamples < 0 || numSamples >= getNumSamples()))
+        stored = lookUpStored(replacement, getSampleRate());
+
+    juce::ScopedLock sl(lock);
+
+    const int currentLength = data.getNumSamples();
+    startSample = juce::jlimit(0, currentLength, startSample);
+    numSamples = numSamples < 0 ? currentLength - startSample
+                                : juce::jlimit(0, currentLength - startSample, numSamples);
 
-        // Copy after insert point
-        int afterLength = data.getNumSamples() - insertPosition;
-        if (afterLength > 0)
-            newBuffer.copyFrom(ch, insertPosition + source.getNumSamples(), data, ch, insertPosition, afterLength);
+    // The whole buffer: take the replacement as it is (stretch, warp, reset)
+    if (startSample == 0 && numSamples == currentLength)
+    {
+        data = replacement;
+        contentReplaced(&stored);
+        return;
     }
 
-    data = std::move(newBuffer);
+    jassert(replacement.getNumSamples() == 0 || replacement.getNumChannels() >= data.getNumChannels());
 
-    // Recalculate transients
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    data.replace(startSample, numSamples, replacement);
 
-    DBG("SampleBuffer: Inserted " + juce::String(source.getNumSamples()) + " samples at position " +
-        juce::String(insertPosition) + ", new length " + juce::String(data.getNumSamples()));
+    // Same length: only the range changed; otherwise everything after it moved
+    if (replacement.getNumSamples() == numSamples)
+        contentChanged(startSample, numSamples);
+    else
+        contentChangedFrom(startSample);
 }
 
-void SampleBuffer::timeStretch(double ratio, double targetLengthSeconds)
+void SampleBuffer::timeStretch(double ratio, double targetLengthSeconds, SampleDSP::Progress* progress)
 {
     juce::ScopedLock sl(lock);
 
     if (ratio <= 0.0)
         return;
 
-    // Store original if not already stored
+    // Store original if not already stored (shares the chunks)
     if (originalData.getNumSamples() == 0)
     {
-        originalData.makeCopyOf(data);
+        originalData = data;
     }
 
     // Only do actual time stretching if ratio is not 1.0
     if (ratio != 1.0)
     {
+        // Every output sample depends on the whole input: stretch a contiguous copy
         juce::AudioBuffer<float> stretched;
-        SampleDSP::timeStretch(data, stretched, ratio);
+        SampleDSP::timeStretch(data.flatten(), stretched, ratio, progress);
 
-        data = std::move(stretched);
+        if (progress != nullptr && progress->isCancelled())
+            return;
+
+        data = ChunkedAudio(stretched);
         stretchFactor *= ratio;
     }
 
@@ -445,23 +581,28 @@ void SampleBuffer::timeStretch(double ratio, double targetLengthSeconds)
         padOrTrimToLength(targetLengthSeconds);
     }
 
-    // Recalculate transients on the buffer
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    // One analysis of the final buffer (peaks, onsets, transients)
+    contentReplaced();
 
     DBG("SampleBuffer: Time stretched by " + juce::String(ratio, 3) +
         " (total factor: " + juce::String(stretchFactor, 3) +
         ", " + juce::String(static_cast<int>(transients.size())) + " transients)");
 }
 
-void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
+void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds, SampleDSP::Progress* progress)
 {
+    // A warp back to the original's tempo restores the original: read its
+    // stored analysis before taking the lock
+    StoredLookup stored;
+    if (const double bpm = getDetectedBPM(); bpm > 0.0 && targetBPM > 0.0 && std::abs(bpm / targetBPM - 1.0) <= 0.001)
+        stored = lookUpOriginal();
+
     juce::ScopedLock sl(lock);
 
-    // Need detected BPM to warp
+    // Need detected BPM to warp (measured once, then kept)
     if (detectedBPM <= 0.0)
     {
-        detectedBPM = SampleDSP::detectBPM(originalData.getNumSamples() > 0 ? originalData : data,
-                                           sampleRate);
+        detectBPM();
     }
 
     if (detectedBPM <= 0.0 || targetBPM <= 0.0)
@@ -474,10 +615,10 @@ void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
     // we need to stretch by 140/120 = 1.167 (make it longer/slower)
     double ratio = detectedBPM / targetBPM;
 
-    // Store original if not stored
+    // Store original if not stored (shares the chunks)
     if (originalData.getNumSamples() == 0)
     {
-        originalData.makeCopyOf(data);
+        originalData = data;
     }
 
     // Only do actual time stretching if ratio is not 1.0 (BPMs don't match)
@@ -485,9 +626,12 @@ void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
     {
         // Apply stretch to original (not current) for consistent warping
         juce::AudioBuffer<float> stretched;
-        SampleDSP::timeStretch(originalData, stretched, ratio);
+        SampleDSP::timeStretch(originalData.flatten(), stretched, ratio, progress);
 
-        data = std::move(stretched);
+        if (progress != nullptr && progress->isCancelled())
+            return;
+
+        data = ChunkedAudio(stretched);
         stretchFactor = ratio;
     }
     else
@@ -495,7 +639,7 @@ void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
         // BPMs match - just restore from original if we have it
         if (originalData.getNumSamples() > 0)
         {
-            data.makeCopyOf(originalData);
+            data = originalData;
         }
         stretchFactor = 1.0;
     }
@@ -506,8 +650,9 @@ void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
         padOrTrimToLength(targetLengthSeconds);
     }
 
-    // Recalculate transients on the warped buffer
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    // One analysis of the warped buffer; a warp back to the original's tempo
+    // finds the original's stored analysis
+    contentReplaced(&stored);
 
     DBG("SampleBuffer: Warped from " + juce::String(detectedBPM, 1) + " BPM to " +
         juce::String(targetBPM, 1) + " BPM (ratio: " + juce::String(ratio, 3) +
@@ -516,7 +661,8 @@ void SampleBuffer::applyWarp(double targetBPM, double targetLengthSeconds)
 
 void SampleBuffer::padOrTrimToLength(double targetLengthSeconds)
 {
-    // Note: Assumes lock is already held by caller
+    // Note: Assumes lock is already held by caller, and that the caller
+    // brings the analysis up to date afterwards (contentReplaced())
     if (targetLengthSeconds <= 0.0 || sampleRate <= 0.0)
         return;
 
@@ -529,17 +675,8 @@ void SampleBuffer::padOrTrimToLength(double targetLengthSeconds)
 
     if (targetSamples > currentSamples)
     {
-        // Pad with silence: create larger buffer, copy existing data, zero the rest
-        juce::AudioBuffer<float> padded(numChannels, targetSamples);
-        padded.clear();  // Fill with zeros (silence)
-
-        // Copy existing audio data to the beginning
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            padded.copyFrom(ch, 0, data, ch, 0, currentSamples);
-        }
-
-        data = std::move(padded);
+        // Pad with silence: append pieces of a shared zero chunk
+        data.insert(currentSamples, ChunkedAudio::silence(numChannels, targetSamples - currentSamples));
 
         DBG("SampleBuffer: Padded from " + juce::String(currentSamples) +
             " to " + juce::String(targetSamples) + " samples (added " +
@@ -548,14 +685,7 @@ void SampleBuffer::padOrTrimToLength(double targetLengthSeconds)
     else
     {
         // Trim: keep only the first targetSamples
-        juce::AudioBuffer<float> trimmed(numChannels, targetSamples);
-
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            trimmed.copyFrom(ch, 0, data, ch, 0, targetSamples);
-        }
-
-        data = std::move(trimmed);
+        data.erase(targetSamples, currentSamples - targetSamples);
 
         DBG("SampleBuffer: Trimmed from " + juce::String(currentSamples) +
             " to " + juce::String(targetSamples) + " samples");
@@ -569,17 +699,38 @@ double SampleBuffer::detectBPM()
 {
     juce::ScopedLock sl(lock);
 
-    // Use original buffer if available, otherwise current
-    const juce::AudioBuffer<float>& sourceBuffer =
-        originalData.getNumSamples() > 0 ? originalData : data;
+    // Measured (or restored from the analysis store) and unchanged since
+    if (bpmDetected)
+        return detectedBPM;
 
-    detectedBPM = SampleDSP::detectBPM(sourceBuffer, sampleRate);
+    // Use original buffer if available, otherwise current (whose onsets are kept up to date)
+    if (originalData.getNumSamples() > 0)
+    {
+        detectedBPM = SampleDSP::detectBPM(SampleDSP::analyzeOnsets(originalData, sampleRate));
+    }
+    else
+    {
+        ensureOnsets();
+        detectedBPM = SampleDSP::detectBPM(onsets);
+    }
+
+    bpmDetected = true;
 
     DBG("SampleBuffer: Detected BPM = " + juce::String(detectedBPM, 1));
 
     return detectedBPM;
 }
 
+void SampleBuffer::setDetectedBPM(double bpm)
+{
+    juce::ScopedLock sl(lock);
+
+    if (bpm != detectedBPM)
+        bpmDetected = false;
+
+    detectedBPM = bpm;
+}
+
 //==============================================================================
 // Transient Detection
 
@@ -587,19 +738,94 @@ void SampleBuffer::detectTransients()
 {
     juce::ScopedLock sl(lock);
 
-    // Always detect transients on current data buffer (which may be stretched/edited)
-    transients = SampleDSP::detectTransients(data, sampleRate);
+    // Transients of the current data buffer (which may be stretched/edited)
+    // are kept in step by every edit, or restored from the analysis store;
+    // only detect again if they were cleared
+    if (transients.empty())
+        refreshTransients();
 
     DBG("SampleBuffer: Detected " + juce::String(static_cast<int>(transients.size())) + " transients");
 }
 
+//==============================================================================
+// Loudness and Analysis Store
+
+SampleDSP::Loudness SampleBuffer::getLoudness()
+{
+    juce::ScopedLock sl(lock);
+
+    if (!loudnessValid)
+    {
+        loudness = SampleDSP::measureLoudness(data, sampleRate);
+        loudnessValid = true;
+    }
+
+    return loudness;
+}
+
+juce::String SampleBuffer::getContentKey()
+{
+    juce::ScopedLock sl(lock);
+
+    if (contentKey.isEmpty() && data.getNumSamples() > 0)
+    {
+        if (!contentHash.isBuilt())
+            contentHash.build(data, sampleRate);
+
+        contentKey = contentHash.getKey();
+    }
+
+    return contentKey;
+}
+
+void SampleBuffer::storeAnalysis(const juce::File& sourceFile)
+{
+    AnalysisCache::Entry entry;
+    juce::String key;
+
+    {
+        juce::ScopedLock sl(lock);
+
+        if (data.getNumSamples() == 0)
+            return;
+
+        key = getContentKey();
+
+        entry.sampleRate = sampleRate;
+        entry.numChannels = data.getNumChannels();
+        entry.numSamples = data.getNumSamples();
+
+        // The tempo belongs to this content only when it was measured on it
+        // (not on the original of a stretched buffer)
+        entry.bpm = (bpmDetected && originalData.getNumSamples() == 0) ? detectedBPM : 0.0;
+        entry.transients = transients;
+        entry.loudness = getLoudness();
+
+        juce::MemoryOutputStream peaksOut(entry.peaks, false);
+        peakPyramid.writeTo(peaksOut);
+    }
+
+    // Disk I/O outside the lock
+    AnalysisCache::store(key, entry);
+
+    // A saved WAV is 16-bit, so its decode hashes differently from data;
+    // the source index is what finds this entry again when it is reloaded.
+    if (sourceFile != juce::File())
+        AnalysisCache::rememberSource(sourceFile, key);
+}
+
 //==============================================================================
 // Non-Destructive Editing Support
 
 void SampleBuffer::storeAsOriginal()
 {
     juce::ScopedLock sl(lock);
-    originalData.makeCopyOf(data);
+
+    // Shares the chunks; later edits replace pieces of data, never chunk contents
+    originalData = data;
+
+    // detectBPM() measures the original from now on
+    bpmDetected = false;
 }
 
 bool SampleBuffer::hasOriginal() const
@@ -608,18 +834,26 @@ bool SampleBuffer::hasOriginal() const
     return originalData.getNumSamples() > 0;
 }
 
+ChunkedAudio SampleBuffer::getOriginal() const
+{
+    juce::ScopedLock sl(lock);
+    return originalData;
+}
+
 void SampleBuffer::reset()
 {
+    auto stored = lookUpOriginal();
+
     juce::ScopedLock sl(lock);
 
     if (originalData.getNumSamples() > 0)
     {
-        data.makeCopyOf(originalData);
+        data = originalData;
         stretchFactor = 1.0;
         playbackOffset = 0.0;
 
-        // Recalculate transients on the original buffer
-        transients = SampleDSP::detectTransients(data, sampleRate);
+        // Usually served from the analysis store (the original was stored on load)
+        contentReplaced(&stored);
 
         DBG("SampleBuffer: Reset to original (" +
             juce::String(static_cast<int>(transients.size())) + " transients)");
@@ -629,9 +863,165 @@ void SampleBuffer::reset()
 //==============================================================================
 // Internal Helpers
 
-void SampleBuffer::timeStretchInternal(const juce::AudioBuffer<float>& source,
-                                        juce::AudioBuffer<float>& dest,
-                                        double ratio)
+void SampleBuffer::rewriteRange(int startSample, int numSamples,
+                                const std::function<void(juce::AudioBuffer<float>&)>& process)
 {
-    SampleDSP::timeStretch(source, dest, ratio);
+    startSample = juce::jmax(0, startSample);
+    numSamples = juce::jmin(numSamples, data.getNumSamples() - startSample);
+
+    if (numSamples <= 0)
+        return;
+
+    // Copy-on-write: the range is processed in a copy and spliced back in as
+    // new chunks; chunks shared with the original or undo steps stay as they are
+    juce::AudioBuffer<float> range(data.getNumChannels(), numSamples);
+    data.copyTo(range, 0, startSample, numSamples);
+    process(range);
+
+    data.replace(startSample, numSamples, ChunkedAudio(range));
+    contentChanged(startSample, numSamples);
+}
+
+void SampleBuffer::dropFlatCopy()
+{
+    flatData.setSize(0, 0);
+    flatValid = false;
+}
+
+void SampleBuffer::contentChanged(int startSample, int numSamples)
+{
+    // Samples changed in place: refresh only the buckets, hops and hash
+    // blocks they fall in
+    dropFlatCopy();
+    peakPyramid.update(data, startSample, numSamples);
+
+    if (onsets.hopSize > 0)
+        SampleDSP::updateOnsets(onsets, data, startSample, numSamples);
+
+    if (contentHash.isBuilt())
+        contentHash.update(data, startSample, numSamples);
+
+    contentKey.clear();
+    loudnessValid = false;
+
+    if (originalData.getNumSamples() == 0)
+        bpmDetected = false;
+
+    refreshTransients();
+}
+
+void SampleBuffer::contentChangedFrom(int startSample)
+{
+    // Everything from startSample on changed or moved; what comes before is kept
+    dropFlatCopy();
+    peakPyramid.updateFrom(data, startSample);
+
+    if (onsets.hopSize > 0)
+        SampleDSP::updateOnsetsFrom(onsets, data, startSample);
+
+    if (contentHash.isBuilt())
+        contentHash.updateFrom(data, startSample);
+
+    contentKey.clear();
+    loudnessValid = false;
+
+    if (originalData.getNumSamples() == 0)
+        bpmDetected = false;
+
+    refreshTransients();
+}
+
+SampleBuffer::StoredLookup SampleBuffer::lookUpStored(const ChunkedAudio& content, double rate)
+{
+    StoredLookup lookup;
+    lookup.sampleRate = rate;
+    lookup.hash.build(content, rate);
+    lookup.key = lookup.hash.getKey();
+    lookup.found = AnalysisCache::load(lookup.key, lookup.entry);
+    return lookup;
+}
+
+SampleBuffer::StoredLookup SampleBuffer::lookUpOriginal() const
+{
+    ChunkedAudio original;
+    double rate = 0.0;
+    {
+        juce::ScopedLock sl(lock);
+        original = originalData;    // shares the chunks
+        rate = sampleRate;
+    }
+
+    if (original.getNumSamples() == 0)
+        return {};
+
+    // Only the key and entry: data is the original again only by the time
+    // contentReplaced() runs, so its hash is rebuilt there
+    auto lookup = lookUpStored(original, rate);
+    lookup.hash.clear();
+    return lookup;
+}
+
+void SampleBuffer::contentReplaced(StoredLookup* stored)
+{
+    // All of data is new; it may still be audio the store has seen
+    // (reset, undo, a warp back to the original tempo).  The store itself is
+    // only read by the lookups, before the caller took the lock.
+    dropFlatCopy();
+
+    if (stored != nullptr && stored->hash.isBuilt() && stored->sampleRate == sampleRate)
+        contentHash = std::move(stored->hash);
+    else
+        contentHash.build(data, sampleRate);
+
+    contentKey = contentHash.getKey();
+
+    if (stored != nullptr && stored->found && stored->key == contentKey
+        && stored->entry.numChannels == data.getNumChannels()
+        && stored->entry.numSamples == data.getNumSamples())
+    {
+        applyStoredAnalysis(stored->entry);
+        return;
+    }
+
+    peakPyramid.build(data);
+    onsets = SampleDSP::analyzeOnsets(data, sampleRate);
+    loudnessValid = false;
+
+    if (originalData.getNumSamples() == 0)
+        bpmDetected = false;
+
+    transients = SampleDSP::detectTransients(onsets);
+}
+
+void SampleBuffer::refreshTransients()
+{
+    ensureOnsets();
+    transients = SampleDSP::detectTransients(onsets);
+}
+
+void SampleBuffer::ensureOnsets()
+{
+    // Not built after a store hit, until something needs it
+    if (onsets.hopSize <= 0 || onsets.numSamples != data.getNumSamples()
+        || onsets.numChannels != data.getNumChannels())
+        onsets = SampleDSP::analyzeOnsets(data, sampleRate);
+}
+
+void SampleBuffer::applyStoredAnalysis(const AnalysisCache::Entry& entry)
+{
+    juce::MemoryInputStream peaksIn(entry.peaks, false);
+    if (!peakPyramid.readFrom(peaksIn, data.getNumChannels(), data.getNumSamples()))
+        peakPyramid.build(data);
+
+    transients = entry.transients;
+    loudness = entry.loudness;
+    loudnessValid = true;
+    onsets = {};
+
+    // The stored tempo is this content's; it is the BPM source unless an original is kept
+    if (originalData.getNumSamples() == 0)
+    {
+        detectedBPM = entry.bpm;
+        bpmDetected = entry.bpm > 0.0;
+    }
 }
@@ -2,10 +2,17 @@
     SampleBuffer - Thread-safe container for editable audio data
 
     Provides:
-    - In-memory audio buffer for editing
-    - Original buffer preservation for non-destructive editing
+    - In-memory audio buffer for editing, held as a ChunkedAudio piece
+      table: cut, paste, trim and undo splice pieces instead of copying
+      the whole buffer, and in-place edits write new chunks for their range
+    - Original buffer preservation for non-destructive editing (shares chunks)
     - Thread-safe access between audio and UI threads
     - Sample-level editing operations
+    - Min/max/RMS peak pyramid, kept up to date by the edits, for waveform
+      display at any zoom
+    - Onset envelope, transients and content hash kept up to date the same
+      way; tempo, transients, peaks and loudness are served from
+      AnalysisCache when the content has been analysed before
 */
 
 #pragma once
@@ -13,6 +20,13 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <utility>
+#include <functional>
+#include <memory>
+#include "ChunkedAudio.h"
+#include "PeakPyramid.h"
+#include "DSPWorkerPool.h"
+#include "SampleDSP.h"
+#include "AnalysisCache.h"
 
 class SampleBuffer
 {
@@ -25,6 +39,8 @@ public:
 
     /**
      * Load audio data from a file. Returns true on success.
+     * Analysis comes from AnalysisCache when the file (or the same content)
+     * was analysed before; otherwise it runs here and is stored.
      * @param file The audio file to load
      * @param targetSampleRate If > 0, resample to this rate. If 0, keep original rate.
      */
@@ -42,10 +58,29 @@ public:
     /** Clear all data */
     void clear();
 
+    /**
+     * A copy of the buffer and its analysis to edit elsewhere, e.g. on a
+     * background job.  Shares the audio chunks; only the peak pyramid and
+     * analysis are copied.
+     */
+    std::unique_ptr<SampleBuffer> createWorkingCopy() const;
+
+    /**
+     * Take over another buffer's audio and analysis in one step under the
+     * lock (other gets this buffer's old content).
+     */
+    void takeContentFrom(SampleBuffer& other);
+
     //==============================================================================
     // Buffer Access (for playback)
 
-    /** Get read pointer to channel data. Thread-safe via lock. */
+    /**
+     * Get read pointer to channel data.
+     * Legacy contiguous access: the pieces are flattened into a copy on the
+     * first call after an edit; prefer copyToBuffer() or getWaveformFrames().
+     * The pointer is into that copy, which every edit frees: it is only valid
+     * while the caller holds getLock(), and must not be kept past it.
+     */
     const float* getReadPointer(int channel) const;
 
     /** Copy samples to destination buffer for playback */
@@ -74,6 +109,17 @@ public:
      */
     std::vector<std::pair<float, float>> getWaveformPeaks(int numPoints) const;
 
+    /**
+     * Get min/max/RMS frames for a zoomed range, from the peak pyramid.
+     * Cost is proportional to numPoints, not to the length of the range.
+     * @param channel Channel to summarise
+     * @param startSample First sample of the range
+     * @param numSamples Length of the range
+     * @param numPoints Number of frames to return
+     */
+    std::vector<PeakPyramid::Peak> getWaveformFrames(int channel, int startSample, int numSamples,
+                                                     int numPoints) const;
+
     //==============================================================================
     // Edit Operations (modify current buffer)
 
@@ -95,20 +141,40 @@ public:
     /** Copy a range from the buffer to a new buffer */
     juce::AudioBuffer<float> copyRange(int startSample, int numSamples) const;
 
+    /** Copy a range as pieces sharing this buffer's chunks (no samples copied) */
+    ChunkedAudio getRange(int startSample, int numSamples) const;
+
     /** Insert another buffer at a specified position */
     void insertBuffer(const juce::AudioBuffer<float>& source, int insertPosition);
 
+    /** Insert audio at a specified position, sharing its chunks */
+    void insertBuffer(const ChunkedAudio& source, int insertPosition);
+
+    /**
+     * Replace a range with other samples (any length), as SampleEditor's
+     * undo records do.  Replacing the whole buffer also takes the
+     * replacement's channel count.
+     * @param startSample First sample of the range
+     * @param numSamples Length of the range; -1 for everything from startSample on
+     * @param replacement Samples to put in its place
+     */
+    void replaceRange(int startSample, int numSamples, const ChunkedAudio& replacement);
+
     /** Time stretch the buffer by a ratio (e.g., 2.0 = twice as long)
      *  @param ratio Stretch ratio
      *  @param targetLengthSeconds If > 0, pad/trim to this length after stretching
+     *  @param progress If given, receives the stretch's progress; if cancelled, the buffer is left as it was
      */
-    void timeStretch(double ratio, double targetLengthSeconds = 0.0);
+    void timeStretch(double ratio, double targetLengthSeconds = 0.0,
+                     SampleDSP::Progress* progress = nullptr);
 
     /** Apply warp to match target BPM (uses detected or stored BPM)
      *  @param targetBPM Target BPM to match
      *  @param targetLengthSeconds If > 0, pad/trim to this length after warping
+     *  @param progress If given, receives the stretch's progress; if cancelled, the buffer is left as it was
      */
-    void applyWarp(double targetBPM, double targetLengthSeconds = 0.0);
+    void applyWarp(double targetBPM, double targetLengthSeconds = 0.0,
+                   SampleDSP::Progress* progress = nullptr);
 
     /** Pad or trim buffer to exact length
      *  @param targetLengthSeconds Target length in seconds
@@ -118,19 +184,19 @@ public:
     //==============================================================================
     // BPM Detection and Storage
 
-    /** Detect BPM from buffer content */
+    /** Detect BPM from buffer content (cached until the analysed audio changes) */
     double detectBPM();
 
     /** Get stored/detected BPM */
     double getDetectedBPM() const { return detectedBPM; }
 
-    /** Set BPM manually (for user override) */
-    void setDetectedBPM(double bpm) { detectedBPM = bpm; }
+    /** Set BPM manually (for user override); the next detectBPM() measures again */
+    void setDetectedBPM(double bpm);
 
     //==============================================================================
     // Transient Detection
 
-    /** Detect transients in the buffer */
+    /** Detect transients in the buffer (kept up to date by the edits, so usually free) */
     void detectTransients();
 
     /** Get detected transient positions in seconds */
@@ -139,6 +205,22 @@ public:
     /** Clear transient data */
     void clearTransients() { transients.clear(); }
 
+    //==============================================================================
+    // Loudness and Analysis Store
+
+    /** RMS and integrated loudness of the current buffer (measured on first use after an edit) */
+    SampleDSP::Loudness getLoudness();
+
+    /** AnalysisCache key of the current buffer content */
+    juce::String getContentKey();
+
+    /**
+     * Write the current analysis (BPM, transients, peaks, loudness) to
+     * AnalysisCache under the content key.
+     * @param sourceFile If given, the file now holding this content (e.g. just saved)
+     */
+    void storeAnalysis(const juce::File& sourceFile = {});
+
     //==============================================================================
     // Non-Destructive Editing Support
 
@@ -148,12 +230,18 @@ public:
     /** Check if original buffer is stored */
     bool hasOriginal() const;
 
+    /** The stored original, sharing its chunks (empty if none) */
+    ChunkedAudio getOriginal() const;
+
     /** Reset to original buffer */
     void reset();
 
     /** Get current stretch factor (1.0 = no stretch) */
     double getStretchFactor() const { return stretchFactor; }
 
+    /** Restore a stretch factor (undo) */
+    void setStretchFactor(double factor) { stretchFactor = factor; }
+
     //==============================================================================
     // Playback Offset
 
@@ -170,21 +258,56 @@ public:
     juce::CriticalSection& getLock() { return lock; }
 
 private:
-    juce::AudioBuffer<float> data;          // Main editable buffer
-    juce::AudioBuffer<float> originalData;  // Original for non-destructive operations
+    ChunkedAudio data;                      // Main editable buffer
+    ChunkedAudio originalData;              // Original for non-destructive operations
+    mutable juce::AudioBuffer<float> flatData;  // getReadPointer() copy of data, freed by every edit
+    mutable bool flatValid = false;
     double sampleRate = 44100.0;
     double detectedBPM = 0.0;
     double stretchFactor = 1.0;
     double playbackOffset = 0.0;
     std::vector<double> transients;         // Detected transient positions in seconds
+    PeakPyramid peakPyramid;                // Waveform summary of data, updated by every edit
+
+    // Analysis of data, kept in step by the edits.  After a cache hit the
+    // envelope and hash are built on first need instead of at load.
+    SampleDSP::OnsetEnvelope onsets;
+    AnalysisCache::ContentHash contentHash;
+    juce::String contentKey;                // cached contentHash.getKey(); empty when stale
+    SampleDSP::Loudness loudness;
+    bool loudnessValid = false;
+    bool bpmDetected = false;               // detectedBPM was measured on the current BPM source
 
-    juce::AudioFormatManager formatManager;
     mutable juce::CriticalSection lock;
 
-    // Internal helper for time stretching
-    void timeStretchInternal(const juce::AudioBuffer<float>& source,
-                            juce::AudioBuffer<float>& dest,
-                            double ratio);
+    // Keeps the stretch / resample workers running between operations
+    juce::SharedResourcePointer<DSPWorkerPool> dspWorkers;
+
+    // Stored analysis for content about to replace data, read from
+    // AnalysisCache before taking the lock (the lookups do disk I/O and are
+    // called without it)
+    struct StoredLookup
+    {
+        AnalysisCache::ContentHash hash;    // built when the lookup hashed the new content itself
+        double sampleRate = 0.0;
+        juce::String key;
+        AnalysisCache::Entry entry;
+        bool found = false;
+    };
+
+    static StoredLookup lookUpStored(const ChunkedAudio& content, double rate);
+    StoredLookup lookUpOriginal() const;
+
+    // Edits and analysis upkeep; all called with the lock held
+    void rewriteRange(int startSample, int numSamples,
+                      const std::function<void(juce::AudioBuffer<float>&)>& process);
+    void dropFlatCopy();
+    void contentChanged(int startSample, int numSamples);
+    void contentChangedFrom(int startSample);
+    void contentReplaced(StoredLookup* stored = nullptr);
+    void refreshTransients();
+    void ensureOnsets();
+    void applyStoredAnalysis(const AnalysisCache::Entry& entry);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleBuffer)
 };
@@ -3,95 +3,137 @@
 */
 
 #include "SampleDSP.h"
+#include "DSPWorkerPool.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
 #include <vector>
 
+//==============================================================================
+// Progress and Cancellation
+
+void SampleDSP::Progress::setRange(double start, double end)
+{
+    rangeStart = start;
+    rangeEnd = end;
+    setStepProgress(0.0);
+}
+
+void SampleDSP::Progress::setStepProgress(double proportion)
+{
+    const double start = rangeStart.load();
+    const double value = start + (rangeEnd.load() - start) * juce::jlimit(0.0, 1.0, proportion);
+
+    // Steps may report from several workers at once: keep the furthest
+    double current = progress.load();
+    while (value > current && !progress.compare_exchange_weak(current, value))
+    {
+    }
+}
+
 //==============================================================================
 // Time Stretching
 
-void SampleDSP::timeStretch(const juce::AudioBuffer<float>& source,
-                             juce::AudioBuffer<float>& dest,
-                             double ratio)
+namespace
 {
-    if (source.getNumSamples() == 0 || ratio <= 0.0)
-        return;
+    // WSOLA parameters — 2048-sample (~46 ms at 44.1 kHz) frame with 50 % overlap
+    constexpr int frameSize    = 2048;
+    constexpr int halfFrame    = frameSize / 2;
+    constexpr int synthesisHop = halfFrame;      // fixed output step
+    constexpr int searchRadius = 128;            // ±samples to search
+    constexpr int corrLen      = 256;            // samples used for cross-corr
+
+    /**
+     * Finds the WSOLA shift with one FFT cross-correlation per hop instead of
+     * (2 * searchRadius + 1) direct 256-tap sums.
+     *
+     * The FFT scores are single precision, so they only short-list: every
+     * candidate within the FFT error bound of the best score is re-scored
+     * with the exact sum the direct search uses, in the same order and with
+     * the same tie-break.  The identity is per frame: for a given output tail
+     * the chosen shift is the one the exhaustive search picks.  Whether a
+     * segmented stretch still matches a single pass is up to wsolaStretch().
+     */
+    class WsolaSearch
+    {
+    public:
+        WsolaSearch()
+            : fft(fftOrder),
+              tailSpectrum(2 * fftSize),
+              work(2 * fftSize),
+              scores(2 * searchRadius + 1)
+        {
+        }
 
-    const int numChannels = source.getNumChannels();
-    const int srcLen      = source.getNumSamples();
-    const int dstLen      = static_cast<int>(std::round(srcLen * ratio));
-
-    if (dstLen <= 0) return;
-
-    dest.setSize(numChannels, dstLen);
-    dest.clear();
-
-    // -----------------------------------------------------------------------
-    // WSOLA — Waveform Similarity Overlap-Add (pitch-preserving time stretch)
-    //
-    // The old linear-interpolation approach was simple resampling, which
-    // changes pitch proportionally to tempo (tape-speed effect).  WSOLA
-    // avoids this by:
-    //   1. Stepping through the SOURCE at the *original* sample rate (so
-    //      each frame is taken verbatim — no pitch shift).
-    //   2. Placing those frames in the OUTPUT at a *different* rate
-    //      (synthesisHop = analysisHop * ratio).
-    //   3. Before placing each frame, cross-correlating the candidate frame
-    //      against the tail of what's already been written, and shifting by
-    //      ±searchRadius to find the position that minimises the discontinuity
-    //      (waveform similarity step that gives WSOLA its name).
-    //   4. Overlap-adding with a Hann window and normalising.
-    // -----------------------------------------------------------------------
-
-    // Parameters — 2048-sample (~46 ms at 44.1 kHz) frame with 50 % overlap
-    const int frameSize    = 2048;
-    const int halfFrame    = frameSize / 2;
-    const int synthesisHop = halfFrame;          // fixed output step
-    const int searchRadius = 128;                // ±samples to search
-    const int corrLen      = 256;                // samples used for cross-corr
-
-    // Hann window
-    std::vector<float> hann(frameSize);
-    const double twoPiOverNm1 = 2.0 * juce::MathConstants<double>::pi / (frameSize - 1);
-    for (int i = 0; i < frameSize; ++i)
-        hann[i] = static_cast<float>(0.5 * (1.0 - std::cos(twoPiOverNm1 * i)));
-
-    // Use ch0 to determine the optimal frame positions via cross-correlation;
-    // the same positions are then applied to all channels so stereo imaging
-    // is preserved (L and R are never shifted relative to each other).
-    const float* ch0src = source.getReadPointer(0);
-
-    const int bufLen = dstLen + frameSize;   // headroom to avoid per-sample bounds checks
-    std::vector<float> ch0acc(bufLen, 0.0f); // accumulated ch0 output for cross-correlation
-    std::vector<float> normAcc(bufLen, 0.0f);
-    std::vector<int>   frameStarts;
-
-    for (int synthPos = 0; synthPos < dstLen; synthPos += synthesisHop)
-    {
-        // Nominal frame start in source for this synthesis position.
-        // Using round(synthPos/ratio) directly as frameStart means the analysis
-        // hop equals synthesisHop/ratio, which is correct for any ratio.
-        // (The earlier nomSrc-halfFrame formula was off by halfFrame, causing
-        // consecutive frames to overlap incorrectly in the identity case.)
-        const int nomFrameStart = static_cast<int>(std::round(synthPos / ratio));
-
-        // WSOLA: cross-correlate the recent output tail against candidate frames
-        // near nomFrameStart to find the shift that yields the smoothest join
-        int bestDelta = 0;
-        if (synthPos >= corrLen)
+        int findBestDelta(const float* tail, const float* src, int srcLen, int nomFrameStart)
         {
-            double bestCorr  = -1e30;
-            const int tailStart = synthPos - corrLen;
+            // Spectrum of the output tail (zero-padded)
+            std::fill(tailSpectrum.begin(), tailSpectrum.end(), 0.0f);
+            std::copy(tail, tail + corrLen, tailSpectrum.begin());
+            fft.performRealOnlyForwardTransform(tailSpectrum.data(), true);
+
+            // Spectrum of the source span all candidates come from
+            const int spanStart = nomFrameStart - searchRadius;
+            double spanEnergy = 0.0;
+            std::fill(work.begin(), work.end(), 0.0f);
+            for (int i = 0; i < spanLen; ++i)
+            {
+                const int index = spanStart + i;
+                if (index >= 0 && index < srcLen)
+                {
+                    work[(size_t)i] = src[index];
+                    spanEnergy += (double)src[index] * src[index];
+                }
+            }
+            fft.performRealOnlyForwardTransform(work.data(), true);
+
+            // conj(tail) * span -> correlation at lag k = delta + searchRadius
+            for (int bin = 0; bin <= fftSize / 2; ++bin)
+            {
+                const float ar = tailSpectrum[(size_t)(2 * bin)], ai = tailSpectrum[(size_t)(2 * bin + 1)];
+                const float br = work[(size_t)(2 * bin)],         bi = work[(size_t)(2 * bin + 1)];
+                work[(size_t)(2 * bin)]     = ar * br + ai * bi;
+                work[(size_t)(2 * bin + 1)] = ar * bi - ai * br;
+            }
+            fft.performRealOnlyInverseTransform(work.data());
+
+            double tailEnergy = 0.0;
+            for (int i = 0; i < corrLen; ++i)
+                tailEnergy += (double)tail[i] * tail[i];
+
+            // Each score is within errorBound of its exact value.
+            const double errorBound = fftErrorScale * std::sqrt(tailEnergy * spanEnergy);
+
+            double bestScore = -1e30;
+            for (int delta = -searchRadius; delta <= searchRadius; ++delta)
+            {
+                const int candStart = nomFrameStart + delta;
+                const double score = work[(size_t)(delta + searchRadius)];
+                scores[(size_t)(delta + searchRadius)] = score;
+
+                if (candStart >= 0 && candStart + corrLen <= srcLen)
+                    bestScore = std::max(bestScore, score);
+            }
+
+            // Exact re-scoring of the short list; same sum and tie-break as
+            // exhaustiveBestDelta().
+            double bestCorr = -1e30;
+            int bestDelta = 0;
 
             for (int delta = -searchRadius; delta <= searchRadius; ++delta)
             {
                 const int candStart = nomFrameStart + delta;
-                if (candStart < 0 || candStart + corrLen > srcLen)
+                if (candStart < 0 || candStart + corrLen > srcLen
+                    || scores[(size_t)(delta + searchRadius)] < bestScore - 2.0 * errorBound)
                     continue;
 
                 double corr = 0.0;
                 for (int i = 0; i < corrLen; ++i)
-                    corr += ch0acc[tailStart + i] * ch0src[candStart + i];
+                    corr += tail[i] * src[candStart + i];
 
                 if (corr > bestCorr)
                 {
@@ -99,123 +141,591 @@ void SampleDSP::timeStretch(const juce::AudioBuffer<float>& source,
                     bestDelta = delta;
                 }
             }
+
+            return bestDelta;
         }
 
-        int frameStart = nomFrameStart + bestDelta;
-        frameStart = juce::jmax(0, juce::jmin(frameStart, srcLen - frameSize));
-        frameStarts.push_back(frameStart);
+    private:
+        static constexpr int fftOrder = 10;
+        static constexpr int fftSize  = 1 << fftOrder;
+        static constexpr int spanLen  = 2 * searchRadius + corrLen;
+        static_assert(spanLen <= fftSize, "correlation must not wrap");
+
+        // Single-precision FFT error relative to |tail| * |span|, with a wide margin.
+        static constexpr double fftErrorScale = 1.0e-5;
+
+        juce::dsp::FFT fft;
+        std::vector<float> tailSpectrum;
+        std::vector<float> work;
+        std::vector<double> scores;
+    };
+
+    // The original direct search, kept as the reference for the stretch benchmark.
+    int exhaustiveBestDelta(const float* tail, const float* src, int srcLen, int nomFrameStart)
+    {
+        double bestCorr  = -1e30;
+        int bestDelta = 0;
+
+        for (int delta = -searchRadius; delta <= searchRadius; ++delta)
+        {
+            const int candStart = nomFrameStart + delta;
+            if (candStart < 0 || candStart + corrLen > srcLen)
+                continue;
+
+            double corr = 0.0;
+            for (int i = 0; i < corrLen; ++i)
+                corr += tail[i] * src[candStart + i];
+
+            if (corr > bestCorr)
+            {
+                bestCorr  = corr;
+                bestDelta = delta;
+            }
+        }
+
+        return bestDelta;
+    }
+
+    // Output hops per frame-search segment (~6 s at 44.1 kHz).  Fixed, so the
+    // output does not depend on the number of cores.
+    constexpr int hopsPerSegment = 256;
+    // Hops a segment searches before its own first hop, so that by then it has
+    // usually settled onto the path of a single pass and its seam is short.
+    constexpr int overlapHops = 64;
+    // Output hops per overlap-add task.
+    constexpr int hopsPerBlock = 256;
+
+    /**
+     * Frame positions for hops [firstHop, endHop).  Without history the output
+     * before firstHop is taken as silent; with it, history holds the positions
+     * of hops firstHop - 2 and firstHop - 1.
+     *
+     * Each search correlates against the output of the two hops before it
+     * only (frameSize = 2 * synthesisHop), so once two positions agree with
+     * those of another run, every position after them does too.  Given such
+     * a run (rejoin, its first hop rejoinFirst), the search stops as soon as
+     * two consecutive positions agree with it; the result ends with them.
+     */
+    std::vector<int> findFrameStarts(const float* ch0src, int srcLen, double ratio,
+                                     const std::vector<float>& hann, int firstHop, int endHop,
+                                     bool exhaustiveSearch,
+                                     const int* history = nullptr,
+                                     const std::vector<int>* rejoin = nullptr, int rejoinFirst = 0)
+    {
+        // Accumulated ch0 output for cross-correlation
+        const int origin = (history != nullptr ? firstHop - 2 : firstHop) * synthesisHop;
+        std::vector<float> ch0acc((size_t)(endHop * synthesisHop - origin + frameSize), 0.0f);
+        std::vector<int> frameStarts;
+        frameStarts.reserve((size_t)(endHop - firstHop));
+        WsolaSearch search;
 
         // Accumulate into ch0 buffer so the next frame can correlate against it.
-        // normAcc accumulates hann[i] (not hann[i]²) so that dividing by it in
-        // the final step exactly cancels the windowing: output = Σ(src·w) / Σ(w).
-        // Using w² here would give output = src·w/w² = src/w → huge amplification
-        // near the window edges where w ≈ 0.
-        const int writeEnd = std::min(synthPos + frameSize, bufLen);
-        for (int i = 0; i < writeEnd - synthPos; ++i)
+        auto addFrame = [&](int hop, int frameStart)
+        {
+            float* acc = ch0acc.data() + (hop * synthesisHop - origin);
+            for (int i = 0; i < frameSize; ++i)
+                acc[i] += ch0src[frameStart + i] * hann[(size_t)i];
+        };
+
+        // Consecutive positions, up to the latest, that agree with rejoin
+        int numAgreeing = 0;
+        auto countAgreement = [&](int hop, int frameStart)
+        {
+            const int index = hop - rejoinFirst;
+            const bool agrees = rejoin != nullptr && index >= 0 && index < (int)rejoin->size()
+                                && (*rejoin)[(size_t)index] == frameStart;
+            numAgreeing = agrees ? numAgreeing + 1 : 0;
+        };
+
+        if (history != nullptr)
         {
-            ch0acc [synthPos + i] += ch0src[frameStart + i] * hann[i];
-            normAcc[synthPos + i] += hann[i];   // NOT hann[i]*hann[i]
+            for (int i = 0; i < 2; ++i)
+            {
+                addFrame(firstHop - 2 + i, history[i]);
+                countAgreement(firstHop - 2 + i, history[i]);
+            }
+        }
+
+        for (int hop = firstHop; hop < endHop && numAgreeing < 2; ++hop)
+        {
+            const int synthPos = hop * synthesisHop;
+
+            // Nominal frame start in source for this synthesis position.
+            // Using round(synthPos/ratio) directly as frameStart means the analysis
+            // hop equals synthesisHop/ratio, which is correct for any ratio.
+            // (The earlier nomSrc-halfFrame formula was off by halfFrame, causing
+            // consecutive frames to overlap incorrectly in the identity case.)
+            const int nomFrameStart = static_cast<int>(std::round(synthPos / ratio));
+
+            // WSOLA: cross-correlate the recent output tail against candidate frames
+            // near nomFrameStart to find the shift that yields the smoothest join
+            int bestDelta = 0;
+            if (synthPos - origin >= corrLen)
+            {
+                const float* tail = ch0acc.data() + (synthPos - corrLen - origin);
+                bestDelta = exhaustiveSearch ? exhaustiveBestDelta(tail, ch0src, srcLen, nomFrameStart)
+                                             : search.findBestDelta(tail, ch0src, srcLen, nomFrameStart);
+            }
+
+            int frameStart = nomFrameStart + bestDelta;
+            frameStart = juce::jmax(0, juce::jmin(frameStart, srcLen - frameSize));
+            frameStarts.push_back(frameStart);
+            addFrame(hop, frameStart);
+            countAgreement(hop, frameStart);
         }
+
+        return frameStarts;
     }
 
-    // Apply the computed frame positions to every channel
-    for (int ch = 0; ch < numChannels; ++ch)
+    void wsolaStretch(const juce::AudioBuffer<float>& source,
+                      juce::AudioBuffer<float>& dest,
+                      double ratio,
+                      bool exhaustiveSearch,
+                      bool multiThreaded,
+                      bool segmented = true,
+                      SampleDSP::Progress* progress = nullptr)
     {
-        const float* src = source.getReadPointer(ch);
-        float* dst = dest.getWritePointer(ch);
+        if (source.getNumSamples() == 0 || ratio <= 0.0)
+            return;
+
+        const int numChannels = source.getNumChannels();
+        const int srcLen      = source.getNumSamples();
+        const int dstLen      = static_cast<int>(std::round(srcLen * ratio));
+
+        if (dstLen <= 0) return;
+
+        dest.setSize(numChannels, dstLen);
+        dest.clear();
+
+        // -----------------------------------------------------------------------
+        // WSOLA — Waveform Similarity Overlap-Add (pitch-preserving time stretch)
+        //
+        // The old linear-interpolation approach was simple resampling, which
+        // changes pitch proportionally to tempo (tape-speed effect).  WSOLA
+        // avoids this by:
+        //   1. Stepping through the SOURCE at the *original* sample rate (so
+        //      each frame is taken verbatim — no pitch shift).
+        //   2. Placing those frames in the OUTPUT at a *different* rate
+        //      (synthesisHop = analysisHop * ratio).
+        //   3. Before placing each frame, cross-correlating the candidate frame
+        //      against the tail of what's already been written, and shifting by
+        //      ±searchRadius to find the position that minimises the discontinuity
+        //      (waveform similarity step that gives WSOLA its name).
+        //   4. Overlap-adding with a Hann window and normalising.
+        //
+        // Both passes are split over the shared DSPWorkerPool: the frame search
+        // in overlapping segments of hopsPerSegment hops (each seam searched
+        // again until it rejoins, so the positions are those of one pass), the
+        // overlap-add in blocks of output per channel.
+        // -----------------------------------------------------------------------
+
+        // Hann window
+        std::vector<float> hann(frameSize);
+        const double twoPiOverNm1 = 2.0 * juce::MathConstants<double>::pi / (frameSize - 1);
+        for (int i = 0; i < frameSize; ++i)
+            hann[i] = static_cast<float>(0.5 * (1.0 - std::cos(twoPiOverNm1 * i)));
+
+        // Use ch0 to determine the optimal frame positions via cross-correlation;
+        // the same positions are then applied to all channels so stereo imaging
+        // is preserved (L and R are never shifted relative to each other).
+        const float* ch0src = source.getReadPointer(0);
+
+        juce::SharedResourcePointer<DSPWorkerPool> workers;
+        const int numHops = (dstLen + synthesisHop - 1) / synthesisHop;
+
+        // The exhaustive search is the reference for the stretch benchmark,
+        // which also runs it unsegmented: one search over every hop.
+        // Each pass reports its share of the progress task by task (the search
+        // is most of the work), and skips what is left once cancelled.
+        auto isCancelled = [progress] { return progress != nullptr && progress->isCancelled(); };
+
+        auto runTasks = [&](int numTasks, double progressFrom, double progressTo,
+                            const std::function<void(int)>& task)
+        {
+            std::atomic<int> tasksDone { 0 };
+
+            auto reportingTask = [&](int i)
+            {
+                if (isCancelled())
+                    return;
+
+                task(i);
+
+                if (progress != nullptr)
+                    progress->setStepProgress(progressFrom + (progressTo - progressFrom) * ++tasksDone / numTasks);
+            };
+
+            if (multiThreaded)
+                workers->parallelFor(numTasks, reportingTask);
+            else
+                for (int i = 0; i < numTasks; ++i)
+                    reportingTask(i);
+        };
+
+        const int segmentHops = segmented ? hopsPerSegment : juce::jmax(1, numHops);
+        const int numSegments = (numHops + segmentHops - 1) / segmentHops;
 
-        int synthPos = 0;
-        for (const int frameStart : frameStarts)
+        // --- 1. Frame positions, one segment per task ---
+        // Every segment after the first starts its search overlapHops early.
+        auto searchStart = [segmentHops](int segment) { return juce::jmax(0, segment * segmentHops - overlapHops); };
+        auto segmentEnd  = [segmentHops, numHops](int segment) { return juce::jmin(numHops, (segment + 1) * segmentHops); };
+
+        std::vector<std::vector<int>> segmentStarts((size_t)numSegments);
+
+        runTasks(numSegments, 0.0, 0.8, [&](int segment)
+        {
+            segmentStarts[(size_t)segment] = findFrameStarts(ch0src, srcLen, ratio, hann, searchStart(segment),
+                                                             segmentEnd(segment), exhaustiveSearch);
+        });
+
+        // --- 2. Seams, one per task ---
+        // A segment started from silence, so its first positions can differ from
+        // those of a single pass.  Search its first hops again from the last two
+        // positions of the segment before, until they rejoin its own (usually
+        // within a few dozen hops; the rest of the segment is then exact).
+        std::vector<std::vector<int>> seamStarts((size_t)numSegments);
+
+        auto searchSeam = [&](int segment, const int* history)
+        {
+            seamStarts[(size_t)segment] = findFrameStarts(ch0src, srcLen, ratio, hann, segment * segmentHops,
+                                                          segmentEnd(segment), exhaustiveSearch, history,
+                                                          &segmentStarts[(size_t)segment], searchStart(segment));
+        };
+
+        // The positions a seam starts from, as the segment before found them
+        auto segmentHistory = [&](int segment, int* history)
         {
-            const int writeEnd = std::min(synthPos + frameSize, dstLen);
-            for (int i = 0; i < writeEnd - synthPos; ++i)
-                dst[synthPos + i] += src[frameStart + i] * hann[i];
-            synthPos += synthesisHop;
+            const auto& before = segmentStarts[(size_t)(segment - 1)];
+            const int handover = segment * segmentHops - searchStart(segment - 1);
+            history[0] = before[(size_t)(handover - 2)];
+            history[1] = before[(size_t)(handover - 1)];
+        };
+
+        runTasks(numSegments - 1, 0.8, 0.85, [&](int task)
+        {
+            int history[2];
+            segmentHistory(task + 1, history);
+            searchSeam(task + 1, history);
+        });
+
+        // Skipped segments and seams have nothing to join
+        if (isCancelled())
+            return;
+
+        // Join in order.  A seam searched from positions that the seam before
+        // changed (it did not rejoin within its segment) is searched again from
+        // the joined ones, so every position is that of a single pass.
+        std::vector<int> frameStarts = segmentStarts[0];
+        frameStarts.resize((size_t)numHops);
+
+        for (int segment = 1; segment < numSegments; ++segment)
+        {
+            const int firstHop = segment * segmentHops;
+            int history[2];
+            segmentHistory(segment, history);
+
+            if (history[0] != frameStarts[(size_t)(firstHop - 2)] || history[1] != frameStarts[(size_t)(firstHop - 1)])
+            {
+                const int joined[2] = { frameStarts[(size_t)(firstHop - 2)], frameStarts[(size_t)(firstHop - 1)] };
+                searchSeam(segment, joined);
+            }
+
+            const auto& seam = seamStarts[(size_t)segment];
+            const auto& rest = segmentStarts[(size_t)segment];
+            const int rejoinHop = firstHop + (int)seam.size();
+
+            std::copy(seam.begin(), seam.end(), frameStarts.begin() + firstHop);
+            std::copy(rest.begin() + (rejoinHop - searchStart(segment)), rest.end(), frameStarts.begin() + rejoinHop);
         }
 
-        // Normalise: dividing by Σhann cancels the window, giving unity gain
-        for (int i = 0; i < dstLen; ++i)
-            if (normAcc[i] > 1e-6f)
-                dst[i] /= normAcc[i];
+        // --- 2. Overlap-add every channel, one block of output per task ---
+        const int numBlocks = (numHops + hopsPerBlock - 1) / hopsPerBlock;
+
+        runTasks(numChannels * numBlocks, 0.85, 1.0, [&](int taskIndex)
+        {
+            const int ch    = taskIndex / numBlocks;
+            const int block = taskIndex % numBlocks;
+            const int firstHop = block * hopsPerBlock;
+            const int endHop   = juce::jmin(numHops, firstHop + hopsPerBlock);
+            const int lo = firstHop * synthesisHop;
+            const int hi = juce::jmin(dstLen, endHop * synthesisHop);
+
+            const float* src = source.getReadPointer(ch);
+            float* dst = dest.getWritePointer(ch);
+
+            // normAcc accumulates hann[i] (not hann[i]²) so that dividing by it in
+            // the final step exactly cancels the windowing: output = Σ(src·w) / Σ(w).
+            // Using w² here would give output = src·w/w² = src/w → huge amplification
+            // near the window edges where w ≈ 0.
+            std::vector<float> normAcc((size_t)(hi - lo), 0.0f);
+
+            // Frames in hop order (as a single pass would add them), clipped to the block;
+            // the frame of the hop before the block overlaps its first half.
+            for (int hop = juce::jmax(0, firstHop - 1); hop < endHop; ++hop)
+            {
+                const int synthPos   = hop * synthesisHop;
+                const int frameStart = frameStarts[(size_t)hop];
+                const int from = juce::jmax(lo, synthPos);
+                const int to   = juce::jmin(hi, synthPos + frameSize);
+
+                for (int p = from; p < to; ++p)
+                {
+                    dst[p] += src[frameStart + (p - synthPos)] * hann[(size_t)(p - synthPos)];
+                    normAcc[(size_t)(p - lo)] += hann[(size_t)(p - synthPos)];   // NOT hann[i]*hann[i]
+                }
+            }
+
+            // Normalise: dividing by Σhann cancels the window, giving unity gain
+            for (int p = lo; p < hi; ++p)
+                if (normAcc[(size_t)(p - lo)] > 1e-6f)
+                    dst[p] /= normAcc[(size_t)(p - lo)];
+        });
     }
 }
 
+void SampleDSP::timeStretch(const juce::AudioBuffer<float>& source,
+                             juce::AudioBuffer<float>& dest,
+                             double ratio,
+                             Progress* progress)
+{
+    wsolaStretch(source, dest, ratio, false, true, true, progress);
+}
+
+#ifdef GROOVIXBEAT_BENCHMARKS
+void SampleDSP::timeStretchForBenchmark(const juce::AudioBuffer<float>& source,
+                                        juce::AudioBuffer<float>& dest,
+                                        double ratio,
+                                        bool exhaustiveSearch,
+                                        bool multiThreaded,
+                                        bool segmented)
+{
+    wsolaStretch(source, dest, ratio, exhaustiveSearch, multiThreaded, segmented);
+}
+#endif
+
 //==============================================================================
-// BPM Detection
+// Onset Analysis
 
-double SampleDSP::detectBPM(const juce::AudioBuffer<float>& buffer, double sampleRate)
+namespace
 {
-    if (buffer.getNumSamples() == 0 || sampleRate <= 0.0)
-        return 0.0;
+    // RMS of every window of windowHops consecutive hops, from the per-hop mean squares.
+    std::vector<float> windowedRms(const std::vector<float>& energy, int windowHops)
+    {
+        std::vector<float> rms;
+        const int numFrames = static_cast<int>(energy.size()) - windowHops + 1;
+        if (numFrames <= 0)
+            return rms;
 
-    const int numChannels = buffer.getNumChannels();
-    const int numSamples  = buffer.getNumSamples();
+        rms.reserve((size_t)numFrames);
 
-    // --- 1. Compute RMS energy in overlapping frames ---
-    // frameSize ~23 ms gives stable energy estimates.
-    // hopSize must give fps > BPM²/60 ≈ 540 so that integer lag quantisation
-    // error stays below 0.5 BPM across the full 60-180 range, making rounding
-    // always land on the correct integer.  fps ≈ 700 → max error 0.23 BPM.
-    const int frameSize = static_cast<int>(sampleRate * 0.023);
-    const int hopSize   = std::max(1, static_cast<int>(sampleRate / 700.0));
+        double sum = 0.0;
+        for (int i = 0; i < windowHops - 1; ++i)
+            sum += energy[(size_t)i];
 
-    std::vector<float> energy;
-    energy.reserve(numSamples / hopSize + 1);
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            sum += energy[(size_t)(frame + windowHops - 1)];
+            rms.push_back(static_cast<float>(std::sqrt(std::max(0.0, sum / windowHops))));
+            sum -= energy[(size_t)frame];
+        }
+
+        return rms;
+    }
 
-    for (int start = 0; start + frameSize <= numSamples; start += hopSize)
+    // One hop of one channel, contiguous: a hop across a piece boundary is gathered into scratch.
+    const float* readHop(const juce::AudioBuffer<float>& buffer, int channel, int start, int, float*)
     {
-        double rms = 0.0;
-        for (int ch = 0; ch < numChannels; ++ch)
+        return buffer.getReadPointer(channel, start);
+    }
+
+    const float* readHop(const ChunkedAudio& buffer, int channel, int start, int length, float* scratch)
+    {
+        return buffer.getReadPointer(channel, start, length, scratch);
+    }
+
+    // Mean square of hops [firstHop, endHop) over all channels.
+    template <typename Samples>
+    void measureHops(SampleDSP::OnsetEnvelope& envelope, const Samples& buffer,
+                     int firstHop, int endHop)
+    {
+        const int hopSize = envelope.hopSize;
+        const int numChannels = buffer.getNumChannels();
+        std::vector<float> scratch((size_t)hopSize);
+
+        for (int hop = firstHop; hop < endHop; ++hop)
         {
-            const float* data = buffer.getReadPointer(ch);
-            for (int i = 0; i < frameSize; ++i)
-                rms += static_cast<double>(data[start + i]) * data[start + i];
+            double sum = 0.0;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* data = readHop(buffer, ch, hop * hopSize, hopSize, scratch.data());
+                float channelSum = 0.0f;
+                for (int i = 0; i < hopSize; ++i)
+                    channelSum += data[i] * data[i];
+                sum += channelSum;
+            }
+            envelope.energy[(size_t)hop] = static_cast<float>(sum / (hopSize * numChannels));
         }
-        energy.push_back(static_cast<float>(std::sqrt(rms / (frameSize * numChannels))));
     }
 
-    if (energy.size() < 8)
-        return 0.0;
+    // rms and onset from the per-hop energies (no pass over the samples).
+    void deriveEnvelopes(SampleDSP::OnsetEnvelope& envelope)
+    {
+        // RMS over ~23 ms windows, which gives stable energy estimates
+        const int windowHops = std::max(1, static_cast<int>(std::round(0.023 * envelope.getFramesPerSecond())));
+        envelope.rms = windowedRms(envelope.energy, windowHops);
+
+        // Onset strength: half-wave rectified first difference in dB
+        envelope.onset.clear();
+        if (envelope.rms.empty())
+            return;
 
-    // --- 2. Onset strength: half-wave rectified first difference in dB ---
-    std::vector<float> onset;
-    onset.reserve(energy.size());
-    onset.push_back(0.0f);
+        envelope.onset.reserve(envelope.rms.size());
+        envelope.onset.push_back(0.0f);
 
-    for (size_t i = 1; i < energy.size(); ++i)
+        for (size_t i = 1; i < envelope.rms.size(); ++i)
+        {
+            float prev = std::max(envelope.rms[i - 1], 1e-6f);
+            float curr = std::max(envelope.rms[i],     1e-6f);
+            float db   = 20.0f * std::log10(curr / prev);
+            envelope.onset.push_back(std::max(0.0f, db));   // half-wave rectify
+        }
+    }
+
+    template <typename Samples>
+    SampleDSP::OnsetEnvelope analyzeOnsetsOf(const Samples& buffer, double sampleRate)
     {
-        float prev = std::max(energy[i - 1], 1e-6f);
-        float curr = std::max(energy[i],     1e-6f);
-        float db   = 20.0f * std::log10(curr / prev);
-        onset.push_back(std::max(0.0f, db));   // half-wave rectify
+        SampleDSP::OnsetEnvelope envelope;
+        envelope.sampleRate = sampleRate;
+
+        if (buffer.getNumSamples() == 0 || buffer.getNumChannels() == 0 || sampleRate <= 0.0)
+            return envelope;
+
+        envelope.numChannels = buffer.getNumChannels();
+        envelope.numSamples  = buffer.getNumSamples();
+
+        // hopSize must give fps > BPM²/60 ≈ 540 so that integer lag quantisation
+        // error stays below 0.5 BPM across the full 60-180 range, making rounding
+        // always land on the correct integer.  fps ≈ 700 → max error 0.23 BPM.
+        envelope.hopSize = std::max(1, static_cast<int>(sampleRate / 700.0));
+
+        // Mean square of each hop: the only pass over the samples
+        const int numHops = envelope.numSamples / envelope.hopSize;
+        envelope.energy.resize((size_t)numHops);
+        measureHops(envelope, buffer, 0, numHops);
+
+        deriveEnvelopes(envelope);
+        return envelope;
     }
+}
+
+SampleDSP::OnsetEnvelope SampleDSP::analyzeOnsets(const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    return analyzeOnsetsOf(buffer, sampleRate);
+}
+
+SampleDSP::OnsetEnvelope SampleDSP::analyzeOnsets(const ChunkedAudio& buffer, double sampleRate)
+{
+    return analyzeOnsetsOf(buffer, sampleRate);
+}
+
+void SampleDSP::updateOnsets(OnsetEnvelope& envelope, const ChunkedAudio& buffer,
+                             int startSample, int numSamples)
+{
+    // A length or layout change moves hops; only in-place edits take the short path.
+    if (envelope.hopSize <= 0 || buffer.getNumSamples() != envelope.numSamples
+        || buffer.getNumChannels() != envelope.numChannels)
+    {
+        envelope = analyzeOnsets(buffer, envelope.sampleRate);
+        return;
+    }
+
+    const int numHops = static_cast<int>(envelope.energy.size());
+    const int firstHop = juce::jlimit(0, numHops, startSample / envelope.hopSize);
+    const int endHop = juce::jlimit(firstHop, numHops,
+                                    (startSample + juce::jmax(0, numSamples) + envelope.hopSize - 1) / envelope.hopSize);
+
+    if (firstHop >= endHop)
+        return;
+
+    measureHops(envelope, buffer, firstHop, endHop);
+    deriveEnvelopes(envelope);
+}
+
+void SampleDSP::updateOnsetsFrom(OnsetEnvelope& envelope, const ChunkedAudio& buffer,
+                                 int startSample)
+{
+    if (envelope.hopSize <= 0 || buffer.getNumChannels() != envelope.numChannels
+        || buffer.getNumChannels() == 0)
+    {
+        envelope = analyzeOnsets(buffer, envelope.sampleRate);
+        return;
+    }
+
+    envelope.numSamples = buffer.getNumSamples();
+
+    const int numHops = envelope.numSamples / envelope.hopSize;
+    const int firstHop = juce::jlimit(0, numHops, startSample / envelope.hopSize);
+
+    envelope.energy.resize((size_t)numHops);
+    measureHops(envelope, buffer, firstHop, numHops);
+    deriveEnvelopes(envelope);
+}
 
-    // --- 3. Autocorrelation of onset envelope in the 60–180 BPM lag range ---
-    const double framesPerSecond = sampleRate / static_cast<double>(hopSize);
+//==============================================================================
+// BPM Detection
+
+double SampleDSP::detectBPM(const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    return detectBPM(analyzeOnsets(buffer, sampleRate));
+}
+
+double SampleDSP::detectBPM(const OnsetEnvelope& envelope)
+{
+    const auto& onset = envelope.onset;
+
+    if (onset.size() < 8)
+        return 0.0;
+
+    // --- 1. Autocorrelation of onset envelope in the 60–180 BPM lag range ---
+    const double framesPerSecond = envelope.getFramesPerSecond();
+    const int N = static_cast<int>(onset.size());
 
     // Lags corresponding to 60 BPM (long) and 180 BPM (short)
-    const int maxLag = std::min(static_cast<int>(framesPerSecond * 60.0 / 60.0),
-                                static_cast<int>(onset.size()) - 1);
+    const int maxLag = std::min(static_cast<int>(framesPerSecond * 60.0 / 60.0), N - 1);
     const int minLag = static_cast<int>(framesPerSecond * 60.0 / 180.0);
 
     if (minLag >= maxLag)
         return 0.0;
 
+    // All lags at once: the inverse FFT of the power spectrum.  Zero-padded
+    // to at least N + maxLag so the lags used here do not wrap around.
+    int fftOrder = 1;
+    while ((1 << fftOrder) < N + maxLag + 1)
+        ++fftOrder;
+
+    const int fftSize = 1 << fftOrder;
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<float> work((size_t)(2 * fftSize), 0.0f);
+    std::copy(onset.begin(), onset.end(), work.begin());
+
+    fft.performRealOnlyForwardTransform(work.data(), true);
+    for (int bin = 0; bin <= fftSize / 2; ++bin)
+    {
+        const float re = work[(size_t)(2 * bin)], im = work[(size_t)(2 * bin + 1)];
+        work[(size_t)(2 * bin)]     = re * re + im * im;
+        work[(size_t)(2 * bin + 1)] = 0.0f;
+    }
+    fft.performRealOnlyInverseTransform(work.data());
+
+    // Mean product over the overlapping frames
+    auto corrAt = [&](int lag) { return static_cast<double>(work[(size_t)lag]) / (N - lag); };
+
     double bestCorr = -1.0;
     int    bestLag  = minLag;
-    const int N     = static_cast<int>(onset.size());
 
     for (int lag = minLag; lag <= maxLag; ++lag)
     {
-        double corr = 0.0;
-        int    cnt  = 0;
-        for (int i = 0; i + lag < N; ++i)
-        {
-            corr += onset[i] * onset[i + lag];
-            ++cnt;
-        }
-        if (cnt > 0) corr /= cnt;
-
+        const double corr = corrAt(lag);
         if (corr > bestCorr)
         {
             bestCorr = corr;
@@ -226,7 +736,7 @@ double SampleDSP::detectBPM(const juce::AudioBuffer<float>& buffer, double sampl
     if (bestCorr <= 0.0)
         return 0.0;
 
-    // --- 4. Parabolic interpolation to find the true sub-frame lag ---
+    // --- 2. Parabolic interpolation to find the true sub-frame lag ---
     // The autocorrelation operates on integer lags, but the true beat period
     // rarely falls exactly on one. Fitting a parabola through the three samples
     // around the peak gives a fractional correction that eliminates the
@@ -234,12 +744,6 @@ double SampleDSP::detectBPM(const juce::AudioBuffer<float>& buffer, double sampl
     double trueLag = static_cast<double>(bestLag);
     if (bestLag > minLag && bestLag < maxLag)
     {
-        // Recompute neighbours (already computed in the loop above; recalc is cheap)
-        auto corrAt = [&](int lag) -> double {
-            double c = 0.0; int cnt = 0;
-            for (int i = 0; i + lag < N; ++i) { c += onset[i] * onset[i + lag]; ++cnt; }
-            return cnt > 0 ? c / cnt : 0.0;
-        };
         double y0 = corrAt(bestLag - 1);
         double y1 = bestCorr;
         double y2 = corrAt(bestLag + 1);
@@ -248,7 +752,7 @@ double SampleDSP::detectBPM(const juce::AudioBuffer<float>& buffer, double sampl
             trueLag += 0.5 * (y0 - y2) / denom;
     }
 
-    // --- 5. Convert fractional lag to BPM and normalise to 60–180 ---
+    // --- 3. Convert fractional lag to BPM and normalise to 60–180 ---
     double bpm = 60.0 * framesPerSecond / trueLag;
 
     while (bpm < 60.0)  bpm *= 2.0;
@@ -330,47 +834,41 @@ void SampleDSP::silence(juce::AudioBuffer<float>& buffer, int startSample, int n
 // Transient Detection
 
 std::vector<double> SampleDSP::detectTransients(const juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    return detectTransients(analyzeOnsets(buffer, sampleRate));
+}
+
+std::vector<double> SampleDSP::detectTransients(const OnsetEnvelope& envelope)
 {
     std::vector<double> transients;
 
-    if (buffer.getNumSamples() == 0 || sampleRate <= 0.0)
+    const double framesPerSecond = envelope.getFramesPerSecond();
+    if (envelope.energy.empty() || framesPerSecond <= 0.0)
         return transients;
 
-    // Use first channel for analysis
-    const float* channelData = buffer.getReadPointer(0);
-    int numSamples = buffer.getNumSamples();
-
-    // Parameters for transient detection
-    const int windowSize = static_cast<int>(sampleRate * 0.01);  // 10ms window
-    const int hopSize = windowSize / 2;  // 50% overlap
+    // Parameters for transient detection, in envelope hops
+    const int windowHops = std::max(1, static_cast<int>(std::round(framesPerSecond * 0.01)));   // 10ms window
+    const int riseHops   = std::max(1, static_cast<int>(std::round(framesPerSecond * 0.005)));  // rise over 5ms
     const double minTimeBetweenTransients = 0.05;  // 50ms minimum between transients
-    const int minSamplesBetween = static_cast<int>(minTimeBetweenTransients * sampleRate);
+    const int minSamplesBetween = static_cast<int>(minTimeBetweenTransients * envelope.sampleRate);
 
     // Calculate onset detection function (spectral flux approximation using amplitude difference)
-    std::vector<float> onsetFunction;
-    onsetFunction.reserve(numSamples / hopSize);
+    const auto rms = windowedRms(envelope.energy, windowHops);
 
-    float prevEnergy = 0.0f;
+    std::vector<float> onsetFunction;
+    onsetFunction.reserve(rms.size());
 
-    for (int i = 0; i < numSamples - windowSize; i += hopSize)
+    for (size_t i = 0; i < rms.size(); ++i)
     {
-        // Calculate RMS energy in this window
-        float energy = 0.0f;
-        for (int j = 0; j < windowSize; ++j)
-        {
-            float sample = channelData[i + j];
-            energy += sample * sample;
-        }
-        energy = std::sqrt(energy / static_cast<float>(windowSize));
-
         // Onset function is the positive difference (half-wave rectified)
-        float onset = std::max(0.0f, energy - prevEnergy);
-        onsetFunction.push_back(onset);
-
-        prevEnergy = energy;
+        const float prevEnergy = i >= (size_t)riseHops ? rms[i - (size_t)riseHops] : 0.0f;
+        onsetFunction.push_back(std::max(0.0f, rms[i] - prevEnergy));
     }
 
-    if (onsetFunction.empty())
+    // Local maxima are taken over ±10ms
+    const size_t reach = (size_t)(2 * riseHops);
+
+    if (onsetFunction.size() <= 2 * reach)
         return transients;
 
     // Calculate adaptive threshold (mean + 1.5 * standard deviation)
@@ -395,21 +893,25 @@ std::vector<double> SampleDSP::detectTransients(const juce::AudioBuffer<float>&
     // Peak picking with local maximum check
     int lastTransientSample = -minSamplesBetween;
 
-    for (size_t i = 2; i < onsetFunction.size() - 2; ++i)
+    for (size_t i = reach; i < onsetFunction.size() - reach; ++i)
     {
+        const float value = onsetFunction[i];
+        if (value <= threshold)
+            continue;
+
         // Check if this is a local maximum above threshold
-        if (onsetFunction[i] > threshold &&
-            onsetFunction[i] > onsetFunction[i - 1] &&
-            onsetFunction[i] > onsetFunction[i - 2] &&
-            onsetFunction[i] >= onsetFunction[i + 1] &&
-            onsetFunction[i] >= onsetFunction[i + 2])
+        bool isPeak = true;
+        for (size_t j = 1; j <= reach && isPeak; ++j)
+            isPeak = value > onsetFunction[i - j] && value >= onsetFunction[i + j];
+
+        if (isPeak)
         {
-            int samplePosition = static_cast<int>(i) * hopSize;
+            int samplePosition = static_cast<int>(i) * envelope.hopSize;
 
             // Check minimum time between transients
             if (samplePosition - lastTransientSample >= minSamplesBetween)
             {
-                double timeInSeconds = static_cast<double>(samplePosition) / sampleRate;
+                double timeInSeconds = static_cast<double>(samplePosition) / envelope.sampleRate;
                 transients.push_back(timeInSeconds);
                 lastTransientSample = samplePosition;
             }
@@ -421,6 +923,161 @@ std::vector<double> SampleDSP::detectTransients(const juce::AudioBuffer<float>&
     return transients;
 }
 
+//==============================================================================
+// Loudness
+
+namespace
+{
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        double process(double x)
+        {
+            const double y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    // BS.1770 K-weighting stages, designed for any sample rate (as in libebur128).
+    Biquad makeKWeightingShelf(double sampleRate)
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k  = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        Biquad f;
+        f.b0 = (vh + vb * k / q + k * k) / a0;
+        f.b1 = 2.0 * (k * k - vh) / a0;
+        f.b2 = (vh - vb * k / q + k * k) / a0;
+        f.a1 = 2.0 * (k * k - 1.0) / a0;
+        f.a2 = (1.0 - k / q + k * k) / a0;
+        return f;
+    }
+
+    Biquad makeKWeightingHighPass(double sampleRate)
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k  = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        Biquad f;
+        f.b0 = 1.0;
+        f.b1 = -2.0;
+        f.b2 = 1.0;
+        f.a1 = 2.0 * (k * k - 1.0) / a0;
+        f.a2 = (1.0 - k / q + k * k) / a0;
+        return f;
+    }
+}
+
+SampleDSP::Loudness SampleDSP::measureLoudness(const ChunkedAudio& buffer, double sampleRate)
+{
+    Loudness result;
+
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples  = buffer.getNumSamples();
+
+    if (numChannels == 0 || numSamples == 0 || sampleRate <= 0.0)
+        return result;
+
+    // 100 ms segments; a 400 ms gating block is four of them (75 % overlap)
+    const int segmentLength = std::max(1, static_cast<int>(std::round(0.1 * sampleRate)));
+    const int numSegments = std::max(1, numSamples / segmentLength);
+
+    std::vector<std::vector<double>> segmentEnergy((size_t)numChannels, std::vector<double>((size_t)numSegments, 0.0));
+    std::vector<double> channelSquares((size_t)numChannels, 0.0);
+
+    juce::SharedResourcePointer<DSPWorkerPool> workers;
+
+    workers->parallelFor(numChannels, [&](int ch)
+    {
+        Biquad shelf    = makeKWeightingShelf(sampleRate);
+        Biquad highPass = makeKWeightingHighPass(sampleRate);
+
+        auto& energy = segmentEnergy[(size_t)ch];
+        double squares = 0.0;
+        int i = 0;
+
+        buffer.forEachSpan(ch, 0, numSamples, [&](const float* data, int n)
+        {
+            for (int j = 0; j < n; ++j, ++i)
+            {
+                const double x = data[j];
+                squares += x * x;
+
+                const double y = highPass.process(shelf.process(x));
+                const int segment = std::min(i / segmentLength, numSegments - 1);
+                energy[(size_t)segment] += y * y;
+            }
+        });
+
+        channelSquares[(size_t)ch] = squares;
+    });
+
+    const double totalSquares = std::accumulate(channelSquares.begin(), channelSquares.end(), 0.0);
+    const double rms = std::sqrt(totalSquares / ((double)numSamples * numChannels));
+    if (rms > 0.0)
+        result.rmsDb = std::max(-100.0, 20.0 * std::log10(rms));
+
+    // Mean square per block, summed over channels (all weighted 1.0)
+    const int segmentsPerBlock = std::min(4, numSegments);
+    const int numBlocks = numSegments - segmentsPerBlock + 1;
+    const double blockLength = (double)std::min(numSamples, segmentLength * segmentsPerBlock);
+
+    std::vector<double> blockPower;
+    blockPower.reserve((size_t)numBlocks);
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        double sum = 0.0;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < segmentsPerBlock; ++s)
+                sum += segmentEnergy[(size_t)ch][(size_t)(block + s)];
+        blockPower.push_back(sum / blockLength);
+    }
+
+    auto toLufs = [](double power) { return -0.691 + 10.0 * std::log10(power); };
+
+    // Absolute gate, then relative gate 10 LU below the absolute-gated loudness
+    auto gatedMean = [&blockPower, &toLufs](double thresholdLufs, bool& any)
+    {
+        double sum = 0.0;
+        int count = 0;
+        for (double power : blockPower)
+        {
+            if (power > 0.0 && toLufs(power) > thresholdLufs)
+            {
+                sum += power;
+                ++count;
+            }
+        }
+        any = count > 0;
+        return any ? sum / count : 0.0;
+    };
+
+    bool any = false;
+    const double absoluteGated = gatedMean(-70.0, any);
+    if (!any)
+        return result;
+
+    const double relativeGated = gatedMean(toLufs(absoluteGated) - 10.0, any);
+    if (any)
+        result.lufs = std::max(-100.0, toLufs(relativeGated));
+
+    return result;
+}
+
 //==============================================================================
 // Resampling
 
@@ -448,24 +1105,61 @@ void SampleDSP::resample(const juce::AudioBuffer<float>& source,
 
     dest.setSize(numChannels, destLength);
 
-    // Use JUCE's LagrangeInterpolator for high-quality resampling
-    for (int ch = 0; ch < numChannels; ++ch)
+    // speedRatio = source rate / target rate
+    // e.g., 44100 -> 48000: speedRatio = 44100/48000 = 0.91875
+    const double speedRatio = sourceSampleRate / targetSampleRate;
+
+    // Blocks start where an output sample falls exactly on an input sample:
+    // every outputPeriod outputs, inputPeriod inputs (160 and 147 for
+    // 44.1 -> 48 kHz).  A block runs its interpolator from one period early,
+    // so it arrives at its first sample in the state a single pass would have,
+    // to within float rounding.
+    juce::int64 inputPeriod = 0, outputPeriod = 0;
+    if (sourceSampleRate == std::floor(sourceSampleRate) && targetSampleRate == std::floor(targetSampleRate))
     {
-        juce::LagrangeInterpolator interpolator;
-        interpolator.reset();
+        const auto divisor = std::gcd((juce::int64)sourceSampleRate, (juce::int64)targetSampleRate);
+        inputPeriod  = (juce::int64)sourceSampleRate / divisor;
+        outputPeriod = (juce::int64)targetSampleRate / divisor;
+    }
+
+    constexpr int targetBlockSize = 1 << 16;
+    const bool splitBlocks = outputPeriod > 0 && outputPeriod <= targetBlockSize && inputPeriod >= 8
+                             && destLength > 2 * targetBlockSize;
+    const int blockSize = splitBlocks ? (int)((targetBlockSize / outputPeriod) * outputPeriod) : destLength;
+    const int numBlocks = (destLength + blockSize - 1) / blockSize;
+
+    // Use JUCE's LagrangeInterpolator for high-quality resampling, per channel and block
+    juce::SharedResourcePointer<DSPWorkerPool> workers;
+
+    workers->parallelFor(numChannels * numBlocks, [&](int taskIndex)
+    {
+        const int ch    = taskIndex / numBlocks;
+        const int block = taskIndex % numBlocks;
+        const int outStart  = block * blockSize;
+        const int outLength = juce::jmin(blockSize, destLength - outStart);
 
         const float* srcData = source.getReadPointer(ch);
         float* dstData = dest.getWritePointer(ch);
 
-        // speedRatio = source rate / target rate
-        // e.g., 44100 -> 48000: speedRatio = 44100/48000 = 0.91875
-        double speedRatio = sourceSampleRate / targetSampleRate;
+        juce::LagrangeInterpolator interpolator;
+        interpolator.reset();
+
+        // Bounded by sourceLength: the last output samples need input past the
+        // end, which is read as silence instead of running off the buffer.
+        if (block == 0)
+        {
+            interpolator.process(speedRatio, srcData, dstData, outLength, sourceLength, 0);
+            return;
+        }
 
-        int samplesUsed = interpolator.process(speedRatio, srcData, dstData, destLength);
+        const auto warmOut = (int)outputPeriod;
+        const auto inStart = (int)(((juce::int64)outStart - warmOut) / outputPeriod * inputPeriod);
 
-        // If we didn't use all samples (shouldn't happen normally), that's ok
-        juce::ignoreUnused(samplesUsed);
-    }
+        std::vector<float> scratch((size_t)(warmOut + outLength));
+        interpolator.process(speedRatio, srcData + inStart, scratch.data(), (int)scratch.size(),
+                             sourceLength - inStart, 0);
+        std::copy(scratch.begin() + warmOut, scratch.end(), dstData + outStart);
+    });
 
     DBG("SampleDSP: Resampled from " + juce::String(sourceSampleRate) + " Hz to " +
         juce::String(targetSampleRate) + " Hz (" + juce::String(sourceLength) +
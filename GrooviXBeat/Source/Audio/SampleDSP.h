@@ -2,34 +2,135 @@
     SampleDSP - Static DSP algorithms for sample editing
 
     Provides:
-    - Time stretching (linear interpolation)
-    - BPM detection (onset-based)
+    - Time stretching (WSOLA, FFT-accelerated similarity search)
+    - Onset analysis: RMS and onset envelopes from one pass over the samples
+    - BPM detection (FFT autocorrelation of the onset envelope)
+    - Loudness: RMS and integrated LUFS
     - Fade in/out operations
     - Silence operation
 
-    All methods are static and operate on AudioBuffer references.
+    All methods are static and operate on AudioBuffer references, except
+    the analysis SampleBuffer keeps in step with its edits, which reads its
+    ChunkedAudio in place.  Time stretching and resampling split long
+    buffers over the DSPWorkerPool.  Time stretching reports to a Progress
+    and stops early when it is cancelled.
 */
 
 #pragma once
 
 #include <JuceHeader.h>
 #include <vector>
+#include <atomic>
+#include "ChunkedAudio.h"
 
 class SampleDSP
 {
 public:
+    //==============================================================================
+    // Progress and Cancellation
+
+    /**
+     * Shared between a long operation and whoever started it (e.g. a
+     * background edit job); safe to use from any thread.  The operation
+     * reports how far it got and stops early once cancelled, leaving output
+     * that must be discarded.
+     */
+    class Progress
+    {
+    public:
+        /** Part of the overall progress [start, end] the next step reports into. */
+        void setRange(double start, double end);
+
+        /** Report how far (0..1) the current step got; never moves backwards. */
+        void setStepProgress(double proportion);
+
+        /** Overall progress, 0..1 */
+        double getProgress() const { return progress.load(); }
+
+        void cancel() { cancelled = true; }
+        bool isCancelled() const { return cancelled.load(); }
+
+    private:
+        std::atomic<double> progress { 0.0 };
+        std::atomic<double> rangeStart { 0.0 };
+        std::atomic<double> rangeEnd { 1.0 };
+        std::atomic<bool> cancelled { false };
+    };
+
     //==============================================================================
     // Time Stretching
 
     /**
-     * Time stretch using linear interpolation.
+     * Pitch-preserving time stretch (WSOLA).  The frame search runs in
+     * overlapping segments of a few seconds on the DSP worker pool, and the
+     * seams between them are searched again until they rejoin, so the output
+     * is that of a single pass and does not depend on the number of cores.
+     * (GrooviXBeatBench checks this against an unsegmented direct search.)
      * @param source Input buffer
      * @param dest Output buffer (will be resized)
      * @param ratio Stretch ratio (2.0 = twice as long, 0.5 = half as long)
+     * @param progress If given, receives progress; when cancelled, dest is incomplete
      */
     static void timeStretch(const juce::AudioBuffer<float>& source,
                             juce::AudioBuffer<float>& dest,
-                            double ratio);
+                            double ratio,
+                            Progress* progress = nullptr);
+
+   #ifdef GROOVIXBEAT_BENCHMARKS
+    /**
+     * Bench builds only (GrooviXBeatBench): timeStretch() with the original
+     * direct similarity search instead of the FFT one, and/or on the calling
+     * thread instead of the DSP worker pool, and/or as one search over the
+     * whole buffer instead of segments (the reference for the output).
+     */
+    static void timeStretchForBenchmark(const juce::AudioBuffer<float>& source,
+                                        juce::AudioBuffer<float>& dest,
+                                        double ratio,
+                                        bool exhaustiveSearch,
+                                        bool multiThreaded,
+                                        bool segmented = true);
+   #endif
+
+    //==============================================================================
+    // Onset Analysis
+
+    /** Envelopes shared by BPM and transient detection. */
+    struct OnsetEnvelope
+    {
+        double sampleRate = 0.0;
+        int numChannels = 0;
+        int numSamples = 0;            // of the analyzed buffer
+        int hopSize = 0;               // samples per frame (~700 frames per second)
+        std::vector<float> energy;     // mean square of each hop, over all channels
+        std::vector<float> rms;        // RMS of the ~23 ms window starting at each hop
+        std::vector<float> onset;      // half-wave rectified rise of rms, in dB
+
+        double getFramesPerSecond() const { return hopSize > 0 ? sampleRate / hopSize : 0.0; }
+    };
+
+    /**
+     * Build the RMS and onset envelopes in one pass over the samples.
+     * Windows are whole numbers of hops, summed from the per-hop energies.
+     * @param buffer Audio buffer to analyze
+     * @param sampleRate Sample rate of the audio
+     */
+    static OnsetEnvelope analyzeOnsets(const juce::AudioBuffer<float>& buffer, double sampleRate);
+    static OnsetEnvelope analyzeOnsets(const ChunkedAudio& buffer, double sampleRate);
+
+    /**
+     * Samples in [startSample, startSample + numSamples) changed in place:
+     * only the hops they touch are measured again.  Falls back to a full
+     * analysis if the envelope is not of this buffer's layout.
+     */
+    static void updateOnsets(OnsetEnvelope& envelope, const ChunkedAudio& buffer,
+                             int startSample, int numSamples);
+
+    /**
+     * Everything from startSample on changed or moved (insert, delete, new
+     * length).  Hops before startSample are kept.
+     */
+    static void updateOnsetsFrom(OnsetEnvelope& envelope, const ChunkedAudio& buffer,
+                                 int startSample);
 
     //==============================================================================
     // BPM Detection
@@ -42,6 +143,13 @@ public:
      */
     static double detectBPM(const juce::AudioBuffer<float>& buffer, double sampleRate);
 
+    /**
+     * Detect BPM from an onset envelope: FFT autocorrelation over the
+     * 60-180 BPM lag range, refined with a parabolic fit.
+     * @return Detected BPM (normalized to 60-180 range), or 0 if detection fails
+     */
+    static double detectBPM(const OnsetEnvelope& envelope);
+
     //==============================================================================
     // Fade Operations
 
@@ -84,11 +192,39 @@ public:
      */
     static std::vector<double> detectTransients(const juce::AudioBuffer<float>& buffer, double sampleRate);
 
+    /**
+     * Detect transients from an onset envelope: the rise of a ~10 ms RMS
+     * taken from its per-hop energies.
+     * @return Vector of transient positions in seconds
+     */
+    static std::vector<double> detectTransients(const OnsetEnvelope& envelope);
+
+    //==============================================================================
+    // Loudness
+
+    /** Overall level of a buffer; -100 for silence. */
+    struct Loudness
+    {
+        double rmsDb = -100.0;   // RMS over all channels, dBFS
+        double lufs  = -100.0;   // integrated loudness (ITU-R BS.1770, gated), LUFS
+    };
+
+    /**
+     * Measure RMS and integrated loudness: K-weighted 400 ms blocks with
+     * 75 % overlap, absolute gate at -70 LUFS and relative gate 10 LU down.
+     * Channels are filtered in parallel on the DSP worker pool.
+     * @param buffer Audio buffer to measure (all channels weighted 1.0)
+     * @param sampleRate Sample rate of the audio
+     */
+    static Loudness measureLoudness(const ChunkedAudio& buffer, double sampleRate);
+
     //==============================================================================
     // Resampling
 
     /**
      * Resample audio to a different sample rate using high-quality interpolation.
+     * Long buffers are resampled per channel and block on the DSP worker pool,
+     * and the output matches a single pass to within float rounding.
      * @param source Input buffer
      * @param dest Output buffer (will be resized)
      * @param sourceSampleRate Original sample rate
@@ -25,6 +25,7 @@ bool SampleEditor::loadFromFile(const juce::File& file, double targetSampleRate)
     {
         currentFilePath = file.getFullPathName();
         clearUndoHistory();
+        ++generation;
     }
 
     return success;
@@ -38,6 +39,7 @@ bool SampleEditor::loadFromBuffer(const juce::AudioBuffer<float>& sourceBuffer,
     buffer->loadFromBuffer(sourceBuffer, sampleRate);
     currentFilePath = {};  // No file path for cached buffers
     clearUndoHistory();
+    ++generation;
 
     return buffer->hasData();
 }
@@ -57,6 +59,7 @@ void SampleEditor::clear()
     buffer->clear();
     currentFilePath = {};
     clearUndoHistory();
+    ++generation;
 }
 
 //==============================================================================
@@ -85,21 +88,24 @@ int SampleEditor::getNumChannels() const
 //==============================================================================
 // Editing Operations
 
-void SampleEditor::timeStretch(double ratio, double targetLengthSeconds)
+void SampleEditor::timeStretch(double ratio, double targetLengthSeconds, SampleDSP::Progress* progress)
 {
     if (!isLoaded() || ratio <= 0.0 || ratio == 1.0)
         return;
 
-    pushUndoState();
-    buffer->timeStretch(ratio, targetLengthSeconds);
+    // A cancelled stretch leaves this undo point behind: only working copies
+    // are given a progress, and a cancelled one is dropped
+    pushUndoState("timeStretch", { { 0, -1, -1 } });
+    buffer->timeStretch(ratio, targetLengthSeconds, progress);
 }
 
-void SampleEditor::applyWarp(double sampleBPM, double targetBPM, double targetLengthSeconds)
+void SampleEditor::applyWarp(double sampleBPM, double targetBPM, double targetLengthSeconds,
+                             SampleDSP::Progress* progress)
 {
     if (!isLoaded() || targetBPM <= 0.0)
         return;
 
-    pushUndoState();
+    pushUndoState("applyWarp", { { 0, -1, -1 } });
 
     // If sample BPM provided, set it; otherwise detect
     if (sampleBPM > 0.0)
@@ -111,7 +117,7 @@ void SampleEditor::applyWarp(double sampleBPM, double targetBPM, double targetLe
         buffer->detectBPM();
     }
 
-    buffer->applyWarp(targetBPM, targetLengthSeconds);
+    buffer->applyWarp(targetBPM, targetLengthSeconds, progress);
 }
 
 double SampleEditor::detectBPM()
@@ -134,7 +140,7 @@ void SampleEditor::fadeIn(double startSeconds, double endSeconds)
     if (numSamples <= 0)
         return;
 
-    pushUndoState();
+    pushUndoState("fadeIn", { { startSample, numSamples, numSamples } });
     buffer->fadeIn(startSample, numSamples);
 }
 
@@ -150,7 +156,7 @@ void SampleEditor::fadeOut(double startSeconds, double endSeconds)
     if (numSamples <= 0)
         return;
 
-    pushUndoState();
+    pushUndoState("fadeOut", { { startSample, numSamples, numSamples } });
     buffer->fadeOut(startSample, numSamples);
 }
 
@@ -166,7 +172,7 @@ void SampleEditor::silence(double startSeconds, double endSeconds)
     if (numSamples <= 0)
         return;
 
-    pushUndoState();
+    pushUndoState("silence", { { startSample, numSamples, numSamples } });
     buffer->silence(startSample, numSamples);
 }
 
@@ -179,10 +185,16 @@ void SampleEditor::trim(double startSeconds, double endSeconds)
     int endSample = secondsToSamples(endSeconds);
     int numSamples = endSample - startSample;
 
+    // Same validation as SampleBuffer::trim, so the undo step matches the edit
+    int totalSamples = buffer->getNumSamples();
+    startSample = juce::jlimit(0, totalSamples, startSample);
+    numSamples = juce::jlimit(0, totalSamples - startSample, numSamples);
+
     if (numSamples <= 0)
         return;
 
-    pushUndoState();
+    // Keeping a range = removing the tail, then the head
+    pushUndoState("trim", { { startSample + numSamples, -1, 0 }, { 0, startSample, 0 } });
     buffer->trim(startSample, numSamples);
 }
 
@@ -195,10 +207,15 @@ void SampleEditor::deleteRange(double startSeconds, double endSeconds)
     int endSample = secondsToSamples(endSeconds);
     int numSamples = endSample - startSample;
 
-    if (numSamples <= 0)
+    // Same validation as SampleBuffer::deleteRange, so the undo step matches the edit
+    int totalSamples = buffer->getNumSamples();
+    startSample = juce::jlimit(0, totalSamples, startSample);
+    numSamples = juce::jlimit(0, totalSamples - startSample, numSamples);
+
+    if (numSamples <= 0 || numSamples >= totalSamples)
         return;
 
-    pushUndoState();
+    pushUndoState("deleteRange", { { startSample, numSamples, 0 } });
     buffer->deleteRange(startSample, numSamples);
 }
 
@@ -214,8 +231,9 @@ void SampleEditor::copyRange(double startSeconds, double endSeconds)
     if (numSamples <= 0)
         return;
 
-    clipboard = buffer->copyRange(startSample, numSamples);
+    clipboard = buffer->getRange(startSample, numSamples);
     clipboardSampleRate = buffer->getSampleRate();
+    ++generation;
 
     DBG("SampleEditor: Copied " + juce::String(numSamples) + " samples to clipboard");
 }
@@ -225,9 +243,15 @@ void SampleEditor::insertClipboard(double positionSeconds)
     if (!isLoaded() || clipboard.getNumSamples() == 0)
         return;
 
-    int insertPosition = secondsToSamples(positionSeconds);
+    int insertPosition = juce::jlimit(0, buffer->getNumSamples(), secondsToSamples(positionSeconds));
+
+    // An insert costs no undo memory, unless a clipboard with fewer channels
+    // drops channels from the buffer
+    if (clipboard.getNumChannels() >= buffer->getNumChannels())
+        pushUndoState("insertClipboard", { { insertPosition, 0, clipboard.getNumSamples() } });
+    else
+        pushUndoState("insertClipboard", { { 0, -1, -1 } });
 
-    pushUndoState();
     buffer->insertBuffer(clipboard, insertPosition);
 
     DBG("SampleEditor: Inserted clipboard at " + juce::String(positionSeconds, 3) + "s");
@@ -240,8 +264,9 @@ bool SampleEditor::hasClipboardData() const
 
 void SampleEditor::clearClipboard()
 {
-    clipboard.setSize(0, 0);
+    clipboard.clear();
     clipboardSampleRate = 0.0;
+    ++generation;
 }
 
 //==============================================================================
@@ -272,35 +297,55 @@ void SampleEditor::offsetBy(double deltaSeconds)
 
 void SampleEditor::reset()
 {
-    if (!isLoaded())
+    if (!isLoaded() || !buffer->hasOriginal())
         return;
 
-    pushUndoState();
+    pushUndoState("reset", { { 0, -1, -1 } });
     buffer->reset();
 }
 
 //==============================================================================
 // Undo/Redo
 
-void SampleEditor::pushUndoState()
+void SampleEditor::pushUndoState(const juce::String& operation, std::initializer_list<EditRegion> regions)
 {
     if (!isLoaded())
         return;
 
-    // Capture current state
-    UndoState state = captureState();
+    UndoState state;
+    state.operation = operation;
+    state.detectedBPM = buffer->getDetectedBPM();
+    state.stretchFactor = buffer->getStretchFactor();
+    state.playbackOffset = buffer->getPlaybackOffset();
 
-    // Push to undo stack
-    undoStack.push_back(std::move(state));
+    const int currentLength = buffer->getNumSamples();
 
-    // Limit undo stack size
-    while (static_cast<int>(undoStack.size()) > maxUndoStates)
+    // Keep only what each region replaces.  The splices undo the regions in
+    // reverse order, each putting the old samples back over the new ones.
+    for (const auto& region : regions)
     {
-        undoStack.erase(undoStack.begin());
+        const int start = juce::jlimit(0, currentLength, region.startSample);
+        const int oldLength = region.oldLength < 0 ? currentLength - start
+                                                   : juce::jlimit(0, currentLength - start, region.oldLength);
+
+        // In-place edits are clipped like the range they overwrite
+        const int newLength = (region.newLength >= 0 && region.newLength == region.oldLength) ? oldLength
+                                                                                              : region.newLength;
+
+        Splice splice;
+        splice.startSample = start;
+        splice.numSamples = newLength;
+        splice.samples = buffer->getRange(start, oldLength);
+        state.splices.insert(state.splices.begin(), std::move(splice));
     }
 
+    undoStack.push_back(std::move(state));
+
     // Clear redo stack (new action invalidates redo history)
     redoStack.clear();
+
+    trimUndoHistory();
+    ++generation;
 }
 
 void SampleEditor::undo()
@@ -308,13 +353,16 @@ void SampleEditor::undo()
     if (!canUndo())
         return;
 
-    // Save current state to redo stack
-    redoStack.push_back(captureState());
-
-    // Restore from undo stack
-    UndoState& state = undoStack.back();
-    restoreState(state);
+    UndoState state = std::move(undoStack.back());
     undoStack.pop_back();
+
+    // Restore, keeping what it replaces on the redo stack
+    redoStack.push_back(applyState(state));
+    trimUndoHistory();
+    ++generation;
+
+    DBG("SampleEditor: Undo " + state.operation + " (" +
+        juce::File::descriptionOfSizeInBytes((juce::int64)getUndoSizeInBytes()) + " of undo history)");
 }
 
 void SampleEditor::redo()
@@ -322,13 +370,15 @@ void SampleEditor::redo()
     if (!canRedo())
         return;
 
-    // Save current state to undo stack
-    undoStack.push_back(captureState());
-
-    // Restore from redo stack
-    UndoState& state = redoStack.back();
-    restoreState(state);
+    UndoState state = std::move(redoStack.back());
     redoStack.pop_back();
+
+    // Restore, keeping what it replaces on the undo stack
+    undoStack.push_back(applyState(state));
+    trimUndoHistory();
+    ++generation;
+
+    DBG("SampleEditor: Redo " + state.operation);
 }
 
 bool SampleEditor::canUndo() const
@@ -347,15 +397,105 @@ void SampleEditor::clearUndoHistory()
     redoStack.clear();
 }
 
-void SampleEditor::setMaxUndoStates(int maxStates)
+void SampleEditor::setUndoBudgetBytes(size_t maxBytes)
 {
-    maxUndoStates = juce::jmax(1, maxStates);
+    undoBudgetBytes = maxBytes;
+    trimUndoHistory();
+}
+
+size_t SampleEditor::getUndoSizeInBytes() const
+{
+    return tallyUndoChunks().getSizeInBytes();
+}
 
-    // Trim undo stack if necessary
-    while (static_cast<int>(undoStack.size()) > maxUndoStates)
+ChunkedAudio::ChunkTally SampleEditor::tallyUndoChunks() const
+{
+    ChunkedAudio::ChunkTally tally;
+
+    // Chunks the buffer, its original or the clipboard still use stay in
+    // memory whatever happens to the history
+    if (buffer)
     {
-        undoStack.erase(undoStack.begin());
+        tally.exclude(buffer->getRange(0, buffer->getNumSamples()));
+        tally.exclude(buffer->getOriginal());
     }
+    tally.exclude(clipboard);
+
+    for (const auto* stack : { &undoStack, &redoStack })
+        for (const auto& state : *stack)
+            for (const auto& splice : state.splices)
+                tally.add(splice.samples);
+
+    return tally;
+}
+
+void SampleEditor::trimUndoHistory()
+{
+    auto tally = tallyUndoChunks();
+
+    // A chunk shared between steps is freed only with the last of them
+    auto drop = [&tally](std::vector<UndoState>& stack)
+    {
+        for (const auto& splice : stack.front().splices)
+            tally.remove(splice.samples);
+        stack.erase(stack.begin());
+    };
+
+    // Oldest undo steps first, then the redo steps furthest away; the most
+    // recent undo step is always kept
+    while (tally.getSizeInBytes() > undoBudgetBytes && undoStack.size() > 1)
+        drop(undoStack);
+
+    while (tally.getSizeInBytes() > undoBudgetBytes && !redoStack.empty())
+        drop(redoStack);
+}
+
+//==============================================================================
+// Working Copies
+
+std::unique_ptr<SampleEditor> SampleEditor::createWorkingCopy() const
+{
+    auto copy = std::make_unique<SampleEditor>();
+
+    // Everything here shares chunks, so this copies no audio
+    copy->buffer = buffer->createWorkingCopy();
+    copy->currentFilePath = currentFilePath;
+    copy->clipboard = clipboard;
+    copy->clipboardSampleRate = clipboardSampleRate;
+    copy->undoStack = undoStack;
+    copy->redoStack = redoStack;
+    copy->undoBudgetBytes = undoBudgetBytes;
+    copy->generation = generation;
+    copy->baseGeneration = generation;
+    copy->basePlaybackOffset = buffer->getPlaybackOffset();
+
+    return copy;
+}
+
+bool SampleEditor::commitWorkingCopy(SampleEditor& copy)
+{
+    if (copy.baseGeneration != generation)
+    {
+        DBG("SampleEditor: Working copy is out of date, not committed");
+        return false;
+    }
+
+    // Offsets are set directly, without a working copy: keep one set since
+    // the copy was made, unless the edit (undo, redo, reset) moved it
+    if (copy.buffer->getPlaybackOffset() == copy.basePlaybackOffset)
+        copy.buffer->setPlaybackOffset(buffer->getPlaybackOffset());
+
+    buffer->takeContentFrom(*copy.buffer);
+    std::swap(clipboard, copy.clipboard);
+    std::swap(clipboardSampleRate, copy.clipboardSampleRate);
+    std::swap(undoStack, copy.undoStack);
+    std::swap(redoStack, copy.redoStack);
+
+    // The budget may have changed meanwhile
+    trimUndoHistory();
+    ++generation;
+
+    return true;
 }
 
 //==============================================================================
@@ -369,44 +509,36 @@ int SampleEditor::secondsToSamples(double seconds) const
     return static_cast<int>(seconds * buffer->getSampleRate());
 }
 
-SampleEditor::UndoState SampleEditor::captureState() const
+SampleEditor::UndoState SampleEditor::applyState(const UndoState& state)
 {
-    UndoState state;
+    UndoState reverse;
+    reverse.operation = state.operation;
 
-    if (buffer)
+    if (!buffer)
+        return reverse;
+
+    reverse.detectedBPM = buffer->getDetectedBPM();
+    reverse.stretchFactor = buffer->getStretchFactor();
+    reverse.playbackOffset = buffer->getPlaybackOffset();
+
+    for (const auto& splice : state.splices)
     {
-        juce::ScopedLock sl(buffer->getLock());
-
-        // Copy buffer data
-        int numChannels = buffer->getNumChannels();
-        int numSamples = buffer->getNumSamples();
-
-        state.data.setSize(numChannels, numSamples);
-        for (int ch = 0; ch < numChannels; ++ch)
-        {
-            const float* src = buffer->getReadPointer(ch);
-            if (src)
-            {
-                std::memcpy(state.data.getWritePointer(ch), src,
-                           sizeof(float) * static_cast<size_t>(numSamples));
-            }
-        }
-
-        state.sampleRate = buffer->getSampleRate();
-        state.detectedBPM = buffer->getDetectedBPM();
-        state.stretchFactor = buffer->getStretchFactor();
-        state.playbackOffset = buffer->getPlaybackOffset();
-    }
+        const int start = juce::jlimit(0, buffer->getNumSamples(), splice.startSample);
+        const int length = splice.numSamples < 0 ? buffer->getNumSamples() - start : splice.numSamples;
 
-    return state;
-}
+        // The reverse step puts back what this splice removes, running backwards
+        Splice back;
+        back.startSample = start;
+        back.numSamples = splice.samples.getNumSamples();
+        back.samples = buffer->getRange(start, length);
+        reverse.splices.insert(reverse.splices.begin(), std::move(back));
 
-void SampleEditor::restoreState(const UndoState& state)
-{
-    if (!buffer)
-        return;
+        buffer->replaceRange(start, length, splice.samples);
+    }
 
-    buffer->loadFromBuffer(state.data, state.sampleRate);
     buffer->setDetectedBPM(state.detectedBPM);
+    buffer->setStretchFactor(state.stretchFactor);
     buffer->setPlaybackOffset(state.playbackOffset);
+
+    return reverse;
 }
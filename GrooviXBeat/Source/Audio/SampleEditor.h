@@ -4,13 +4,17 @@
     Provides:
     - File loading and saving
     - All editing operations with automatic undo state management
-    - Undo/redo functionality
+    - Undo/redo functionality: each step keeps only the samples its edit
+      replaced, within a byte budget
     - Range-based editing (start time, end time in seconds)
+    - Working copies: edit a copy off the message thread, then commit it
+      back (audio, analysis, clipboard and undo point) in one step
 */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include <memory>
 #include "SampleBuffer.h"
 
 class SampleEditor
@@ -77,16 +81,20 @@ public:
      * Time stretch the sample.
      * @param ratio Stretch ratio (2.0 = twice as long, 0.5 = half as long)
      * @param targetLengthSeconds If > 0, pad/trim to this length after stretching
+     * @param progress If given, receives the stretch's progress and can cancel it
      */
-    void timeStretch(double ratio, double targetLengthSeconds = 0.0);
+    void timeStretch(double ratio, double targetLengthSeconds = 0.0,
+                     SampleDSP::Progress* progress = nullptr);
 
     /**
      * Apply warp to match sample BPM to target BPM.
      * @param sampleBPM The BPM of the sample (or 0 to auto-detect)
      * @param targetBPM The target BPM to match
      * @param targetLengthSeconds If > 0, pad/trim to this length after warping
+     * @param progress If given, receives the stretch's progress and can cancel it
      */
-    void applyWarp(double sampleBPM, double targetBPM, double targetLengthSeconds = 0.0);
+    void applyWarp(double sampleBPM, double targetBPM, double targetLengthSeconds = 0.0,
+                   SampleDSP::Progress* progress = nullptr);
 
     /**
      * Detect BPM from sample.
@@ -169,9 +177,6 @@ public:
     //==============================================================================
     // Undo/Redo
 
-    /** Push current state onto undo stack */
-    void pushUndoState();
-
     /** Undo last operation */
     void undo();
 
@@ -190,38 +195,105 @@ public:
     //==============================================================================
     // Undo Settings
 
-    /** Set maximum number of undo states (default 10) */
-    void setMaxUndoStates(int maxStates);
+    static constexpr size_t defaultUndoBudgetBytes = (size_t)256 * 1024 * 1024;
+
+    /**
+     * Set the memory undo and redo history may use together (default 256 MB).
+     * Oldest steps are dropped first; the most recent edit stays undoable
+     * even if it alone is larger.
+     */
+    void setUndoBudgetBytes(size_t maxBytes);
+
+    /** Get the undo memory budget */
+    size_t getUndoBudgetBytes() const { return undoBudgetBytes; }
+
+    /** Memory only the undo and redo history keep alive (each shared chunk counted once) */
+    size_t getUndoSizeInBytes() const;
+
+    //==============================================================================
+    // Working Copies
+
+    /**
+     * A copy to run edits on elsewhere (e.g. a background job).  Shares the
+     * audio chunks and carries the clipboard and undo history, so an edit on
+     * it records its undo point as usual.  Commit it with commitWorkingCopy(),
+     * or drop it to discard the edit.
+     */
+    std::unique_ptr<SampleEditor> createWorkingCopy() const;
+
+    /**
+     * Take over an edited working copy's audio, analysis, clipboard and undo
+     * history in one step.  A playback offset set here meanwhile is kept
+     * unless the edit moved it.  Returns false, changing nothing, if this
+     * editor was changed (loaded, edited, committed) since the copy was made.
+     */
+    bool commitWorkingCopy(SampleEditor& copy);
 
-    /** Get maximum undo states */
-    int getMaxUndoStates() const { return maxUndoStates; }
+    /** Counts changes to the audio, clipboard and undo history */
+    juce::uint32 getGeneration() const { return generation; }
 
 private:
     std::unique_ptr<SampleBuffer> buffer;
     juce::String currentFilePath;
 
-    // Clipboard for copy/paste operations
-    juce::AudioBuffer<float> clipboard;
+    // Clipboard for copy/paste operations (shares the buffer's chunks)
+    ChunkedAudio clipboard;
     double clipboardSampleRate = 0.0;
 
-    // Undo/Redo system
+    // Undo/Redo system.  A step is a list of splices that turns the buffer
+    // back into what it was, so it holds only the samples the edit replaced
+    // (nothing at all for an insert), as pieces of the chunks they were in.
+    struct Splice
+    {
+        int startSample = 0;
+        int numSamples = 0;                 // length of the range it replaces; -1 = to the end
+        ChunkedAudio samples;               // what goes in its place
+    };
+
     struct UndoState
     {
-        juce::AudioBuffer<float> data;
-        double sampleRate;
-        double detectedBPM;
-        double stretchFactor;
-        double playbackOffset;
+        juce::String operation;             // for logging
+        std::vector<Splice> splices;        // applied in order
+        double detectedBPM = 0.0;
+        double stretchFactor = 1.0;
+        double playbackOffset = 0.0;
+    };
+
+    // A range an edit is about to replace: [startSample, startSample + oldLength)
+    // becomes newLength samples.  -1 lengths mean "to the end".
+    struct EditRegion
+    {
+        int startSample;
+        int oldLength;
+        int newLength;
     };
 
     std::vector<UndoState> undoStack;
     std::vector<UndoState> redoStack;
-    int maxUndoStates = 10;
+    size_t undoBudgetBytes = defaultUndoBudgetBytes;
+
+    juce::uint32 generation = 0;
+
+    // Of a working copy: the editor's generation and offset it was made at
+    juce::uint32 baseGeneration = 0;
+    double basePlaybackOffset = 0.0;
 
     // Helpers
     int secondsToSamples(double seconds) const;
-    UndoState captureState() const;
-    void restoreState(const UndoState& state);
+
+    /**
+     * Record an undo step before an edit.  Regions are listed in the order
+     * the edit applies them, and each must be unaffected by the ones before.
+     */
+    void pushUndoState(const juce::String& operation, std::initializer_list<EditRegion> regions);
+
+    /** Apply a step to the buffer; returns the step that reverses it. */
+    UndoState applyState(const UndoState& state);
+
+    void trimUndoHistory();
+
+    /** The chunks only the undo and redo history keep alive. */
+    ChunkedAudio::ChunkTally tallyUndoChunks() const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleEditor)
 };
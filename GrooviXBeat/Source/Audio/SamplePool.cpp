@@ -0,0 +1,116 @@
+/*
+    SamplePool - Process-wide store of decoded samples
+*/
+
+#include "SamplePool.h"
+#include "DecodeCache.h"
+
+//==============================================================================
+SamplePool::SamplePool()
+{
+}
+
+SamplePool::~SamplePool()
+{
+}
+
+SharedSampleBuffer::Ptr SamplePool::get(const juce::String& filePath, SharedSampleBuffer::Storage storage)
+{
+    juce::File file(filePath);
+    if (!file.existsAsFile())
+        return nullptr;
+
+    // Taken before decoding, so an edit during the decode leaves the entry stale.
+    const auto fileSize = file.getSize();
+    const auto modificationTime = file.getLastModificationTime().toMilliseconds();
+    const Key key { filePath, storage };
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            if (it->second.fileSize == fileSize && it->second.modificationTime == modificationTime)
+            {
+                ++hits;
+                return it->second.buffer;
+            }
+
+            entries.erase(it);
+        }
+    }
+
+    // Decode outside the lock; own format manager per call, so threads never
+    // share reader factories.
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    juce::AudioBuffer<float> decoded;
+    double sampleRate = 0.0;
+
+    if (!DecodeCache::readFile(formatManager, file, decoded, sampleRate))
+        return nullptr;
+
+    SharedSampleBuffer::Ptr buffer = new SharedSampleBuffer(std::move(decoded), sampleRate, filePath, storage);
+
+    const juce::ScopedLock sl(lock);
+    ++decodes;
+
+    // Another thread may have decoded the same file meanwhile: keep one copy.
+    auto& entry = entries[key];
+    if (entry.buffer != nullptr && entry.fileSize == fileSize && entry.modificationTime == modificationTime)
+        return entry.buffer;
+
+    entry = { buffer, fileSize, modificationTime };
+    return buffer;
+}
+
+void SamplePool::invalidate(const juce::String& filePath)
+{
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->first.first == filePath)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+void SamplePool::purgeUnused()
+{
+    const juce::ScopedLock sl(lock);
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.buffer->getReferenceCount() <= 1)
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+bool SamplePool::contains(const SharedSampleBuffer& buffer) const
+{
+    const juce::ScopedLock sl(lock);
+
+    auto it = entries.find({ buffer.getFilePath(), buffer.getStorage() });
+    return it != entries.end() && it->second.buffer.get() == &buffer;
+}
+
+SamplePool::Stats SamplePool::getStats() const
+{
+    const juce::ScopedLock sl(lock);
+
+    Stats stats;
+    stats.numBuffers = (int)entries.size();
+    stats.hits       = hits;
+    stats.decodes    = decodes;
+
+    for (const auto& [key, entry] : entries)
+        stats.sizeInBytes += entry.buffer->getSizeInBytes();
+
+    return stats;
+}
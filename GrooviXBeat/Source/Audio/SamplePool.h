@@ -0,0 +1,73 @@
+/*
+    SamplePool - Process-wide store of decoded samples
+
+    Provides:
+    - One SharedSampleBuffer per file (and storage format), handed out to
+      every consumer that asks for it: the Live Mode sample cache, drum kit
+      pads, sampler instrument banks and the sample editors
+    - Validation by file size and modification time, plus invalidate() for
+      edits saved in place, so a changed file is decoded again
+    - purgeUnused(): drops buffers nobody but the pool holds any more
+
+    Memory scales with the unique audio in use, not with how many tracks or
+    pads reference it.  Access it through juce::SharedResourcePointer<SamplePool>;
+    all methods are thread-safe.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedSampleBuffer.h"
+#include <map>
+
+class SamplePool
+{
+public:
+    SamplePool();
+    ~SamplePool();
+
+    /**
+     * The shared decoded buffer for a file, decoding it (through DecodeCache)
+     * if the pool has no current copy.  Blocking; call from a background
+     * thread for large files.  Returns nullptr if the file cannot be decoded.
+     */
+    SharedSampleBuffer::Ptr get(const juce::String& filePath,
+                                SharedSampleBuffer::Storage storage = SharedSampleBuffer::Storage::float32);
+
+    /** Forget every copy of a file, e.g. after it was rewritten in place. */
+    void invalidate(const juce::String& filePath);
+
+    /** Drop buffers that only the pool still references. */
+    void purgeUnused();
+
+    /** True if this exact buffer is the pool's copy of its file (one reference is the pool's). */
+    bool contains(const SharedSampleBuffer& buffer) const;
+
+    struct Stats
+    {
+        int numBuffers = 0;
+        size_t sizeInBytes = 0;
+        juce::uint64 hits = 0;      // get() served an existing buffer
+        juce::uint64 decodes = 0;   // get() had to decode
+    };
+    Stats getStats() const;
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        SharedSampleBuffer::Ptr buffer;
+        juce::int64 fileSize = -1;
+        juce::int64 modificationTime = 0;
+    };
+
+    // Keyed by path and storage, so int16 and float32 copies of a file can coexist.
+    using Key = std::pair<juce::String, SharedSampleBuffer::Storage>;
+
+    mutable juce::CriticalSection lock;
+    std::map<Key, Entry> entries;
+    juce::uint64 hits = 0;
+    juce::uint64 decodes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePool)
+};
@@ -0,0 +1,187 @@
+/*
+    SampleVoice - Direct renderer for in-memory sample clips
+*/
+
+#include "SampleVoice.h"
+
+//==============================================================================
+SampleVoice::SampleVoice(SharedSampleBuffer::Ptr sourceBuffer, juce::int64 playLengthSamples)
+    : buffer(std::move(sourceBuffer)),
+      playLength(playLengthSamples >= 0 ? playLengthSamples
+                                        : (buffer != nullptr ? buffer->getNumSamples() : 0)),
+      dataEnd(std::min((juce::int64)(buffer != nullptr ? buffer->getNumSamples() : 0), playLength)),
+      numSourceChannels(buffer != nullptr ? buffer->getNumChannels() : 0),
+      span(juce::jmax(1, numSourceChannels), chunkSize * maxRatio + 2),
+      spanIndex((size_t)chunkSize),
+      fraction((size_t)chunkSize),
+      left((size_t)chunkSize),
+      right((size_t)chunkSize)
+{
+}
+
+void SampleVoice::setOutputSampleRate(double outputRate)
+{
+    const double bufferRate = buffer != nullptr ? buffer->getSampleRate() : 0.0;
+
+    if (outputRate <= 0.0 || bufferRate <= 0.0 || std::abs(bufferRate - outputRate) <= 0.01)
+        ratio = 1.0;
+    else
+        ratio = juce::jlimit(1.0 / maxRatio, (double)maxRatio, bufferRate / outputRate);
+}
+
+void SampleVoice::setPositionSeconds(double seconds)
+{
+    position = buffer != nullptr ? seconds * buffer->getSampleRate() : 0.0;
+}
+
+double SampleVoice::getPositionSeconds() const
+{
+    if (buffer == nullptr || buffer->getSampleRate() <= 0.0)
+        return 0.0;
+
+    double pos = position;
+    if (looping && playLength > 0 && pos >= (double)playLength)
+        pos = std::fmod(pos, (double)playLength);
+
+    return pos / buffer->getSampleRate();
+}
+
+void SampleVoice::wrapPosition()
+{
+    position = std::fmod(position, (double)playLength);
+}
+
+//==============================================================================
+void SampleVoice::render(juce::AudioBuffer<float>& dest, int startSample, int numSamples)
+{
+    const int destChannels = dest.getNumChannels();
+    int destPos   = startSample;
+    int remaining = numSamples;
+
+    while (remaining > 0 && playing && playLength > 0 && numSourceChannels > 0)
+    {
+        if (position >= (double)playLength)
+        {
+            if (!looping)
+            {
+                playing = false;
+                position = (double)playLength;
+                break;
+            }
+            wrapPosition();
+        }
+
+        int chunk;
+
+        if (position < (double)dataEnd && position >= 0.0)
+        {
+            // Data: never read past dataEnd within one pass.
+            chunk = juce::jlimit(1, juce::jmin(remaining, chunkSize),
+                                 (int)std::ceil(((double)dataEnd - position) / ratio));
+            renderData(dest, destPos, chunk);
+        }
+        else
+        {
+            // Pre-roll before sample 0, or padding after the data up to the play length.
+            const double silentUntil = position < 0.0 ? 0.0 : (double)playLength;
+            chunk = juce::jlimit(1, remaining, (int)std::ceil((silentUntil - position) / ratio));
+            for (int ch = 0; ch < destChannels; ++ch)
+                dest.clear(ch, destPos, chunk);
+            position += chunk * ratio;
+        }
+
+        destPos   += chunk;
+        remaining -= chunk;
+    }
+
+    // Stopped or past the end of a non-looping clip: silence.
+    if (remaining > 0)
+        for (int ch = 0; ch < destChannels; ++ch)
+            dest.clear(ch, destPos, remaining);
+}
+
+void SampleVoice::renderData(juce::AudioBuffer<float>& dest, int destStart, int numOut)
+{
+    const int destChannels = dest.getNumChannels();
+
+    // Same rate, whole-sample position: a straight vector copy (or integer
+    // conversion) out of the shared buffer.
+    if (ratio == 1.0 && position == std::floor(position))
+    {
+        const int index = (int)position;
+        for (int ch = 0; ch < destChannels; ++ch)
+            buffer->readSamples(dest, ch, destStart, juce::jmin(ch, numSourceChannels - 1), index, numOut);
+
+        position += numOut;
+        return;
+    }
+
+    // Linear interpolation.  Positions are worked out once for all channels;
+    // per channel the two neighbours are gathered and the blend is done with
+    // vector operations:  out = left + (right - left) * fraction.
+    const int first   = (int)std::floor(position);
+    const int lastIdx = (int)std::floor(position + (numOut - 1) * ratio);
+    const int spanLen = (int)std::min(dataEnd, (juce::int64)lastIdx + 2) - first;
+
+    for (int sc = 0; sc < numSourceChannels; ++sc)
+    {
+        buffer->readSamples(span, sc, 0, sc, first, spanLen);
+
+        // The right neighbour of the last data sample: the clip start across a
+        // loop seam, silence otherwise.
+        if (first + spanLen <= lastIdx + 1)
+        {
+            if (looping && dataEnd == playLength)
+                buffer->readSamples(span, sc, spanLen, sc, 0, 1);
+            else
+                span.setSample(sc, spanLen, 0.0f);
+        }
+    }
+
+    for (int j = 0; j < numOut; ++j)
+    {
+        const double p  = position + j * ratio;
+        const double fl = std::floor(p);
+        spanIndex[(size_t)j] = (int)fl - first;
+        fraction[(size_t)j]  = (float)(p - fl);
+    }
+
+    for (int ch = 0; ch < destChannels; ++ch)
+    {
+        const float* src = span.getReadPointer(juce::jmin(ch, numSourceChannels - 1));
+
+        for (int j = 0; j < numOut; ++j)
+        {
+            const int i = spanIndex[(size_t)j];
+            left[(size_t)j]  = src[i];
+            right[(size_t)j] = src[i + 1];
+        }
+
+        juce::FloatVectorOperations::subtract(right.data(), left.data(), numOut);
+        juce::FloatVectorOperations::multiply(right.data(), fraction.data(), numOut);
+        juce::FloatVectorOperations::add(dest.getWritePointer(ch, destStart), left.data(), right.data(), numOut);
+    }
+
+    position += numOut * ratio;
+}
+
+void SampleVoice::advance(int numSamples)
+{
+    if (!playing || playLength <= 0 || numSamples <= 0)
+        return;
+
+    position += numSamples * ratio;
+
+    if (position >= (double)playLength)
+    {
+        if (looping)
+        {
+            wrapPosition();
+        }
+        else
+        {
+            playing = false;
+            position = (double)playLength;
+        }
+    }
+}
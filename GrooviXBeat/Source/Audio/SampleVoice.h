@@ -0,0 +1,94 @@
+/*
+    SampleVoice - Direct renderer for in-memory sample clips
+
+    Provides:
+    - Playback of a SharedSampleBuffer view (play length, native looping,
+      pre-roll) straight into the output block, without the
+      AudioTransportSource / ResamplingAudioSource / source chain
+    - A vectorised copy (FloatVectorOperations) when the buffer is at the
+      output rate, and a block linear interpolator when it is not
+    - advance(): moves the play position arithmetically, so muted or silent
+      stretches cost O(1) instead of a render that is thrown away
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedSampleBuffer.h"
+#include <vector>
+
+/**
+ * Plays one clip from a shared buffer.  Positions are in buffer samples (the
+ * clip's own rate); setOutputSampleRate() sets the step per output sample.
+ *
+ * Mono data is duplicated to every output channel, as SharedSampleBufferSource
+ * does.  The play length works the same way too: a shorter one stops (or
+ * wraps) early, a longer one plays silence after the data ends.
+ *
+ * All scratch memory is allocated in the constructor; render() and advance()
+ * never allocate, lock or do I/O, so they are safe on the audio thread.
+ */
+class SampleVoice
+{
+public:
+    /**
+     * @param sourceBuffer       Shared data to play.
+     * @param playLengthSamples  Length of the view in buffer samples; a negative
+     *                           value plays the whole buffer.
+     */
+    explicit SampleVoice(SharedSampleBuffer::Ptr sourceBuffer, juce::int64 playLengthSamples = -1);
+
+    /** Rate the voice renders at; the buffer is interpolated if it differs. */
+    void setOutputSampleRate(double outputRate);
+
+    void setLooping(bool shouldLoop) { looping = shouldLoop; }
+    bool isLooping() const { return looping; }
+
+    /** Seek (O(1)).  A negative position plays silence up to the clip start. */
+    void setPositionSeconds(double seconds);
+    double getPositionSeconds() const;
+
+    /** Start (or restart after a non-looping clip ended).  Keeps the position. */
+    void start() { playing = true; }
+
+    /** False once a non-looping clip has played to the end of its play length. */
+    bool isPlaying() const { return playing; }
+
+    juce::int64 getTotalLength() const { return playLength; }
+
+    /** Write numSamples into dest (replacing what is there) and advance. */
+    void render(juce::AudioBuffer<float>& dest, int startSample, int numSamples);
+
+    /** Advance by numSamples output samples without producing audio. */
+    void advance(int numSamples);
+
+private:
+    //==============================================================================
+    // Output samples rendered per interpolation pass (sizes the scratch buffers).
+    static constexpr int chunkSize = 256;
+    // Highest buffer/output rate ratio interpolated in one pass (e.g. 192k -> 24k).
+    static constexpr int maxRatio = 8;
+
+    void wrapPosition();
+    void renderData(juce::AudioBuffer<float>& dest, int destStart, int numOut);
+
+    SharedSampleBuffer::Ptr buffer;
+    const juce::int64 playLength;
+    const juce::int64 dataEnd;      // min(data length, playLength)
+    const int numSourceChannels;
+
+    double position = 0.0;          // buffer samples, may be fractional
+    double ratio = 1.0;             // buffer samples per output sample
+    bool looping = false;
+    bool playing = true;
+
+    // Interpolation scratch: the source span for a pass (plus one sample for
+    // the loop seam), and per output sample the span index and fraction.
+    juce::AudioBuffer<float> span;
+    std::vector<int> spanIndex;
+    std::vector<float> fraction;
+    std::vector<float> left;
+    std::vector<float> right;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleVoice)
+};
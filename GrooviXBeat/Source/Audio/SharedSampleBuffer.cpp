@@ -0,0 +1,226 @@
+/*
+    SharedSampleBuffer - Immutable, reference-counted decoded audio
+*/
+
+#include "SharedSampleBuffer.h"
+
+namespace
+{
+    using FloatPointer      = juce::AudioData::Pointer<juce::AudioData::Float32, juce::AudioData::NativeEndian, juce::AudioData::NonInterleaved, juce::AudioData::NonConst>;
+    using ConstFloatPointer = juce::AudioData::Pointer<juce::AudioData::Float32, juce::AudioData::NativeEndian, juce::AudioData::NonInterleaved, juce::AudioData::Const>;
+    using Int16Pointer      = juce::AudioData::Pointer<juce::AudioData::Int16, juce::AudioData::LittleEndian, juce::AudioData::NonInterleaved, juce::AudioData::NonConst>;
+    using ConstInt16Pointer = juce::AudioData::Pointer<juce::AudioData::Int16, juce::AudioData::LittleEndian, juce::AudioData::NonInterleaved, juce::AudioData::Const>;
+    using Int24Pointer      = juce::AudioData::Pointer<juce::AudioData::Int24, juce::AudioData::LittleEndian, juce::AudioData::NonInterleaved, juce::AudioData::NonConst>;
+    using ConstInt24Pointer = juce::AudioData::Pointer<juce::AudioData::Int24, juce::AudioData::LittleEndian, juce::AudioData::NonInterleaved, juce::AudioData::Const>;
+
+    int getBytesPerSample(SharedSampleBuffer::Storage storage)
+    {
+        switch (storage)
+        {
+            case SharedSampleBuffer::Storage::int16: return 2;
+            case SharedSampleBuffer::Storage::int24: return 3;
+            case SharedSampleBuffer::Storage::float32:
+            default: return (int)sizeof(float);
+        }
+    }
+}
+
+//==============================================================================
+SharedSampleBuffer::SharedSampleBuffer(juce::AudioBuffer<float>&& decodedData,
+                                       double dataSampleRate,
+                                       const juce::String& sourcePath,
+                                       Storage dataStorage)
+    : buffer(std::move(decodedData)),
+      sampleRate(dataSampleRate),
+      filePath(sourcePath),
+      storage(dataStorage),
+      numChannels(buffer.getNumChannels()),
+      numSamples(buffer.getNumSamples())
+{
+    if (storage == Storage::float32)
+        return;
+
+    // Pack each channel, then drop the float data.
+    const int bytesPerSample = getBytesPerSample(storage);
+    packed.resize((size_t)numChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& block = packed[(size_t)ch];
+        block.setSize((size_t)numSamples * (size_t)bytesPerSample);
+
+        ConstFloatPointer src(buffer.getReadPointer(ch));
+
+        if (storage == Storage::int16)
+            Int16Pointer(block.getData()).convertSamples(src, numSamples);
+        else
+            Int24Pointer(block.getData()).convertSamples(src, numSamples);
+    }
+
+    buffer.setSize(0, 0);
+}
+
+juce::String SharedSampleBuffer::getStorageName(Storage storageType)
+{
+    switch (storageType)
+    {
+        case Storage::int16: return "int16";
+        case Storage::int24: return "int24";
+        case Storage::float32:
+        default: return "float32";
+    }
+}
+
+double SharedSampleBuffer::getLengthInSeconds() const
+{
+    if (sampleRate > 0)
+        return (double)numSamples / sampleRate;
+    return 0.0;
+}
+
+void SharedSampleBuffer::readSamples(juce::AudioBuffer<float>& dest, int destChannel, int destStartSample,
+                                     int srcChannel, int srcStartSample, int numSamplesToRead) const
+{
+    if (numSamplesToRead <= 0)
+        return;
+
+    jassert(srcStartSample >= 0 && srcStartSample + numSamplesToRead <= numSamples);
+
+    if (storage == Storage::float32)
+    {
+        dest.copyFrom(destChannel, destStartSample, buffer, srcChannel, srcStartSample, numSamplesToRead);
+        return;
+    }
+
+    const auto* src = static_cast<const char*>(packed[(size_t)srcChannel].getData())
+                    + (size_t)srcStartSample * (size_t)getBytesPerSample(storage);
+    FloatPointer out(dest.getWritePointer(destChannel, destStartSample));
+
+    if (storage == Storage::int16)
+        out.convertSamples(ConstInt16Pointer(src), numSamplesToRead);
+    else
+        out.convertSamples(ConstInt24Pointer(src), numSamplesToRead);
+}
+
+juce::AudioBuffer<float> SharedSampleBuffer::toFloatBuffer() const
+{
+    if (storage == Storage::float32)
+        return buffer;
+
+    juce::AudioBuffer<float> result(numChannels, numSamples);
+    for (int ch = 0; ch < numChannels; ++ch)
+        readSamples(result, ch, 0, ch, 0, numSamples);
+    return result;
+}
+
+size_t SharedSampleBuffer::getSizeInBytes() const
+{
+    return (size_t)numChannels * (size_t)numSamples * (size_t)getBytesPerSample(storage);
+}
+
+//==============================================================================
+SharedSampleBufferSource::SharedSampleBufferSource(SharedSampleBuffer::Ptr sourceBuffer,
+                                                   juce::int64 playLengthSamples)
+    : buffer(std::move(sourceBuffer)),
+      playLength(playLengthSamples >= 0 ? playLengthSamples
+                                        : (buffer != nullptr ? buffer->getNumSamples() : 0))
+{
+}
+
+void SharedSampleBufferSource::prepareToPlay(int, double)
+{
+}
+
+void SharedSampleBufferSource::releaseResources()
+{
+}
+
+void SharedSampleBufferSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (info.numSamples <= 0)
+        return;
+
+    const int dataSamples = buffer != nullptr ? buffer->getNumSamples() : 0;
+    const int srcChannels = buffer != nullptr ? buffer->getNumChannels() : 0;
+
+    if (playLength <= 0 || srcChannels == 0)
+    {
+        info.clearActiveBufferRegion();
+        return;
+    }
+
+    const int destChannels = info.buffer->getNumChannels();
+    const juce::int64 dataEnd = std::min((juce::int64)dataSamples, playLength);
+
+    int destPos   = info.startSample;
+    int remaining = info.numSamples;
+    juce::int64 pos = nextPlayPos;
+
+    while (remaining > 0)
+    {
+        if (pos < 0)
+        {
+            // Negative read position (pre-roll): silence up to sample 0.
+            const int silent = (int)std::min((juce::int64)remaining, -pos);
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->clear(ch, destPos, silent);
+
+            destPos   += silent;
+            remaining -= silent;
+            pos       += silent;
+            continue;
+        }
+
+        if (pos >= playLength)
+        {
+            if (!looping)
+                break;
+            pos %= playLength;
+        }
+
+        int chunk;
+
+        if (pos >= dataEnd)
+        {
+            // Padding past the end of the data, up to the play length.
+            chunk = (int)std::min((juce::int64)remaining, playLength - pos);
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->clear(ch, destPos, chunk);
+        }
+        else
+        {
+            chunk = (int)std::min((juce::int64)remaining, dataEnd - pos);
+            // Integer storage is converted here, one block just ahead of the play position.
+            for (int ch = 0; ch < destChannels; ++ch)
+                buffer->readSamples(*info.buffer, ch, destPos, std::min(ch, srcChannels - 1), (int)pos, chunk);
+        }
+
+        destPos   += chunk;
+        remaining -= chunk;
+        pos       += chunk;
+    }
+
+    // Past the end of a non-looping buffer: output silence.
+    if (remaining > 0)
+        for (int ch = 0; ch < destChannels; ++ch)
+            info.buffer->clear(ch, destPos, remaining);
+
+    nextPlayPos = looping ? pos : nextPlayPos + info.numSamples;
+}
+
+void SharedSampleBufferSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextPlayPos = newPosition;
+}
+
+juce::int64 SharedSampleBufferSource::getNextReadPosition() const
+{
+    if (looping && playLength > 0)
+        return nextPlayPos % playLength;
+    return nextPlayPos;
+}
+
+juce::int64 SharedSampleBufferSource::getTotalLength() const
+{
+    return playLength;
+}
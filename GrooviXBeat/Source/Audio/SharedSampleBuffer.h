@@ -0,0 +1,130 @@
+/*
+    SharedSampleBuffer - Immutable, reference-counted decoded audio
+
+    Provides:
+    - A decoded AudioBuffer that is never modified after construction
+    - Cheap sharing between the sample cache and any number of players
+    - Optional packed int16 / int24 storage, decoded block by block on read
+    - SharedSampleBufferSource: a PositionableAudioSource that reads the
+      shared data directly (no re-encode, no per-launch copy), optionally
+      through a play length that truncates or silence-pads it to a loop
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class SharedSampleBuffer : public juce::ReferenceCountedObject
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SharedSampleBuffer>;
+
+    /**
+     * How the samples are held in memory.  The integer formats are packed
+     * little-endian PCM (half / three quarters of the float size) and are
+     * converted back to float a block at a time as they are read.
+     */
+    enum class Storage
+    {
+        float32,
+        int16,
+        int24
+    };
+
+    /**
+     * Takes ownership of already-decoded audio. The data is immutable from here on.
+     * With an integer storage the float data is packed and then released.
+     */
+    SharedSampleBuffer(juce::AudioBuffer<float>&& decodedData,
+                       double dataSampleRate,
+                       const juce::String& sourcePath,
+                       Storage dataStorage = Storage::float32);
+
+    /** The float data.  Only valid for Storage::float32; use readSamples() otherwise. */
+    const juce::AudioBuffer<float>& getBuffer() const { jassert(storage == Storage::float32); return buffer; }
+    double getSampleRate() const { return sampleRate; }
+    const juce::String& getFilePath() const { return filePath; }
+
+    Storage getStorage() const { return storage; }
+    static juce::String getStorageName(Storage storageType);
+
+    int getNumChannels() const { return numChannels; }
+    int getNumSamples() const { return numSamples; }
+    double getLengthInSeconds() const;
+
+    /**
+     * Convert numSamples from srcChannel, starting at srcStartSample, into
+     * dest.  Works for every storage; real-time safe (no allocation).
+     */
+    void readSamples(juce::AudioBuffer<float>& dest, int destChannel, int destStartSample,
+                     int srcChannel, int srcStartSample, int numSamplesToRead) const;
+
+    /** Whole buffer as float (a copy for integer storage).  Not for the audio thread. */
+    juce::AudioBuffer<float> toFloatBuffer() const;
+
+    /** Approximate heap footprint of the sample data in bytes. */
+    size_t getSizeInBytes() const;
+
+private:
+    juce::AudioBuffer<float> buffer;          // Storage::float32
+    std::vector<juce::MemoryBlock> packed;    // integer storage, one block per channel
+    const double sampleRate;
+    const juce::String filePath;
+    const Storage storage;
+    int numChannels = 0;
+    int numSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedSampleBuffer)
+};
+
+//==============================================================================
+/**
+ * Plays a SharedSampleBuffer through the normal AudioSource chain
+ * (e.g. as the source of an AudioTransportSource).
+ *
+ * Holds a reference to the buffer, so the data stays alive for as long as
+ * this source exists even if the cache drops its own reference.
+ * Mono data is duplicated to every output channel, matching the behaviour
+ * of AudioFormatReaderSource.
+ *
+ * The play length is a view over the shared data: a shorter length stops
+ * (or wraps) early, a longer one plays silence after the data ends.  This
+ * fits a clip to its loop length without copying the buffer.
+ */
+class SharedSampleBufferSource : public juce::PositionableAudioSource
+{
+public:
+    /**
+     * @param sourceBuffer       Shared data to play.
+     * @param playLengthSamples  Length of the view in buffer samples; a negative
+     *                           value plays the whole buffer.
+     */
+    explicit SharedSampleBufferSource(SharedSampleBuffer::Ptr sourceBuffer,
+                                      juce::int64 playLengthSamples = -1);
+    ~SharedSampleBufferSource() override = default;
+
+    SharedSampleBuffer* getSharedBuffer() const { return buffer.get(); }
+
+    //==============================================================================
+    // AudioSource
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override;
+
+    //==============================================================================
+    // PositionableAudioSource
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override;
+    bool isLooping() const override { return looping; }
+    void setLooping(bool shouldLoop) override { looping = shouldLoop; }
+
+private:
+    SharedSampleBuffer::Ptr buffer;
+    const juce::int64 playLength;
+    juce::int64 nextPlayPos = 0;
+    bool looping = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedSampleBufferSource)
+};
@@ -0,0 +1,266 @@
+/*
+    StreamingSampleSource - Disk streaming with background read-ahead
+*/
+
+#include "StreamingSampleSource.h"
+
+//==============================================================================
+StreamingSampleSource::StreamingSampleSource(juce::AudioFormatReader* sourceReader,
+                                             juce::TimeSliceThread& thread,
+                                             int readAheadSamples,
+                                             int headSamples,
+                                             std::atomic<juce::uint64>& underrunCounter)
+    : reader(sourceReader),
+      backgroundThread(thread),
+      underruns(underrunCounter),
+      totalLength(sourceReader != nullptr ? sourceReader->lengthInSamples : 0),
+      numChannels(sourceReader != nullptr ? juce::jmax(1, (int)sourceReader->numChannels) : 1),
+      ringCapacity(juce::jmax(readChunkSamples * 2, readAheadSamples)),
+      headCapacity(juce::jmax(0, headSamples))
+{
+}
+
+StreamingSampleSource::~StreamingSampleSource()
+{
+    // Waits for an in-progress useTimeSlice() to finish.
+    backgroundThread.removeTimeSliceClient(this);
+}
+
+void StreamingSampleSource::prime(juce::int64 headStartSample)
+{
+    headStart = juce::jlimit((juce::int64)0, totalLength, headStartSample);
+    const int headLength = (int)juce::jmin((juce::int64)headCapacity, totalLength - headStart);
+    headEnd = headStart + headLength;
+
+    head.setSize(numChannels, juce::jmax(1, headLength));
+    head.clear();
+    if (headLength > 0)
+        reader->read(&head, 0, headLength, headStart, true, true);
+
+    ring.setSize(numChannels, ringCapacity);
+    ring.clear();
+
+    // Start playback at the head; the ring continues where the head ends.
+    nextPlayPos = headStart;
+    readPosition.store(headStart, std::memory_order_relaxed);
+    validStart.store(headEnd, std::memory_order_relaxed);
+    validEnd.store(headEnd, std::memory_order_relaxed);
+
+    // First window synchronously so playback can start without waiting.
+    const int firstWindow = juce::jmin(ringCapacity, readChunkSamples * 4);
+    fillRing(headEnd, firstWindow);
+    validEnd.store(headEnd + firstWindow, std::memory_order_relaxed);
+
+    backgroundThread.addTimeSliceClient(this);
+}
+
+//==============================================================================
+void StreamingSampleSource::prepareToPlay(int, double)
+{
+}
+
+void StreamingSampleSource::releaseResources()
+{
+}
+
+void StreamingSampleSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (info.numSamples <= 0)
+        return;
+
+    const bool isLoopingNow = looping.load(std::memory_order_relaxed);
+    const int destChannels = info.buffer->getNumChannels();
+
+    // The ring is only usable once the streaming thread has caught up with our
+    // latest seek; until then everything outside the head is an underrun.
+    juce::int64 ringStart = 0, ringEnd = 0;
+    if (bufferGeneration.load(std::memory_order_acquire) == audioGeneration)
+    {
+        ringStart = validStart.load(std::memory_order_acquire);
+        ringEnd   = validEnd.load(std::memory_order_acquire);
+    }
+
+    int destPos   = info.startSample;
+    int remaining = info.numSamples;
+    juce::int64 pos = nextPlayPos;
+    bool underrun = false;
+
+    while (remaining > 0)
+    {
+        juce::int64 filePos = pos;
+        if (isLoopingNow && totalLength > 0 && pos >= 0)
+            filePos = pos % totalLength;
+
+        int chunk = remaining;
+
+        if (pos < 0 || totalLength <= 0 || (!isLoopingNow && filePos >= totalLength))
+        {
+            // Pre-roll or past the end of a non-looping file: silence.
+            if (pos < 0)
+                chunk = (int)juce::jmin((juce::int64)remaining, -pos);
+
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->clear(ch, destPos, chunk);
+        }
+        else if (filePos >= headStart && filePos < headEnd)
+        {
+            chunk = (int)juce::jmin((juce::int64)remaining, headEnd - filePos);
+            const int headOffset = (int)(filePos - headStart);
+
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->copyFrom(ch, destPos, head, juce::jmin(ch, numChannels - 1), headOffset, chunk);
+        }
+        else if (pos >= ringStart && pos < ringEnd)
+        {
+            const int slot = (int)(pos % ringCapacity);
+            chunk = (int)juce::jmin((juce::int64)remaining, ringEnd - pos);
+            chunk = juce::jmin(chunk, ringCapacity - slot);
+
+            // Stop at the head so a native loop wrap is served from it.
+            if (isLoopingNow && filePos < headStart)
+                chunk = (int)juce::jmin((juce::int64)chunk, headStart - filePos);
+
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->copyFrom(ch, destPos, ring, juce::jmin(ch, numChannels - 1), slot, chunk);
+        }
+        else
+        {
+            underrun = true;
+            for (int ch = 0; ch < destChannels; ++ch)
+                info.buffer->clear(ch, destPos, chunk);
+        }
+
+        destPos   += chunk;
+        remaining -= chunk;
+        pos       += chunk;
+    }
+
+    if (underrun)
+        underruns.fetch_add(1, std::memory_order_relaxed);
+
+    nextPlayPos = pos;
+    readPosition.store(pos, std::memory_order_release);
+}
+
+void StreamingSampleSource::setNextReadPosition(juce::int64 newPosition)
+{
+    nextPlayPos = newPosition;
+    requestFill(newPosition);
+}
+
+juce::int64 StreamingSampleSource::getNextReadPosition() const
+{
+    if (looping.load(std::memory_order_relaxed) && totalLength > 0 && nextPlayPos >= 0)
+        return nextPlayPos % totalLength;
+    return nextPlayPos;
+}
+
+void StreamingSampleSource::setLooping(bool shouldLoop)
+{
+    if (looping.exchange(shouldLoop, std::memory_order_relaxed) == shouldLoop)
+        return;
+
+    // Data past the end of the file differs between the modes (silence vs the
+    // wrapped start), so refill from here.
+    requestFill(nextPlayPos, true);
+}
+
+//==============================================================================
+juce::int64 StreamingSampleSource::getFillStartFor(juce::int64 streamPos) const
+{
+    streamPos = juce::jmax((juce::int64)0, streamPos);
+
+    juce::int64 filePos = streamPos;
+    if (looping.load(std::memory_order_relaxed) && totalLength > 0)
+        filePos = streamPos % totalLength;
+
+    if (filePos >= headStart && filePos < headEnd)
+        return streamPos + (headEnd - filePos);
+
+    return streamPos;
+}
+
+void StreamingSampleSource::requestFill(juce::int64 streamPos, bool forceRefill)
+{
+    const auto fillStart = getFillStartFor(streamPos);
+    const auto consumed  = readPosition.load(std::memory_order_relaxed);
+
+    // A forward seek inside what is already buffered needs no refill.  A
+    // backwards seek always does: the streaming thread may be overwriting
+    // the slots behind the old read position.
+    if (!forceRefill
+        && bufferGeneration.load(std::memory_order_acquire) == audioGeneration
+        && streamPos >= consumed
+        && fillStart >= validStart.load(std::memory_order_acquire)
+        && fillStart <= validEnd.load(std::memory_order_acquire))
+    {
+        readPosition.store(streamPos, std::memory_order_release);
+        return;
+    }
+
+    readPosition.store(streamPos, std::memory_order_release);
+    requestedFillStart.store(fillStart, std::memory_order_relaxed);
+    requestedGeneration.store(++audioGeneration, std::memory_order_release);
+}
+
+void StreamingSampleSource::fillRing(juce::int64 streamStart, int numSamples)
+{
+    const bool isLoopingNow = looping.load(std::memory_order_relaxed);
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        const juce::int64 pos = streamStart + done;
+        const int slot = (int)(pos % ringCapacity);
+        int chunk = juce::jmin(numSamples - done, ringCapacity - slot);
+
+        juce::int64 filePos = pos;
+        if (isLoopingNow && totalLength > 0)
+            filePos = pos % totalLength;
+
+        if (pos < 0 || filePos >= totalLength)
+        {
+            if (pos < 0)
+                chunk = (int)juce::jmin((juce::int64)chunk, -pos);
+            ring.clear(slot, chunk);
+        }
+        else
+        {
+            chunk = (int)juce::jmin((juce::int64)chunk, totalLength - filePos);
+            reader->read(&ring, slot, chunk, filePos, true, true);
+        }
+
+        done += chunk;
+    }
+}
+
+int StreamingSampleSource::useTimeSlice()
+{
+    // Pick up a seek from the audio thread: publish an empty range for the new
+    // generation before any data, so stale samples are never read as new ones.
+    const auto requested = requestedGeneration.load(std::memory_order_acquire);
+    if (requested != bufferGeneration.load(std::memory_order_relaxed))
+    {
+        const auto start = requestedFillStart.load(std::memory_order_relaxed);
+        validStart.store(start, std::memory_order_relaxed);
+        validEnd.store(start, std::memory_order_relaxed);
+        bufferGeneration.store(requested, std::memory_order_release);
+    }
+
+    const auto start    = validStart.load(std::memory_order_relaxed);
+    const auto end      = validEnd.load(std::memory_order_relaxed);
+    const auto consumed = juce::jmax(readPosition.load(std::memory_order_acquire), start);
+    const auto space    = consumed + ringCapacity - end;
+
+    if (space < readChunkSamples)
+        return 2;  // ring is full enough; check again shortly for seeks
+
+    const int chunk = (int)juce::jmin(space, (juce::int64)readChunkSamples);
+    fillRing(end, chunk);
+
+    // Slots older than one ring behind the new end are gone.
+    validStart.store(juce::jmax(start, end + chunk - ringCapacity), std::memory_order_release);
+    validEnd.store(end + chunk, std::memory_order_release);
+
+    return (space - chunk >= readChunkSamples) ? 0 : 2;
+}
@@ -0,0 +1,134 @@
+/*
+    StreamingSampleSource - Disk streaming with background read-ahead
+
+    Provides:
+    - SampleStreamingThread: one TimeSliceThread shared by every streaming
+      source in the process (via juce::SharedResourcePointer)
+    - StreamingSampleSource: a PositionableAudioSource that decodes on that
+      thread into a read-ahead ring, so the audio thread only copies memory
+    - A pinned "loop head" (the first part of the loop region, read once) so
+      a beat-loop wrap seeks into RAM while the ring refills behind it
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Background thread that all StreamingSampleSources read on. */
+class SampleStreamingThread : public juce::TimeSliceThread
+{
+public:
+    SampleStreamingThread() : juce::TimeSliceThread("Sample Streaming")
+    {
+        startThread(juce::Thread::Priority::high);
+    }
+
+    ~SampleStreamingThread() override
+    {
+        stopThread(2000);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStreamingThread)
+};
+
+//==============================================================================
+/**
+ * Streams an AudioFormatReader through a fixed-size read-ahead ring.
+ *
+ * Threads:
+ * - prime() runs on the message thread before the source is handed to the
+ *   audio thread; it reads the loop head and the first ring window.
+ * - getNextAudioBlock()/setNextReadPosition()/setLooping() run on the audio
+ *   thread and never block, allocate or touch the reader.
+ * - useTimeSlice() runs on the streaming thread and is the only reader user
+ *   after prime().
+ *
+ * If the ring has not caught up after a seek outside the loop head, the
+ * missing samples are output as silence and counted as an underrun.
+ */
+class StreamingSampleSource : public juce::PositionableAudioSource,
+                              private juce::TimeSliceClient
+{
+public:
+    /**
+     * @param sourceReader      Reader to stream from (takes ownership).
+     * @param thread            Thread to decode on; must outlive this source.
+     * @param readAheadSamples  Ring capacity in source samples.
+     * @param headSamples       Length of the pinned loop head in source samples.
+     * @param underrunCounter   Incremented on the audio thread for every block
+     *                          that had to output silence; must outlive this source.
+     */
+    StreamingSampleSource(juce::AudioFormatReader* sourceReader,
+                          juce::TimeSliceThread& thread,
+                          int readAheadSamples,
+                          int headSamples,
+                          std::atomic<juce::uint64>& underrunCounter);
+    ~StreamingSampleSource() override;
+
+    /**
+     * Read the loop head starting at headStartSample plus the first read-ahead
+     * window, then start streaming.  Message thread; call once, before the
+     * source is used for playback.
+     */
+    void prime(juce::int64 headStartSample);
+
+    //==============================================================================
+    // AudioSource
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override;
+
+    //==============================================================================
+    // PositionableAudioSource
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override { return totalLength; }
+    bool isLooping() const override { return looping.load(std::memory_order_relaxed); }
+    void setLooping(bool shouldLoop) override;
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+
+    // Where the ring should start filling for a read at streamPos: right after
+    // the loop head if streamPos lands inside it, otherwise streamPos itself.
+    juce::int64 getFillStartFor(juce::int64 streamPos) const;
+    void requestFill(juce::int64 streamPos, bool forceRefill = false);
+    void fillRing(juce::int64 streamStart, int numSamples);
+
+    static constexpr int readChunkSamples = 8192;
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::TimeSliceThread& backgroundThread;
+    std::atomic<juce::uint64>& underruns;
+
+    const juce::int64 totalLength;
+    const int numChannels;
+    const int ringCapacity;
+    const int headCapacity;
+
+    // Loop head — immutable after prime()
+    juce::AudioBuffer<float> head;
+    juce::int64 headStart = 0;
+    juce::int64 headEnd = 0;
+
+    // Read-ahead ring, indexed by (stream position % ringCapacity).  Stream
+    // positions keep increasing across native loop wraps.
+    juce::AudioBuffer<float> ring;
+    std::atomic<juce::int64> validStart { 0 };    // written by the streaming thread
+    std::atomic<juce::int64> validEnd { 0 };
+    std::atomic<juce::uint32> bufferGeneration { 0 };
+
+    // Audio thread -> streaming thread
+    std::atomic<juce::int64> readPosition { 0 };  // everything before this has been consumed
+    std::atomic<juce::int64> requestedFillStart { 0 };
+    std::atomic<juce::uint32> requestedGeneration { 0 };
+    std::atomic<bool> looping { false };
+
+    // Audio thread
+    juce::int64 nextPlayPos = 0;
+    juce::uint32 audioGeneration = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamingSampleSource)
+};
@@ -0,0 +1,336 @@
+/*
+    TempoStretchSource - Real-time WSOLA time stretch for sample playback
+*/
+
+#include "TempoStretchSource.h"
+#include <cmath>
+#include <cstring>
+
+//==============================================================================
+TempoStretchSource::TempoStretchSource(std::unique_ptr<juce::PositionableAudioSource> inputSource,
+                                       int channels)
+    : input(std::move(inputSource)),
+      numChannels(juce::jmax(1, channels))
+{
+    jassert(input != nullptr);
+
+    // Hann window, as in SampleDSP::timeStretch
+    window.resize((size_t)frameSize);
+    const double twoPiOverNm1 = 2.0 * juce::MathConstants<double>::pi / (frameSize - 1);
+    for (int i = 0; i < frameSize; ++i)
+        window[(size_t)i] = static_cast<float>(0.5 * (1.0 - std::cos(twoPiOverNm1 * i)));
+
+    // Worst case span needed for one hop: the frame plus the search range on
+    // both sides, plus how far the template can trail the nominal position
+    // at maximum speed.  Everything else is discarded as the hops advance.
+    const int inputCapacity = frameSize + 4 * searchRadius + corrLen
+                            + 2 * (int)std::ceil(hopSize * maxSpeed);
+
+    inputBuffer.setSize(numChannels, inputCapacity);
+    overlapAdd.setSize(numChannels, frameSize);
+    overlapNorm.resize((size_t)frameSize);
+    hopOutput.setSize(numChannels, hopSize);
+
+    resetAt(0);
+}
+
+TempoStretchSource::~TempoStretchSource()
+{
+}
+
+void TempoStretchSource::setSpeed(double newSpeed)
+{
+    speed = juce::jlimit(minSpeed, maxSpeed, newSpeed);
+}
+
+void TempoStretchSource::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    // No seek either way: the input just carries on from where it was read to,
+    // so a streaming input keeps its read-ahead.
+    enabled = shouldBeEnabled;
+
+    if (enabled)
+    {
+        // Start the stretch at the first input sample not yet played.
+        if (drainPos < inputStart + inputFilled)
+            restartStretchAt(drainPos);
+        else
+            restartStretchAt(input->getNextReadPosition());
+    }
+    else
+    {
+        // Play out the input already buffered from the current output position.
+        drainPos = juce::jlimit(inputStart, inputStart + inputFilled, (juce::int64)std::floor(readPos));
+    }
+}
+
+//==============================================================================
+void TempoStretchSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void TempoStretchSource::releaseResources()
+{
+    input->releaseResources();
+}
+
+void TempoStretchSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+    if (!enabled)
+    {
+        playThrough(info);
+        return;
+    }
+
+    const int destChannels = info.buffer->getNumChannels();
+    int destPos   = info.startSample;
+    int remaining = info.numSamples;
+
+    while (remaining > 0)
+    {
+        if (hopReadPos >= hopSize)
+            renderNextHop();
+
+        const int chunk = juce::jmin(remaining, hopSize - hopReadPos);
+
+        for (int ch = 0; ch < destChannels; ++ch)
+            info.buffer->copyFrom(ch, destPos, hopOutput, juce::jmin(ch, numChannels - 1), hopReadPos, chunk);
+
+        hopReadPos += chunk;
+        destPos    += chunk;
+        remaining  -= chunk;
+        readPos    += chunk * speed;
+    }
+}
+
+//==============================================================================
+void TempoStretchSource::setNextReadPosition(juce::int64 newPosition)
+{
+    if (newPosition == getNextReadPosition())
+        return;
+
+    if (enabled)
+    {
+        resetAt(newPosition);
+    }
+    else
+    {
+        inputFilled = 0;
+        drainPos = inputStart;
+        input->setNextReadPosition(newPosition);
+    }
+}
+
+juce::int64 TempoStretchSource::getNextReadPosition() const
+{
+    if (!enabled && drainPos >= inputStart + inputFilled)
+        return input->getNextReadPosition();
+
+    auto position = enabled ? (juce::int64)std::floor(readPos) : drainPos;
+    const auto total = input->getTotalLength();
+
+    if (input->isLooping() && total > 0 && position >= 0)
+        position %= total;
+
+    return position;
+}
+
+//==============================================================================
+void TempoStretchSource::resetAt(juce::int64 inputPosition)
+{
+    if (input->getNextReadPosition() != inputPosition)
+        input->setNextReadPosition(inputPosition);
+
+    inputStart  = inputPosition;
+    inputFilled = 0;
+    drainPos    = inputPosition;
+
+    restartStretchAt(inputPosition);
+}
+
+void TempoStretchSource::restartStretchAt(juce::int64 inputPosition)
+{
+    // Keep whatever input is buffered from inputPosition on; the input's read
+    // position is still the end of it.
+    if (inputPosition < inputStart || inputPosition > inputStart + inputFilled)
+    {
+        inputStart  = inputPosition;
+        inputFilled = 0;
+    }
+
+    discardInputBefore(inputPosition);
+
+    overlapAdd.clear();
+    std::fill(overlapNorm.begin(), overlapNorm.end(), 0.0f);
+    hopReadPos = hopSize;
+
+    analysisPos      = (double)inputPosition;
+    readPos          = (double)inputPosition;
+    prevFrameStart   = inputPosition;
+    hasPreviousFrame = false;
+}
+
+void TempoStretchSource::playThrough(const juce::AudioSourceChannelInfo& info)
+{
+    // Input left over from the stretch first, then straight from the source.
+    const int buffered = (int)juce::jmin((juce::int64)info.numSamples,
+                                         inputStart + inputFilled - drainPos);
+
+    if (buffered > 0)
+    {
+        const int offset = (int)(drainPos - inputStart);
+
+        for (int ch = 0; ch < info.buffer->getNumChannels(); ++ch)
+            info.buffer->copyFrom(ch, info.startSample, inputBuffer, juce::jmin(ch, numChannels - 1), offset, buffered);
+
+        drainPos += buffered;
+    }
+
+    if (buffered < info.numSamples)
+    {
+        juce::AudioSourceChannelInfo rest(info.buffer, info.startSample + juce::jmax(0, buffered),
+                                          info.numSamples - juce::jmax(0, buffered));
+        input->getNextAudioBlock(rest);
+    }
+}
+
+void TempoStretchSource::discardInputBefore(juce::int64 start)
+{
+    const int drop = (int)juce::jlimit((juce::int64)0, (juce::int64)inputFilled, start - inputStart);
+    if (drop <= 0)
+        return;
+
+    const int keep = inputFilled - drop;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = inputBuffer.getWritePointer(ch);
+        std::memmove(data, data + drop, (size_t)keep * sizeof(float));
+    }
+
+    inputFilled = keep;
+    inputStart += drop;
+}
+
+void TempoStretchSource::ensureInput(juce::int64 start, juce::int64 end)
+{
+    discardInputBefore(start);
+
+    const int capacity = inputBuffer.getNumSamples();
+
+    while (inputStart + inputFilled < end)
+    {
+        const int space = capacity - inputFilled;
+        if (space <= 0)
+        {
+            jassertfalse;  // capacity is sized for the worst case; should not happen
+            return;
+        }
+
+        const int toRead = (int)juce::jmin((juce::int64)space, end - (inputStart + inputFilled));
+        juce::AudioSourceChannelInfo readInfo(&inputBuffer, inputFilled, toRead);
+        input->getNextAudioBlock(readInfo);
+        inputFilled += toRead;
+
+        // Only matters if the request jumped past everything buffered.
+        discardInputBefore(start);
+    }
+}
+
+void TempoStretchSource::renderNextHop()
+{
+    const auto nominal       = (juce::int64)std::llround(analysisPos);
+    const auto templateStart = prevFrameStart + hopSize;   // natural continuation of the last frame
+    const bool unitSpeed     = speed == 1.0;
+
+    juce::int64 needStart = nominal - searchRadius;
+    juce::int64 needEnd   = nominal + searchRadius + frameSize;
+
+    if (hasPreviousFrame)
+    {
+        needStart = juce::jmin(needStart, templateStart);
+        needEnd   = juce::jmax(needEnd, templateStart + frameSize);
+    }
+
+    ensureInput(juce::jmax(inputStart, needStart), needEnd);
+
+    const auto bufferedEnd = inputStart + inputFilled;
+    juce::int64 frameStart = nominal;
+
+    if (hasPreviousFrame && unitSpeed)
+    {
+        // Exact reconstruction: no search, no drift beyond the lag already taken.
+        frameStart = templateStart;
+    }
+    else if (hasPreviousFrame)
+    {
+        // WSOLA: pick the candidate near the nominal position that best matches
+        // what would naturally have followed the previous frame.  Channel 0
+        // decides for all channels so stereo imaging is preserved.
+        const float* in0  = inputBuffer.getReadPointer(0);
+        const float* tmpl = in0 + (templateStart - inputStart);
+
+        double bestCorr = -1e30;
+        int bestDelta   = 0;
+
+        for (int delta = -searchRadius; delta <= searchRadius; ++delta)
+        {
+            const auto candStart = nominal + delta;
+            if (candStart < inputStart || candStart + frameSize > bufferedEnd)
+                continue;
+
+            const float* cand = in0 + (candStart - inputStart);
+            double corr = 0.0;
+            for (int i = 0; i < corrLen; ++i)
+                corr += tmpl[i] * cand[i];
+
+            if (corr > bestCorr)
+            {
+                bestCorr  = corr;
+                bestDelta = delta;
+            }
+        }
+
+        frameStart = nominal + bestDelta;
+    }
+
+    frameStart = juce::jlimit(inputStart, juce::jmax(inputStart, bufferedEnd - frameSize), frameStart);
+    const int frameOffset = (int)(frameStart - inputStart);
+    const int frameLength = juce::jmin(frameSize, inputFilled - frameOffset);
+
+    // Overlap-add the windowed frame.  overlapNorm accumulates the window (not
+    // its square), so dividing by it cancels the windowing exactly.
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::addWithMultiply(overlapAdd.getWritePointer(ch),
+                                                     inputBuffer.getReadPointer(ch, frameOffset),
+                                                     window.data(), frameLength);
+    juce::FloatVectorOperations::add(overlapNorm.data(), window.data(), frameLength);
+
+    // The first hop is now complete: normalise it out, then shift the accumulator.
+    // Where the window is zero (the first sample after a restart) the input is used as is.
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* acc = overlapAdd.getReadPointer(ch);
+        const float* frame = inputBuffer.getReadPointer(ch, frameOffset);
+        float* out = hopOutput.getWritePointer(ch);
+
+        for (int i = 0; i < hopSize; ++i)
+            out[i] = overlapNorm[(size_t)i] > 1e-6f ? acc[i] / overlapNorm[(size_t)i]
+                                                    : (!hasPreviousFrame && i < frameLength ? frame[i] : 0.0f);
+
+        float* accWrite = overlapAdd.getWritePointer(ch);
+        std::memmove(accWrite, accWrite + hopSize, (size_t)(frameSize - hopSize) * sizeof(float));
+        juce::FloatVectorOperations::clear(accWrite + (frameSize - hopSize), hopSize);
+    }
+
+    std::memmove(overlapNorm.data(), overlapNorm.data() + hopSize, (size_t)(frameSize - hopSize) * sizeof(float));
+    std::fill(overlapNorm.begin() + (frameSize - hopSize), overlapNorm.end(), 0.0f);
+
+    prevFrameStart   = frameStart;
+    hasPreviousFrame = true;
+    analysisPos     += hopSize * speed;
+    hopReadPos       = 0;
+}
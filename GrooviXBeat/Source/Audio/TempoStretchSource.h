@@ -0,0 +1,132 @@
+/*
+    TempoStretchSource - Real-time WSOLA time stretch for sample playback
+
+    Provides:
+    - A PositionableAudioSource that wraps another one (cached buffer or disk
+      stream) and plays it faster or slower without changing pitch
+    - The same WSOLA scheme as SampleDSP::timeStretch (Hann frames, 50 %
+      overlap, cross-correlation search), run one hop at a time
+    - A fixed cost per output hop, so the CPU per track is bounded whatever
+      the tempo
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+/**
+ * Streams its input through WSOLA at a speed set from the audio thread.
+ *
+ * Positions (setNextReadPosition / getNextReadPosition / getTotalLength) are
+ * in input samples, so the transport and the player's loop logic work exactly
+ * as they do without the stretch.  A seek restarts the overlap-add at the new
+ * position, so the first output sample after it is the input sample itself.
+ *
+ * At speed 1.0 each frame is the natural continuation of the previous one,
+ * which reconstructs the input exactly; the similarity search only runs when
+ * the speed differs.  When disabled, calls pass straight through to the input.
+ * Switching on or off never seeks the input (a streaming input would lose its
+ * read-ahead): input already buffered for the stretch is played out first.
+ *
+ * All buffers are allocated in the constructor; no method allocates, locks or
+ * does I/O (beyond what the input source itself does).
+ */
+class TempoStretchSource : public juce::PositionableAudioSource
+{
+public:
+    /** Speed limits: outside this range WSOLA artefacts get obvious. */
+    static constexpr double minSpeed = 0.5;
+    static constexpr double maxSpeed = 2.0;
+
+    /**
+     * @param inputSource  Source to stretch (takes ownership).
+     * @param numChannels  Channels to process (mono input is duplicated by the
+     *                     input source itself, as everywhere else).
+     */
+    TempoStretchSource(std::unique_ptr<juce::PositionableAudioSource> inputSource, int numChannels);
+    ~TempoStretchSource() override;
+
+    juce::PositionableAudioSource* getInputSource() const { return input.get(); }
+
+    /**
+     * Playback speed relative to the input (2.0 = twice as fast, e.g. the
+     * transport at 140 BPM for a clip made at 70).  Clamped to
+     * [minSpeed, maxSpeed].  Audio thread; takes effect from the next hop.
+     */
+    void setSpeed(double newSpeed);
+    double getSpeed() const { return speed; }
+
+    /**
+     * Turn the stretch on or off.  Audio thread; playback continues from the
+     * current position without seeking the input.
+     */
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled; }
+
+    //==============================================================================
+    // AudioSource
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& info) override;
+
+    //==============================================================================
+    // PositionableAudioSource
+    void setNextReadPosition(juce::int64 newPosition) override;
+    juce::int64 getNextReadPosition() const override;
+    juce::int64 getTotalLength() const override { return input->getTotalLength(); }
+    bool isLooping() const override { return input->isLooping(); }
+    void setLooping(bool shouldLoop) override { input->setLooping(shouldLoop); }
+
+private:
+    //==============================================================================
+    // Same parameters as SampleDSP::timeStretch: ~46 ms frames at 44.1 kHz.
+    static constexpr int frameSize    = 2048;
+    static constexpr int hopSize      = frameSize / 2;   // fixed output step
+    static constexpr int searchRadius = 128;             // ±samples to search
+    static constexpr int corrLen      = 256;             // samples used for cross-corr
+
+    // Seek: the input is repositioned only if it is not already there.
+    void resetAt(juce::int64 inputPosition);
+
+    // Restart the overlap-add at inputPosition, keeping buffered input from
+    // there on; the input itself is not touched.
+    void restartStretchAt(juce::int64 inputPosition);
+
+    // Disabled: plays out buffered input from drainPos, then reads the input.
+    void playThrough(const juce::AudioSourceChannelInfo& info);
+    void renderNextHop();
+
+    // Make [start, end) of the input available in inputBuffer, reading the
+    // input sequentially and discarding what lies before start.
+    void ensureInput(juce::int64 start, juce::int64 end);
+    void discardInputBefore(juce::int64 start);
+
+    std::unique_ptr<juce::PositionableAudioSource> input;
+    const int numChannels;
+
+    bool enabled = false;
+    double speed = 1.0;
+
+    std::vector<float> window;
+
+    // Input window: sample i is input stream position inputStart + i.  Stream
+    // positions keep increasing across native loop wraps of the input.
+    juce::AudioBuffer<float> inputBuffer;
+    juce::int64 inputStart = 0;
+    int inputFilled = 0;
+
+    // Overlap-add accumulator for the frame being built, and the finished hop.
+    juce::AudioBuffer<float> overlapAdd;
+    std::vector<float> overlapNorm;
+    juce::AudioBuffer<float> hopOutput;
+    int hopReadPos = hopSize;
+
+    double analysisPos = 0.0;         // nominal input position of the next frame
+    juce::int64 prevFrameStart = 0;
+    bool hasPreviousFrame = false;
+    double readPos = 0.0;             // input position of the next output sample (approximate)
+    juce::int64 drainPos = 0;         // disabled: next buffered input sample to play
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TempoStretchSource)
+};
@@ -0,0 +1,80 @@
+/*
+    BenchMain - Entry point of the GrooviXBeatBench console target
+*/
+
+#include "Benchmarks.h"
+#include <cstdio>
+
+namespace
+{
+    struct Benchmark
+    {
+        const char* name;
+        void (*run)();
+    };
+
+    const Benchmark benchmarks[] =
+    {
+        { "cacheStorage",  Benchmarks::cacheStorage },
+        { "sampleVoice",   Benchmarks::sampleVoice },
+        { "timeStretch",   Benchmarks::timeStretch },
+        { "onsetAnalysis", Benchmarks::onsetAnalysis },
+    };
+
+    bool anyCheckFailed = false;
+
+    void printUsage()
+    {
+        std::printf("Usage: GrooviXBeatBench [all | <name>...]\nBenchmarks:\n");
+        for (const auto& benchmark : benchmarks)
+            std::printf("  %s\n", benchmark.name);
+    }
+}
+
+void Benchmarks::check(bool condition, const char* what)
+{
+    if (condition)
+        return;
+
+    std::printf("CHECK FAILED: %s\n", what);
+    anyCheckFailed = true;
+}
+
+int main(int argc, char* argv[])
+{
+    // The audio code uses thread pools and shared resources, which expect
+    // JUCE to be initialised.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray names;
+    for (int i = 1; i < argc; ++i)
+        names.add(argv[i]);
+
+    if (names.isEmpty() || names.contains("-h") || names.contains("--help"))
+    {
+        printUsage();
+        return names.isEmpty() ? 1 : 0;
+    }
+
+    const bool runAll = names.contains("all");
+    int numRun = 0;
+
+    for (const auto& benchmark : benchmarks)
+    {
+        if (!runAll && !names.contains(benchmark.name))
+            continue;
+
+        std::printf("== %s\n", benchmark.name);
+        benchmark.run();
+        std::fflush(stdout);
+        ++numRun;
+    }
+
+    if (numRun == 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    return anyCheckFailed ? 1 : 0;
+}
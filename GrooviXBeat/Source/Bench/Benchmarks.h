@@ -0,0 +1,50 @@
+/*
+    Benchmarks - Offline performance checks for the audio code
+
+    Provides:
+    - One function per benchmark, printing its results to stdout
+    - check() for results a benchmark also verifies (a failure sets the exit code)
+    - Built only into the GrooviXBeatBench console target, never the app
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Benchmarks
+{
+    /**
+     * Verify a result: if condition is false, print what failed and make
+     * GrooviXBeatBench exit with 1 once the benchmarks have run.
+     */
+    void check(bool condition, const char* what);
+
+    /**
+     * Compare the sample cache storage formats on a synthetic stereo clip:
+     * memory use, the cost of SharedSampleBufferSource::getNextAudioBlock
+     * (what the audio thread pays per block) and the error against float.
+     */
+    void cacheStorage();
+
+    /**
+     * Time one stereo clip through the transport chain and through
+     * SampleVoice: at the output rate, resampled (44.1 kHz clip on a 48 kHz
+     * device), and muted.
+     */
+    void sampleVoice();
+
+    /**
+     * Stretch 1, 5 and 10 minute stereo buffers at several ratios with the
+     * direct similarity search in one pass over the whole buffer, and with
+     * timeStretch(), single-threaded and on the DSP worker pool.  Checks that
+     * both match the single pass exactly (segments and all).  Takes minutes
+     * and close to 1 GB at the 10 minute length.
+     */
+    void timeStretch();
+
+    /**
+     * Analyze 1, 5 and 10 minute stereo buffers at 120 BPM and time the
+     * onset envelope, BPM and transient detection (one hit per beat).
+     */
+    void onsetAnalysis();
+}
@@ -0,0 +1,73 @@
+/*
+    CacheStorageBench - Sample cache storage formats: memory, read cost, error
+*/
+
+#include "Benchmarks.h"
+#include "../Audio/SharedSampleBuffer.h"
+#include <cstdio>
+
+void Benchmarks::cacheStorage()
+{
+    constexpr double seconds = 8.0;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    const int numSamples = juce::jmax(blockSize, (int)(seconds * sampleRate));
+
+    // Stereo test clip: a chord plus some noise, so nothing is trivially compressible
+    juce::AudioBuffer<float> clip(2, numSamples);
+    juce::Random random(1234);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* data = clip.getWritePointer(ch);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / sampleRate;
+            data[i] = (float)(0.3 * std::sin(juce::MathConstants<double>::twoPi * 220.0 * t)
+                            + 0.2 * std::sin(juce::MathConstants<double>::twoPi * (277.2 + ch) * t))
+                    + 0.1f * (random.nextFloat() - 0.5f);
+        }
+    }
+
+    // Play the clip through several times, as the audio thread would
+    const int numBlocks = 4 * numSamples / blockSize;
+    juce::AudioBuffer<float> output(2, blockSize);
+
+    std::printf("%-8s %10s %14s %12s\n", "storage", "MB", "us per block", "max error");
+
+    for (auto storage : { SharedSampleBuffer::Storage::float32,
+                          SharedSampleBuffer::Storage::int16,
+                          SharedSampleBuffer::Storage::int24 })
+    {
+        juce::AudioBuffer<float> copy(clip);
+        SharedSampleBuffer::Ptr shared = new SharedSampleBuffer(std::move(copy), sampleRate, {}, storage);
+
+        SharedSampleBufferSource source(shared);
+        source.setLooping(true);
+
+        float maxError = 0.0f;
+        juce::int64 ticks = 0;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            const auto position = source.getNextReadPosition();
+
+            juce::AudioSourceChannelInfo info(&output, 0, blockSize);
+            const auto start = juce::Time::getHighResolutionTicks();
+            source.getNextAudioBlock(info);
+            ticks += juce::Time::getHighResolutionTicks() - start;
+
+            // Quantisation error against the float original (first pass only)
+            if (position + blockSize <= numSamples && block * blockSize < numSamples)
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        maxError = juce::jmax(maxError, std::abs(output.getSample(ch, i) - clip.getSample(ch, (int)position + i)));
+        }
+
+        std::printf("%-8s %10.2f %14.3f %12.7f\n",
+                    SharedSampleBuffer::getStorageName(storage).toRawUTF8(),
+                    (double)shared->getSizeInBytes() / (1024.0 * 1024.0),
+                    juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / numBlocks,
+                    (double)maxError);
+    }
+}
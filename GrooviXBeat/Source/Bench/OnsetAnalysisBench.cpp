@@ -0,0 +1,53 @@
+/*
+    OnsetAnalysisBench - Onset envelope, BPM and transient detection timings
+*/
+
+#include "Benchmarks.h"
+#include "../Audio/SampleDSP.h"
+#include <cstdio>
+
+void Benchmarks::onsetAnalysis()
+{
+    constexpr double sampleRate = 44100.0;
+    const double lengthsMinutes[] = { 1.0, 5.0, 10.0 };
+
+    std::printf("%-5s %12s %14s %8s %16s %12s\n",
+                "min", "envelope ms", "BPM ms", "BPM", "transients ms", "transients");
+
+    for (double minutes : lengthsMinutes)
+    {
+        // Stereo test material: a decaying hit on every beat at 120 BPM over
+        // two tones and some noise.
+        const int numSamples = static_cast<int>(minutes * 60.0 * sampleRate);
+        juce::AudioBuffer<float> source(2, numSamples);
+        juce::Random random(7);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            float* data = source.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / sampleRate;
+                const double hit = std::exp(-30.0 * std::fmod(t, 0.5));
+                data[i] = static_cast<float>(0.5 * hit * std::sin(juce::MathConstants<double>::twoPi * 60.0 * t)
+                                             + 0.1 * std::sin(juce::MathConstants<double>::twoPi * (220.0 + ch) * t))
+                          + 0.05f * (random.nextFloat() - 0.5f);
+            }
+        }
+
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        const auto envelope = SampleDSP::analyzeOnsets(source, sampleRate);
+        const double analyzeMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        const double bpm = SampleDSP::detectBPM(envelope);
+        const double bpmMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        start = juce::Time::getMillisecondCounterHiRes();
+        const auto numTransients = SampleDSP::detectTransients(envelope).size();
+        const double transientsMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+        std::printf("%-5.0f %12.1f %14.1f %8.1f %16.1f %12d\n",
+                    minutes, analyzeMs, bpmMs, bpm, transientsMs, (int)numTransients);
+    }
+}
@@ -0,0 +1,102 @@
+/*
+    SampleVoiceBench - SampleVoice against the transport chain it replaces
+*/
+
+#include "Benchmarks.h"
+#include "../Audio/SampleVoice.h"
+#include "../Audio/TempoStretchSource.h"
+#include <cstdio>
+
+void Benchmarks::sampleVoice()
+{
+    constexpr double seconds = 8.0;
+    constexpr int blockSize = 512;
+    constexpr double outputRate = 48000.0;
+
+    // Stereo test clip: a chord plus some noise
+    auto makeClip = [](double rate)
+    {
+        const int numSamples = juce::jmax(blockSize, (int)(seconds * rate));
+        juce::AudioBuffer<float> clip(2, numSamples);
+        juce::Random random(1234);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            float* data = clip.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / rate;
+                data[i] = (float)(0.3 * std::sin(juce::MathConstants<double>::twoPi * 220.0 * t)
+                                + 0.2 * std::sin(juce::MathConstants<double>::twoPi * (277.2 + ch) * t))
+                        + 0.1f * (random.nextFloat() - 0.5f);
+            }
+        }
+
+        return SharedSampleBuffer::Ptr(new SharedSampleBuffer(std::move(clip), rate, {}));
+    };
+
+    const int numBlocks = juce::jmax(1, (int)(4.0 * seconds * outputRate) / blockSize);
+    juce::AudioBuffer<float> output(2, blockSize);
+
+    struct Case { const char* name; double clipRate; bool muted; };
+    const Case cases[] = { { "native",    outputRate, false },
+                           { "resampled", 44100.0,    false },
+                           { "muted",     outputRate, true  } };
+
+    std::printf("%-10s %22s %18s\n", "case", "transport us/block", "voice us/block");
+
+    for (const auto& c : cases)
+    {
+        auto shared = makeClip(c.clipRate);
+        double transportMicrosPerBlock = 0.0;
+        double voiceMicrosPerBlock = 0.0;
+
+        // The chain a player builds without the voice: transport (with a
+        // resampler if the rates differ) -> bypassed tempo stretch -> shared
+        // buffer source.
+        {
+            auto source = std::make_unique<TempoStretchSource>(std::make_unique<SharedSampleBufferSource>(shared), 2);
+            source->setLooping(true);
+
+            juce::AudioTransportSource transport;
+            transport.prepareToPlay(blockSize, outputRate);
+            transport.setSource(source.get(), 0, nullptr, c.clipRate != outputRate ? c.clipRate : 0.0, 2);
+            transport.start();
+
+            juce::int64 ticks = 0;
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                juce::AudioSourceChannelInfo info(&output, 0, blockSize);
+                const auto start = juce::Time::getHighResolutionTicks();
+                transport.getNextAudioBlock(info);
+                if (c.muted)
+                    output.clear();
+                ticks += juce::Time::getHighResolutionTicks() - start;
+            }
+
+            transport.setSource(nullptr);
+            transportMicrosPerBlock = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / numBlocks;
+        }
+
+        {
+            SampleVoice voice(shared);
+            voice.setOutputSampleRate(outputRate);
+            voice.setLooping(true);
+
+            juce::int64 ticks = 0;
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                const auto start = juce::Time::getHighResolutionTicks();
+                if (c.muted)
+                    voice.advance(blockSize);
+                else
+                    voice.render(output, 0, blockSize);
+                ticks += juce::Time::getHighResolutionTicks() - start;
+            }
+
+            voiceMicrosPerBlock = juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6 / numBlocks;
+        }
+
+        std::printf("%-10s %22.3f %18.3f\n", c.name, transportMicrosPerBlock, voiceMicrosPerBlock);
+    }
+}
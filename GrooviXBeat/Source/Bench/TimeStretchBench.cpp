@@ -0,0 +1,90 @@
+/*
+    TimeStretchBench - SampleDSP::timeStretch against a single-pass direct search
+*/
+
+#include "Benchmarks.h"
+#include "../Audio/SampleDSP.h"
+#include <cstdio>
+#include <limits>
+
+void Benchmarks::timeStretch()
+{
+    constexpr double sampleRate = 44100.0;
+    const double lengthsMinutes[] = { 1.0, 5.0, 10.0 };
+    const double ratios[] = { 0.8, 1.25, 1.5 };
+
+    // The segments, their seams and the FFT search must all leave the output
+    // exactly as one direct search over the whole buffer makes it.
+    constexpr float maxAllowedDifference = 0.0f;
+
+    auto maxDifference = [](const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        if (a.getNumChannels() != b.getNumChannels() || a.getNumSamples() != b.getNumSamples())
+            return std::numeric_limits<float>::infinity();
+
+        float difference = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+        {
+            const float* x = a.getReadPointer(ch);
+            const float* y = b.getReadPointer(ch);
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                difference = std::max(difference, std::abs(x[i] - y[i]));
+        }
+        return difference;
+    };
+
+    std::printf("%-5s %6s %16s %16s %14s %16s\n",
+                "min", "ratio", "single pass ms", "FFT 1 thread ms", "FFT pool ms", "max difference");
+
+    for (double minutes : lengthsMinutes)
+    {
+        // Stereo test material: a decaying hit every half second over two
+        // detuned tones and some noise, so the search has real peaks to find.
+        const int numSamples = static_cast<int>(minutes * 60.0 * sampleRate);
+        juce::AudioBuffer<float> source(2, numSamples);
+        juce::Random random(42);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            float* data = source.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double t = i / sampleRate;
+                const double hit = std::exp(-30.0 * std::fmod(t, 0.5));
+                data[i] = static_cast<float>(0.4 * hit * std::sin(juce::MathConstants<double>::twoPi * 60.0 * t)
+                                             + 0.2 * std::sin(juce::MathConstants<double>::twoPi * (220.0 + ch) * t)
+                                             + 0.1 * std::sin(juce::MathConstants<double>::twoPi * 331.0 * t))
+                          + 0.05f * (random.nextFloat() - 0.5f);
+            }
+        }
+
+        for (double ratio : ratios)
+        {
+            juce::AudioBuffer<float> reference, stretched;
+
+            // Reference: the direct search, one pass over every hop
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            SampleDSP::timeStretchForBenchmark(source, reference, ratio, true, false, false);
+            const double singlePassMs = juce::Time::getMillisecondCounterHiRes() - start;
+
+            start = juce::Time::getMillisecondCounterHiRes();
+            SampleDSP::timeStretchForBenchmark(source, stretched, ratio, false, false);
+            const double fftSingleThreadMs = juce::Time::getMillisecondCounterHiRes() - start;
+            const float singleThreadDifference = maxDifference(reference, stretched);
+
+            start = juce::Time::getMillisecondCounterHiRes();
+            SampleDSP::timeStretch(source, stretched, ratio);
+            const double fftMs = juce::Time::getMillisecondCounterHiRes() - start;
+            const float poolDifference = maxDifference(reference, stretched);
+
+            const float difference = std::max(singleThreadDifference, poolDifference);
+
+            std::printf("%-5.0f %6.2f %16.1f %16.1f %14.1f %16g\n",
+                        minutes, ratio, singlePassMs, fftSingleThreadMs, fftMs, (double)difference);
+            std::fflush(stdout);
+
+            Benchmarks::check(difference <= maxAllowedDifference,
+                              "timeStretch() differs from the single-pass direct search");
+        }
+    }
+}
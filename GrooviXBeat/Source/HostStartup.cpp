@@ -35,6 +35,8 @@
 #include <JuceHeader.h>
 #include "UI/MainHostWindow.h"
 #include "Plugins/InternalPlugins.h"
+#include "Audio/DecodeCache.h"
+#include "Audio/AnalysisCache.h"
 
 #if ! (JUCE_PLUGINHOST_VST || JUCE_PLUGINHOST_VST3 || JUCE_PLUGINHOST_AU)
  #error "If you're building the audio plugin host, you probably want to enable VST and/or AU support"
@@ -163,6 +165,12 @@ public:
         appProperties.reset (new ApplicationProperties());
         appProperties->setStorageParameters (options);
 
+        // Decoded MP3/OGG samples are kept next to the settings file between sessions
+        DecodeCache::setDirectory (appProperties->getUserSettings()->getFile().getSiblingFile ("DecodeCache"));
+
+        // Tempo, transients, peaks and loudness of analysed samples, likewise
+        AnalysisCache::setDirectory (appProperties->getUserSettings()->getFile().getSiblingFile ("AnalysisCache"));
+
         auto logoImage = juce::ImageCache::getFromMemory (BinaryData::GroovixLabsSplash_png,
                                                           BinaryData::GroovixLabsSplash_pngSize);
 
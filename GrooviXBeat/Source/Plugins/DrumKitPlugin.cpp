@@ -4,7 +4,6 @@ DrumKitPlugin::DrumKitPlugin()
     : AudioProcessor(BusesProperties()
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
-    formatManager.registerBasicFormats();
 }
 
 //==============================================================================
@@ -33,36 +32,32 @@ bool DrumKitPlugin::loadSample(int noteNumber, const juce::File& audioFile)
         return false;
     }
 
-    std::unique_ptr<juce::AudioFormatReader> reader(
-        formatManager.createReaderFor(audioFile));
-
-    if (reader == nullptr)
+    // Shared with every other pad and kit using the same file.  Mono is
+    // duplicated to both sides at render time.
+    auto data = samplePool->get(audioFile.getFullPathName());
+    if (data == nullptr)
     {
         DBG("DrumKitPlugin::loadSample - unsupported format: " + audioFile.getFileName());
         return false;
     }
 
     auto& s = samples[noteNumber];
-
-    // Decode into a float buffer
-    s.buffer.setSize((int)reader->numChannels, (int)reader->lengthInSamples);
-    reader->read(&s.buffer, 0, (int)reader->lengthInSamples, 0, true, true);
-
-    // Ensure stereo (duplicate mono channel)
-    if (s.buffer.getNumChannels() == 1)
+    SharedSampleBuffer::Ptr previous;
     {
-        s.buffer.setSize(2, s.buffer.getNumSamples(), /*keepExistingContent=*/true,
-                         false, false);
-        s.buffer.copyFrom(1, 0, s.buffer, 0, 0, s.buffer.getNumSamples());
+        // processBlock reads the slot under voiceLock
+        juce::ScopedLock lock(voiceLock);
+        previous   = std::move(s.data);
+        s.data     = data;
+        s.filePath = audioFile.getFullPathName();
+        s.loaded   = true;
     }
-
-    s.filePath = audioFile.getFullPathName();
-    s.loaded   = true;
+    previous = nullptr;
+    samplePool->purgeUnused();
 
     DBG("DrumKitPlugin: Loaded note " + juce::String(noteNumber) +
         " <- " + audioFile.getFileName() +
-        " (" + juce::String(s.buffer.getNumSamples()) + " samples, " +
-        juce::String(reader->numChannels) + " ch)");
+        " (" + juce::String(data->getNumSamples()) + " samples, " +
+        juce::String(data->getNumChannels()) + " ch)");
 
     return true;
 }
@@ -70,10 +65,16 @@ bool DrumKitPlugin::loadSample(int noteNumber, const juce::File& audioFile)
 void DrumKitPlugin::clearSample(int noteNumber)
 {
     if (noteNumber < 0 || noteNumber >= MAX_NOTES) return;
-    auto& s   = samples[noteNumber];
-    s.loaded  = false;
-    s.filePath = {};
-    s.buffer.setSize(0, 0);
+    auto& s = samples[noteNumber];
+    SharedSampleBuffer::Ptr previous;
+    {
+        juce::ScopedLock lock(voiceLock);
+        s.loaded   = false;
+        s.filePath = {};
+        previous   = std::move(s.data);
+    }
+    previous = nullptr;
+    samplePool->purgeUnused();
 }
 
 juce::String DrumKitPlugin::getSamplePath(int noteNumber) const
@@ -145,17 +146,18 @@ void DrumKitPlugin::processBlock(juce::AudioBuffer<float>& buffer,
             if (!v.active) continue;
 
             auto& s = samples[v.noteNumber];
-            if (!s.loaded) { v.active = false; continue; }
+            if (!s.loaded || s.data == nullptr) { v.active = false; continue; }
 
-            const int total     = s.buffer.getNumSamples();
+            const auto& src     = s.data->getBuffer();
+            const int total     = src.getNumSamples();
             const int remaining = total - v.position;
             const int toCopy    = std::min(numOut, remaining);
 
             for (int ch = 0; ch < numCh; ++ch)
             {
-                const int srcCh = std::min(ch, s.buffer.getNumChannels() - 1);
+                const int srcCh = std::min(ch, src.getNumChannels() - 1);
                 buffer.addFrom(ch, 0,
-                               s.buffer, srcCh, v.position,
+                               src, srcCh, v.position,
                                toCopy, v.velocity);
             }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "../Audio/SamplePool.h"
 
 /**
  * DrumKitPlugin - a polyphonic, per-note one-shot sample player.
@@ -8,6 +9,8 @@
  * When a note-on arrives the sample plays from the beginning to its end
  * regardless of the subsequent note-off (true one-shot behaviour).
  * Up to MAX_VOICES samples can play simultaneously.
+ * Sample data comes from the process-wide SamplePool, so a file used on
+ * several pads or kits is held in memory once.
  *
  * Signal flow:
  *   MidiTrackOutput --MIDI--> DrumKitPlugin --audio--> TrackMixer --> MasterMixer --> Output
@@ -64,7 +67,7 @@ public:
 private:
     struct DrumSample
     {
-        juce::AudioBuffer<float> buffer;
+        SharedSampleBuffer::Ptr  data;       // pooled, immutable
         juce::String             filePath;
         bool                     loaded = false;
     };
@@ -80,7 +83,7 @@ private:
     std::array<DrumSample, MAX_NOTES>  samples;
     std::array<DrumVoice,  MAX_VOICES> voices;
     juce::CriticalSection              voiceLock;
-    juce::AudioFormatManager           formatManager;
+    juce::SharedResourcePointer<SamplePool> samplePool;
     int                                trackIndex = -1;
 
     void triggerNote(int noteNumber, float velocity);
@@ -3,48 +3,7 @@
 */
 
 #include "SamplePlayerPlugin.h"
-
-//==============================================================================
-// Static helper: encode an AudioBuffer as 32-bit float WAV into destBlock,
-// then return a reader backed by that block. Caller must ensure destBlock
-// outlives the returned reader. Returns nullptr on failure.
-juce::AudioFormatReader* SamplePlayerPlugin::createWavReaderFromBuffer(
-    const juce::AudioBuffer<float>& buffer,
-    double sampleRate,
-    juce::MemoryBlock& destBlock)
-{
-    destBlock.reset();
-
-    juce::WavAudioFormat wavFormat;
-
-    // AudioFormatWriter takes ownership of the stream and calls delete on it in its
-    // destructor, so we must heap-allocate it (NOT pass a stack-local address).
-    auto* mos = new juce::MemoryOutputStream(destBlock, false);
-    auto writer = std::unique_ptr<juce::AudioFormatWriter>(
-        wavFormat.createWriterFor(mos,
-                                  sampleRate,
-                                  static_cast<unsigned int>(buffer.getNumChannels()),
-                                  32,   // 32-bit float — lossless
-                                  {},
-                                  0));
-    if (writer == nullptr)
-    {
-        delete mos;
-        return nullptr;
-    }
-
-    writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
-    writer.reset(); // flush/close WAV; also deletes mos → destBlock is populated
-
-    // Create a reader from the encoded WAV data.
-    // MemoryInputStream does NOT copy — destBlock must stay alive.
-    auto* mis = new juce::MemoryInputStream(destBlock.getData(), destBlock.getSize(), false);
-    auto* reader = wavFormat.createReaderFor(mis, true); // reader takes ownership of mis
-    if (reader == nullptr)
-        delete mis;
-
-    return reader;
-}
+#include "../Sequencer/MidiClipScheduler.h"
 
 //==============================================================================
 SamplePlayerPlugin::SamplePlayerPlugin()
@@ -60,205 +19,288 @@ SamplePlayerPlugin::SamplePlayerPlugin()
 
 SamplePlayerPlugin::~SamplePlayerPlugin()
 {
+    // The graph has already stopped calling processBlock(), so this thread now
+    // owns everything: drop sources still sitting in the command FIFO, then
+    // the audio-thread slots, then anything waiting to be retired.
     transportSource.setSource(nullptr);
-    readerSource.reset();
-    pendingReaderSource.reset();
+
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
+    for (int i = 0; i < size1; ++i) delete commandBuffer[(size_t)(start1 + i)].source;
+    for (int i = 0; i < size2; ++i) delete commandBuffer[(size_t)(start2 + i)].source;
+    commandFifo.finishedRead(size1 + size2);
+
+    for (int i = 0; i < numLiveEvents; ++i)
+        delete liveEvents[(size_t)i].source;
+    numLiveEvents = 0;
+
+    delete activeSource;
+    delete pendingSource;
+    activeSource  = nullptr;
+    pendingSource = nullptr;
+
+    releaseRetiredSources();
     sampleEditor.reset();
 }
 
 //==============================================================================
-bool SamplePlayerPlugin::loadFile(const juce::String& filePath)
+// Message-thread plumbing
+
+bool SamplePlayerPlugin::postCommand(Command::Type type, double value, juce::int64 position,
+                                     LoadedSource* source)
 {
-    DBG("SamplePlayerPlugin::loadFile CALLED with path: '" + filePath + "'");
+    // Free whatever the audio thread handed back since the last post.  This also
+    // bounds the retire FIFO: at most one retire per source-carrying command.
+    releaseRetiredSources();
 
-    // Step 1: Stop transport BEFORE acquiring the lock.
-    // transportSource.stop() blocks until the audio thread finishes its current callback.
-    // Holding 'lock' here would deadlock: audio-thread processBlock holds 'lock' →
-    // can't ack stop → message thread waits 1 s per call → audio graph stalls.
-    transportSource.stop();
-    transportSource.setSource(nullptr);
+    int start1, size1, start2, size2;
+    commandFifo.prepareToWrite(1, start1, size1, start2, size2);
 
-    // Step 2: File I/O outside lock (can be slow for large files).
-    juce::File file(filePath);
-    if (!file.existsAsFile())
+    if (size1 + size2 < 1)
     {
-        DBG("SamplePlayerPlugin: File not found: " + filePath);
-        juce::ScopedLock sl(lock);
-        playing = false;
-        readerSource.reset();
-        cachedMemoryBlock.reset();
-        currentFilePath = {};
+        // Audio thread is not draining (device stopped or plugin not in the graph).
+        ++stats.commandQueueFull;
+        DBG("[SPP T" + juce::String(trackIndex) + "] command queue full — dropping command "
+            + juce::String((int)type));
+        delete source;
         return false;
     }
 
-    auto* reader = formatManager.createReaderFor(file);
-    if (reader == nullptr)
+    auto& slot    = commandBuffer[(size_t)(size1 > 0 ? start1 : start2)];
+    slot.type     = type;
+    slot.value    = value;
+    slot.position = position;
+    slot.source   = source;
+    commandFifo.finishedWrite(1);
+
+    if (type == Command::Type::SetSource
+        || type == Command::Type::ResetForLiveMode
+        || type == Command::Type::ReleaseSource)
     {
-        DBG("SamplePlayerPlugin: Could not create reader for: " + filePath);
-        juce::ScopedLock sl(lock);
-        playing = false;
-        readerSource.reset();
-        cachedMemoryBlock.reset();
-        currentFilePath = {};
-        return false;
+        requestedSource = source;
+        ++postedSourceChanges;
     }
 
-    double newSampleRate     = reader->sampleRate;
-    int64_t newLengthSamples = reader->lengthInSamples;
-    int newNumChannels       = reader->numChannels;
-    auto newReaderSource     = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+    ++stats.commandsPosted;
+    return true;
+}
 
-    // Step 3: Commit state under brief lock — only plain-variable writes, no AudioTransportSource calls.
-    {
-        juce::ScopedLock sl(lock);
-        playing = false;
-        readerSource.reset();
-        cachedMemoryBlock.reset();
-        readerSource = std::move(newReaderSource);
-        readerSource->setLooping(loopEnabled && !useBeatsForLoop);
-        fileSampleRate    = newSampleRate;
-        fileLengthSamples = newLengthSamples;
-        currentFilePath   = filePath;
-    }
+void SamplePlayerPlugin::releaseRetiredSources()
+{
+    int start1, size1, start2, size2;
+    retireFifo.prepareToRead(retireFifo.getNumReady(), start1, size1, start2, size2);
 
-    // Step 4: Connect transport source outside lock (AudioTransportSource has its own thread safety).
-    transportSource.setSource(readerSource.get(), 0, nullptr, newSampleRate, newNumChannels);
-    if (currentSampleRate > 0)
-        transportSource.prepareToPlay(currentBlockSize, currentSampleRate);
+    for (int i = 0; i < size1; ++i) delete retireBuffer[(size_t)(start1 + i)];
+    for (int i = 0; i < size2; ++i) delete retireBuffer[(size_t)(start2 + i)];
 
-    DBG("SamplePlayerPlugin: Loaded " + filePath +
-        " (duration: " + juce::String(getLengthInSeconds(), 2) + "s)");
-    return true;
+    retireFifo.finishedRead(size1 + size2);
 }
 
-bool SamplePlayerPlugin::loadFromCachedBuffer(const juce::String& filePath,
-                                               const juce::AudioBuffer<float>& cachedBuffer,
-                                               double bufferSampleRate)
+SamplePlayerPlugin::LoadedSource* SamplePlayerPlugin::createFileSource(const juce::String& filePath,
+                                                                       double loopStartSeconds)
 {
-    DBG("SamplePlayerPlugin::loadFromCachedBuffer - path: " + filePath +
-        " samples: " + juce::String(cachedBuffer.getNumSamples()) +
-        " sampleRate: " + juce::String(bufferSampleRate));
+    juce::File file(filePath);
+    if (!file.existsAsFile())
+    {
+        DBG("SamplePlayerPlugin: File not found: " + filePath);
+        return nullptr;
+    }
 
-    if (cachedBuffer.getNumSamples() == 0 || bufferSampleRate <= 0)
+    // Uncompressed WAV/AIFF is played straight from a memory map; everything
+    // else goes through a normal reader.
+    auto mapped = MappedSampleSource::createMappedReader(formatManager, file);
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    if (mapped == nullptr)
     {
-        DBG("SamplePlayerPlugin: Invalid cached buffer for: " + filePath);
-        return false;
+        reader.reset(formatManager.createReaderFor(file));
+        if (reader == nullptr)
+        {
+            DBG("SamplePlayerPlugin: Could not create reader for: " + filePath);
+            return nullptr;
+        }
     }
 
-    // Step 1: Stop transport BEFORE the lock (same deadlock-prevention as loadFile).
-    transportSource.stop();
-    transportSource.setSource(nullptr);
+    const juce::AudioFormatReader& format = mapped != nullptr ? *mapped : *reader;
+
+    auto* loaded          = new LoadedSource();
+    loaded->sampleRate    = format.sampleRate;
+    loaded->lengthSamples = format.lengthInSamples;
+    loaded->numChannels   = (int)format.numChannels;
+    loaded->filePath      = filePath;
 
-    // Step 2: WAV encoding outside the lock — can be hundreds of ms for large buffers.
-    juce::MemoryBlock newMemoryBlock;
-    auto* reader = createWavReaderFromBuffer(cachedBuffer, bufferSampleRate, newMemoryBlock);
-    if (reader == nullptr)
+    // Size the read-ahead from the loop the clip will play: one loop's worth,
+    // clamped, and a head long enough to cover the loop start.
+    double readAheadSeconds = defaultReadAheadSeconds;
+    double headSeconds      = maxLoopHeadSeconds;
+    const double bpm = currentBpm.load();
+
+    if (loopEnabled && useBeatsForLoop && bpm > 0)
     {
-        DBG("SamplePlayerPlugin: Failed to encode cached buffer as WAV: " + filePath);
-        return false;
+        const double loopSeconds = loopLengthBeats.load() * 60.0 / bpm;
+        readAheadSeconds = juce::jlimit(minReadAheadSeconds, maxReadAheadSeconds, loopSeconds);
+        headSeconds      = juce::jlimit(0.0, maxLoopHeadSeconds, loopSeconds);
     }
 
-    double newSampleRate     = reader->sampleRate;
-    int64_t newLengthSamples = reader->lengthInSamples;
-    int newNumChannels       = reader->numChannels;
-    auto newReaderSource     = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+    const double fileRate = juce::jmax(1.0, format.sampleRate);
+    const int readAheadSamples = (int)(readAheadSeconds * fileRate);
+    const int headSamples      = (int)(headSeconds * fileRate);
 
-    // Step 3: Commit state under brief lock — plain-variable writes only.
+    if (mapped != nullptr)
     {
-        juce::ScopedLock sl(lock);
-        playing = false;
-        readerSource.reset();
-        cachedMemoryBlock.reset();
-        cachedMemoryBlock = std::move(newMemoryBlock);
-        readerSource = std::move(newReaderSource);
-        readerSource->setLooping(loopEnabled && !useBeatsForLoop);
-        fileSampleRate    = newSampleRate;
-        fileLengthSamples = newLengthSamples;
-        currentFilePath   = filePath;
+        // No decode and no copy: reads come from the OS page cache, which is
+        // shared with every other track mapping the same file.
+        auto source = std::make_unique<MappedSampleSource>(std::move(mapped), *streamingThread, readAheadSamples);
+        source->prime((juce::int64)(loopStartSeconds * fileRate));
+        loaded->source = std::move(source);
+        addTempoStretch(*loaded);
+
+        DBG("SamplePlayerPlugin: Memory-mapped " + filePath);
+        return loaded;
+    }
+
+    if (reader->lengthInSamples <= (juce::int64)readAheadSamples + headSamples)
+    {
+        // Streaming would buffer the whole file anyway — decode it once here.
+        juce::AudioBuffer<float> decoded((int)reader->numChannels, (int)reader->lengthInSamples);
+        reader->read(&decoded, 0, (int)reader->lengthInSamples, 0, true, true);
+
+        SharedSampleBuffer::Ptr shared = new SharedSampleBuffer(std::move(decoded), reader->sampleRate, filePath);
+        loaded->voice  = std::make_unique<SampleVoice>(shared);
+        loaded->source = std::make_unique<SharedSampleBufferSource>(std::move(shared));
+        addTempoStretch(*loaded);
+        return loaded;
     }
 
-    // Step 4: Connect transport source outside lock.
-    transportSource.setSource(readerSource.get(), 0, nullptr, newSampleRate, newNumChannels);
-    if (currentSampleRate > 0)
-        transportSource.prepareToPlay(currentBlockSize, currentSampleRate);
+    auto streaming = std::make_unique<StreamingSampleSource>(reader.release(), *streamingThread,
+                                                             readAheadSamples, headSamples,
+                                                             stats.streamUnderruns);
+    streaming->prime((juce::int64)(loopStartSeconds * fileRate));
+    loaded->source = std::move(streaming);
+    addTempoStretch(*loaded);
+
+    DBG("SamplePlayerPlugin: Streaming " + filePath
+        + " (read-ahead " + juce::String(readAheadSeconds, 1) + "s, loop head "
+        + juce::String(headSeconds, 1) + "s)");
+    return loaded;
+}
 
-    DBG("SamplePlayerPlugin: Loaded from cache (WAV-in-memory) " + filePath +
-        " (duration: " + juce::String(getLengthInSeconds(), 2) + "s)");
-    return true;
+SamplePlayerPlugin::LoadedSource* SamplePlayerPlugin::createBufferSource(const juce::String& filePath,
+                                                                         SharedSampleBuffer::Ptr cachedBuffer,
+                                                                         juce::int64 playLengthSamples)
+{
+    auto* loaded          = new LoadedSource();
+    loaded->sampleRate    = cachedBuffer->getSampleRate();
+    loaded->numChannels   = cachedBuffer->getNumChannels();
+    loaded->filePath      = filePath;
+    loaded->voice         = std::make_unique<SampleVoice>(cachedBuffer, playLengthSamples);
+    loaded->source        = std::make_unique<SharedSampleBufferSource>(std::move(cachedBuffer), playLengthSamples);
+    loaded->lengthSamples = loaded->source->getTotalLength();
+    addTempoStretch(*loaded);
+    return loaded;
+}
+
+void SamplePlayerPlugin::addTempoStretch(LoadedSource& loaded)
+{
+    // Always in the chain so tempo following can be switched on mid-clip; it
+    // is bypassed while the tempo matches referenceBpm.
+    auto stretch = std::make_unique<TempoStretchSource>(std::move(loaded.source), loaded.numChannels);
+    loaded.stretch      = stretch.get();
+    loaded.referenceBpm = currentBpm.load();
+    loaded.source       = std::move(stretch);
+}
+
+const SamplePlayerPlugin::LoadedSource* SamplePlayerPlugin::getVisibleSource() const
+{
+    // Once the audio thread has applied every source change we posted, its view
+    // is authoritative (it includes pending -> current promotions).  Until then,
+    // report the source we last asked for — it cannot have been retired yet.
+    if (appliedSourceChanges.load(std::memory_order_acquire) == postedSourceChanges)
+        return activeSourceSnapshot.load(std::memory_order_acquire);
+
+    return requestedSource;
 }
 
 //==============================================================================
-void SamplePlayerPlugin::play(double offsetSeconds)
+bool SamplePlayerPlugin::loadFile(const juce::String& filePath, double loopStartSeconds)
 {
-    // Stop BEFORE acquiring the lock to avoid deadlock with processBlock.
-    transportSource.stop();
+    DBG("SamplePlayerPlugin::loadFile CALLED with path: '" + filePath + "'");
 
+    // File I/O happens here on the message thread; the audio thread only swaps
+    // the pointer in when it drains the command.
+    auto* loaded = createFileSource(filePath, loopStartSeconds);
+    if (loaded == nullptr)
     {
-        juce::ScopedLock sl(lock);
-        if (readerSource == nullptr)
-            return;
-        startOffset = offsetSeconds;
-        playing = false;  // will be set true after transportSource.start()
+        // A failed load leaves the player empty rather than on the old file.
+        postCommand(Command::Type::SetSource);
+        return false;
     }
 
-    transportSource.setPosition(offsetSeconds);
-    transportSource.start();
+    const double lengthSeconds = loaded->lengthSamples / juce::jmax(1.0, loaded->sampleRate);
+
+    if (!postCommand(Command::Type::SetSource, 0.0, 0, loaded))
+        return false;
+
+    DBG("SamplePlayerPlugin: Loaded " + filePath +
+        " (duration: " + juce::String(lengthSeconds, 2) + "s)");
+    return true;
+}
 
+bool SamplePlayerPlugin::loadFromCachedBuffer(const juce::String& filePath,
+                                               SharedSampleBuffer::Ptr cachedBuffer,
+                                               juce::int64 playLengthSamples)
+{
+    if (cachedBuffer == nullptr || cachedBuffer->getNumSamples() == 0 || cachedBuffer->getSampleRate() <= 0)
     {
-        juce::ScopedLock sl(lock);
-        playing = true;
-        samplesPlayedSinceStart = 0;
-        queuedToPlay = false;
-        queuedToStop = false;
-        needsStartBeatInit = true;
+        DBG("SamplePlayerPlugin: Invalid cached buffer for: " + filePath);
+        return false;
     }
 
-    DBG("SamplePlayerPlugin: Playing from " + juce::String(offsetSeconds, 3) + "s, loopLengthBeats=" + juce::String(loopLengthBeats));
+    DBG("SamplePlayerPlugin::loadFromCachedBuffer - path: " + filePath +
+        " samples: " + juce::String(cachedBuffer->getNumSamples()) +
+        " sampleRate: " + juce::String(cachedBuffer->getSampleRate()));
+
+    // Wrap the shared buffer — no copy, no encode, just a reference.
+    auto* loaded = createBufferSource(filePath, std::move(cachedBuffer), playLengthSamples);
+
+    const double lengthSeconds = loaded->lengthSamples / loaded->sampleRate;
+
+    if (!postCommand(Command::Type::SetSource, 0.0, 0, loaded))
+        return false;
+
+    DBG("SamplePlayerPlugin: Loaded from cache (shared buffer) " + filePath +
+        " (duration: " + juce::String(lengthSeconds, 2) + "s)");
+    return true;
 }
 
-void SamplePlayerPlugin::stop()
+//==============================================================================
+void SamplePlayerPlugin::play(double offsetSeconds)
 {
-    // Call transportSource.stop() BEFORE acquiring the lock.
-    // transportSource.stop() blocks until the audio thread acknowledges the stop.
-    // The audio thread's processBlock() holds 'lock' while running, so if we
-    // acquire 'lock' first and then call transportSource.stop(), we deadlock:
-    // message thread holds lock → audio thread can't enter processBlock → never
-    // acknowledges stop → message thread waits 1 s per player before timing out.
-    if (readerSource != nullptr)
-        transportSource.stop();
-
-    {
-        juce::ScopedLock sl(lock);
+    postCommand(Command::Type::Play, offsetSeconds);
 
-        if (readerSource != nullptr)
-            transportSource.setPosition(0.0);
+    DBG("SamplePlayerPlugin: Playing from " + juce::String(offsetSeconds, 3) + "s, loopLengthBeats="
+        + juce::String(loopLengthBeats.load()));
+}
 
-        playing = false;
-        queuedToPlay = false;
-        queuedToStop = false;
+void SamplePlayerPlugin::stop()
+{
+    // Clear mute state so the track plays normally next time it is started.
+    // If a live-mode mute fired but the track was stopped before unmute, the
+    // muted flag would persist and silence all subsequent scene/track playback.
+    // Queued mute/unmute events are dropped by the command itself; events
+    // scheduled after this call come later in the FIFO and survive.
+    pendingMuteNotification.store(false,   std::memory_order_relaxed);
+    pendingUnmuteNotification.store(false, std::memory_order_relaxed);
 
-        // Clear mute state so the track plays normally next time it is started.
-        // If a live-mode mute fired but the track was stopped before unmute, the
-        // muted flag would persist and silence all subsequent scene/track playback.
-        muted = false;
-        targetMuteSample.store(-1,   std::memory_order_relaxed);
-        targetUnmuteSample.store(-1, std::memory_order_relaxed);
-        pendingMuteNotification.store(false,   std::memory_order_relaxed);
-        pendingUnmuteNotification.store(false, std::memory_order_relaxed);
-    }
+    postCommand(Command::Type::Stop);
 
     DBG("SamplePlayerPlugin: Stopped");
 }
 
 void SamplePlayerPlugin::setLooping(bool shouldLoop)
 {
-    juce::ScopedLock sl(lock);
-
     loopEnabled = shouldLoop;
-
-    // Only set native looping if not using beat-based looping
-    if (readerSource != nullptr && !useBeatsForLoop)
-        readerSource->setLooping(shouldLoop);
+    postCommand(Command::Type::ApplyLoopMode);
 }
 
 //==============================================================================
@@ -266,12 +308,7 @@ void SamplePlayerPlugin::setLooping(bool shouldLoop)
 
 void SamplePlayerPlugin::queuePlay(double offsetSeconds)
 {
-    juce::ScopedLock sl(lock);
-
-    queuedToPlay = true;
-    queuedToStop = false;
-    queuedOffset = offsetSeconds;
-    targetStopSample.store(-1, std::memory_order_relaxed);  // cancel any stale stop
+    postCommand(Command::Type::QueuePlay, offsetSeconds);  // also cancels any stale stop event
 
     DBG("SamplePlayerPlugin: Queued to play (offset: " + juce::String(offsetSeconds, 3) + "s)");
 }
@@ -280,161 +317,75 @@ bool SamplePlayerPlugin::loadFileForPendingPlay(const juce::String& filePath, do
 {
     DBG("SamplePlayerPlugin::loadFileForPendingPlay - path: " + filePath);
 
-    // Step 1: Perform disk I/O WITHOUT holding the player lock so we don't
-    // stall the audio thread (which acquires the same lock in processBlock).
-    juce::File file(filePath);
-    if (!file.existsAsFile())
-    {
-        DBG("SamplePlayerPlugin: Pending file not found: " + filePath);
+    // Disk I/O on the message thread; the audio thread just stages the pointer.
+    auto* loaded = createFileSource(filePath, offsetSeconds);
+    if (loaded == nullptr)
         return false;
-    }
 
-    auto* reader = formatManager.createReaderFor(file);
-    if (reader == nullptr)
-    {
-        DBG("SamplePlayerPlugin: Could not create reader for pending file: " + filePath);
+    if (!postCommand(Command::Type::SetPendingSource, offsetSeconds, 0, loaded))
         return false;
-    }
-
-    double newFileSampleRate     = reader->sampleRate;
-    int64_t newFileLengthSamples = reader->lengthInSamples;
-
-    auto newReaderSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
-    newReaderSource->setLooping(loopEnabled && !useBeatsForLoop);
-
-    // Step 2: Acquire the player lock briefly to commit the pending state.
-    {
-        juce::ScopedLock sl(lock);
-
-        pendingReaderSource      = std::move(newReaderSource);
-        pendingFileSampleRate    = newFileSampleRate;
-        pendingFileLengthSamples = newFileLengthSamples;
-        pendingFilePath          = filePath;
-
-        hasPendingFile = true;
-        queuedToPlay   = true;
-        queuedToStop   = false;
-        queuedOffset   = offsetSeconds;
-        // Do NOT set needsImmediateStart — let crossedBoundary detection fire at the quantize boundary
-    }
 
     DBG("SamplePlayerPlugin: Prepared pending file for seamless transition: " + filePath);
     return true;
 }
 
 bool SamplePlayerPlugin::loadCachedBufferForPendingPlay(const juce::String& filePath,
-                                                         const juce::AudioBuffer<float>& cachedBuffer,
-                                                         double bufferSampleRate,
-                                                         double offsetSeconds)
+                                                         SharedSampleBuffer::Ptr cachedBuffer,
+                                                         double offsetSeconds,
+                                                         juce::int64 playLengthSamples)
 {
-    DBG("SamplePlayerPlugin::loadCachedBufferForPendingPlay - path: " + filePath +
-        " samples: " + juce::String(cachedBuffer.getNumSamples()));
-
-    if (cachedBuffer.getNumSamples() == 0 || bufferSampleRate <= 0)
+    if (cachedBuffer == nullptr || cachedBuffer->getNumSamples() == 0 || cachedBuffer->getSampleRate() <= 0)
     {
         DBG("SamplePlayerPlugin: Invalid cached buffer for pending play");
         return false;
     }
 
-    // ----------------------------------------------------------------
-    // Step 1: Encode the WAV WITHOUT holding the player lock.
-    // The audio thread's processBlock() also acquires this lock, so holding
-    // it during potentially-slow encoding (tens to hundreds of milliseconds
-    // for large buffers) blocks the entire audio callback and causes a
-    // dropout across ALL sample players until encoding finishes.
-    // ----------------------------------------------------------------
-    juce::MemoryBlock newMemoryBlock;
-    auto* reader = createWavReaderFromBuffer(cachedBuffer, bufferSampleRate, newMemoryBlock);
-    if (reader == nullptr)
-    {
-        DBG("SamplePlayerPlugin: Failed to encode pending cached buffer as WAV: " + filePath);
-        return false;
-    }
-
-    double newFileSampleRate     = reader->sampleRate;
-    int64_t newFileLengthSamples = reader->lengthInSamples;
+    DBG("SamplePlayerPlugin::loadCachedBufferForPendingPlay - path: " + filePath +
+        " samples: " + juce::String(cachedBuffer->getNumSamples()));
 
-    // loopEnabled / useBeatsForLoop are only written from the message thread
-    // (same thread as this function), so reading them outside the lock is safe.
-    auto newReaderSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
-    newReaderSource->setLooping(loopEnabled && !useBeatsForLoop);
+    // The source only takes a reference to the shared buffer, so this is
+    // a few small allocations regardless of clip length.
+    auto* loaded = createBufferSource(filePath, std::move(cachedBuffer), playLengthSamples);
 
-    // ----------------------------------------------------------------
-    // Step 2: Acquire the player lock briefly to commit the pending state.
-    // All state mutations that the audio thread reads are done here.
-    // ----------------------------------------------------------------
-    {
-        juce::ScopedLock sl(lock);
-
-        pendingReaderSource.reset();
-        pendingMemoryBlock.reset();
-
-        pendingMemoryBlock       = std::move(newMemoryBlock);
-        pendingReaderSource      = std::move(newReaderSource);
-        pendingFileSampleRate    = newFileSampleRate;
-        pendingFileLengthSamples = newFileLengthSamples;
-        pendingFilePath          = filePath;
-
-        hasPendingFile = true;
-        queuedToPlay   = true;
-        queuedToStop   = false;
-        queuedOffset   = offsetSeconds;
-        // Do NOT set needsImmediateStart — let crossedBoundary detection fire at the quantize boundary
-    }
+    // Do NOT set needsImmediateStart — let crossedBoundary detection fire at the quantize boundary
+    if (!postCommand(Command::Type::SetPendingSource, offsetSeconds, 0, loaded))
+        return false;
 
-    DBG("SamplePlayerPlugin: Prepared pending cached buffer (WAV-in-memory) for: " + filePath);
+    DBG("SamplePlayerPlugin: Prepared pending cached buffer (shared) for: " + filePath);
     return true;
 }
 
 void SamplePlayerPlugin::queueStop()
 {
-    juce::ScopedLock sl(lock);
-
-    queuedToStop = true;
-    queuedToPlay = false;
+    postCommand(Command::Type::QueueStop);
 
     DBG("SamplePlayerPlugin: Queued to stop");
 }
 
 void SamplePlayerPlugin::cancelQueue()
 {
-    juce::ScopedLock sl(lock);
-
-    queuedToPlay = false;
-    queuedToStop = false;
-
-    // Also disarm audio-thread targets so pending file/mute never fires
-    targetStartSample.store(-1,  std::memory_order_relaxed);
-    targetStopSample.store(-1,   std::memory_order_relaxed);
-    targetMuteSample.store(-1,   std::memory_order_relaxed);
-    targetUnmuteSample.store(-1, std::memory_order_relaxed);
-    hasPendingFile = false;
+    // Drops every scheduled event too, so a pending file/mute never fires.
+    postCommand(Command::Type::CancelQueue);
 }
 
 void SamplePlayerPlugin::setLoopLengthBeats(double beats)
 {
-    juce::ScopedLock sl(lock);
-
     loopLengthBeats = beats;
     useBeatsForLoop = true;
 
     // Disable native looping when using beat-based looping
-    if (readerSource != nullptr)
-        readerSource->setLooping(false);
+    postCommand(Command::Type::ApplyLoopMode);
 }
 
 void SamplePlayerPlugin::setLoopLengthSeconds(double seconds)
 {
-    juce::ScopedLock sl(lock);
-
     // Convert seconds to beats at current BPM
-    double beatsPerSecond = currentBpm / 60.0;
+    double beatsPerSecond = currentBpm.load() / 60.0;
     loopLengthBeats = seconds * beatsPerSecond;
     useBeatsForLoop = false;
 
     // Use native looping for time-based loops
-    if (readerSource != nullptr)
-        readerSource->setLooping(loopEnabled);
+    postCommand(Command::Type::ApplyLoopMode);
 }
 
 void SamplePlayerPlugin::syncToTransport(double transportPositionBeats,
@@ -442,291 +393,562 @@ void SamplePlayerPlugin::syncToTransport(double transportPositionBeats,
                                           int quantizeSteps,
                                           bool transportPlaying)
 {
-    // =========================================================================
-    // Phase 1: Check transport-stopped case under brief lock.
-    // transportSource.stop() must be called OUTSIDE the lock to avoid deadlock
-    // (audio thread's processBlock() also holds 'lock').
-    // =========================================================================
-    bool needsTransportStop = false;
-    {
-        juce::ScopedLock sl(lock);
-        currentBpm = bpm;
-        if (!transportPlaying)
-        {
-            lastTransportBeat = transportPositionBeats;
-            if (playing)
-            {
-                playing = false;
-                needsTransportStop = true;
-            }
-        }
-    }
+    // Publish only.  The serial is bumped last (release) so the audio thread
+    // never sees a new serial with stale values.  Several calls between two
+    // blocks coalesce into one evaluation; boundary detection still compares
+    // against the last beat the audio thread saw, so no crossing is missed.
+    currentBpm = bpm;
+    syncTransportBeats.store(transportPositionBeats, std::memory_order_relaxed);
+    syncQuantizeSteps.store(quantizeSteps, std::memory_order_relaxed);
+    syncTransportPlaying.store(transportPlaying, std::memory_order_relaxed);
+    syncSerial.fetch_add(1, std::memory_order_release);
+}
 
-    if (!transportPlaying)
-    {
-        if (needsTransportStop)
-        {
-            transportSource.stop();
-            DBG("[SPP T" + juce::String(trackIndex) + "] STOPPED by transport (transportPlaying=false)"
-                + " at beat=" + juce::String(transportPositionBeats, 2));
-        }
-        return;
-    }
+//==============================================================================
+// State Queries
 
-    // =========================================================================
-    // Phase 2: Detect boundary actions under lock — collect what needs doing
-    // WITHOUT calling any AudioTransportSource methods (they can block/deadlock).
-    //
-    // For the seamless-switch case we move the pending reader OUT of the player
-    // state into a local variable so we can safely destroy the old reader after
-    // releasing the lock (once transportSource.setSource(nullptr) has been
-    // called and the transport no longer holds a raw pointer to the old reader).
-    // =========================================================================
+juce::String SamplePlayerPlugin::getCurrentFilePath() const
+{
+    if (auto* visible = getVisibleSource())
+        return visible->filePath;
+    return {};
+}
 
-    enum class SceneAction { None, SeamlessSwitch, DirectStart, Stop };
-    SceneAction action = SceneAction::None;
+double SamplePlayerPlugin::getLengthInSeconds() const
+{
+    if (auto* visible = getVisibleSource())
+        if (visible->sampleRate > 0 && visible->lengthSamples > 0)
+            return (double)visible->lengthSamples / visible->sampleRate;
+    return 0.0;
+}
 
-    // Captured for SeamlessSwitch:
-    std::unique_ptr<juce::AudioFormatReaderSource> newReaderSource;
-    juce::MemoryBlock                              newMemoryBlock;
-    juce::String                                   newFilePath;
-    double                                         newFileSampleRate    = 0.0;
-    int64_t                                        newFileLengthSamples = 0;
-    double                                         newSampleStartBeat   = 0.0;
-    double                                         newStartPos          = 0.0;
+bool SamplePlayerPlugin::hasValidSource() const
+{
+    return getVisibleSource() != nullptr;
+}
 
-    {
-        juce::ScopedLock sl(lock);
+void SamplePlayerPlugin::resetForLiveMode()
+{
+    // The command drops queued start/stop events; events scheduled right after
+    // the reset come later in the FIFO and survive it.
+    // cumulativeSamplePosition is NOT reset here; it is set externally via
+    // setCumulativePosition() to match the MidiClipScheduler's counter.
+    postCommand(Command::Type::ResetForLiveMode);
 
-        double beatsPerQuantize = quantizeSteps / 4.0;
-        int prevQuantize = (int)(lastTransportBeat / beatsPerQuantize);
-        int currQuantize = (int)(transportPositionBeats / beatsPerQuantize);
-        bool crossedBoundary = currQuantize > prevQuantize;
+    DBG("SamplePlayerPlugin: Reset for Live Mode");
+}
 
-        if (crossedBoundary || needsImmediateStart)
-        {
-            // Live-mode clips are handled sample-accurately in processBlock() —
-            // skip scene-mode boundary logic when the audio-thread path is armed.
-            bool livePathArmed = (targetStartSample.load(std::memory_order_relaxed) >= 0);
+double SamplePlayerPlugin::getPositionSeconds() const
+{
+    return positionSnapshot.load(std::memory_order_relaxed);
+}
 
-            if (!livePathArmed)
-            {
-                if (queuedToPlay && hasPendingFile && pendingReaderSource != nullptr)
-                {
-                    // Move pending reader to locals — do NOT touch readerSource yet
-                    // (transport still holds a raw pointer to the current reader;
-                    // we must call setSource(nullptr) first, outside the lock).
-                    newReaderSource      = std::move(pendingReaderSource);
-                    newMemoryBlock       = std::move(pendingMemoryBlock);
-                    newFilePath          = pendingFilePath;
-                    newFileSampleRate    = pendingFileSampleRate;
-                    newFileLengthSamples = pendingFileLengthSamples;
-                    newSampleStartBeat   = currQuantize * beatsPerQuantize;
-                    newStartPos          = queuedOffset;
-
-                    hasPendingFile           = false;
-                    pendingFilePath          = {};
-                    pendingFileSampleRate    = 0.0;
-                    pendingFileLengthSamples = 0;
-                    queuedToPlay             = false;
-                    needsImmediateStart      = false;
-                    playing                  = false;  // set true again after transport ops
-                    action = SceneAction::SeamlessSwitch;
-                }
-                else if (queuedToPlay && readerSource != nullptr)
-                {
-                    newSampleStartBeat = currQuantize * beatsPerQuantize;
-                    newStartPos        = queuedOffset;
-                    queuedToPlay       = false;
-                    needsImmediateStart = false;
-                    action = SceneAction::DirectStart;
-                }
-            }
+void SamplePlayerPlugin::setPositionSeconds(double position)
+{
+    postCommand(Command::Type::SetPosition, position);
+}
 
-            bool liveStopArmed = (targetStopSample.load(std::memory_order_relaxed) >= 0);
-            if (queuedToStop && !liveStopArmed && action == SceneAction::None)
-            {
-                if (playing)
-                {
-                    playing = false;
-                    action = SceneAction::Stop;
-                }
-                queuedToStop        = false;
-                needsImmediateStart = false;
-            }
+//==============================================================================
+// Audio-thread quantize triggering
 
-            if (needsImmediateStart && action == SceneAction::None)
-                needsImmediateStart = false;
-        }
+void SamplePlayerPlugin::setCumulativePosition(int64_t pos)
+{
+    postCommand(Command::Type::SetCumulativePosition, 0.0, pos);
+}
 
-        lastTransportBeat = transportPositionBeats;
+void SamplePlayerPlugin::scheduleStart(juce::int64 samplePos, double offsetSeconds)
+{
+    postCommand(Command::Type::ScheduleStart, offsetSeconds, samplePos);
+}
+
+bool SamplePlayerPlugin::scheduleCachedBufferStart(const juce::String& filePath,
+                                                   SharedSampleBuffer::Ptr cachedBuffer,
+                                                   juce::int64 samplePos,
+                                                   double offsetSeconds,
+                                                   juce::int64 playLengthSamples)
+{
+    if (cachedBuffer == nullptr || cachedBuffer->getNumSamples() == 0 || cachedBuffer->getSampleRate() <= 0)
+    {
+        DBG("SamplePlayerPlugin: Invalid cached buffer for scheduled start");
+        return false;
     }
 
-    // =========================================================================
-    // Phase 3: Execute transport operations OUTSIDE the lock.
-    // AudioTransportSource calls are safe here: no lock is held, so the audio
-    // thread can freely enter processBlock() and ack any stop requests.
-    // =========================================================================
+    // The event owns the source until it fires, so several launches queued
+    // before the first boundary each keep their own clip.
+    auto* loaded = createBufferSource(filePath, std::move(cachedBuffer), playLengthSamples);
 
-    if (action == SceneAction::SeamlessSwitch)
-    {
-        // 1. Stop the transport — transport releases its hold on the old reader.
-        transportSource.stop();
-        transportSource.setSource(nullptr);
+    if (!postCommand(Command::Type::ScheduleStart, offsetSeconds, samplePos, loaded))
+        return false;
 
-        // 2. Now safe to swap old reader for new one (transport no longer holds it).
-        {
-            juce::ScopedLock sl(lock);
-            readerSource.reset();          // destroy old reader
-            cachedMemoryBlock.reset();
-            cachedMemoryBlock = std::move(newMemoryBlock);
-            readerSource      = std::move(newReaderSource);
-            currentFilePath   = newFilePath;
-            fileSampleRate    = newFileSampleRate;
-            fileLengthSamples = newFileLengthSamples;
-        }
+    DBG("SamplePlayerPlugin: Scheduled start of " + filePath + " at " + juce::String(samplePos));
+    return true;
+}
 
-        // 3. Connect and start new reader.
-        // Note: setSource() calls source->prepareToPlay() internally when the
-        // transport is already prepared — no need for an explicit prepareToPlay().
-        if (readerSource != nullptr)
-        {
-            if (auto* reader = readerSource->getAudioFormatReader())
-                transportSource.setSource(readerSource.get(), 0, nullptr,
-                                          reader->sampleRate, reader->numChannels);
-        }
+void SamplePlayerPlugin::scheduleStop(juce::int64 samplePos)
+{
+    postCommand(Command::Type::ScheduleStop, 0.0, samplePos);
+}
 
-        transportSource.setPosition(newStartPos);
-        transportSource.start();
+void SamplePlayerPlugin::scheduleMute(juce::int64 samplePos)
+{
+    postCommand(Command::Type::ScheduleMute, 0.0, samplePos);
+}
 
-        {
-            juce::ScopedLock sl(lock);
-            sampleStartBeat         = newSampleStartBeat;
-            playing                 = true;
-            samplesPlayedSinceStart = 0;
-        }
+void SamplePlayerPlugin::scheduleUnmute(juce::int64 samplePos)
+{
+    postCommand(Command::Type::ScheduleUnmute, 0.0, samplePos);
+}
 
-        DBG("SamplePlayerPlugin: Seamless switch (scene) at beat " + juce::String(newSampleStartBeat, 2));
-    }
-    else if (action == SceneAction::DirectStart)
+//==============================================================================
+// Audio-thread command handling
+
+void SamplePlayerPlugin::retireSource(LoadedSource* source)
+{
+    if (source == nullptr)
+        return;
+
+    int start1, size1, start2, size2;
+    retireFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 < 1)
     {
-        transportSource.setPosition(newStartPos);
-        transportSource.start();
+        // Should not happen (postCommand drains before every post), but never leak.
+        ++stats.sourcesFreedOnAudioThread;
+        delete source;
+        return;
+    }
 
-        {
-            juce::ScopedLock sl(lock);
-            sampleStartBeat = newSampleStartBeat;
-            playing         = true;
-        }
+    retireBuffer[(size_t)(size1 > 0 ? start1 : start2)] = source;
+    retireFifo.finishedWrite(1);
+}
+
+void SamplePlayerPlugin::makeSourceActive(LoadedSource* source)
+{
+    // Do NOT call transportSource.stop() here — it spin-waits for the audio
+    // thread.  setSource(nullptr) sets the transport's playing flag to false
+    // under its callbackLock without any spin-wait.
+    transportSource.setSource(nullptr);
 
-        DBG("SamplePlayerPlugin: Started (scene) at beat " + juce::String(newSampleStartBeat, 2));
+    auto* old = activeSource;
+    activeSource = source;
+    activeSourceSnapshot.store(activeSource, std::memory_order_release);
+    retireSource(old);
+
+    // A new source starts on the voice when it has one (its stretch starts bypassed).
+    voiceRendering = activeSource != nullptr && activeSource->voice != nullptr;
+
+    if (activeSource != nullptr)
+    {
+        activeSource->source->setLooping(loopEnabled && !useBeatsForLoop);
+        if (activeSource->voice != nullptr)
+            activeSource->voice->setLooping(loopEnabled && !useBeatsForLoop);
+        attachActiveSourceToTransport();
     }
-    else if (action == SceneAction::Stop)
+}
+
+void SamplePlayerPlugin::attachActiveSourceToTransport()
+{
+    // A source already at the device rate (e.g. a cache entry converted by
+    // SamplePlayerManager) is attached without rate correction, so the
+    // transport does not put a resampler in its path.
+    const double sourceRate = activeSource->sampleRate;
+    const bool needsResampling = std::abs(sourceRate - currentSampleRate) > 0.01;
+
+    // setSource() calls source->prepareToPlay() internally when the
+    // transport is already prepared.
+    transportSource.setSource(activeSource->source.get(), 0, nullptr,
+                              needsResampling ? sourceRate : 0.0, activeSource->numChannels);
+
+    // The voice interpolates itself; no allocation here.
+    if (activeSource->voice != nullptr)
+        activeSource->voice->setOutputSampleRate(currentSampleRate);
+}
+
+void SamplePlayerPlugin::applyLoopMode()
+{
+    const bool nativeLoop = loopEnabled && !useBeatsForLoop;
+
+    for (auto* loaded : { activeSource, pendingSource })
     {
-        transportSource.stop();
-        transportSource.setPosition(0.0);
-        DBG("SamplePlayerPlugin: Stopped (scene) at beat " + juce::String(transportPositionBeats, 2));
+        if (loaded == nullptr)
+            continue;
+
+        loaded->source->setLooping(nativeLoop);
+        if (loaded->voice != nullptr)
+            loaded->voice->setLooping(nativeLoop);
     }
 }
 
+void SamplePlayerPlugin::applyTempoFollow(double bpm)
+{
+    auto* stretch = activeSource != nullptr ? activeSource->stretch : nullptr;
+    if (stretch == nullptr)
+        return;
+
+    // Bypassed while the tempo matches, so an unchanged tempo costs nothing.
+    const double referenceBpm = activeSource->referenceBpm;
+    const bool follow = tempoFollow.load(std::memory_order_relaxed)
+                        && referenceBpm > 0 && bpm > 0 && bpm != referenceBpm;
+
+    if (follow)
+        stretch->setSpeed(bpm / referenceBpm);
+    stretch->setEnabled(follow);
+
+    updatePlaybackPath();
+}
+
 //==============================================================================
-// State Queries
+// Active source playback
 
-double SamplePlayerPlugin::getLengthInSeconds() const
+void SamplePlayerPlugin::seekSource(double seconds)
 {
-    if (fileSampleRate > 0 && fileLengthSamples > 0)
-        return (double)fileLengthSamples / fileSampleRate;
-    return 0.0;
+    transportSource.setPosition(seconds);
+    if (activeSource != nullptr && activeSource->voice != nullptr)
+        activeSource->voice->setPositionSeconds(seconds);
 }
 
-bool SamplePlayerPlugin::hasValidSource() const
+void SamplePlayerPlugin::startSource()
 {
-    return readerSource != nullptr;
+    transportSource.start();
+    if (activeSource != nullptr && activeSource->voice != nullptr)
+        activeSource->voice->start();
 }
 
-void SamplePlayerPlugin::resetForLiveMode()
+bool SamplePlayerPlugin::sourceIsPlaying() const
 {
-    // Stop transport before the lock (same deadlock-prevention pattern).
-    transportSource.stop();
-    transportSource.setSource(nullptr);
+    return voiceRendering ? activeSource->voice->isPlaying() : transportSource.isPlaying();
+}
 
-    juce::ScopedLock sl(lock);
+double SamplePlayerPlugin::getSourcePositionSeconds() const
+{
+    return voiceRendering ? activeSource->voice->getPositionSeconds() : transportSource.getCurrentPosition();
+}
 
-    playing = false;
-    readerSource.reset();
-    cachedMemoryBlock.reset();
+void SamplePlayerPlugin::updatePlaybackPath()
+{
+    // The voice cannot stretch, so a clip following the tempo goes through the
+    // transport chain; back at the reference tempo it returns to the voice.
+    const bool useVoice = activeSource != nullptr && activeSource->voice != nullptr
+                          && !(activeSource->stretch != nullptr && activeSource->stretch->isEnabled());
 
-    currentFilePath = {};
-    fileSampleRate = 0.0;
-    fileLengthSamples = 0;
+    if (useVoice == voiceRendering)
+        return;
 
-    queuedToPlay = false;
-    queuedToStop = false;
-    needsImmediateStart = false;
+    // Hand the position over to the path taking over.
+    if (useVoice)
+    {
+        activeSource->voice->setPositionSeconds(transportSource.getCurrentPosition());
+        if (transportSource.isPlaying())
+            activeSource->voice->start();
+    }
+    else
+    {
+        transportSource.setPosition(activeSource->voice->getPositionSeconds());
+    }
 
-    hasPendingFile = false;
-    pendingReaderSource.reset();
-    pendingMemoryBlock.reset();
-    pendingFilePath = {};
-    pendingFileSampleRate = 0.0;
-    pendingFileLengthSamples = 0;
+    voiceRendering = useVoice;
+}
 
-    lastTransportBeat = 0.0;
-    sampleStartBeat = 0.0;
-    samplesPlayedSinceStart = 0;
+void SamplePlayerPlugin::processCommands()
+{
+    int start1, size1, start2, size2;
+    commandFifo.prepareToRead(commandFifo.getNumReady(), start1, size1, start2, size2);
 
-    // Clear audio-thread trigger targets.
-    // cumulativeSamplePosition is NOT reset here; it is set externally via
-    // setCumulativePosition() to match the MidiClipScheduler's counter.
-    targetStartSample.store(-1, std::memory_order_relaxed);
-    targetStopSample.store(-1,  std::memory_order_relaxed);
+    for (int i = 0; i < size1; ++i) applyCommand(commandBuffer[(size_t)(start1 + i)]);
+    for (int i = 0; i < size2; ++i) applyCommand(commandBuffer[(size_t)(start2 + i)]);
 
-    DBG("SamplePlayerPlugin: Reset for Live Mode");
-}
+    const int numProcessed = size1 + size2;
+    commandFifo.finishedRead(numProcessed);
 
-double SamplePlayerPlugin::getPositionSeconds() const
-{
-    return transportSource.getCurrentPosition();
+    if (numProcessed > 0)
+    {
+        stats.commandsProcessed += (juce::uint64)numProcessed;
+        if (numProcessed > stats.maxCommandsPerBlock.load(std::memory_order_relaxed))
+            stats.maxCommandsPerBlock.store(numProcessed, std::memory_order_relaxed);
+    }
 }
 
-void SamplePlayerPlugin::setPositionSeconds(double position)
+void SamplePlayerPlugin::applyCommand(const Command& command)
 {
-    juce::ScopedLock sl(lock);
-    transportSource.setPosition(position);
+    switch (command.type)
+    {
+        case Command::Type::SetSource:
+            playing = false;
+            makeSourceActive(command.source);
+            appliedSourceChanges.fetch_add(1, std::memory_order_release);
+            break;
+
+        case Command::Type::SetPendingSource:
+            retireSource(pendingSource);
+            pendingSource = command.source;
+            pendingSource->source->setLooping(loopEnabled && !useBeatsForLoop);
+            queuedToPlay = true;
+            queuedToStop = false;
+            queuedOffset = command.value;
+            break;
+
+        case Command::Type::Play:
+            if (activeSource == nullptr)
+                break;
+            startOffset = command.value;
+            seekSource(command.value);
+            startSource();
+            playing = true;
+            samplesPlayedSinceStart = 0;
+            queuedToPlay = false;
+            queuedToStop = false;
+            break;
+
+        case Command::Type::Stop:
+            // Never transportSource.stop() on the audio thread (spin-wait).
+            // playing=false is enough: getNextAudioBlock is not called again
+            // until the next start.
+            if (activeSource != nullptr)
+                seekSource(0.0);
+            playing = false;
+            queuedToPlay = false;
+            queuedToStop = false;
+            muted = false;
+            removeLiveEvents(LiveEvent::Kind::Mute);
+            removeLiveEvents(LiveEvent::Kind::Unmute);
+            break;
+
+        case Command::Type::QueuePlay:
+            removeLiveEvents(LiveEvent::Kind::Stop);
+            queuedToPlay = true;
+            queuedToStop = false;
+            queuedOffset = command.value;
+            break;
+
+        case Command::Type::QueueStop:
+            queuedToStop = true;
+            queuedToPlay = false;
+            break;
+
+        case Command::Type::CancelQueue:
+            queuedToPlay = false;
+            queuedToStop = false;
+            retireSource(pendingSource);
+            pendingSource = nullptr;
+            clearLiveEvents();
+            break;
+
+        case Command::Type::ApplyLoopMode:
+            applyLoopMode();
+            break;
+
+        case Command::Type::SetPosition:
+            if (activeSource != nullptr)
+                seekSource(command.value);
+            break;
+
+        case Command::Type::SetCumulativePosition:
+            cumulativeSamplePosition = command.position;
+            break;
+
+        case Command::Type::ResetForLiveMode:
+            playing = false;
+            makeSourceActive(nullptr);
+            retireSource(pendingSource);
+            pendingSource = nullptr;
+            queuedToPlay = false;
+            queuedToStop = false;
+            needsImmediateStart = false;
+            lastTransportBeat = 0.0;
+            samplesPlayedSinceStart = 0;
+            removeLiveEvents(LiveEvent::Kind::Start);
+            removeLiveEvents(LiveEvent::Kind::Stop);
+            appliedSourceChanges.fetch_add(1, std::memory_order_release);
+            break;
+
+        case Command::Type::ReleaseSource:
+            playing = false;
+            makeSourceActive(nullptr);
+            appliedSourceChanges.fetch_add(1, std::memory_order_release);
+            break;
+
+        case Command::Type::ScheduleStart:
+            // A new start cancels any stop queued before it.  Without this, a
+            // stale stop left over from a scene transition (queued when this
+            // track was not yet playing) fires right after the start, silencing
+            // the sample before it outputs any audio.
+            removeLiveEvents(LiveEvent::Kind::Stop);
+            addLiveEvent({ LiveEvent::Kind::Start, resolveEventTime(command.position),
+                           command.value, command.source });
+            queuedToPlay = true;
+            queuedToStop = false;
+            break;
+
+        case Command::Type::ScheduleStop:
+            addLiveEvent({ LiveEvent::Kind::Stop, resolveEventTime(command.position) });
+            queuedToStop = true;
+            break;
+
+        case Command::Type::ScheduleMute:
+            addLiveEvent({ LiveEvent::Kind::Mute, resolveEventTime(command.position) });
+            break;
+
+        case Command::Type::ScheduleUnmute:
+            addLiveEvent({ LiveEvent::Kind::Unmute, resolveEventTime(command.position) });
+            break;
+    }
 }
 
 //==============================================================================
-// Audio-thread quantize triggering
+// Live Mode event queue (audio thread)
 
-void SamplePlayerPlugin::setCumulativePosition(int64_t pos)
+juce::int64 SamplePlayerPlugin::resolveEventTime(juce::int64 samplePos) const
 {
-    juce::ScopedLock sl(lock);
-    cumulativeSamplePosition = pos;
+    if (samplePos != atNextBoundary)
+        return samplePos;
+
+    // First boundary at or after this block — the same rule MidiClipScheduler
+    // applies to pending MIDI clips, so both land on the same sample.  Resolved
+    // here rather than on the message thread, so a command that reaches the
+    // audio thread after the boundary it was aimed at lands on the following
+    // one instead of firing late.
+    int64_t anchor = -1;
+    double spacing = 0.0;
+    if (clipScheduler != nullptr)
+        clipScheduler->getPublishedQuantizeGrid(anchor, spacing);
+
+    if (anchor < 0 || spacing <= 0.0 || cumulativeSamplePosition <= anchor)
+        return anchor >= 0 ? anchor : cumulativeSamplePosition;
+
+    const double elapsed = (double)(cumulativeSamplePosition - anchor);
+    const auto boundary = anchor + (juce::int64)std::round(std::ceil(elapsed / spacing) * spacing);
+    return std::max(boundary, cumulativeSamplePosition);
 }
 
-void SamplePlayerPlugin::setTargetStartSample(int64_t samplePos)
+void SamplePlayerPlugin::addLiveEvent(const LiveEvent& event)
 {
-    // Arming a new START cancels any previously queued STOP.  Without this, a
-    // stale targetStopSample left over from a scene transition (queued when this
-    // track was not yet playing) fires immediately after the new START triggers,
-    // silencing the sample before it outputs any audio.
-    targetStopSample.store(-1, std::memory_order_relaxed);
-    targetStartSample.store(samplePos, std::memory_order_relaxed);
+    if (numLiveEvents >= maxLiveEvents)
+    {
+        ++stats.liveEventsDropped;
+        retireSource(event.source);
+        return;
+    }
+
+    // Keep sorted by (sample, kind); equal keys stay in arrival order.
+    int index = numLiveEvents;
+    while (index > 0)
+    {
+        const auto& before = liveEvents[(size_t)(index - 1)];
+        if (before.sample < event.sample || (before.sample == event.sample && before.kind <= event.kind))
+            break;
+        liveEvents[(size_t)index] = before;
+        --index;
+    }
+
+    liveEvents[(size_t)index] = event;
+    ++numLiveEvents;
 }
 
-void SamplePlayerPlugin::setTargetStopSample(int64_t samplePos)
+void SamplePlayerPlugin::removeLiveEvents(LiveEvent::Kind kind)
 {
-    targetStopSample.store(samplePos, std::memory_order_relaxed);
+    int kept = 0;
+    for (int i = 0; i < numLiveEvents; ++i)
+    {
+        auto& event = liveEvents[(size_t)i];
+        if (event.kind == kind)
+            retireSource(event.source);
+        else
+            liveEvents[(size_t)kept++] = event;
+    }
+    numLiveEvents = kept;
 }
 
-void SamplePlayerPlugin::setTargetMuteSample(int64_t samplePos)
+void SamplePlayerPlugin::clearLiveEvents()
 {
-    targetMuteSample.store(samplePos, std::memory_order_relaxed);
+    for (int i = 0; i < numLiveEvents; ++i)
+        retireSource(liveEvents[(size_t)i].source);
+    numLiveEvents = 0;
 }
 
-void SamplePlayerPlugin::setTargetUnmuteSample(int64_t samplePos)
+bool SamplePlayerPlugin::hasLiveEvent(LiveEvent::Kind kind) const
 {
-    targetUnmuteSample.store(samplePos, std::memory_order_relaxed);
+    for (int i = 0; i < numLiveEvents; ++i)
+        if (liveEvents[(size_t)i].kind == kind)
+            return true;
+    return false;
+}
+
+void SamplePlayerPlugin::applyTransportSync()
+{
+    const auto serial = syncSerial.load(std::memory_order_acquire);
+    if (serial == lastAppliedSyncSerial)
+        return;
+    lastAppliedSyncSerial = serial;
+
+    const double transportPositionBeats = syncTransportBeats.load(std::memory_order_relaxed);
+    const int    quantizeSteps          = syncQuantizeSteps.load(std::memory_order_relaxed);
+
+    if (!syncTransportPlaying.load(std::memory_order_relaxed))
+    {
+        lastTransportBeat = transportPositionBeats;
+        if (playing)
+        {
+            playing = false;
+            DBG("[SPP T" + juce::String(trackIndex) + "] STOPPED by transport (transportPlaying=false)"
+                + " at beat=" + juce::String(transportPositionBeats, 2));
+        }
+        return;
+    }
+
+    double beatsPerQuantize = quantizeSteps / 4.0;
+    int prevQuantize = (int)(lastTransportBeat / beatsPerQuantize);
+    int currQuantize = (int)(transportPositionBeats / beatsPerQuantize);
+    bool crossedBoundary = currQuantize > prevQuantize;
+
+    lastTransportBeat = transportPositionBeats;
+
+    if (!crossedBoundary && !needsImmediateStart)
+        return;
+
+    // Live-mode clips are handled sample-accurately by the event queue in
+    // renderBlock() — skip scene-mode boundary logic when that path is armed.
+    const bool livePathArmed = hasLiveEvent(LiveEvent::Kind::Start);
+    bool started = false;
+
+    if (!livePathArmed && queuedToPlay)
+    {
+        if (pendingSource != nullptr)
+        {
+            makeSourceActive(pendingSource);
+            pendingSource = nullptr;
+            samplesPlayedSinceStart = 0;
+            DBG("SamplePlayerPlugin: Seamless switch (scene) at beat "
+                + juce::String(currQuantize * beatsPerQuantize, 2));
+        }
+
+        if (activeSource != nullptr)
+        {
+            seekSource(queuedOffset);
+            startSource();
+            playing = true;
+            started = true;
+            DBG("SamplePlayerPlugin: Started (scene) at beat " + juce::String(currQuantize * beatsPerQuantize, 2));
+        }
+
+        queuedToPlay        = false;
+        needsImmediateStart = false;
+    }
+
+    const bool liveStopArmed = hasLiveEvent(LiveEvent::Kind::Stop);
+    if (queuedToStop && !liveStopArmed && !started)
+    {
+        if (playing)
+        {
+            playing = false;
+            if (activeSource != nullptr)
+                seekSource(0.0);
+            DBG("SamplePlayerPlugin: Stopped (scene) at beat " + juce::String(transportPositionBeats, 2));
+        }
+        queuedToStop        = false;
+        needsImmediateStart = false;
+    }
+
+    needsImmediateStart = false;
 }
 
 //==============================================================================
@@ -734,13 +956,20 @@ void SamplePlayerPlugin::setTargetUnmuteSample(int64_t samplePos)
 
 void SamplePlayerPlugin::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    juce::ScopedLock sl(lock);
+    // Not concurrent with processBlock(), but take syncLock anyway so a stray
+    // callback during a device restart skips rather than racing the transport.
+    const juce::ScopedLock sl(syncLock);
 
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
+    preparedSampleRate.store(sampleRate, std::memory_order_relaxed);
 
     transportSource.prepareToPlay(samplesPerBlock, sampleRate);
 
+    // The rate correction for the active source depends on the device rate.
+    if (activeSource != nullptr)
+        attachActiveSourceToTransport();
+
     // Reset the position counter.  All nodes in the graph get prepareToPlay
     // simultaneously, so starting at 0 keeps them synchronised.
     cumulativeSamplePosition = 0;
@@ -748,28 +977,52 @@ void SamplePlayerPlugin::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 void SamplePlayerPlugin::releaseResources()
 {
-    // releaseResources is called from the audio thread, so it's safe to call
-    // transportSource.releaseResources() directly without the message-thread lock.
     transportSource.releaseResources();
 }
 
 void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
                                        juce::MidiBuffer& /*midiMessages*/)
 {
-    // Snapshot the cumulative position BEFORE acquiring the lock so the
-    // atomic target comparisons use the same value that we use below.
-    const int64_t blockStart = cumulativeSamplePosition;
+    const int numSamples = buffer.getNumSamples();
 
-    juce::ScopedLock sl(lock);
+    // The only lock on this path, and it is never waited on: if the message
+    // thread is in the middle of a synchronous operation, output silence for
+    // this block and count it.
+    const juce::ScopedTryLock stl(syncLock);
+    if (!stl.isLocked())
+    {
+        ++stats.blocksSkippedForLock;
+        buffer.clear();
+        cumulativeSamplePosition += numSamples;
+        return;
+    }
 
-    buffer.clear();
+    processCommands();
+    applyTransportSync();
 
-    const int numSamples = buffer.getNumSamples();
+    // Snapshot the cumulative position so the event comparisons all use the
+    // same block start.
+    const int64_t blockStart = cumulativeSamplePosition;
 
     // Periodic state dump — once every ~200 blocks per track to reveal ongoing state.
     const int64_t blockIndex = (currentSampleRate > 0 && currentBlockSize > 0)
                                    ? blockStart / currentBlockSize
                                    : 0;
+
+    buffer.clear();
+    renderBlock(buffer, blockStart, blockIndex);
+
+    cumulativeSamplePosition += numSamples;
+    if (activeSource != nullptr)
+        positionSnapshot.store(getSourcePositionSeconds(), std::memory_order_relaxed);
+}
+
+void SamplePlayerPlugin::renderBlock(juce::AudioBuffer<float>& buffer,
+                                      int64_t blockStart,
+                                      int64_t blockIndex)
+{
+    const int numSamples = buffer.getNumSamples();
+
     if (blockIndex % 200 == 0)
     {
         /*
@@ -777,225 +1030,26 @@ void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
             + " playing=" + juce::String(playing ? 1 : 0)
             + " queuedPlay=" + juce::String(queuedToPlay ? 1 : 0)
             + " queuedStop=" + juce::String(queuedToStop ? 1 : 0)
-            + " hasPending=" + juce::String(hasPendingFile ? 1 : 0)
+            + " hasPending=" + juce::String(pendingSource != nullptr ? 1 : 0)
             + " sps=" + juce::String(samplesPlayedSinceStart)
             + " loopSamples=" + juce::String(loopLengthSamples)
-            + " bpm=" + juce::String(currentBpm, 1)
-            + " tStart=" + juce::String(targetStartSample.load(std::memory_order_relaxed))
-            + " tStop=" + juce::String(targetStopSample.load(std::memory_order_relaxed))
+            + " bpm=" + juce::String(currentBpm.load(), 1)
+            + " events=" + juce::String(numLiveEvents)
             + " cumPos=" + juce::String(blockStart));
             */
     }
 
     // =========================================================================
-    // Audio-thread quantize STOP
-    // =========================================================================
-    {
-        int64_t tStop = targetStopSample.load(std::memory_order_relaxed);
-        if (tStop >= 0 && playing)
-        {
-            // Is the stop boundary in this block (or already past)?
-            if (tStop <= blockStart + numSamples)
-            {
-                // How many samples of audio do we still owe before the stop?
-                int stopOffset = (int)std::max(int64_t(0), tStop - blockStart);
-                stopOffset = std::min(stopOffset, numSamples);
-
-                DBG("[SPP T" + juce::String(trackIndex) + "] STOP FIRED"
-                    + " tStop=" + juce::String(tStop)
-                    + " blockStart=" + juce::String(blockStart)
-                    + " stopOffset=" + juce::String(stopOffset)
-                    + " sps=" + juce::String(samplesPlayedSinceStart));
-
-                if (stopOffset > 0 && readerSource != nullptr)
-                {
-                    juce::AudioSourceChannelInfo info(&buffer, 0, stopOffset);
-                    transportSource.getNextAudioBlock(info);
-                    samplesPlayedSinceStart += stopOffset;
-                }
-
-                // Do NOT call transportSource.stop() here — it spin-waits up to 1 second
-                // on the audio thread waiting for stopped=true (which only getNextAudioBlock
-                // sets), stalling the entire audio graph.  Setting plugin playing=false is
-                // sufficient: future blocks return early without calling getNextAudioBlock.
-                // The transport's internal playing flag stays true but is harmless since we
-                // never call getNextAudioBlock again until the next START FIRED.
-                playing      = false;
-                queuedToStop = false;
-                targetStopSample.store(-1, std::memory_order_relaxed);
-                pendingStopNotification.store(true, std::memory_order_relaxed);
-
-                // Buffer already cleared; samples 0..stopOffset filled,
-                // stopOffset..numSamples are silent.
-                cumulativeSamplePosition += numSamples;
-                return;
-            }
-        }
-    }
-
+    // Audio-thread quantize events  (Live Mode start / stop / mute / unmute)
     // =========================================================================
-    // Audio-thread quantize START  (Live Mode seamless triggering)
-    // =========================================================================
-    {
-        int64_t tStart = targetStartSample.load(std::memory_order_relaxed);
-        if (tStart >= 0 && tStart <= blockStart + numSamples)
-        {
-            // The boundary falls in this block (or is already past — catch-up).
-            int triggerOffset = (int)std::max(int64_t(0), tStart - blockStart);
-            triggerOffset = std::min(triggerOffset, numSamples - 1);
-
-            DBG("[SPP T" + juce::String(trackIndex) + "] START FIRED"
-                + " tStart=" + juce::String(tStart)
-                + " blockStart=" + juce::String(blockStart)
-                + " triggerOffset=" + juce::String(triggerOffset)
-                + " hasPending=" + juce::String(hasPendingFile ? 1 : 0)
-                + " wasPlaying=" + juce::String(playing ? 1 : 0));
-
-            // --- Seamless switch: if we have a pending reader, play the old
-            //     source up to the trigger point then atomically switch. ---
-            if (hasPendingFile && pendingReaderSource != nullptr)
-            {
-                // Fill pre-trigger samples from the currently-playing source.
-                if (triggerOffset > 0 && playing && readerSource != nullptr)
-                {
-                    juce::AudioSourceChannelInfo oldInfo(&buffer, 0, triggerOffset);
-                    transportSource.getNextAudioBlock(oldInfo);
-                    samplesPlayedSinceStart += triggerOffset;
-                }
-
-                // Release old reader before touching cachedMemoryBlock.
-                // Do NOT call transportSource.stop() here — spin-wait on audio thread.
-                // setSource(nullptr) internally sets playing=false under callbackLock
-                // without any spin-wait, which is sufficient to stop the transport.
-                transportSource.setSource(nullptr);
-                readerSource.reset();
-                cachedMemoryBlock.reset();
-
-                // Promote pending source.
-                cachedMemoryBlock      = std::move(pendingMemoryBlock);
-                readerSource           = std::move(pendingReaderSource);
-                currentFilePath        = pendingFilePath;
-                fileSampleRate         = pendingFileSampleRate;
-                fileLengthSamples      = pendingFileLengthSamples;
-
-                hasPendingFile         = false;
-                pendingFilePath        = {};
-                pendingFileSampleRate  = 0.0;
-                pendingFileLengthSamples = 0;
-
-                if (auto* reader = readerSource->getAudioFormatReader())
-                {
-                    // setSource() calls source->prepareToPlay() internally when the
-                    // transport is already prepared — no heap allocation on the audio thread.
-                    transportSource.setSource(readerSource.get(), 0, nullptr,
-                                              reader->sampleRate, reader->numChannels);
-                }
-            }
-            else if (triggerOffset > 0 && playing && readerSource != nullptr)
-            {
-                // Same file re-trigger: fill pre-trigger samples from old position.
-                juce::AudioSourceChannelInfo oldInfo(&buffer, 0, triggerOffset);
-                transportSource.getNextAudioBlock(oldInfo);
-            }
-
-            // Start the new (or re-started) source at the trigger offset.
-            if (readerSource != nullptr)
-            {
-                transportSource.setPosition(queuedOffset);
-                transportSource.start();
-                playing              = true;
-                samplesPlayedSinceStart = 0;
-                queuedToPlay         = false;
-                needsImmediateStart  = false;
-
-                // Fill post-trigger samples from the new source.
-                int postSamples = numSamples - triggerOffset;
-                if (postSamples > 0)
-                {
-                    juce::AudioSourceChannelInfo newInfo(&buffer, triggerOffset, postSamples);
-                    transportSource.getNextAudioBlock(newInfo);
-                    samplesPlayedSinceStart += postSamples;
-                }
-            }
-            else
-            {
-                DBG("[SPP T" + juce::String(trackIndex) + "] START FIRED but readerSource is null — no audio!");
-            }
-
-            targetStartSample.store(-1, std::memory_order_relaxed);
-            pendingStartNotification.store(true, std::memory_order_relaxed);
-            cumulativeSamplePosition += numSamples;
-            return;
-        }
-    }
-
-    // =========================================================================
-    // Audio-thread quantize MUTE / UNMUTE  (Live Mode mute toggle)
-    // =========================================================================
-    // Muting keeps the transport running so loop position is preserved.
-    // When unmuted the audio resumes from exactly where it would be in the loop
-    // without any seeking or file reloading.
-    {
-        int64_t tMute = targetMuteSample.load(std::memory_order_relaxed);
-        if (tMute >= 0 && playing && !muted && tMute <= blockStart + numSamples)
-        {
-            DBG("[SPP T" + juce::String(trackIndex) + "] MUTE FIRED at cumPos=" + juce::String(blockStart));
-            muted = true;
-            targetMuteSample.store(-1, std::memory_order_relaxed);
-            pendingMuteNotification.store(true, std::memory_order_relaxed);
-        }
-
-        int64_t tUnmute = targetUnmuteSample.load(std::memory_order_relaxed);
-        if (tUnmute >= 0 && playing && muted && tUnmute <= blockStart + numSamples)
-        {
-            // Sample-accurate restart: advance the transport silently up to the
-            // trigger point (output is zeros anyway — muted), then start fresh audio
-            // from the trigger offset onwards.  Without this the full block would
-            // render from startOffset even if the trigger is mid-block.
-            int triggerOffset = (int)std::max(int64_t(0), tUnmute - blockStart);
-            triggerOffset = std::min(triggerOffset, numSamples);
-
-            DBG("[SPP T" + juce::String(trackIndex) + "] UNMUTE FIRED at cumPos=" + juce::String(blockStart)
-                + " triggerOffset=" + juce::String(triggerOffset) + " - restarting from beginning");
-
-            // Advance transport (discarded — buffer was cleared at block start; muted = zeros).
-            if (triggerOffset > 0 && readerSource != nullptr)
-            {
-                juce::AudioSourceChannelInfo silentInfo(&buffer, 0, triggerOffset);
-                transportSource.getNextAudioBlock(silentInfo);
-            }
-
-            // Restart from the beginning of the clip.
-            // Do NOT call transportSource.stop() — it spin-waits on the audio thread.
-            // The transport is already playing (mute keeps it running); setPosition()
-            // seeks to startOffset and the next getNextAudioBlock renders from there.
-            // Do NOT call transportSource.start() — already playing, start() is a no-op
-            // when internal playing=true, and the seek via setPosition is sufficient.
-            transportSource.setPosition(startOffset);
-            samplesPlayedSinceStart = 0;
-            muted = false;
-            targetUnmuteSample.store(-1, std::memory_order_relaxed);
-            pendingUnmuteNotification.store(true, std::memory_order_relaxed);
-
-            // Fill post-trigger audio from the restarted source.
-            int postSamples = numSamples - triggerOffset;
-            if (postSamples > 0 && readerSource != nullptr)
-            {
-                juce::AudioSourceChannelInfo newInfo(&buffer, triggerOffset, postSamples);
-                transportSource.getNextAudioBlock(newInfo);
-                samplesPlayedSinceStart += postSamples;
-            }
-
-            cumulativeSamplePosition += numSamples;
-            return;
-        }
-    }
+    if (renderLiveEvents(buffer, blockStart))
+        return;
 
     // =========================================================================
     // Normal playback (scene mode / already-running clips)
     // =========================================================================
 
-    if (!playing || readerSource == nullptr)
+    if (!playing || activeSource == nullptr)
     {
         // Log the first few times this track is silently not-playing, to catch
         // unexpected stops. Rate-limited to avoid flooding.
@@ -1004,27 +1058,32 @@ void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
             /*
             DBG("[SPP T" + juce::String(trackIndex) + "] SILENT"
                 + " playing=" + juce::String(playing ? 1 : 0)
-                + " hasSource=" + juce::String(readerSource != nullptr ? 1 : 0)
-                + " hasPending=" + juce::String(hasPendingFile ? 1 : 0)
+                + " hasSource=" + juce::String(activeSource != nullptr ? 1 : 0)
+                + " hasPending=" + juce::String(pendingSource != nullptr ? 1 : 0)
                 + " queuedPlay=" + juce::String(queuedToPlay ? 1 : 0)
-                + " tStart=" + juce::String(targetStartSample.load(std::memory_order_relaxed))
+                + " events=" + juce::String(numLiveEvents)
                 + " cumPos=" + juce::String(blockStart));
-              */  
+              */
         }
-        cumulativeSamplePosition += numSamples;
         return;
     }
 
     // Calculate loop length in samples if using beat-based looping.
-    if (loopEnabled && useBeatsForLoop && currentBpm > 0 && currentSampleRate > 0)
+    const double bpm = currentBpm.load(std::memory_order_relaxed);
+    const bool beatLooping = loopEnabled && useBeatsForLoop;
+
+    // Stretch the clip to the current tempo (bypassed at the tempo it was loaded at).
+    applyTempoFollow(bpm);
+
+    if (beatLooping && bpm > 0 && currentSampleRate > 0)
     {
-        double secondsPerBeat = 60.0 / currentBpm;
-        double loopLengthSeconds = loopLengthBeats * secondsPerBeat;
+        double secondsPerBeat = 60.0 / bpm;
+        double loopLengthSeconds = loopLengthBeats.load(std::memory_order_relaxed) * secondsPerBeat;
         loopLengthSamples = static_cast<juce::int64>(loopLengthSeconds * currentSampleRate);
     }
 
     // Sample-accurate looping.
-    if (loopEnabled && useBeatsForLoop && loopLengthSamples > 0)
+    if (beatLooping && loopLengthSamples > 0)
     {
         juce::int64 samplesRemainingInLoop = loopLengthSamples - samplesPlayedSinceStart;
 
@@ -1033,15 +1092,15 @@ void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
             DBG("[SPP T" + juce::String(trackIndex) + "] LOOP WRAP (overrun)"
                 + " sps=" + juce::String(samplesPlayedSinceStart)
                 + " loopSamples=" + juce::String(loopLengthSamples)
-                + " bpm=" + juce::String(currentBpm, 1)
+                + " bpm=" + juce::String(bpm, 1)
                 + " cumPos=" + juce::String(blockStart));
             // Seek back to loop start. Do NOT call transportSource.stop() — it
             // spin-waits up to 1 second on the audio thread, stalling all tracks.
             // setPosition() seeks safely while playing; if the transport internally
             // stopped at EOF, start() will re-arm it without any spin-wait.
-            transportSource.setPosition(startOffset);
-            if (!transportSource.isPlaying())
-                transportSource.start();
+            seekSource(startOffset);
+            if (!sourceIsPlaying())
+                startSource();
             samplesPlayedSinceStart = 0;
         }
         else if (samplesRemainingInLoop < numSamples)
@@ -1050,48 +1109,36 @@ void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
                 + " sps=" + juce::String(samplesPlayedSinceStart)
                 + " remaining=" + juce::String(samplesRemainingInLoop)
                 + " loopSamples=" + juce::String(loopLengthSamples)
-                + " bpm=" + juce::String(currentBpm, 1)
+                + " bpm=" + juce::String(bpm, 1)
                 + " cumPos=" + juce::String(blockStart));
 
             int samplesToPlay = static_cast<int>(samplesRemainingInLoop);
 
-            juce::AudioSourceChannelInfo partialInfo(&buffer, 0, samplesToPlay);
-            transportSource.getNextAudioBlock(partialInfo);
+            renderSegment(buffer, 0, samplesToPlay);
 
             // Seek back to loop start — same as the overrun path above.
-            transportSource.setPosition(startOffset);
-            if (!transportSource.isPlaying())
-                transportSource.start();
+            seekSource(startOffset);
+            if (!sourceIsPlaying())
+                startSource();
 
             int remainingSamples = numSamples - samplesToPlay;
-            if (remainingSamples > 0)
-            {
-                juce::AudioSourceChannelInfo remainingInfo(&buffer, samplesToPlay, remainingSamples);
-                transportSource.getNextAudioBlock(remainingInfo);
-            }
+            renderSegment(buffer, samplesToPlay, remainingSamples);
 
             samplesPlayedSinceStart = remainingSamples;
-            if (muted) buffer.clear();
-            cumulativeSamplePosition += numSamples;
             return;
         }
     }
 
-    juce::AudioSourceChannelInfo info(&buffer, 0, numSamples);
-    transportSource.getNextAudioBlock(info);
-    samplesPlayedSinceStart += numSamples;
+    // If muted, this only advances the position, so the loop position stays
+    // correct and unmuting will resume audio seamlessly.
+    renderSegment(buffer, 0, numSamples);
 
-    if (!loopEnabled && !transportSource.isPlaying())
+    if (!loopEnabled && !sourceIsPlaying())
     {
         playing = false;
         DBG("[SPP T" + juce::String(trackIndex) + "] Playback ended naturally (non-looping)");
     }
 
-    // If muted, silence the output — the transport has still advanced so the loop
-    // position is correct and unmuting will resume audio seamlessly.
-    if (muted)
-        buffer.clear();
-
     // Spot-check: log when a playing, non-muted track outputs all-zero audio.
     if (!muted && blockIndex % 20 == 0)
     {
@@ -1104,12 +1151,152 @@ void SamplePlayerPlugin::processBlock(juce::AudioBuffer<float>& buffer,
             DBG("[SPP T" + juce::String(trackIndex) + "] OUTPUT SILENT (rms~0 but playing=1)"
                 + " sps=" + juce::String(samplesPlayedSinceStart)
                 + " loopSamples=" + juce::String(loopLengthSamples)
-                + " tsPlaying=" + juce::String(transportSource.isPlaying() ? 1 : 0)
+                + " tsPlaying=" + juce::String(sourceIsPlaying() ? 1 : 0)
                 + " cumPos=" + juce::String(blockStart));
         }
     }
+}
 
-    cumulativeSamplePosition += numSamples;
+bool SamplePlayerPlugin::renderLiveEvents(juce::AudioBuffer<float>& buffer, int64_t blockStart)
+{
+    const int numSamples = buffer.getNumSamples();
+    const int64_t blockEnd = blockStart + numSamples;
+
+    if (numLiveEvents == 0 || liveEvents[0].sample >= blockEnd)
+        return false;
+
+    applyTempoFollow(currentBpm.load(std::memory_order_relaxed));
+
+    // Each due event splits the block: the state before it renders up to its
+    // sample, then it fires.  Events already in the past (late commands,
+    // skipped blocks) fire at the start of the block.
+    int rendered = 0;
+    bool firedStart = false, firedStop = false;
+    while (numLiveEvents > 0 && liveEvents[0].sample < blockEnd)
+    {
+        const LiveEvent event = liveEvents[0];
+        std::move(liveEvents.begin() + 1, liveEvents.begin() + numLiveEvents, liveEvents.begin());
+        --numLiveEvents;
+
+        const int offset = (int)juce::jlimit<int64_t>(rendered, numSamples, event.sample - blockStart);
+        renderSegment(buffer, rendered, offset - rendered);
+        rendered = offset;
+
+        DBG("[SPP T" + juce::String(trackIndex) + "] EVENT " + juce::String((int)event.kind)
+            + " at=" + juce::String(event.sample)
+            + " blockStart=" + juce::String(blockStart)
+            + " offset=" + juce::String(offset)
+            + " wasPlaying=" + juce::String(playing ? 1 : 0));
+
+        fireLiveEvent(event);
+        firedStart = firedStart || event.kind == LiveEvent::Kind::Start;
+        firedStop  = firedStop  || event.kind == LiveEvent::Kind::Stop;
+    }
+
+    renderSegment(buffer, rendered, numSamples - rendered);
+
+    // Only clear the flags for events that fired here and have no successor
+    // queued; a play or stop queued through the transport path keeps its flag.
+    if (firedStart && !hasLiveEvent(LiveEvent::Kind::Start))
+        queuedToPlay = false;
+    if (firedStop && !hasLiveEvent(LiveEvent::Kind::Stop))
+        queuedToStop = false;
+    return true;
+}
+
+void SamplePlayerPlugin::renderSegment(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (numSamples <= 0 || !playing || activeSource == nullptr)
+        return;
+
+    samplesPlayedSinceStart += numSamples;
+
+    if (voiceRendering)
+    {
+        // Muted: an O(1) position update; the block was cleared in processBlock().
+        if (muted)
+            activeSource->voice->advance(numSamples);
+        else
+            activeSource->voice->render(buffer, startSample, numSamples);
+        return;
+    }
+
+    // Muted segments still advance the transport so the loop position is kept.
+    juce::AudioSourceChannelInfo info(&buffer, startSample, numSamples);
+    transportSource.getNextAudioBlock(info);
+
+    if (muted)
+        buffer.clear(startSample, numSamples);
+}
+
+void SamplePlayerPlugin::fireLiveEvent(const LiveEvent& event)
+{
+    switch (event.kind)
+    {
+        case LiveEvent::Kind::Start:
+        {
+            // Seamless switch: the old source has played up to this point; the
+            // old one goes back to the message thread for destruction.
+            if (event.source != nullptr)
+            {
+                makeSourceActive(event.source);
+            }
+            else if (pendingSource != nullptr)
+            {
+                makeSourceActive(pendingSource);
+                pendingSource = nullptr;
+            }
+
+            if (activeSource == nullptr)
+            {
+                DBG("[SPP T" + juce::String(trackIndex) + "] START FIRED but no source — no audio!");
+                break;
+            }
+
+            startOffset  = event.offsetSeconds;
+            queuedOffset = event.offsetSeconds;
+            seekSource(event.offsetSeconds);
+            startSource();
+            playing                 = true;
+            samplesPlayedSinceStart = 0;
+            needsImmediateStart     = false;
+            pendingStartNotification.store(true, std::memory_order_relaxed);
+            break;
+        }
+
+        case LiveEvent::Kind::Stop:
+            if (!playing)
+                break;
+
+            // Do NOT call transportSource.stop() here — it spin-waits up to 1 second
+            // on the audio thread waiting for stopped=true (which only getNextAudioBlock
+            // sets), stalling the entire audio graph.  Setting plugin playing=false is
+            // sufficient: later segments render nothing until the next start.
+            playing = false;
+            pendingStopNotification.store(true, std::memory_order_relaxed);
+            break;
+
+        case LiveEvent::Kind::Mute:
+            // Muting keeps the transport running so loop position is preserved.
+            if (!playing || muted)
+                break;
+            muted = true;
+            pendingMuteNotification.store(true, std::memory_order_relaxed);
+            break;
+
+        case LiveEvent::Kind::Unmute:
+            if (!playing || !muted)
+                break;
+
+            // Restart from the beginning of the clip.  The transport is already
+            // playing (mute keeps it running), so the seek alone is enough —
+            // no stop()/start() on the audio thread.
+            seekSource(startOffset);
+            samplesPlayedSinceStart = 0;
+            muted = false;
+            pendingUnmuteNotification.store(true, std::memory_order_relaxed);
+            break;
+    }
 }
 
 //==============================================================================
@@ -1117,7 +1304,7 @@ void SamplePlayerPlugin::getStateInformation(juce::MemoryBlock& destData)
 {
     // Save current file path and settings
     juce::MemoryOutputStream stream(destData, true);
-    stream.writeString(currentFilePath);
+    stream.writeString(getCurrentFilePath());
     stream.writeDouble(loopLengthBeats);
     stream.writeBool(loopEnabled);
     stream.writeBool(useBeatsForLoop);
@@ -1143,8 +1330,6 @@ void SamplePlayerPlugin::setStateInformation(const void* data, int sizeInBytes)
 
 bool SamplePlayerPlugin::loadFileForEditing(const juce::String& filePath)
 {
-    juce::ScopedLock sl(lock);
-
     if (!sampleEditor)
         sampleEditor = std::make_unique<SampleEditor>();
 
@@ -1174,15 +1359,10 @@ bool SamplePlayerPlugin::loadFileForEditing(const juce::String& filePath)
 
 void SamplePlayerPlugin::discardEdits()
 {
-    // Read currentFilePath under lock, then call loadFile() outside lock.
-    // loadFile() calls transportSource.stop() which must not be inside a lock.
-    juce::String pathToReload;
-    {
-        juce::ScopedLock sl(lock);
-        if (sampleEditor)
-            sampleEditor->clear();
-        pathToReload = currentFilePath;
-    }
+    if (sampleEditor)
+        sampleEditor->clear();
+
+    juce::String pathToReload = getCurrentFilePath();
 
     if (pathToReload.isNotEmpty())
     {
@@ -1196,19 +1376,22 @@ void SamplePlayerPlugin::discardEdits()
 
 void SamplePlayerPlugin::releaseFileHandle()
 {
-    // Stop transport BEFORE the lock (same deadlock-prevention pattern as stop/loadFile).
-    transportSource.stop();
-    transportSource.setSource(nullptr);
-
+    // The caller is about to overwrite the file, so the reader must be closed
+    // before we return — posting a command and hoping the audio thread gets to
+    // it is not enough (and it never will if the device is stopped).
+    //
+    // Lock the audio thread out (processBlock only try-locks and skips a block
+    // if we hold this), then apply every queued command here in order, so the
+    // FIFO still has exactly one consumer at a time.
     {
-        juce::ScopedLock sl(lock);
-        // Stop playback and release the file reader so the file can be overwritten.
-        // Does NOT touch sampleEditor — the in-memory buffer is preserved.
-        playing = false;
-        readerSource.reset();
-        cachedMemoryBlock.reset();
+        const juce::ScopedLock sl(syncLock);
+        processCommands();   // drain first so the post below cannot find the FIFO full
+        postCommand(Command::Type::ReleaseSource);
+        processCommands();
     }
 
+    // Destroys the reader (and its file handle) on this thread.
+    releaseRetiredSources();
+
     DBG("SamplePlayerPlugin: Released file handle");
 }
-
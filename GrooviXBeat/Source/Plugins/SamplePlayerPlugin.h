@@ -2,17 +2,37 @@
     SamplePlayerPlugin - Internal audio processor for sample playback
 
     Features:
-    - Load and play audio files (wav, mp3, aiff, flac, ogg)
+    - Load and play audio files (wav, mp3, aiff, flac, ogg); WAV/AIFF play
+      from a memory map, other formats are decoded or streamed
     - Immediate or quantized (queued) playback for Live Mode
     - Transport-synced looping
+    - Cached (in-memory) clips render through SampleVoice, straight from the
+      shared buffer; muted clips just advance their position
     - Per-track instance allows individual effects chains
     - In-memory editable buffer support for sample editing
+
+    Threading:
+    - All control calls come from the message thread. They never touch the
+      transport directly; they post a Command into a single-producer /
+      single-consumer FIFO that processBlock() drains at the top of each block.
+    - State the audio thread owns (playing, queued, muted, position...) is
+      published through atomics so queries never take a lock.
+    - Sources replaced on the audio thread are handed back through a second
+      FIFO and destroyed on the message thread.
 */
 
 #pragma once
 
 #include <JuceHeader.h>
 #include "../Audio/SampleEditor.h"
+#include "../Audio/SharedSampleBuffer.h"
+#include "../Audio/StreamingSampleSource.h"
+#include "../Audio/MappedSampleSource.h"
+#include "../Audio/TempoStretchSource.h"
+#include "../Audio/SampleVoice.h"
+
+// Forward declaration to avoid circular includes
+class MidiClipScheduler;
 
 class SamplePlayerPlugin : public juce::AudioProcessor
 {
@@ -23,16 +43,24 @@ public:
     //==============================================================================
     // Sample Control API (called from SamplePlayerManager)
 
-    /** Load an audio file. Returns true on success. */
-    bool loadFile(const juce::String& filePath);
+    /**
+     * Load an audio file. Returns true on success.
+     * Long files are streamed from disk on the shared streaming thread; the
+     * read-ahead is sized from the current loop length, and the first part of
+     * the loop starting at loopStartSeconds is kept in memory so beat-loop
+     * wraps never wait for the disk.
+     */
+    bool loadFile(const juce::String& filePath, double loopStartSeconds = 0.0);
 
     /**
      * Load from a pre-cached audio buffer (for Live Mode instant playback).
-     * The buffer is copied, so the original can be safely modified.
+     * The buffer is shared, not copied: the player holds a reference and reads
+     * the decoded data directly.  playLengthSamples (in buffer samples) plays
+     * the buffer truncated or silence-padded to that length; negative plays it all.
      */
     bool loadFromCachedBuffer(const juce::String& filePath,
-                              const juce::AudioBuffer<float>& cachedBuffer,
-                              double sampleRate);
+                              SharedSampleBuffer::Ptr cachedBuffer,
+                              juce::int64 playLengthSamples = -1);
 
     /** Start playback immediately */
     void play(double offsetSeconds = 0.0);
@@ -60,11 +88,12 @@ public:
     /**
      * Load from a cached buffer for pending playback in Live Mode.
      * Same as loadFileForPendingPlay but uses pre-loaded buffer instead of reading from disk.
+     * playLengthSamples works as in loadFromCachedBuffer().
      */
     bool loadCachedBufferForPendingPlay(const juce::String& filePath,
-                                         const juce::AudioBuffer<float>& cachedBuffer,
-                                         double sampleRate,
-                                         double offsetSeconds = 0.0);
+                                         SharedSampleBuffer::Ptr cachedBuffer,
+                                         double offsetSeconds = 0.0,
+                                         juce::int64 playLengthSamples = -1);
 
     /** Queue stop at next quantization boundary */
     void queueStop();
@@ -79,7 +108,17 @@ public:
     void setLoopLengthSeconds(double seconds);
 
     /**
-     * Sync with transport - call from audio thread
+     * Follow the transport tempo in real time (on by default).  A clip plays at
+     * its own speed at the BPM it was loaded at; when the tempo changes, it is
+     * time-stretched (WSOLA, pitch preserved) so it stays in sync without being
+     * re-triggered.  Speed is limited to TempoStretchSource::minSpeed..maxSpeed.
+     */
+    void setTempoFollow(bool shouldFollow) { tempoFollow.store(shouldFollow, std::memory_order_relaxed); }
+    bool isTempoFollowing() const { return tempoFollow.load(std::memory_order_relaxed); }
+
+    /**
+     * Publish the transport state.  Called from the message thread (MidiBridge timer);
+     * the quantize-boundary logic itself runs on the audio thread in processBlock().
      * @param transportPositionBeats Current transport position in quarter notes
      * @param bpm Current tempo
      * @param quantizeSteps Quantization in 1/16th notes (e.g., 16 = 1 bar)
@@ -93,11 +132,13 @@ public:
     //==============================================================================
     // State Queries
 
+    // Audio-thread state as of the last processed block (commands posted since
+    // then are not reflected until the next block).
     bool isCurrentlyPlaying() const { return playing; }
     bool isQueued() const { return queuedToPlay || queuedToStop; }
     bool isQueuedToPlay() const { return queuedToPlay; }
     bool isQueuedToStop() const { return queuedToStop; }
-    juce::String getCurrentFilePath() const { return currentFilePath; }
+    juce::String getCurrentFilePath() const;
     double getLengthInSeconds() const;
 
     /** Check if player has a valid source ready for playback */
@@ -111,35 +152,66 @@ public:
     /**
      * Synchronise the internal cumulative-sample counter with the audio engine.
      * Must be called (from the message thread) after resetForLiveMode() and before
-     * the first live-mode audio block, so targetStartSample comparisons are valid.
+     * the first live-mode audio block, so scheduled event times are valid.
      */
     void setCumulativePosition(int64_t pos);
 
+    //==============================================================================
+    // Live Mode event queue
+    //
+    // Start / stop / mute / unmute are timestamped events in a queue that only
+    // the audio thread touches (they travel there through the command FIFO).
+    // Events fire in sample order, several per block if need be, so quick
+    // successive launches are played in turn instead of overwriting each other.
+
     /**
-     * Set the absolute audio-thread sample position at which to start playback.
-     * The pending file/buffer must already be loaded before calling this.
-     * Checked on the audio thread in processBlock(); pass -1 to clear/disable.
+     * Event time meaning "the next quantize boundary at or after the block in
+     * which the audio thread receives the event".  Resolving it there, against
+     * the audio thread's own position, means a command that arrives late still
+     * lands on a boundary instead of firing off the grid.
      */
-    void setTargetStartSample(int64_t samplePos);
+    static constexpr juce::int64 atNextBoundary = -2;
 
     /**
-     * Set the absolute audio-thread sample position at which to stop playback.
-     * Checked on the audio thread in processBlock(); pass -1 to clear/disable.
+     * The scheduler whose quantize grid resolves atNextBoundary (see
+     * MidiClipScheduler::getPublishedQuantizeGrid()).  Set after construction,
+     * before the player is added to the graph.  Without a grid,
+     * atNextBoundary events fire at the start of the next block.
      */
-    void setTargetStopSample(int64_t samplePos);
+    void setClipScheduler(const MidiClipScheduler* scheduler) { clipScheduler = scheduler; }
 
-    /** Consume pending live-mode start/stop notifications (call from message thread). */
-    bool consumeStartNotification() { return pendingStartNotification.exchange(false, std::memory_order_relaxed); }
-    bool consumeStopNotification()  { return pendingStopNotification.exchange(false, std::memory_order_relaxed); }
+    /**
+     * Schedule a (re)start of the current source at samplePos (absolute, or
+     * atNextBoundary).  Cancels any stop still queued.
+     */
+    void scheduleStart(juce::int64 samplePos, double offsetSeconds = 0.0);
 
     /**
-     * Queue a sample-accurate mute or unmute at the given absolute sample position.
+     * Schedule a seamless switch to a cached buffer: the current source keeps
+     * playing up to samplePos, where the new one starts.  Cancels any stop still
+     * queued.  playLengthSamples works as in loadFromCachedBuffer().
+     */
+    bool scheduleCachedBufferStart(const juce::String& filePath,
+                                   SharedSampleBuffer::Ptr cachedBuffer,
+                                   juce::int64 samplePos,
+                                   double offsetSeconds = 0.0,
+                                   juce::int64 playLengthSamples = -1);
+
+    /** Schedule a stop at samplePos (absolute, or atNextBoundary). */
+    void scheduleStop(juce::int64 samplePos);
+
+    /**
+     * Schedule a sample-accurate mute or unmute at samplePos (absolute, or atNextBoundary).
      * In muted state the transport continues running (loop wraps still fire) but the
      * output buffer is silenced — so unmuting resumes audio seamlessly from the correct
      * loop position without any seeking or file reloading.
      */
-    void setTargetMuteSample(int64_t samplePos);
-    void setTargetUnmuteSample(int64_t samplePos);
+    void scheduleMute(juce::int64 samplePos);
+    void scheduleUnmute(juce::int64 samplePos);
+
+    /** Consume pending live-mode start/stop notifications (call from message thread). */
+    bool consumeStartNotification() { return pendingStartNotification.exchange(false, std::memory_order_relaxed); }
+    bool consumeStopNotification()  { return pendingStopNotification.exchange(false, std::memory_order_relaxed); }
 
     bool consumeMuteNotification()   { return pendingMuteNotification.exchange(false, std::memory_order_relaxed); }
     bool consumeUnmuteNotification() { return pendingUnmuteNotification.exchange(false, std::memory_order_relaxed); }
@@ -161,15 +233,44 @@ public:
     /** Discard edits and return to file-based playback */
     void discardEdits();
 
-    /** Release file handle (readerSource/transportSource) without clearing the editor.
-     *  Call before overwriting the file on disk, then call loadFile() after. */
+    /** Release file handle (current source/transportSource) without clearing the editor.
+     *  Call before overwriting the file on disk, then call loadFile() after.
+     *  Synchronous: the reader is closed by the time this returns. */
     void releaseFileHandle();
 
+    //==============================================================================
+    // Real-time diagnostics
+
+    /**
+     * Counters for the places where the message and audio threads can still
+     * interfere with each other.  Written lock-free; safe to read from any thread.
+     */
+    struct RealtimeStats
+    {
+        std::atomic<juce::uint64> commandsPosted        { 0 };
+        std::atomic<juce::uint64> commandsProcessed     { 0 };
+        std::atomic<juce::uint64> commandQueueFull      { 0 };  // post dropped: FIFO full (audio not running?)
+        std::atomic<juce::uint64> blocksSkippedForLock  { 0 };  // processBlock found syncLock held
+        std::atomic<juce::uint64> sourcesFreedOnAudioThread { 0 };  // retire FIFO was full
+        std::atomic<juce::uint64> streamUnderruns       { 0 };  // blocks a streamed file had no data for
+        std::atomic<juce::uint64> liveEventsDropped     { 0 };  // event queue full
+        std::atomic<int>          maxCommandsPerBlock   { 0 };
+    };
+
+    const RealtimeStats& getRealtimeStats() const { return stats; }
+
+    /** Destroy sources the audio thread has finished with.  Message thread only;
+     *  also done automatically whenever a command is posted. */
+    void releaseRetiredSources();
+
     //==============================================================================
     // Track assignment
     void setTrackIndex(int index) { trackIndex = index; }
     int getTrackIndex() const { return trackIndex; }
 
+    /** Sample rate from the last prepareToPlay(), or 0 if never prepared.  Any thread. */
+    double getPreparedSampleRate() const { return preparedSampleRate.load(std::memory_order_relaxed); }
+
     //==============================================================================
     // AudioProcessor Implementation
 
@@ -196,21 +297,126 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
 private:
+    //==============================================================================
+    // A playable source plus the metadata the message thread needs for queries.
+    // Created on the message thread, owned by the audio thread once posted, and
+    // handed back through retireFifo to be destroyed on the message thread.
+    struct LoadedSource
+    {
+        std::unique_ptr<juce::PositionableAudioSource> source;
+        juce::String filePath;
+        double sampleRate = 44100.0;
+        juce::int64 lengthSamples = 0;
+        int numChannels = 2;
+
+        // Tempo following: the stage at the top of the source chain (owned by
+        // source) and the BPM the clip was loaded at, which plays at speed 1.
+        TempoStretchSource* stretch = nullptr;
+        double referenceBpm = 0.0;
+
+        // In-memory clips only: renders the same data without the transport
+        // chain.  Used whenever the tempo stretch is bypassed.
+        std::unique_ptr<SampleVoice> voice;
+    };
+
+    // Message thread -> audio thread.  Plain data so it can live in a FIFO slot.
+    struct Command
+    {
+        enum class Type
+        {
+            SetSource,          // replace the current source (source may be nullptr)
+            SetPendingSource,   // stage a source for a seamless switch at the next boundary
+            Play,               // value = offset seconds
+            Stop,
+            QueuePlay,          // value = offset seconds
+            QueueStop,
+            CancelQueue,
+            ApplyLoopMode,      // push loopEnabled/useBeatsForLoop into the sources
+            SetPosition,        // value = seconds
+            SetCumulativePosition,
+            ResetForLiveMode,
+            ReleaseSource,      // stop and drop the current source, keep the pending one
+            ScheduleStart,      // position = event time, value = offset seconds, source = switch to (may be nullptr)
+            ScheduleStop,       // position = event time
+            ScheduleMute,
+            ScheduleUnmute
+        };
+
+        Type type = Type::Stop;
+        double value = 0.0;
+        juce::int64 position = 0;
+        LoadedSource* source = nullptr;
+    };
+
+    // A timestamped Live Mode event.  Lives in the audio-thread queue; owns
+    // source until it fires (or is cancelled and retired).
+    struct LiveEvent
+    {
+        // Also the order of events due at the same sample.
+        enum class Kind { Stop, Start, Mute, Unmute };
+
+        Kind kind = Kind::Start;
+        juce::int64 sample = 0;          // absolute audio-thread position (resolved)
+        double offsetSeconds = 0.0;      // Start: position in the clip
+        LoadedSource* source = nullptr;  // Start: source to switch to (nullptr = restart current)
+    };
+
+    // Disk streaming.  The read-ahead covers one loop (clamped), the pinned head
+    // covers the loop start; files no longer than both together are simply
+    // decoded into memory.
+    static constexpr double minReadAheadSeconds     = 2.0;
+    static constexpr double maxReadAheadSeconds     = 10.0;
+    static constexpr double defaultReadAheadSeconds = 4.0;
+    static constexpr double maxLoopHeadSeconds      = 2.0;
+
+    static constexpr int commandQueueSize = 256;
+    static constexpr int retireQueueSize  = commandQueueSize * 2;
+    static constexpr int maxLiveEvents    = 32;
+
     //==============================================================================
     int trackIndex = 0;
 
     juce::AudioFormatManager formatManager;
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
-    juce::AudioTransportSource transportSource;
-
-    // File info
-    juce::String currentFilePath;
-    double fileSampleRate = 44100.0;
-    juce::int64 fileLengthSamples = 0;
+    juce::AudioTransportSource transportSource;   // audio thread only (plus prepare/release)
+    juce::SharedResourcePointer<SampleStreamingThread> streamingThread;
 
     // Sample editor (for waveform editing; edits are flushed to disk, not used for playback)
     std::unique_ptr<SampleEditor> sampleEditor;
 
+    //==============================================================================
+    // Command FIFO (single producer: message thread, single consumer: audio thread)
+    juce::AbstractFifo commandFifo { commandQueueSize };
+    std::array<Command, (size_t)commandQueueSize> commandBuffer;
+
+    // Retired sources (single producer: audio thread, single consumer: message thread)
+    juce::AbstractFifo retireFifo { retireQueueSize };
+    std::array<LoadedSource*, (size_t)retireQueueSize> retireBuffer {};
+
+    // Held by the message thread only for the rare operations that must be
+    // synchronous (releaseFileHandle).  processBlock() only ever try-locks it.
+    juce::CriticalSection syncLock;
+
+    RealtimeStats stats;
+
+    //==============================================================================
+    // Audio-thread owned sources
+    LoadedSource* activeSource  = nullptr;
+    LoadedSource* pendingSource = nullptr;
+
+    // Published for message-thread queries.  activeSourceSnapshot is only ever
+    // dereferenced on the message thread, which is also the only thread that
+    // deletes sources, so a pointer read here cannot dangle.
+    std::atomic<LoadedSource*> activeSourceSnapshot { nullptr };
+    std::atomic<double> positionSnapshot { 0.0 };
+    bool voiceRendering = false;   // audio thread: activeSource plays through its SampleVoice
+
+    // Message-thread view of sources still in flight: the source the last
+    // SetSource/ResetForLiveMode/ReleaseSource asked for, and how many of those
+    // the audio thread has applied so far.
+    LoadedSource* requestedSource = nullptr;
+    juce::uint32 postedSourceChanges = 0;
+    std::atomic<juce::uint32> appliedSourceChanges { 0 };
+
     // -------------------------------------------------------------------------
     // Audio-thread quantize triggering
     //
@@ -219,72 +425,99 @@ private:
     //   and re-synced from MidiBridge::getLatestAudioPosition() when entering
     //   Live Mode, so it stays aligned with MidiClipScheduler's block counter.
     //
-    // targetStartSample / targetStopSample: absolute sample positions at which to
-    //   fire a start or stop.  Written from the message thread (atomic), read and
-    //   cleared on the audio thread inside processBlock().  -1 = not armed.
-    // targetMuteSample / targetUnmuteSample: same mechanism for live-mode mute toggle.
+    // liveEvents: scheduled start/stop/mute/unmute, sorted by sample (then
+    //   Kind).  Audio thread only; filled from Schedule* commands.
+    //
+    // clipScheduler: source of the quantize grid used to resolve atNextBoundary.
     int64_t cumulativeSamplePosition = 0;
-    std::atomic<int64_t> targetStartSample  { -1 };
-    std::atomic<int64_t> targetStopSample   { -1 };
-    std::atomic<int64_t> targetMuteSample   { -1 };
-    std::atomic<int64_t> targetUnmuteSample { -1 };
+    std::array<LiveEvent, (size_t)maxLiveEvents> liveEvents {};
+    int numLiveEvents = 0;
+    const MidiClipScheduler* clipScheduler = nullptr;
     std::atomic<bool> pendingStartNotification  { false };
     std::atomic<bool> pendingStopNotification   { false };
     std::atomic<bool> pendingMuteNotification   { false };
     std::atomic<bool> pendingUnmuteNotification { false };
 
-    // Playback state
-    bool playing = false;
-    bool muted   = false;
-    bool loopEnabled = true;
+    // Playback state — written by the audio thread, read anywhere
+    std::atomic<bool> playing { false };
+    std::atomic<bool> muted   { false };
     double startOffset = 0.0;
 
-    // Live Mode state
-    bool queuedToPlay = false;
-    bool queuedToStop = false;
+    // Live Mode state — written by the audio thread, read anywhere
+    std::atomic<bool> queuedToPlay { false };
+    std::atomic<bool> queuedToStop { false };
     double queuedOffset = 0.0;
 
-    // Pending file for seamless Live Mode transitions
-    std::unique_ptr<juce::AudioFormatReaderSource> pendingReaderSource;
-    juce::String pendingFilePath;
-    double pendingFileSampleRate = 0.0;
-    juce::int64 pendingFileLengthSamples = 0;
-    bool hasPendingFile = false;
-
-    // MemoryBlocks that back WAV-in-memory readers (must outlive their reader/readerSource)
-    juce::MemoryBlock cachedMemoryBlock;
-    juce::MemoryBlock pendingMemoryBlock;
-
     // Flag to force immediate start on next sync (for first clip in Live Mode)
     bool needsImmediateStart = false;
 
-    // Loop settings (in beats, where 1 beat = 1 quarter note)
-    double loopLengthBeats = 16.0;  // Default 4 bars in 4/4
-    bool useBeatsForLoop = true;    // If false, use sample's natural length
+    // Loop settings (in beats, where 1 beat = 1 quarter note).
+    // Written by the message thread, read by the audio thread.
+    std::atomic<double> loopLengthBeats { 16.0 };  // Default 4 bars in 4/4
+    std::atomic<bool> loopEnabled { true };
+    std::atomic<bool> useBeatsForLoop { true };    // If false, use sample's natural length
 
-    // Sample-accurate loop tracking
+    // Sample-accurate loop tracking (audio thread)
     juce::int64 samplesPlayedSinceStart = 0;
     juce::int64 loopLengthSamples = 0;  // Calculated from loopLengthBeats and BPM
 
-    // Transport tracking for Live Mode
+    // Transport state published by syncToTransport() (message thread) and
+    // evaluated once per new serial on the audio thread.
+    std::atomic<double> syncTransportBeats { 0.0 };
+    std::atomic<int> syncQuantizeSteps { 16 };
+    std::atomic<bool> syncTransportPlaying { false };
+    std::atomic<juce::uint32> syncSerial { 0 };
+    juce::uint32 lastAppliedSyncSerial = 0;
+    std::atomic<double> currentBpm { 120.0 };
+    std::atomic<bool> tempoFollow { true };
+
+    // Transport tracking for Live Mode (audio thread)
     double lastTransportBeat = 0.0;
-    double sampleStartBeat = 0.0;   // Transport beat when sample started
-    double currentBpm = 120.0;
-    bool needsStartBeatInit = false; // Set when play() called, cleared when syncToTransport initializes sampleStartBeat
 
     // Prepared state
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
-
-    juce::CriticalSection lock;
+    std::atomic<double> preparedSampleRate { 0.0 };   // published copy of currentSampleRate
 
     //==============================================================================
-    // Encode an AudioBuffer as 32-bit float WAV into a MemoryBlock and return a reader.
-    // The MemoryBlock must outlive the returned reader.
-    static juce::AudioFormatReader* createWavReaderFromBuffer(
-        const juce::AudioBuffer<float>& buffer,
-        double sampleRate,
-        juce::MemoryBlock& destBlock);
+    // Message thread
+    bool postCommand(Command::Type type, double value = 0.0, juce::int64 position = 0,
+                     LoadedSource* source = nullptr);
+    LoadedSource* createFileSource(const juce::String& filePath, double loopStartSeconds);
+    LoadedSource* createBufferSource(const juce::String& filePath, SharedSampleBuffer::Ptr cachedBuffer,
+                                     juce::int64 playLengthSamples);
+    void addTempoStretch(LoadedSource& loaded);  // message thread, before posting
+    const LoadedSource* getVisibleSource() const;
+
+    // Audio thread (or message thread while holding syncLock)
+    void processCommands();
+    void applyCommand(const Command& command);
+    void applyTransportSync();
+    void makeSourceActive(LoadedSource* source);
+    void attachActiveSourceToTransport();
+    void retireSource(LoadedSource* source);
+    void applyLoopMode();
+    void applyTempoFollow(double bpm);
+    void renderBlock(juce::AudioBuffer<float>& buffer, int64_t blockStart, int64_t blockIndex);
+
+    // Live Mode event queue (audio thread)
+    juce::int64 resolveEventTime(juce::int64 samplePos) const;
+    void addLiveEvent(const LiveEvent& event);
+    void removeLiveEvents(LiveEvent::Kind kind);
+    void clearLiveEvents();
+    bool hasLiveEvent(LiveEvent::Kind kind) const;
+    bool renderLiveEvents(juce::AudioBuffer<float>& buffer, int64_t blockStart);
+    void renderSegment(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void fireLiveEvent(const LiveEvent& event);
+
+    // Active source playback (audio thread).  Seeks and starts go to both the
+    // voice and the transport; rendering uses the voice while voiceRendering,
+    // and the position is handed over when that changes.
+    void seekSource(double seconds);
+    void startSource();
+    bool sourceIsPlaying() const;
+    double getSourcePositionSeconds() const;
+    void updatePlaybackPath();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePlayerPlugin)
 };
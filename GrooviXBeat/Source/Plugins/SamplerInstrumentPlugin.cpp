@@ -124,10 +124,6 @@ void SamplerInstrumentPlugin::SamplerLoadThread::run()
     for (auto& pitchSamples : newSamples)
         pitchSamples.resize(numVelocities);
 
-    // A local format manager for the background thread
-    juce::AudioFormatManager bgFormatManager;
-    bgFormatManager.registerBasicFormats();
-
     int loadedCount = 0;
     int totalFiles = numPitches * numVelocities;
 
@@ -156,24 +152,15 @@ void SamplerInstrumentPlugin::SamplerLoadThread::run()
             if (!sampleFile.existsAsFile())
                 continue;
 
-            // Decode the MP3 file
-            std::unique_ptr<juce::AudioFormatReader> reader(
-                bgFormatManager.createReaderFor(sampleFile));
-
-            if (reader == nullptr)
-                continue;
-
+            // Decode the MP3 file, or share the copy another instance already loaded.
+            // Channels beyond stereo are ignored at render time.
             auto& sample = newSamples[p][v];
-            int numChannels = (int)reader->numChannels;
-            int numFrames = (int)reader->lengthInSamples;
+            sample.data = plugin.samplePool->get(sampleFile.getFullPathName());
 
-            // Limit to stereo
-            if (numChannels > 2)
-                numChannels = 2;
+            if (sample.data == nullptr)
+                continue;
 
-            sample.buffer.setSize(numChannels, numFrames);
-            reader->read(&sample.buffer, 0, numFrames, 0, true, numChannels > 1);
-            sample.sampleRate = reader->sampleRate;
+            sample.sampleRate = sample.data->getSampleRate();
 
             loadedCount++;
 
@@ -193,10 +180,10 @@ void SamplerInstrumentPlugin::SamplerLoadThread::run()
         return;
     }
 
-    // Swap data under lock
+    // Swap data under lock; the previous bank is released after it
     {
         juce::ScopedLock sl(plugin.dataLock);
-        plugin.samples = std::move(newSamples);
+        std::swap(plugin.samples, newSamples);
         plugin.config = newConfig;
         plugin.loaded = true;
 
@@ -205,6 +192,9 @@ void SamplerInstrumentPlugin::SamplerLoadThread::run()
             plugin.voices[i].active = false;
     }
 
+    newSamples.clear();
+    plugin.samplePool->purgeUnused();
+
     plugin.loading = false;
 
     DBG("SamplerLoadThread: Finished loading " + newConfig.name +
@@ -372,7 +362,7 @@ void SamplerInstrumentPlugin::startVoice(int voiceIndex, int pitch, int velocity
         return;
 
     auto& sample = samples[pitchIndex][velLayer];
-    if (sample.buffer.getNumSamples() == 0)
+    if (sample.data == nullptr || sample.data->getNumSamples() == 0)
         return;
 
     auto& voice = voices[voiceIndex];
@@ -436,14 +426,15 @@ void SamplerInstrumentPlugin::renderVoices(juce::AudioBuffer<float>& buffer,
         }
 
         auto& sample = samples[pitchIndex][voice.velocityLayer];
-        if (sample.buffer.getNumSamples() == 0)
+        if (sample.data == nullptr || sample.data->getNumSamples() == 0)
         {
             voice.active = false;
             continue;
         }
 
-        int sampleNumFrames = sample.buffer.getNumSamples();
-        int sampleNumChannels = sample.buffer.getNumChannels();
+        const auto& sampleBuffer = sample.data->getBuffer();
+        int sampleNumFrames = sampleBuffer.getNumSamples();
+        int sampleNumChannels = sampleBuffer.getNumChannels();
         int outputChannels = buffer.getNumChannels();
 
         for (int i = 0; i < numSamples; ++i)
@@ -469,8 +460,8 @@ void SamplerInstrumentPlugin::renderVoices(juce::AudioBuffer<float>& buffer,
                 // Use the last available channel if sample has fewer channels
                 int srcCh = juce::jmin(ch, sampleNumChannels - 1);
 
-                float s0 = sample.buffer.getSample(srcCh, pos0);
-                float s1 = sample.buffer.getSample(srcCh, pos1);
+                float s0 = sampleBuffer.getSample(srcCh, pos0);
+                float s1 = sampleBuffer.getSample(srcCh, pos1);
                 float interpolated = (float)(s0 + (s1 - s0) * frac);
 
                 buffer.addSample(ch, outIdx, interpolated * gain);
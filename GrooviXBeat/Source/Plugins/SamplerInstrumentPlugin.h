@@ -9,6 +9,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../Audio/SamplePool.h"
 
 class SamplerInstrumentPlugin : public juce::AudioProcessor
 {
@@ -77,10 +78,11 @@ private:
         std::vector<int> velocities;  // e.g., {15, 31, 47, 63, 79, 95, 111, 127}
     };
 
-    // A single decoded sample
+    // A single decoded sample, shared through the SamplePool with every
+    // other instance that loaded the same instrument
     struct SamplerSample
     {
-        juce::AudioBuffer<float> buffer;
+        SharedSampleBuffer::Ptr data;
         double sampleRate = 0.0;
     };
 
@@ -143,6 +145,7 @@ private:
 
     // Audio format manager for decoding MP3
     juce::AudioFormatManager formatManager;
+    juce::SharedResourcePointer<SamplePool> samplePool;
 
     // Track index this plugin is assigned to
     int trackIndex = -1;
@@ -422,17 +422,11 @@ void MidiBridge::queueSampleFileSeamless(int trackIndex, const juce::String& fil
 
     if (samplePlayerManager != nullptr)
     {
-        // Compute the exact quantize boundary sample so the audio thread can fire
-        // at the same sample position as MIDI clips.  Falls back to "next block"
-        // when no anchor is established yet (first clip in a session).
-        int64_t targetSample = getNextQuantizeBoundarySample();
-        if (targetSample < 0)
-            targetSample = getLatestAudioPosition(); // Fire at start of next audio block
-
-        DBG("MidiBridge::queueSampleFileSeamless - targetSample: " + juce::String(targetSample));
-
+        // The player's audio thread picks the boundary when the start reaches it,
+        // on the same grid as MIDI clips, so a late command cannot miss the bar.
+        // With no anchor yet (first clip in a session) it fires at the next block.
         samplePlayerManager->queueSampleFileSeamless(trackIndex, filePath, offset, loop,
-                                                      loopLengthBeats, targetSample);
+                                                      loopLengthBeats, SamplePlayerPlugin::atNextBoundary);
     }
     else
     {
@@ -442,19 +436,14 @@ void MidiBridge::queueSampleFileSeamless(int trackIndex, const juce::String& fil
 
 void MidiBridge::queueStopSample(int trackIndex)
 {
-    int64_t boundary = getNextQuantizeBoundarySample();
-    int64_t latest   = getLatestAudioPosition();
-    int64_t targetSample = (boundary >= 0) ? boundary : latest;
-
     DBG("[MidiBridge] queueStopSample T" + juce::String(trackIndex)
-        + " nextBoundary=" + juce::String(boundary)
-        + " latestAudioPos=" + juce::String(latest)
-        + " chosenTarget=" + juce::String(targetSample)
+        + " nextBoundary=" + juce::String(getNextQuantizeBoundarySample())
+        + " latestAudioPos=" + juce::String(getLatestAudioPosition())
         + " transportPlaying=" + juce::String(playing ? 1 : 0));
 
     if (samplePlayerManager != nullptr)
     {
-        samplePlayerManager->queueStopSample(trackIndex, targetSample);
+        samplePlayerManager->queueStopSample(trackIndex, SamplePlayerPlugin::atNextBoundary);
     }
 }
 
@@ -470,30 +459,20 @@ void MidiBridge::cancelQueuedSample(int trackIndex)
 
 void MidiBridge::queueMuteSample(int trackIndex)
 {
-    int64_t boundary = getNextQuantizeBoundarySample();
-    int64_t latest   = getLatestAudioPosition();
-    int64_t targetSample = (boundary >= 0) ? boundary : latest;
-
     DBG("[MidiBridge] queueMuteSample T" + juce::String(trackIndex)
-        + " nextBoundary=" + juce::String(boundary)
-        + " chosenTarget=" + juce::String(targetSample));
+        + " nextBoundary=" + juce::String(getNextQuantizeBoundarySample()));
 
     if (samplePlayerManager != nullptr)
-        samplePlayerManager->queueMuteSample(trackIndex, targetSample);
+        samplePlayerManager->queueMuteSample(trackIndex, SamplePlayerPlugin::atNextBoundary);
 }
 
 void MidiBridge::queueUnmuteSample(int trackIndex)
 {
-    int64_t boundary = getNextQuantizeBoundarySample();
-    int64_t latest   = getLatestAudioPosition();
-    int64_t targetSample = (boundary >= 0) ? boundary : latest;
-
     DBG("[MidiBridge] queueUnmuteSample T" + juce::String(trackIndex)
-        + " nextBoundary=" + juce::String(boundary)
-        + " chosenTarget=" + juce::String(targetSample));
+        + " nextBoundary=" + juce::String(getNextQuantizeBoundarySample()));
 
     if (samplePlayerManager != nullptr)
-        samplePlayerManager->queueUnmuteSample(trackIndex, targetSample);
+        samplePlayerManager->queueUnmuteSample(trackIndex, SamplePlayerPlugin::atNextBoundary);
 }
 
 void MidiBridge::triggerSampleScene(int sceneIndex, const juce::var& clipsArray)
@@ -615,18 +594,21 @@ void MidiBridge::preQueueSongScene(int sceneIndex,
     }
 
     songHasNextScene = true;
+    updatePinnedSongSamples();
 
     // Preload next-scene sample files into cache now, while the current scene is
     // still playing.  This way advanceSongScene() gets a cache-hit for every file
     // and queueSampleFileSeamless runs with no disk I/O — eliminating the late-start
     // problem where the last sample in the loop would miss its targetStartSample.
+    // Decoding runs on the preload pool so the message thread (and the UI) keep going,
+    // and leaves any Live Mode preload the user started running.
     if (samplePlayerManager != nullptr && !nextSceneSamples.empty())
     {
         juce::StringArray pathsToCache;
         for (const auto& s : nextSceneSamples)
             if (s.filePath.isNotEmpty())
                 pathsToCache.add(s.filePath);
-        samplePlayerManager->preloadSamplesForLiveMode(pathsToCache);
+        samplePlayerManager->prefetchSamples(pathsToCache);
     }
 
     DBG("MidiBridge::preQueueSongScene - scene " + juce::String(sceneIndex) +
@@ -637,12 +619,33 @@ void MidiBridge::preQueueSongScene(int sceneIndex,
 
 void MidiBridge::stopSongMode()
 {
+    ++songStartRequest;  // drops a startSong() still waiting for its preload
     inSongMode = false;
     songHasNextScene = false;
     clipScheduler.setSongMode(false);
+
+    currentSceneSamples.clear();
+    updatePinnedSongSamples();
+
     DBG("MidiBridge::stopSongMode");
 }
 
+void MidiBridge::updatePinnedSongSamples()
+{
+    if (samplePlayerManager == nullptr)
+        return;
+
+    juce::StringArray paths;
+    for (const auto& s : currentSceneSamples)
+        paths.addIfNotAlreadyThere(s.filePath);
+
+    if (songHasNextScene)
+        for (const auto& s : nextSceneSamples)
+            paths.addIfNotAlreadyThere(s.filePath);
+
+    samplePlayerManager->setPinnedSamples(paths);
+}
+
 void MidiBridge::setSongSceneChangedCallback(std::function<void(int)> callback)
 {
     songSceneChangedCallback = callback;
@@ -686,37 +689,34 @@ void MidiBridge::advanceSongScene()
 
     // 3. Transition samples: start new scene's tracks seamlessly and stop any old
     //    tracks that have no replacement — both at the same targetSample so the
-    //    cut is gapless.
+    //    cut is gapless.  The clips are prepared in parallel and committed together.
     if (samplePlayerManager != nullptr)
     {
-        int64_t targetSample = clipScheduler.getLatestAudioPosition();
-
-        // Build the set of tracks that will receive a new sample
-        std::set<int> nextTrackIndices;
+        std::vector<SamplePlayerManager::SceneLaunchClip> launchClips;
         for (const auto& sample : nextSceneSamples)
-            nextTrackIndices.insert(sample.trackIndex);
-
-        // Stop tracks NOT in the next scene at the same boundary (no-op if not playing)
-        for (int t : samplePlayerManager->getTrackIndices())
         {
-            if (nextTrackIndices.find(t) == nextTrackIndices.end())
-                samplePlayerManager->queueStopSample(t, targetSample);
+            SamplePlayerManager::SceneLaunchClip clip;
+            clip.trackIndex      = sample.trackIndex;
+            clip.filePath        = sample.filePath;
+            clip.offset          = sample.offset;
+            clip.loop            = sample.loop;
+            clip.loopLengthBeats = sample.loopLengthBeats;
+            launchClips.push_back(clip);
         }
 
-        // Start next scene's samples at that same boundary
-        for (auto& sample : nextSceneSamples)
-        {
-            samplePlayerManager->queueSampleFileSeamless(
-                sample.trackIndex, sample.filePath, sample.offset,
-                sample.loop, sample.loopLengthBeats, targetSample);
-        }
+        // Taken at the commit, once the clips are ready or their deadline passes
+        samplePlayerManager->launchScene(launchClips,
+                                         [this] { return clipScheduler.getLatestAudioPosition(); },
+                                         true);
     }
 
     // 4. Set up song mode for the new scene
     currentSongSceneDurationBeats = songNextSceneDurationBeats;
     songSceneStartTime = getCurrentTime();  // reset wall-clock reference for new scene
     int advancedToScene = songNextSceneIndex;
+    currentSceneSamples = nextSceneSamples;
     songHasNextScene = false;
+    updatePinnedSongSamples();
 
     if (songNextSceneDurationBeats > 0.0)
     {
@@ -751,6 +751,7 @@ void MidiBridge::loadNextSceneFromQueue()
     if (songSceneQueue.empty() || nextIdx >= (int)songSceneQueue.size())
     {
         songHasNextScene = false;
+        updatePinnedSongSamples();
         DBG("MidiBridge::loadNextSceneFromQueue - no more scenes (queue exhausted)");
         return;
     }
@@ -761,16 +762,18 @@ void MidiBridge::loadNextSceneFromQueue()
     nextSceneMidiClipsVar      = next.midiClipsVar;
     nextSceneSamples           = next.sampleClips;
     songHasNextScene           = true;
+    updatePinnedSongSamples();
 
     // Preload sample files into cache now, while the current scene is still playing,
     // so advanceSongScene() finds everything in cache (zero disk I/O at boundary).
+    // Runs on the preload pool in the background, alongside any Live Mode preload.
     if (samplePlayerManager != nullptr && !nextSceneSamples.empty())
     {
         juce::StringArray paths;
         for (const auto& s : nextSceneSamples)
             if (s.filePath.isNotEmpty())
                 paths.add(s.filePath);
-        samplePlayerManager->preloadSamplesForLiveMode(paths);
+        samplePlayerManager->prefetchSamples(paths);
     }
 
     DBG("MidiBridge::loadNextSceneFromQueue - pre-queued scene " + juce::String(next.sceneIndex)
@@ -828,10 +831,23 @@ void MidiBridge::startSong(const juce::var& scenesArray)
 
     // 3. Preload ALL unique sample paths from ALL scenes at once.
     //    Because many songs reuse the same file in multiple scenes, the unique-file
-    //    count is typically small.  preloadSamplesForLiveMode() skips already-cached
-    //    entries so calling it again on the next startSong() is also cheap.
+    //    count is typically small.  preloadSamplesAsync() decodes in parallel on the
+    //    preload pool and skips already-cached entries, so calling it again on the
+    //    next startSong() is also cheap.  Scene 0 starts from its completion, so
+    //    the message thread never waits for the disk.
+    const int songStart = ++songStartRequest;
+
     if (samplePlayerManager != nullptr)
     {
+        // Pin scenes 0 and 1 first so the budget never evicts them in favour of
+        // files from later scenes loaded by the same call.
+        currentSceneSamples = songSceneQueue[0].sampleClips;
+        juce::StringArray firstScenePaths;
+        for (size_t i = 0; i < songSceneQueue.size() && i < 2; ++i)
+            for (const auto& s : songSceneQueue[i].sampleClips)
+                firstScenePaths.addIfNotAlreadyThere(s.filePath);
+        samplePlayerManager->setPinnedSamples(firstScenePaths);
+
         juce::StringArray allPaths;
         std::set<juce::String> seen;
         for (const auto& scene : songSceneQueue)
@@ -848,10 +864,28 @@ void MidiBridge::startSong(const juce::var& scenesArray)
         if (allPaths.size() > 0)
         {
             DBG("MidiBridge::startSong - preloading " + juce::String(allPaths.size()) + " unique sample file(s)");
-            samplePlayerManager->preloadSamplesForLiveMode(allPaths);
+
+            // Also when the preload is cancelled by a newer one: uncached clips are
+            // read from disk at launch.  A stop or a newer startSong() in the
+            // meantime bumps songStartRequest, and this one is dropped.
+            samplePlayerManager->preloadSamplesAsync(allPaths,
+                [this, songStart](const SamplePlayerManager::PreloadProgress& progress)
+                {
+                    if (progress.finished && songStart == songStartRequest)
+                        startFirstSongScene();
+                });
+            return;
         }
     }
 
+    startFirstSongScene();
+}
+
+void MidiBridge::startFirstSongScene()
+{
+    if (songSceneQueue.empty())
+        return;
+
     currentSongQueueIndex = 0;
     const SongSceneData& scene0 = songSceneQueue[0];
 
@@ -229,9 +229,14 @@ private:
         double loopLengthBeats;
     };
 
+    std::vector<SongSampleClip> currentSceneSamples;
     std::vector<SongSampleClip> nextSceneSamples;
     juce::var nextSceneMidiClipsVar;
 
+    // Pin the current and (if queued) next scene's files in the sample cache
+    // so budget eviction never drops a clip that is about to be needed.
+    void updatePinnedSongSamples();
+
     // ---- C++-driven song sequencing ----------------------------------------
     // When JS calls startSong() it hands all scene data at once.  C++ then owns
     // scene transitions entirely — no JS round-trip is needed per transition.
@@ -248,5 +253,10 @@ private:
 
     void loadNextSceneFromQueue();   // populate nextScene* and preload files from queue
 
+    // startSong() launches scene 0 once its preload is done; bumped by each
+    // startSong() and stopSongMode() so a superseded launch is dropped
+    int songStartRequest = 0;
+    void startFirstSongScene();      // set up and start scene 0 of songSceneQueue
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiBridge)
 };
@@ -227,6 +227,7 @@ void MidiClipScheduler::play()
             pair.second.oneshotFinished = false;
 
         DBG("MidiClipScheduler: Play requested (will start at next audio block)");
+        publishQuantizeGrid();
     }
 }
 
@@ -255,6 +256,7 @@ void MidiClipScheduler::stop()
             midiTrackOutputManager->sendAllNotesOff(pair.first, pair.second.channel);
     }
 
+    publishQuantizeGrid();
     DBG("MidiClipScheduler: Stopped");
 }
 
@@ -278,6 +280,7 @@ void MidiClipScheduler::pause()
                 midiTrackOutputManager->sendAllNotesOff(pair.first, pair.second.channel);
         }
 
+        publishQuantizeGrid();
         DBG("MidiClipScheduler: Paused at step " + juce::String(pausedPositionSteps));
     }
 }
@@ -311,6 +314,8 @@ void MidiClipScheduler::setTempo(double bpm)
     {
         tempo = newTempo;
     }
+
+    publishQuantizeGrid();
 }
 
 //==============================================================================
@@ -358,6 +363,7 @@ void MidiClipScheduler::stopTrack(int trackIndex)
     if (!anyActive)
         liveAnchorSample = -1;
 
+    publishQuantizeGrid();
     DBG("MidiClipScheduler::stopTrack - stopped track " + juce::String(trackIndex));
 }
 
@@ -421,6 +427,7 @@ void MidiClipScheduler::setQuantizeSteps(int steps)
 {
     juce::SpinLock::ScopedLockType sl(lock);
     quantizeSteps = juce::jlimit(1, 256, steps);
+    publishQuantizeGrid();
     DBG("MidiClipScheduler::setQuantizeSteps - " + juce::String(quantizeSteps));
 }
 
@@ -428,6 +435,7 @@ void MidiClipScheduler::resetLiveAnchor()
 {
     juce::SpinLock::ScopedLockType sl(lock);
     liveAnchorSample = -1;
+    publishQuantizeGrid();
     DBG("MidiClipScheduler::resetLiveAnchor");
 }
 
@@ -438,6 +446,7 @@ void MidiClipScheduler::setLiveMode(bool enabled)
     // When entering live mode, reset the anchor so first triggered clip sets it
     if (enabled)
         liveAnchorSample = -1;
+    publishQuantizeGrid();
     DBG("MidiClipScheduler::setLiveMode - " + juce::String(enabled ? "ON" : "OFF"));
 }
 
@@ -477,6 +486,7 @@ void MidiClipScheduler::adjustPlayStartForSceneTransition(double stepsToAdvance)
         for (auto& pair : trackPlayStates)
             pair.second.oneshotFinished = false;
 
+        publishQuantizeGrid();
         DBG("MidiClipScheduler::adjustPlayStartForSceneTransition - advanced " +
             juce::String(stepsToAdvance) + " steps");
     }
@@ -489,6 +499,7 @@ void MidiClipScheduler::prepareToPlay(double newSampleRate)
 {
     juce::SpinLock::ScopedLockType sl(lock);
     sampleRate = newSampleRate;
+    publishQuantizeGrid();
     DBG("MidiClipScheduler::prepareToPlay - sampleRate: " + juce::String(sampleRate));
 }
 
@@ -500,6 +511,16 @@ void MidiClipScheduler::renderTrackBlock(int trackIndex, juce::MidiBuffer& outpu
     if (!sl.isLocked())
         return; // Skip if message thread is modifying clip data
 
+    renderTrackBlockLocked(trackIndex, output, blockStartSample, numSamples, vstParamOutput);
+
+    // The block may have resolved playStartSample or the live anchor
+    publishQuantizeGrid();
+}
+
+void MidiClipScheduler::renderTrackBlockLocked(int trackIndex, juce::MidiBuffer& output,
+                                               int64_t blockStartSample, int numSamples,
+                                               std::vector<PendingVstParam>* vstParamOutput)
+{
     // Update latest audio position (all tracks report same value, no conflict)
     latestAudioPosition.store(blockStartSample + numSamples, std::memory_order_relaxed);
 
@@ -907,6 +928,74 @@ int64_t MidiClipScheduler::computeNextQuantizeBoundarySample() const
     return anchor + static_cast<int64_t>(std::round(nextBoundary * samplesPerStep));
 }
 
+bool MidiClipScheduler::getQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const
+{
+    juce::SpinLock::ScopedLockType sl(lock);
+    return computeQuantizeGrid(anchorSample, samplesPerQuantize);
+}
+
+bool MidiClipScheduler::getPublishedQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const
+{
+    // Both values from the same publish: retry while one is being written, or
+    // if one was written between the two loads.  Publishes are a few stores
+    // long, so this rarely goes round more than once.
+    for (;;)
+    {
+        const auto before = publishedGridSequence.load(std::memory_order_acquire);
+
+        anchorSample = publishedGridAnchor.load(std::memory_order_relaxed);
+        samplesPerQuantize = publishedSamplesPerQuantize.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if ((before & 1) == 0 && publishedGridSequence.load(std::memory_order_relaxed) == before)
+            return anchorSample >= 0;
+    }
+}
+
+void MidiClipScheduler::publishQuantizeGrid()
+{
+    int64_t anchor = -1;
+    double spacing = 0.0;
+    computeQuantizeGrid(anchor, spacing);
+
+    // One writer at a time (the lock is held), so the count is ours to bump
+    const auto sequence = publishedGridSequence.load(std::memory_order_relaxed);
+    publishedGridSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    publishedGridAnchor.store(anchor, std::memory_order_relaxed);
+    publishedSamplesPerQuantize.store(spacing, std::memory_order_relaxed);
+
+    publishedGridSequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool MidiClipScheduler::computeQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const
+{
+    anchorSample = -1;
+    samplesPerQuantize = 0.0;
+
+    if (sampleRate <= 0.0 || tempo <= 0.0)
+        return false;
+
+    const double samplesPerStep = getSamplesPerStep();
+    if (samplesPerStep <= 0.0)
+        return false;
+
+    int64_t anchor = liveAnchorSample;
+    if (anchor < 0)
+    {
+        if (playing && playStartSample >= 0)
+            anchor = playStartSample;
+        else
+            return false;
+    }
+
+    anchorSample = anchor;
+    samplesPerQuantize = samplesPerStep * static_cast<double>(quantizeSteps);
+    return true;
+}
+
 //==============================================================================
 // Notification consumption (message thread)
 
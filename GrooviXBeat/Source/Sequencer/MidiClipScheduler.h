@@ -203,12 +203,36 @@ public:
      */
     int64_t computeNextQuantizeBoundarySample() const;
 
+    /**
+     * The live quantize grid: boundaries fall at anchorSample + n * samplesPerQuantize,
+     * using the same anchor as computeNextQuantizeBoundarySample().
+     * Returns false (anchorSample = -1) if no timing reference has been established yet.
+     */
+    bool getQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const;
+
+    /**
+     * Lock-free copy of getQuantizeGrid() for other audio-thread code (the
+     * sample players); the anchor and spacing always come from the same
+     * publish.  Republished whenever the grid can change: tempo,
+     * quantize and transport calls on the message thread, and every
+     * renderTrackBlock(), which resolves playStartSample and the live anchor.
+     */
+    bool getPublishedQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const;
+
     //==============================================================================
     // Legacy timer-driven API (no-op, kept for compatibility during transition)
     void processEvents(double /*currentTimeSeconds*/) {}
     void processEvents() {}
 
 private:
+    void renderTrackBlockLocked(int trackIndex, juce::MidiBuffer& output,
+                                int64_t blockStartSample, int numSamples,
+                                std::vector<PendingVstParam>* vstParamOutput);
+
+    // Both called with lock held
+    bool computeQuantizeGrid(int64_t& anchorSample, double& samplesPerQuantize) const;
+    void publishQuantizeGrid();
+
     MidiTrackOutputManager* midiTrackOutputManager = nullptr;
 
     // Clip data per track (protected by lock)
@@ -227,6 +251,13 @@ private:
     // Latest audio position reported by any track (for playhead queries)
     std::atomic<int64_t> latestAudioPosition { 0 };
 
+    // Quantize grid as of the last publishQuantizeGrid() (see getPublishedQuantizeGrid).
+    // A sequence lock: the count is odd while a publish is writing the pair, and
+    // readers retry until they read both between the same two even counts.
+    std::atomic<uint32_t> publishedGridSequence { 0 };
+    std::atomic<int64_t> publishedGridAnchor { -1 };
+    std::atomic<double> publishedSamplesPerQuantize { 0.0 };
+
     // Per-track state - uses fixed-size bitset for activeNotes to avoid
     // heap allocation on the audio thread (128 bits covers MIDI range 0-127)
     struct TrackPlayState
@@ -3,15 +3,28 @@
 */
 
 #include "SampleEditorBridge.h"
+#include "../Audio/AnalysisCache.h"
 
 //==============================================================================
 SampleEditorBridge::SampleEditorBridge(SamplePlayerManager& manager)
-    : samplePlayerManager(manager)
+    : samplePlayerManager(manager),
+      jobPool(2)
 {
 }
 
 SampleEditorBridge::~SampleEditorBridge()
 {
+    // Stop the running edits before the players go away.  Completions already
+    // posted to the message thread see the weak reference cleared and do
+    // nothing.  No final reports: the owners of the callbacks are being torn
+    // down too.
+    stopTimer();
+
+    for (auto& [trackIndex, jobs] : trackJobs)
+        for (auto& job : jobs)
+            job->progress.cancel();
+
+    jobPool.removeAllJobs(true, 10000);
 }
 
 //==============================================================================
@@ -59,6 +72,9 @@ bool SampleEditorBridge::loadForEditing(int trackIndex, const juce::String& file
         }
     }
 
+    // Jobs queued for the old content would not be committed anyway
+    cancelJobsForTrack(trackIndex);
+
     bool success = player->loadFileForEditing(filePath);
 
     if (success)
@@ -74,57 +90,324 @@ bool SampleEditorBridge::loadForEditing(int trackIndex, const juce::String& file
 }
 
 //==============================================================================
-// Time Stretch / Warp
+// Edit Jobs
 
-void SampleEditorBridge::timeStretch(int trackIndex, double ratio, double targetLengthSeconds)
+int SampleEditorBridge::submitJob(int trackIndex, const juce::String& operation, bool writesAudio,
+                                  Edit edit, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
+    auto job = std::make_shared<EditJob>();
+    job->id = nextJobId++;
+    job->trackIndex = trackIndex;
+    job->operation = operation;
+    job->edit = std::move(edit);
+    job->writesAudio = writesAudio;
+    job->callback = std::move(callback);
+
+    trackJobs[trackIndex].push_back(job);
+
+    DBG("SampleEditorBridge: Queued " + operation + " (job " + juce::String(job->id) +
+        ") on track " + juce::String(trackIndex));
+
+    reportJobProgress(*job);
+    startNextJob(trackIndex);
+
+    return job->id;
+}
+
+void SampleEditorBridge::startNextJob(int trackIndex)
+{
+    auto it = trackJobs.find(trackIndex);
+
+    while (it != trackJobs.end() && !it->second.empty())
+    {
+        auto job = it->second.front();
+        if (job->started)
+            return;  // one at a time per track
+
+        SampleEditor* editor = getEditorForTrack(trackIndex);
+        if (editor == nullptr || !editor->isLoaded())
+        {
+            it->second.pop_front();
+            reportJobProgress(*job, true, false);
+            it = trackJobs.find(trackIndex);  // the report may have queued more
+            continue;
+        }
+
+        // Taken after the jobs before it were committed, so it edits their result
+        job->workingCopy = editor->createWorkingCopy();
+        job->started = true;
+        reportJobProgress(*job);
+
+        if (!isTimerRunning())
+            startTimerHz(10);
+
+        juce::WeakReference<SampleEditorBridge> weakThis(this);
+
+        jobPool.addJob([weakThis, job]
+        {
+            if (!job->progress.isCancelled())
+                runJob(*job);
+
+            juce::MessageManager::callAsync([weakThis, job]
+            {
+                if (auto* bridge = weakThis.get())
+                    bridge->finishJob(job);
+            });
+        });
+
+        return;
+    }
+
+    if (it != trackJobs.end())
+        trackJobs.erase(it);
+
+    runFlushesIfIdle();
+}
+
+void SampleEditorBridge::runJob(EditJob& job)
+{
+    SampleEditor& editor = *job.workingCopy;
+    const auto generationBefore = editor.getGeneration();
+
+    // The edit reports into most of the range; writing the file is the rest
+    job.progress.setRange(0.0, job.writesAudio ? 0.8 : 1.0);
+    job.succeeded = job.edit(editor, job.progress);
+
+    if (!job.succeeded || job.progress.isCancelled())
         return;
 
-    editor->timeStretch(ratio, targetLengthSeconds);
+    job.progress.setStepProgress(1.0);
+
+    // Nothing to write if the edit turned out to be a no-op (e.g. an empty range)
+    if (!job.writesAudio || editor.getGeneration() == generationBefore || editor.getFilePath().isEmpty())
+        return;
 
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
+    job.progress.setRange(0.8, 1.0);
 
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    // Written next to the sample; the commit moves it over the sample
+    auto editedFile = std::make_unique<juce::TemporaryFile>(getSaveFileFor(editor.getFilePath()));
 
-    DBG("SampleEditorBridge: Time stretched track " + juce::String(trackIndex) +
-        " by " + juce::String(ratio, 3) + " (target: " + juce::String(targetLengthSeconds, 3) + "s)");
+    if (!editor.saveToFile(editedFile->getFile()))
+    {
+        DBG("SampleEditorBridge: Job " + juce::String(job.id) + " failed to write " +
+            editedFile->getFile().getFullPathName());
+        job.succeeded = false;
+        return;
+    }
+
+    // Stored under the content key; the sample is linked to it once in place
+    editor.getBuffer()->storeAnalysis();
+
+    job.editedFile = std::move(editedFile);
+    job.progress.setStepProgress(1.0);
 }
 
-void SampleEditorBridge::applyWarp(int trackIndex, double sampleBPM, double targetBPM, double targetLengthSeconds)
+void SampleEditorBridge::finishJob(const std::shared_ptr<EditJob>& job)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
+    auto& jobs = trackJobs[job->trackIndex];
+    jassert(!jobs.empty() && jobs.front() == job);
+
+    if (!jobs.empty() && jobs.front() == job)
+        jobs.pop_front();
+
+    bool committed = false;
+
+    if (job->succeeded && !job->progress.isCancelled())
+    {
+        SampleEditor* editor = getEditorForTrack(job->trackIndex);
+        committed = editor != nullptr && editor->commitWorkingCopy(*job->workingCopy);
+
+        if (committed && job->editedFile != nullptr)
+        {
+            invalidatePeaksCache(job->trackIndex);
+
+            // Could not replace the sample: write it the direct way instead
+            if (installEditedFile(job->trackIndex, *job->editedFile).isEmpty())
+                flushTrackToDisk(job->trackIndex);
+        }
+    }
+
+    // The working copy now holds the replaced content; the file is deleted
+    // unless it was moved into place
+    job->workingCopy = nullptr;
+    job->editedFile = nullptr;
+
+    DBG("SampleEditorBridge: " + job->operation + " (job " + juce::String(job->id) + ") on track " +
+        juce::String(job->trackIndex) + (committed ? " committed"
+                                                   : job->progress.isCancelled() ? " cancelled" : " failed"));
+
+    reportJobProgress(*job, true, committed);
+    startNextJob(job->trackIndex);
+}
+
+bool SampleEditorBridge::cancelJob(int jobId)
+{
+    for (auto& [trackIndex, jobs] : trackJobs)
+    {
+        for (auto it = jobs.begin(); it != jobs.end(); ++it)
+        {
+            auto job = *it;
+            if (job->id != jobId)
+                continue;
+
+            job->progress.cancel();
+
+            DBG("SampleEditorBridge: Cancelled " + job->operation + " (job " + juce::String(jobId) + ")");
+
+            // A running job is dropped when the pool hands it back
+            if (!job->started)
+            {
+                jobs.erase(it);
+                reportJobProgress(*job, true, false);
+                runFlushesIfIdle();
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int SampleEditorBridge::cancelJobsForTrack(int trackIndex)
+{
+    auto it = trackJobs.find(trackIndex);
+    if (it == trackJobs.end())
+        return 0;
+
+    std::vector<int> jobIds;
+    for (const auto& job : it->second)
+        jobIds.push_back(job->id);
+
+    int numCancelled = 0;
+    for (int jobId : jobIds)
+        if (cancelJob(jobId))
+            ++numCancelled;
+
+    return numCancelled;
+}
+
+bool SampleEditorBridge::hasPendingJobs(int trackIndex) const
+{
+    auto it = trackJobs.find(trackIndex);
+    return it != trackJobs.end() && !it->second.empty();
+}
+
+bool SampleEditorBridge::hasAnyPendingJobs() const
+{
+    for (const auto& [trackIndex, jobs] : trackJobs)
+        if (!jobs.empty())
+            return true;
+
+    return false;
+}
+
+void SampleEditorBridge::runFlushesIfIdle()
+{
+    if (flushesAfterJobs.empty() || hasAnyPendingJobs())
         return;
 
-    editor->applyWarp(sampleBPM, targetBPM, targetLengthSeconds);
+    // Moved out first: a completion may queue more edits or flushes
+    auto completions = std::move(flushesAfterJobs);
+    flushesAfterJobs.clear();
 
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
+    flushAllEditsToDisk();
 
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    for (auto& onFlushed : completions)
+        if (onFlushed)
+            onFlushed();
+}
 
-    DBG("SampleEditorBridge: Warped track " + juce::String(trackIndex) +
-        " from " + juce::String(sampleBPM, 1) + " to " + juce::String(targetBPM, 1) + " BPM" +
-        " (target: " + juce::String(targetLengthSeconds, 3) + "s)");
+void SampleEditorBridge::reportJobProgress(EditJob& job, bool finished, bool succeeded)
+{
+    job.reportedProgress = job.progress.getProgress();
+
+    if (!job.callback)
+        return;
+
+    EditProgress progress;
+    progress.jobId      = job.id;
+    progress.trackIndex = job.trackIndex;
+    progress.operation  = job.operation;
+    progress.progress   = succeeded ? 1.0 : job.reportedProgress;
+    progress.started    = job.started;
+    progress.finished   = finished;
+    progress.succeeded  = succeeded;
+    progress.cancelled  = finished && job.progress.isCancelled();
+
+    if (finished)
+        progress.filePath = getCurrentFilePath(job.trackIndex);
+
+    job.callback(progress);
 }
 
-double SampleEditorBridge::detectBPM(int trackIndex)
+void SampleEditorBridge::timerCallback()
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return 0.0;
+    bool anyRunning = false;
+
+    for (auto& [trackIndex, jobs] : trackJobs)
+    {
+        if (jobs.empty() || !jobs.front()->started)
+            continue;
 
-    double bpm = editor->detectBPM();
+        anyRunning = true;
+        auto& job = *jobs.front();
 
-    DBG("SampleEditorBridge: Detected BPM for track " + juce::String(trackIndex) +
-        ": " + juce::String(bpm, 1));
+        // Whole percents only, so a slow job does not flood the UI
+        if (job.progress.getProgress() >= job.reportedProgress + 0.01)
+            reportJobProgress(job);
+    }
 
-    return bpm;
+    if (!anyRunning)
+        stopTimer();
+}
+
+//==============================================================================
+// Time Stretch / Warp
+
+int SampleEditorBridge::timeStretch(int trackIndex, double ratio, double targetLengthSeconds,
+                                    EditProgressCallback callback)
+{
+    return submitJob(trackIndex, "timeStretch", true,
+        [trackIndex, ratio, targetLengthSeconds](SampleEditor& editor, SampleDSP::Progress& progress)
+        {
+            editor.timeStretch(ratio, targetLengthSeconds, &progress);
+
+            DBG("SampleEditorBridge: Time stretched track " + juce::String(trackIndex) +
+                " by " + juce::String(ratio, 3) + " (target: " + juce::String(targetLengthSeconds, 3) + "s)");
+            return true;
+        },
+        std::move(callback));
+}
+
+int SampleEditorBridge::applyWarp(int trackIndex, double sampleBPM, double targetBPM, double targetLengthSeconds,
+                                  EditProgressCallback callback)
+{
+    return submitJob(trackIndex, "applyWarp", true,
+        [trackIndex, sampleBPM, targetBPM, targetLengthSeconds](SampleEditor& editor, SampleDSP::Progress& progress)
+        {
+            editor.applyWarp(sampleBPM, targetBPM, targetLengthSeconds, &progress);
+
+            DBG("SampleEditorBridge: Warped track " + juce::String(trackIndex) +
+                " from " + juce::String(sampleBPM, 1) + " to " + juce::String(targetBPM, 1) + " BPM" +
+                " (target: " + juce::String(targetLengthSeconds, 3) + "s)");
+            return true;
+        },
+        std::move(callback));
+}
+
+int SampleEditorBridge::detectBPM(int trackIndex, EditProgressCallback callback)
+{
+    return submitJob(trackIndex, "detectBPM", false,
+        [trackIndex](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.detectBPM();
+
+            DBG("SampleEditorBridge: Detected BPM for track " + juce::String(trackIndex) +
+                ": " + juce::String(editor.getBuffer()->getDetectedBPM(), 1));
+            return true;
+        },
+        std::move(callback));
 }
 
 //==============================================================================
@@ -166,153 +449,135 @@ double SampleEditorBridge::getPlaybackOffset(int trackIndex)
 //==============================================================================
 // Fade Operations
 
-void SampleEditorBridge::fadeIn(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::fadeIn(int trackIndex, double startSeconds, double endSeconds,
+                               EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->fadeIn(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "fadeIn", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.fadeIn(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Fade in on track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Fade in on track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::fadeOut(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::fadeOut(int trackIndex, double startSeconds, double endSeconds,
+                                EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->fadeOut(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "fadeOut", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.fadeOut(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Fade out on track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Fade out on track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
 //==============================================================================
 // Selection Operations
 
-void SampleEditorBridge::silence(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::silence(int trackIndex, double startSeconds, double endSeconds,
+                                EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->silence(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "silence", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.silence(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Silenced track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Silenced track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::trim(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::trim(int trackIndex, double startSeconds, double endSeconds,
+                             EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->trim(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "trim", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.trim(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Trimmed track " + juce::String(trackIndex) +
-        " to " + juce::String(startSeconds, 3) + "s - " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Trimmed track " + juce::String(trackIndex) +
+                " to " + juce::String(startSeconds, 3) + "s - " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::deleteRange(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::deleteRange(int trackIndex, double startSeconds, double endSeconds,
+                                    EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->deleteRange(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "deleteRange", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.deleteRange(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Deleted range from track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Deleted range from track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::copyRange(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::copyRange(int trackIndex, double startSeconds, double endSeconds,
+                                  EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->copyRange(startSeconds, endSeconds);
+    return submitJob(trackIndex, "copyRange", false,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.copyRange(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Copied range from track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Copied range from track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::cutRange(int trackIndex, double startSeconds, double endSeconds)
+int SampleEditorBridge::cutRange(int trackIndex, double startSeconds, double endSeconds,
+                                 EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    // Copy first, then delete
-    editor->copyRange(startSeconds, endSeconds);
-    editor->deleteRange(startSeconds, endSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "cutRange", true,
+        [trackIndex, startSeconds, endSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            // Copy first, then delete
+            editor.copyRange(startSeconds, endSeconds);
+            editor.deleteRange(startSeconds, endSeconds);
 
-    DBG("SampleEditorBridge: Cut range from track " + juce::String(trackIndex) +
-        " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Cut range from track " + juce::String(trackIndex) +
+                " from " + juce::String(startSeconds, 3) + "s to " + juce::String(endSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::paste(int trackIndex, double positionSeconds)
+int SampleEditorBridge::paste(int trackIndex, double positionSeconds, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    if (!editor->hasClipboardData())
-    {
-        DBG("SampleEditorBridge: No clipboard data to paste");
-        return;
-    }
-
-    editor->insertClipboard(positionSeconds);
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
+    return submitJob(trackIndex, "paste", true,
+        [trackIndex, positionSeconds](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            // Checked on the copy: a copy queued before this one has filled it
+            if (!editor.hasClipboardData())
+            {
+                DBG("SampleEditorBridge: No clipboard data to paste");
+                return false;
+            }
 
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+            editor.insertClipboard(positionSeconds);
 
-    DBG("SampleEditorBridge: Pasted at track " + juce::String(trackIndex) +
-        " position " + juce::String(positionSeconds, 3) + "s");
+            DBG("SampleEditorBridge: Pasted at track " + juce::String(trackIndex) +
+                " position " + juce::String(positionSeconds, 3) + "s");
+            return true;
+        },
+        std::move(callback));
 }
 
 bool SampleEditorBridge::hasClipboardData(int trackIndex)
@@ -327,55 +592,43 @@ bool SampleEditorBridge::hasClipboardData(int trackIndex)
 //==============================================================================
 // Reset / Undo
 
-void SampleEditorBridge::reset(int trackIndex)
+int SampleEditorBridge::reset(int trackIndex, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return;
-
-    editor->reset();
-
-    // Invalidate peaks cache since waveform was reset to original
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "reset", true,
+        [trackIndex](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.reset();
 
-    DBG("SampleEditorBridge: Reset track " + juce::String(trackIndex));
+            DBG("SampleEditorBridge: Reset track " + juce::String(trackIndex));
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::undo(int trackIndex)
+int SampleEditorBridge::undo(int trackIndex, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr)
-        return;
-
-    editor->undo();
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "undo", true,
+        [trackIndex](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.undo();
 
-    DBG("SampleEditorBridge: Undo on track " + juce::String(trackIndex));
+            DBG("SampleEditorBridge: Undo on track " + juce::String(trackIndex));
+            return true;
+        },
+        std::move(callback));
 }
 
-void SampleEditorBridge::redo(int trackIndex)
+int SampleEditorBridge::redo(int trackIndex, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr)
-        return;
-
-    editor->redo();
-
-    // Invalidate peaks cache since waveform changed
-    invalidatePeaksCache(trackIndex);
-
-    // Flush to disk and reload player from file
-    flushTrackToDisk(trackIndex);
+    return submitJob(trackIndex, "redo", true,
+        [trackIndex](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            editor.redo();
 
-    DBG("SampleEditorBridge: Redo on track " + juce::String(trackIndex));
+            DBG("SampleEditorBridge: Redo on track " + juce::String(trackIndex));
+            return true;
+        },
+        std::move(callback));
 }
 
 bool SampleEditorBridge::canUndo(int trackIndex)
@@ -399,30 +652,52 @@ bool SampleEditorBridge::canRedo(int trackIndex)
 //==============================================================================
 // Save
 
-bool SampleEditorBridge::saveToFile(int trackIndex, const juce::String& filePath)
+int SampleEditorBridge::saveToFile(int trackIndex, const juce::String& filePath, EditProgressCallback callback)
 {
-    SampleEditor* editor = getEditorForTrack(trackIndex);
-    if (editor == nullptr || !editor->isLoaded())
-        return false;
-
     juce::File file(filePath);
-    bool success = editor->saveToFile(file);
 
-    if (success)
+    // Decodes of the file are marked stale back on the message thread
+    auto onProgress = [this, file, callback = std::move(callback)](const EditProgress& progress)
     {
-        DBG("SampleEditorBridge: Saved track " + juce::String(trackIndex) +
-            " to " + filePath);
-    }
-    else
-    {
-        DBG("SampleEditorBridge: Failed to save track " + juce::String(trackIndex));
-    }
+        if (progress.finished && progress.succeeded)
+            samplePlayerManager.markSampleFileEdited(file.getFullPathName());
 
-    return success;
+        if (callback)
+            callback(progress);
+    };
+
+    return submitJob(trackIndex, "saveToFile", false,
+        [trackIndex, file](SampleEditor& editor, SampleDSP::Progress&)
+        {
+            bool success = editor.saveToFile(file);
+
+            if (success)
+            {
+                editor.getBuffer()->storeAnalysis(file);
+                DBG("SampleEditorBridge: Saved track " + juce::String(trackIndex) +
+                    " to " + file.getFullPathName());
+            }
+            else
+            {
+                DBG("SampleEditorBridge: Failed to save track " + juce::String(trackIndex));
+            }
+
+            return success;
+        },
+        std::move(onProgress));
 }
 
-void SampleEditorBridge::flushAllEditsToDisk()
+void SampleEditorBridge::flushAllEditsToDisk(std::function<void()> onFlushed)
 {
+    // The jobs' results would be missing from the files (or, committed
+    // later, replace them): flush once the last one is done
+    if (hasAnyPendingJobs())
+    {
+        DBG("SampleEditorBridge::flushAllEditsToDisk - waiting for pending edit jobs");
+        flushesAfterJobs.push_back(std::move(onFlushed));
+        return;
+    }
+
     DBG("SampleEditorBridge::flushAllEditsToDisk - checking all tracks");
 
     int flushedCount = 0;
@@ -440,6 +715,9 @@ void SampleEditorBridge::flushAllEditsToDisk()
 
     DBG("SampleEditorBridge::flushAllEditsToDisk - flushed " +
         juce::String(flushedCount) + " tracks");
+
+    if (onFlushed)
+        onFlushed();
 }
 
 juce::String SampleEditorBridge::flushTrackToDisk(int trackIndex)
@@ -458,11 +736,7 @@ juce::String SampleEditorBridge::flushTrackToDisk(int trackIndex)
 
     // Save directly to the project copy. The original lives in the Samples Library
     // folder (stored as originalSourcePath in JS) and can be restored from there.
-    juce::File saveFile(filePath);
-
-    // saveToFile writes WAV format — if original was non-WAV, use .wav extension
-    if (!saveFile.getFileExtension().equalsIgnoreCase(".wav"))
-        saveFile = saveFile.withFileExtension("wav");
+    juce::File saveFile = getSaveFileFor(filePath);
 
     // Release the file handle (readerSource/transportSource) so we can
     // overwrite the file on Windows. This does NOT clear the sampleEditor buffer.
@@ -478,6 +752,11 @@ juce::String SampleEditorBridge::flushTrackToDisk(int trackIndex)
 
     juce::String savePath = saveFile.getFullPathName();
 
+    // Any cached decode of this file now holds the pre-edit audio; the
+    // analysis of the edited audio is stored for the next load
+    samplePlayerManager.markSampleFileEdited(savePath);
+    editor->getBuffer()->storeAnalysis(saveFile);
+
     // Update stored paths if extension changed
     if (savePath != filePath)
     {
@@ -494,6 +773,61 @@ juce::String SampleEditorBridge::flushTrackToDisk(int trackIndex)
     return savePath;
 }
 
+juce::String SampleEditorBridge::installEditedFile(int trackIndex, juce::TemporaryFile& editedFile)
+{
+    SamplePlayerPlugin* player = samplePlayerManager.getPlayerForTrack(trackIndex);
+    if (player == nullptr)
+        return {};
+
+    SampleEditor* editor = player->getSampleEditor();
+    if (editor == nullptr || !editor->isLoaded())
+        return {};
+
+    // Release the file handle so the file can be replaced on Windows
+    player->releaseFileHandle();
+
+    const juce::File saveFile = editedFile.getTargetFile();
+
+    if (!editedFile.overwriteTargetFileWithTemporary())
+    {
+        DBG("SampleEditorBridge::installEditedFile - FAILED to replace " + saveFile.getFullPathName());
+        player->loadFile(editor->getFilePath());
+        return {};
+    }
+
+    juce::String savePath = saveFile.getFullPathName();
+
+    // Any cached decode of this file now holds the pre-edit audio; the
+    // analysis the job stored is found through the file from now on
+    samplePlayerManager.markSampleFileEdited(savePath);
+    AnalysisCache::rememberSource(saveFile, editor->getBuffer()->getContentKey());
+
+    // Update stored paths if extension changed
+    if (savePath != editor->getFilePath())
+    {
+        editor->setFilePath(savePath);
+        trackFilePaths[trackIndex] = savePath;
+    }
+
+    // Reload from disk so player switches to file-based mode
+    player->loadFile(savePath);
+
+    DBG("SampleEditorBridge::installEditedFile - track " + juce::String(trackIndex) + " now plays " + savePath);
+
+    return savePath;
+}
+
+juce::File SampleEditorBridge::getSaveFileFor(const juce::String& filePath)
+{
+    juce::File saveFile(filePath);
+
+    // saveToFile writes WAV format — if original was non-WAV, use .wav extension
+    if (!saveFile.getFileExtension().equalsIgnoreCase(".wav"))
+        saveFile = saveFile.withFileExtension("wav");
+
+    return saveFile;
+}
+
 //==============================================================================
 // Query
 
@@ -570,36 +904,76 @@ std::vector<std::pair<float, float>> SampleEditorBridge::getWaveformPeaks(int tr
     if (buffer == nullptr)
         return {};
 
-    // Check if we have a cached file path for this track
-    juce::String filePath;
-    auto it = trackFilePaths.find(trackIndex);
-    if (it != trackFilePaths.end())
-        filePath = it->second;
+    // The pyramid behind this is restored from AnalysisCache on load, so
+    // any numPoints is served without a pass over the samples.
+    auto peaks = buffer->getWaveformPeaks(numPoints);
+
+    return peaks;
+}
+
+juce::MemoryBlock SampleEditorBridge::getWaveformBinary(int trackIndex, double startSeconds, double endSeconds,
+                                                        int numPoints, int channel)
+{
+    SampleEditor* editor = getEditorForTrack(trackIndex);
+    if (editor == nullptr || !editor->isLoaded())
+        return {};
+
+    SampleBuffer* buffer = editor->getBuffer();
+    if (buffer == nullptr)
+        return {};
+
+    // Frames come straight from the peak pyramid, so any zoom range costs
+    // the same.
+    std::vector<PeakPyramid::Peak> frames;
+    std::vector<double> transients;
+    double duration = 0.0;
+    double sampleRate = 0.0;
+
+    numPoints = juce::jlimit(1, 65536, numPoints);
 
-    // Try to load from cache first
-    if (filePath.isNotEmpty())
     {
-        std::vector<std::pair<float, float>> cachedPeaks;
-        if (loadPeaksFromCache(filePath, cachedPeaks, numPoints))
-        {
-            DBG("SampleEditorBridge: Loaded peaks from cache for track " + juce::String(trackIndex));
-            return cachedPeaks;
-        }
+        juce::ScopedLock sl(buffer->getLock());
+
+        sampleRate = buffer->getSampleRate();
+        duration = buffer->getDurationSeconds();
+        channel = juce::jlimit(0, juce::jmax(0, buffer->getNumChannels() - 1), channel);
+
+        startSeconds = juce::jlimit(0.0, duration, startSeconds);
+        endSeconds = endSeconds > 0.0 ? juce::jlimit(startSeconds, duration, endSeconds) : duration;
+
+        const int startSample = static_cast<int>(startSeconds * sampleRate);
+        const int endSample = juce::jmin(buffer->getNumSamples(), static_cast<int>(endSeconds * sampleRate));
+
+        frames = buffer->getWaveformFrames(channel, startSample, endSample - startSample, numPoints);
+        transients = buffer->getTransients();
     }
 
-    // Generate peaks from buffer
-    auto peaks = buffer->getWaveformPeaks(numPoints);
+    juce::MemoryOutputStream out(48 + frames.size() * 12 + 4 + transients.size() * 8);
+
+    out.writeInt(1);
+    out.writeInt(static_cast<int>(frames.size()));
+    out.writeInt(static_cast<int>(transients.size()));
+    out.writeInt(channel);
+
+    out.writeDouble(duration);
+    out.writeDouble(startSeconds);
+    out.writeDouble(endSeconds);
+    out.writeDouble(sampleRate);
 
-    // Save to cache if we have a file path
-    if (filePath.isNotEmpty() && !peaks.empty())
+    for (const auto& frame : frames)
     {
-        if (savePeaksToCache(filePath, peaks))
-        {
-            DBG("SampleEditorBridge: Saved peaks to cache for track " + juce::String(trackIndex));
-        }
+        out.writeFloat(frame.min);
+        out.writeFloat(frame.max);
+        out.writeFloat(frame.rms);
     }
 
-    return peaks;
+    if ((frames.size() * 12) % 8 != 0)
+        out.writeInt(0);
+
+    for (double t : transients)
+        out.writeDouble(t);
+
+    return out.getMemoryBlock();
 }
 
 void SampleEditorBridge::invalidatePeaksCache(int trackIndex)
@@ -622,111 +996,14 @@ juce::String SampleEditorBridge::getCurrentFilePath(int trackIndex)
 
 //==============================================================================
 // Peaks Cache Helpers
+// Peaks now live in AnalysisCache; .peaks JSON files from older versions
+// are still removed when their sample is edited.
 
 juce::File SampleEditorBridge::getPeaksCacheFile(const juce::String& sampleFilePath)
 {
     return juce::File(sampleFilePath + ".peaks");
 }
 
-bool SampleEditorBridge::loadPeaksFromCache(const juce::String& sampleFilePath,
-                                             std::vector<std::pair<float, float>>& peaks,
-                                             int expectedNumPoints)
-{
-    juce::File cacheFile = getPeaksCacheFile(sampleFilePath);
-
-    if (!cacheFile.existsAsFile())
-        return false;
-
-    // Check if cache is older than the sample file
-    juce::File sampleFile(sampleFilePath);
-    if (sampleFile.existsAsFile() &&
-        cacheFile.getLastModificationTime() < sampleFile.getLastModificationTime())
-    {
-        DBG("SampleEditorBridge: Cache is older than sample, regenerating");
-        return false;
-    }
-
-    try
-    {
-        // Read JSON cache file
-        juce::String jsonContent = cacheFile.loadFileAsString();
-        juce::var json = juce::JSON::parse(jsonContent);
-
-        if (!json.isObject())
-            return false;
-
-        int version = json.getProperty("version", 0);
-        if (version != 1)
-            return false;
-
-        int numPoints = json.getProperty("numPoints", 0);
-        if (numPoints != expectedNumPoints)
-        {
-            DBG("SampleEditorBridge: Cache has different numPoints (" + juce::String(numPoints) +
-                " vs " + juce::String(expectedNumPoints) + "), regenerating");
-            return false;
-        }
-
-        juce::var peaksArray = json.getProperty("peaks", juce::var());
-        if (!peaksArray.isArray())
-            return false;
-
-        peaks.clear();
-        peaks.reserve(numPoints);
-
-        for (int i = 0; i < peaksArray.size(); ++i)
-        {
-            juce::var peak = peaksArray[i];
-            if (peak.isArray() && peak.size() >= 2)
-            {
-                float minVal = static_cast<float>(peak[0]);
-                float maxVal = static_cast<float>(peak[1]);
-                peaks.push_back({ minVal, maxVal });
-            }
-        }
-
-        return peaks.size() == static_cast<size_t>(expectedNumPoints);
-    }
-    catch (...)
-    {
-        DBG("SampleEditorBridge: Error reading peaks cache");
-        return false;
-    }
-}
-
-bool SampleEditorBridge::savePeaksToCache(const juce::String& sampleFilePath,
-                                           const std::vector<std::pair<float, float>>& peaks)
-{
-    juce::File cacheFile = getPeaksCacheFile(sampleFilePath);
-
-    try
-    {
-        // Build JSON
-        juce::DynamicObject::Ptr root = new juce::DynamicObject();
-        root->setProperty("version", 1);
-        root->setProperty("numPoints", static_cast<int>(peaks.size()));
-
-        juce::Array<juce::var> peaksArray;
-        for (const auto& peak : peaks)
-        {
-            juce::Array<juce::var> peakPair;
-            peakPair.add(peak.first);
-            peakPair.add(peak.second);
-            peaksArray.add(juce::var(peakPair));
-        }
-        root->setProperty("peaks", peaksArray);
-
-        juce::String jsonContent = juce::JSON::toString(juce::var(root.get()));
-
-        return cacheFile.replaceWithText(jsonContent);
-    }
-    catch (...)
-    {
-        DBG("SampleEditorBridge: Error writing peaks cache");
-        return false;
-    }
-}
-
 void SampleEditorBridge::deletePeaksCache(const juce::String& sampleFilePath)
 {
     juce::File cacheFile = getPeaksCacheFile(sampleFilePath);
@@ -6,6 +6,9 @@
     - Track-based editing (routes operations to correct SamplePlayerPlugin)
     - BPM detection results
     - Editing state notifications
+    - Edits as background jobs, one after another per track, with progress
+      reports and cancellation; each is committed with its undo point in one
+      step on the message thread
 */
 
 #pragma once
@@ -13,14 +16,60 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <utility>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
 #include "SamplePlayerManager.h"
 #include "../Plugins/SamplePlayerPlugin.h"
 
-class SampleEditorBridge
+class SampleEditorBridge : private juce::Timer
 {
 public:
     SampleEditorBridge(SamplePlayerManager& manager);
-    ~SampleEditorBridge();
+    ~SampleEditorBridge() override;
+
+    //==============================================================================
+    // Edit Jobs
+    //
+    // Every operation below that changes a sample (and copy, detect BPM and
+    // save, so they see the edits queued before them) runs as a job on a
+    // background pool: in submission order per track, tracks side by side.
+    // A job edits a working copy of the track's SampleEditor and writes it
+    // to a file next to the sample; back on the message thread the copy is
+    // committed with its undo point, the file moved over the sample and the
+    // player reloaded.  Until then the track plays and shows what it had.
+    // Playback offsets and queries apply at once.  Message thread only.
+
+    /** Progress of an edit job, reported on the message thread. */
+    struct EditProgress
+    {
+        int jobId = 0;
+        int trackIndex = 0;
+        juce::String operation;     // e.g. "timeStretch"
+        double progress = 0.0;      // 0..1
+        bool started = false;       // false while waiting behind the track's earlier jobs
+        bool finished = false;      // true once for the last report of the job
+        bool succeeded = false;     // with finished: the edit was committed
+        bool cancelled = false;     // with finished: cancelled before it was committed
+        juce::String filePath;      // with finished: the track's file (may now end in .wav)
+    };
+
+    using EditProgressCallback = std::function<void(const EditProgress&)>;
+
+    /**
+     * Cancel a job.  A queued job is dropped at once; a running one stops at
+     * its next check and its working copy is discarded.  Either way the
+     * sample is left as it was and the job gets its final, cancelled report.
+     * Returns false if there is no such job (or it already finished).
+     */
+    bool cancelJob(int jobId);
+
+    /** Cancel every job queued or running for a track.  Returns how many. */
+    int cancelJobsForTrack(int trackIndex);
+
+    /** True while a track has edit jobs queued or running. */
+    bool hasPendingJobs(int trackIndex) const;
 
     //==============================================================================
     // Load for Editing
@@ -38,28 +87,36 @@ public:
     // Time Stretch / Warp
 
     /**
-     * Apply time stretch to a track's sample.
+     * Apply time stretch to a track's sample (as a job).
      * @param trackIndex Track index
      * @param ratio Stretch ratio (2.0 = twice as long)
      * @param targetLengthSeconds If > 0, pad/trim to this length after stretching
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void timeStretch(int trackIndex, double ratio, double targetLengthSeconds = 0.0);
+    int timeStretch(int trackIndex, double ratio, double targetLengthSeconds = 0.0,
+                    EditProgressCallback callback = nullptr);
 
     /**
-     * Apply warp to match sample BPM to target BPM.
+     * Apply warp to match sample BPM to target BPM (as a job).
      * @param trackIndex Track index
      * @param sampleBPM Original BPM of sample (0 = auto-detect)
      * @param targetBPM Target BPM to match
      * @param targetLengthSeconds If > 0, pad/trim to this length after warping
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void applyWarp(int trackIndex, double sampleBPM, double targetBPM, double targetLengthSeconds = 0.0);
+    int applyWarp(int trackIndex, double sampleBPM, double targetBPM, double targetLengthSeconds = 0.0,
+                  EditProgressCallback callback = nullptr);
 
     /**
-     * Detect BPM of a track's sample.
+     * Detect BPM of a track's sample (as a job).  When it has finished,
+     * getStoredBPM() holds the result (60-180 range), or 0 if detection failed.
      * @param trackIndex Track index
-     * @return Detected BPM (60-180 range), or 0 if detection fails
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    double detectBPM(int trackIndex);
+    int detectBPM(int trackIndex, EditProgressCallback callback = nullptr);
 
     //==============================================================================
     // Playback Offset
@@ -93,16 +150,22 @@ public:
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void fadeIn(int trackIndex, double startSeconds, double endSeconds);
+    int fadeIn(int trackIndex, double startSeconds, double endSeconds,
+               EditProgressCallback callback = nullptr);
 
     /**
      * Apply fade out to a time range.
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void fadeOut(int trackIndex, double startSeconds, double endSeconds);
+    int fadeOut(int trackIndex, double startSeconds, double endSeconds,
+                EditProgressCallback callback = nullptr);
 
     //==============================================================================
     // Selection Operations
@@ -112,47 +175,64 @@ public:
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void silence(int trackIndex, double startSeconds, double endSeconds);
+    int silence(int trackIndex, double startSeconds, double endSeconds,
+                EditProgressCallback callback = nullptr);
 
     /**
      * Trim to a time range (keep only this region).
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void trim(int trackIndex, double startSeconds, double endSeconds);
+    int trim(int trackIndex, double startSeconds, double endSeconds,
+             EditProgressCallback callback = nullptr);
 
     /**
      * Delete a time range (opposite of trim - remove this region).
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void deleteRange(int trackIndex, double startSeconds, double endSeconds);
+    int deleteRange(int trackIndex, double startSeconds, double endSeconds,
+                    EditProgressCallback callback = nullptr);
 
     /**
      * Copy a time range to internal clipboard.
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void copyRange(int trackIndex, double startSeconds, double endSeconds);
+    int copyRange(int trackIndex, double startSeconds, double endSeconds,
+                  EditProgressCallback callback = nullptr);
 
     /**
      * Cut a time range (copy to clipboard and delete).
      * @param trackIndex Track index
      * @param startSeconds Start time in seconds
      * @param endSeconds End time in seconds
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void cutRange(int trackIndex, double startSeconds, double endSeconds);
+    int cutRange(int trackIndex, double startSeconds, double endSeconds,
+                 EditProgressCallback callback = nullptr);
 
     /**
      * Paste clipboard contents at position.
      * @param trackIndex Track index
      * @param positionSeconds Position to insert at
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void paste(int trackIndex, double positionSeconds);
+    int paste(int trackIndex, double positionSeconds, EditProgressCallback callback = nullptr);
 
     /**
      * Check if clipboard has data.
@@ -167,20 +247,26 @@ public:
     /**
      * Reset sample to original (undo all edits).
      * @param trackIndex Track index
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void reset(int trackIndex);
+    int reset(int trackIndex, EditProgressCallback callback = nullptr);
 
     /**
      * Undo last operation.
      * @param trackIndex Track index
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void undo(int trackIndex);
+    int undo(int trackIndex, EditProgressCallback callback = nullptr);
 
     /**
      * Redo previously undone operation.
      * @param trackIndex Track index
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    void redo(int trackIndex);
+    int redo(int trackIndex, EditProgressCallback callback = nullptr);
 
     /**
      * Check if undo is available.
@@ -200,20 +286,27 @@ public:
     // Save
 
     /**
-     * Save edited sample to file.
+     * Save edited sample to file (as a job, so it includes the edits queued
+     * before it).  The final report's succeeded says whether the save worked.
      * @param trackIndex Track index
      * @param filePath Path to save to
-     * @return true if save succeeded
+     * @param callback Receives the job's progress reports
+     * @return Job id
      */
-    bool saveToFile(int trackIndex, const juce::String& filePath);
+    int saveToFile(int trackIndex, const juce::String& filePath, EditProgressCallback callback = nullptr);
 
     /**
      * Flush all edited samples to disk.
      * For each track with an edited buffer, saves the buffer to its file path
      * and reloads the player from the file so all playback paths use the same data.
-     * Call before Live Mode preload or project save.
+     * Call before Live Mode preload or project save.  While edit jobs are queued
+     * or running the flush waits for them (without blocking the message thread,
+     * which commits them), so the files include every edit asked for.
+     * @param onFlushed Called on the message thread once the files are written
+     *                  (at once if no jobs are pending); not called if the bridge
+     *                  is destroyed first
      */
-    void flushAllEditsToDisk();
+    void flushAllEditsToDisk(std::function<void()> onFlushed = nullptr);
 
     //==============================================================================
     // Query
@@ -255,15 +348,38 @@ public:
 
     /**
      * Get waveform peaks for display.
-     * Uses cached .peaks file if available, otherwise generates and caches.
+     * Served from the buffer's peak pyramid (restored from AnalysisCache on load).
      * @param trackIndex Track index
      * @param numPoints Number of points (typically canvas width)
      * @return Vector of min/max pairs
      */
     std::vector<std::pair<float, float>> getWaveformPeaks(int trackIndex, int numPoints);
 
+    /**
+     * Waveform frames and transients for a zoom range, packed for the
+     * api/waveform.bin resource (read in JS as typed arrays).
+     *
+     * Layout, little-endian:
+     *   Uint32  [4]  version (1), numPoints, numTransients, channel
+     *   Float64 [4]  duration, startSeconds, endSeconds, sampleRate
+     *   Float32 [numPoints * 3]  min, max, rms per frame
+     *   (4 zero bytes if needed so the next field is 8-byte aligned)
+     *   Float64 [numTransients]  transient positions in seconds
+     *
+     * @param trackIndex Track index
+     * @param startSeconds Start of the range
+     * @param endSeconds End of the range; <= 0 for the end of the sample
+     * @param numPoints Number of frames
+     * @param channel Channel to summarise
+     * @return The packed data, or an empty block if nothing is loaded
+     */
+    juce::MemoryBlock getWaveformBinary(int trackIndex, double startSeconds, double endSeconds,
+                                        int numPoints, int channel = 0);
+
     /**
      * Invalidate cached peaks for a track (call after editing).
+     * Only .peaks files left by older versions remain to delete; the peaks
+     * themselves follow the edited buffer.
      * @param trackIndex Track index
      */
     void invalidatePeaksCache(int trackIndex);
@@ -281,6 +397,57 @@ private:
     // Track file paths for caching
     std::map<int, juce::String> trackFilePaths;
 
+    // Edits a working copy on the job pool; returns false if it failed
+    using Edit = std::function<bool(SampleEditor& editor, SampleDSP::Progress& progress)>;
+
+    struct EditJob
+    {
+        int id = 0;
+        int trackIndex = 0;
+        juce::String operation;
+        Edit edit;
+        bool writesAudio = false;                         // save and reload the sample if the edit changed it
+        EditProgressCallback callback;
+
+        SampleDSP::Progress progress;                     // shared with the pool job
+        std::unique_ptr<SampleEditor> workingCopy;        // made when the job starts
+        std::unique_ptr<juce::TemporaryFile> editedFile;  // written by the pool job, moved into place on commit
+        bool succeeded = false;                           // written by the pool job
+        bool started = false;                             // message thread
+        double reportedProgress = 0.0;                    // message thread
+    };
+
+    // Per track, the running job (if any) first, then the queued ones
+    std::map<int, std::deque<std::shared_ptr<EditJob>>> trackJobs;
+    int nextJobId = 1;
+    juce::ThreadPool jobPool;
+
+    // Flushes waiting for the pending jobs, with their completions
+    std::vector<std::function<void()>> flushesAfterJobs;
+
+    int submitJob(int trackIndex, const juce::String& operation, bool writesAudio,
+                  Edit edit, EditProgressCallback callback);
+
+    // Message thread: start the track's next queued job, if none is running
+    void startNextJob(int trackIndex);
+
+    // Pool thread: run the edit on the working copy and write the result
+    static void runJob(EditJob& job);
+
+    // Message thread: commit (or drop) a job the pool is done with, then start the next
+    void finishJob(const std::shared_ptr<EditJob>& job);
+
+    void reportJobProgress(EditJob& job, bool finished = false, bool succeeded = false);
+
+    // True while any track has edit jobs queued or running
+    bool hasAnyPendingJobs() const;
+
+    // Message thread: run the waiting flushes once no jobs are left
+    void runFlushesIfIdle();
+
+    // Sends progress of running jobs (they update it from the pool)
+    void timerCallback() override;
+
     // Get sample editor for a track (returns nullptr if not available)
     SampleEditor* getEditorForTrack(int trackIndex);
 
@@ -288,11 +455,17 @@ private:
     // Returns the path saved to (may differ from original if extension changed), or empty on failure/no-op.
     juce::String flushTrackToDisk(int trackIndex);
 
+    // Move a committed job's file over the track's sample and reload from it.
+    // Returns the path now holding the sample, or empty on failure.
+    juce::String installEditedFile(int trackIndex, juce::TemporaryFile& editedFile);
+
+    // The file an edited sample is written to: its own, as .wav
+    static juce::File getSaveFileFor(const juce::String& filePath);
+
     // Peaks cache helpers
     juce::File getPeaksCacheFile(const juce::String& sampleFilePath);
-    bool loadPeaksFromCache(const juce::String& sampleFilePath, std::vector<std::pair<float, float>>& peaks, int expectedNumPoints);
-    bool savePeaksToCache(const juce::String& sampleFilePath, const std::vector<std::pair<float, float>>& peaks);
     void deletePeaksCache(const juce::String& sampleFilePath);
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SampleEditorBridge)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleEditorBridge)
 };
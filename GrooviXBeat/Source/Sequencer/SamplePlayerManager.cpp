@@ -3,16 +3,26 @@
 */
 
 #include "SamplePlayerManager.h"
+#include "../Audio/SampleDSP.h"
 
 //==============================================================================
 SamplePlayerManager::SamplePlayerManager()
+    : preloadPool(juce::jlimit(2, 8, juce::SystemStats::getNumCpus() - 1)),
+      scenePreparePool(juce::jlimit(2, 4, juce::SystemStats::getNumCpus() / 2))
 {
-    // Initialize format manager for cache loading
-    cacheFormatManager.registerBasicFormats();
 }
 
 SamplePlayerManager::~SamplePlayerManager()
 {
+    // Stop decoding before the cache goes away.  Completions already posted to
+    // the message thread see the weak reference cleared and do nothing.  No
+    // final report here: the owner of the callback is being torn down too.
+    if (currentPreload != nullptr)
+        currentPreload->cancelled = true;
+    currentPreload = nullptr;
+    preloadPool.removeAllJobs(true, 5000);
+    scenePreparePool.removeAllJobs(true, 5000);
+
     // Note: We don't delete the plugins here as they are owned by PluginGraph
     trackPlayers.clear();
 
@@ -29,6 +39,7 @@ SamplePlayerPlugin* SamplePlayerManager::createPlayerForTrack(int trackIndex)
 
     auto* player = new SamplePlayerPlugin();
     player->setTrackIndex(trackIndex);
+    player->setTempoFollow(tempoFollowEnabled);
     trackPlayers[trackIndex] = player;
 
     DBG("SamplePlayerManager: Created player for track " + juce::String(trackIndex));
@@ -42,6 +53,7 @@ void SamplePlayerManager::registerPlayerForTrack(int trackIndex, SamplePlayerPlu
     if (player != nullptr)
     {
         player->setTrackIndex(trackIndex);
+        player->setTempoFollow(tempoFollowEnabled);
         trackPlayers[trackIndex] = player;
         DBG("SamplePlayerManager: Registered player for track " + juce::String(trackIndex));
     }
@@ -112,29 +124,28 @@ void SamplePlayerManager::playSampleFile(int trackIndex,
     DBG("SamplePlayerManager::playSampleFile - requestedPath: '" + filePath + "'");
     DBG("SamplePlayerManager::playSampleFile - paths equal: " + juce::String(currentPath == filePath ? "YES" : "NO"));
 
+    // Set looping mode and loop length first: a streamed file sizes its
+    // read-ahead from the loop length at load time.
+    player->setLooping(loop);
+    if (loop && loopLengthBeats > 0)
+    {
+        player->setLoopLengthBeats(loopLengthBeats);
+        DBG("SamplePlayerManager: Set loop length to " + juce::String(loopLengthBeats) + " beats");
+    }
+
     if (currentPath != filePath)
     {
         bool loaded = false;
 
         // Check cache first for instant loading.
-        // Copy the raw pointer under cacheLock, then fit/load outside (same message thread,
-        // so the pointer stays valid between releasing cacheLock and using it).
-        const juce::AudioBuffer<float>* rawBuf    = nullptr;
-        double                          rawSampleRate = 0.0;
-        {
-            juce::ScopedLock sl(cacheLock);
-            auto it = sampleCache.find(filePath);
-            if (it != sampleCache.end() && it->second != nullptr)
-            {
-                rawBuf       = &it->second->buffer;
-                rawSampleRate = it->second->sampleRate;
-            }
-        }
-        if (rawBuf != nullptr)
+        // Take a shared reference under cacheLock, then load outside — the
+        // reference keeps the buffer alive even if the cache is cleared meanwhile.
+        // The loop fit is only a play length, so this copies nothing at any tempo.
+        if (auto cached = getCachedSample(filePath))
         {
             DBG("SamplePlayerManager::playSampleFile - LOADING FROM CACHE");
-            auto fitted = fitBufferToLoopLength(*rawBuf, rawSampleRate, loopLengthBeats, currentBpm);
-            loaded = player->loadFromCachedBuffer(filePath, fitted, rawSampleRate);
+            const auto playLength = getLoopFitLength(*cached, loopLengthBeats, currentBpm);
+            loaded = player->loadFromCachedBuffer(filePath, cached, playLength);
             if (loaded)
                 DBG("SamplePlayerManager::playSampleFile - Loaded from cache successfully");
         }
@@ -143,7 +154,7 @@ void SamplePlayerManager::playSampleFile(int trackIndex,
         if (!loaded)
         {
             DBG("SamplePlayerManager::playSampleFile - LOADING FROM FILE");
-            if (!player->loadFile(filePath))
+            if (!player->loadFile(filePath, offset))
             {
                 DBG("SamplePlayerManager: Failed to load file: " + filePath);
                 return;
@@ -156,14 +167,6 @@ void SamplePlayerManager::playSampleFile(int trackIndex,
         DBG("SamplePlayerManager::playSampleFile - SKIPPING LOAD (same file)");
     }
 
-    // Set looping mode and loop length
-    player->setLooping(loop);
-    if (loop && loopLengthBeats > 0)
-    {
-        player->setLoopLengthBeats(loopLengthBeats);
-        DBG("SamplePlayerManager: Set loop length to " + juce::String(loopLengthBeats) + " beats");
-    }
-
     DBG("SamplePlayerManager::playSampleFile - calling play()");
     player->play(offset);
     DBG("SamplePlayerManager: Playing track " + juce::String(trackIndex) +
@@ -254,7 +257,7 @@ void SamplePlayerManager::queueSampleFile(int trackIndex,
     // Load file if different from current
     if (player->getCurrentFilePath() != filePath)
     {
-        if (!player->loadFile(filePath))
+        if (!player->loadFile(filePath, offset))
         {
             DBG("SamplePlayerManager: Failed to load file: " + filePath);
             return;
@@ -291,47 +294,30 @@ void SamplePlayerManager::queueSampleFileSeamless(int trackIndex,
     // (no need for seamless switch). But if the source isn't valid, we need to load it.
     if (player->getCurrentFilePath() == filePath && player->hasValidSource())
     {
-        player->setTargetStartSample(targetStartSample);
-        player->queuePlay(offset);
+        if (targetStartSample == -1)
+            player->queuePlay(offset);
+        else
+            player->scheduleStart(targetStartSample, offset);
         DBG("SamplePlayerManager: Queued same file for track " + juce::String(trackIndex));
         return;
     }
 
-    // Load into a buffer (from cache or disk), resize to exact loop length, then
-    // hand to the player as a pending cached buffer.  This guarantees that the
-    // audio delivered to the player is sample-accurate: longer files are truncated
-    // at the loop boundary; shorter files are zero-padded so the loop wraps cleanly.
-    juce::AudioBuffer<float> workBuffer;
-    double workSampleRate = 0.0;
-    bool   loaded         = false;
+    // Load into a buffer (from cache or disk) and hand it to the player as a
+    // pending cached buffer with a play length of exactly one loop.  This keeps
+    // the audio sample-accurate: longer files are truncated at the loop boundary;
+    // shorter files are silence-padded so the loop wraps cleanly.  The fit is a
+    // view over the shared buffer, so a cached clip is never copied.
+    //
+    // getCachedSample() holds cacheLock only long enough to take a reference.
+    SharedSampleBuffer::Ptr workBuffer = getCachedSample(filePath);
 
+    if (workBuffer != nullptr)
     {
-        // Hold cacheLock only long enough to copy the raw buffer pointer and metadata.
-        // fitBufferToLoopLength() does a large allocation + copy — doing it inside
-        // cacheLock would block other cache accesses for tens of milliseconds.
-        const juce::AudioBuffer<float>* rawBuf = nullptr;
-        double rawSampleRate = 0.0;
-        {
-            juce::ScopedLock sl(cacheLock);
-            auto it = sampleCache.find(filePath);
-            if (it != sampleCache.end() && it->second != nullptr)
-            {
-                rawBuf       = &it->second->buffer;
-                rawSampleRate = it->second->sampleRate;
-            }
-        }
-        if (rawBuf != nullptr)
-        {
-            DBG("SamplePlayerManager::queueSampleFileSeamless - USING CACHED BUFFER");
-            workBuffer     = fitBufferToLoopLength(*rawBuf, rawSampleRate, loopLengthBeats, currentBpm);
-            workSampleRate = rawSampleRate;
-            loaded         = true;
-        }
+        DBG("SamplePlayerManager::queueSampleFileSeamless - USING CACHED BUFFER");
     }
-
-    if (!loaded)
+    else
     {
-        // Not in cache — read the file directly into a buffer, then resize.
+        // Not in cache — read the file directly into a buffer.
         DBG("SamplePlayerManager::queueSampleFileSeamless - LOADING FROM FILE");
         juce::File file(filePath);
         if (!file.existsAsFile())
@@ -339,27 +325,15 @@ void SamplePlayerManager::queueSampleFileSeamless(int trackIndex,
             DBG("SamplePlayerManager: File not found: " + filePath);
             return;
         }
-        std::unique_ptr<juce::AudioFormatReader> reader(cacheFormatManager.createReaderFor(file));
-        if (reader == nullptr)
+        workBuffer = samplePool->get(filePath, cacheStorage);
+        if (workBuffer == nullptr)
         {
             DBG("SamplePlayerManager: Could not create reader for: " + filePath);
             return;
         }
-        juce::AudioBuffer<float> fileBuffer((int)reader->numChannels, (int)reader->lengthInSamples);
-        reader->read(&fileBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
-        workSampleRate = reader->sampleRate;
-        workBuffer     = fitBufferToLoopLength(fileBuffer, workSampleRate, loopLengthBeats, currentBpm);
-        loaded         = true;
-    }
-
-    if (!loaded || workBuffer.getNumSamples() == 0)
-    {
-        DBG("SamplePlayerManager: Empty buffer for track " + juce::String(trackIndex));
-        return;
     }
 
-    bool queued = player->loadCachedBufferForPendingPlay(filePath, workBuffer, workSampleRate, offset);
-    if (!queued)
+    if (!armSampleBuffer(*player, filePath, workBuffer, offset, loopLengthBeats, targetStartSample))
     {
         DBG("SamplePlayerManager: Failed to load pending buffer for track " + juce::String(trackIndex));
         return;
@@ -367,10 +341,29 @@ void SamplePlayerManager::queueSampleFileSeamless(int trackIndex,
 
     DBG("SamplePlayerManager: Queued seamless transition for track " + juce::String(trackIndex) +
         " - " + filePath);
+}
+
+bool SamplePlayerManager::armSampleBuffer(SamplePlayerPlugin& player,
+                                          const juce::String& filePath,
+                                          SharedSampleBuffer::Ptr buffer,
+                                          double offset,
+                                          double loopLengthBeats,
+                                          int64_t targetStartSample)
+{
+    const auto playLength = getLoopFitLength(*buffer, loopLengthBeats, currentBpm);
+
+    if (buffer->getNumSamples() == 0 || playLength == 0)
+    {
+        DBG("SamplePlayerManager: Empty buffer for " + filePath);
+        return false;
+    }
 
-    // Set the audio-thread target so processBlock fires at the exact boundary sample.
-    // This must be done AFTER loading the pending buffer so the player is ready.
-    player->setTargetStartSample(targetStartSample);
+    // With a target the buffer travels inside the start event, so the audio
+    // thread switches at the exact boundary sample; without one it waits as the
+    // pending source for the next transport boundary.
+    return (targetStartSample == -1)
+               ? player.loadCachedBufferForPendingPlay(filePath, buffer, offset, playLength)
+               : player.scheduleCachedBufferStart(filePath, buffer, targetStartSample, offset, playLength);
 }
 
 void SamplePlayerManager::queueStopSample(int trackIndex, int64_t targetStopSample)
@@ -378,8 +371,10 @@ void SamplePlayerManager::queueStopSample(int trackIndex, int64_t targetStopSamp
     auto* player = getPlayerForTrack(trackIndex);
     if (player != nullptr)
     {
-        player->setTargetStopSample(targetStopSample);
-        player->queueStop();
+        if (targetStopSample == -1)
+            player->queueStop();
+        else
+            player->scheduleStop(targetStopSample);
         DBG("[SPM] queueStopSample T" + juce::String(trackIndex)
             + " targetStop=" + juce::String(targetStopSample));
 
@@ -412,7 +407,7 @@ void SamplePlayerManager::queueMuteSample(int trackIndex, int64_t targetSample)
     auto* player = getPlayerForTrack(trackIndex);
     if (player != nullptr)
     {
-        player->setTargetMuteSample(targetSample);
+        player->scheduleMute(targetSample);
         DBG("[SPM] queueMuteSample T" + juce::String(trackIndex)
             + " target=" + juce::String(targetSample));
     }
@@ -423,7 +418,7 @@ void SamplePlayerManager::queueUnmuteSample(int trackIndex, int64_t targetSample
     auto* player = getPlayerForTrack(trackIndex);
     if (player != nullptr)
     {
-        player->setTargetUnmuteSample(targetSample);
+        player->scheduleUnmute(targetSample);
         DBG("[SPM] queueUnmuteSample T" + juce::String(trackIndex)
             + " target=" + juce::String(targetSample));
     }
@@ -444,6 +439,18 @@ void SamplePlayerManager::setTrackLoopLengthBars(int trackIndex, double bars)
     setTrackLoopLengthBeats(trackIndex, bars * 4.0);
 }
 
+void SamplePlayerManager::setTempoFollow(bool shouldFollow)
+{
+    juce::ScopedLock sl(lock);
+
+    tempoFollowEnabled = shouldFollow;
+    for (auto& pair : trackPlayers)
+        if (pair.second != nullptr)
+            pair.second->setTempoFollow(shouldFollow);
+
+    DBG("SamplePlayerManager: Tempo follow " + juce::String(shouldFollow ? "on" : "off"));
+}
+
 //==============================================================================
 // Scene Triggering
 
@@ -456,42 +463,274 @@ void SamplePlayerManager::triggerScene(int sceneIndex,
     DBG("SamplePlayerManager: Triggering scene " + juce::String(sceneIndex) +
         " with " + juce::String(clips.size()) + " clips");
 
-    // First, queue stop for all currently playing/queued samples
+    // One pass over the scene: cached clips are armed from the cache, the rest
+    // stream or map from disk as before, so nothing here waits for a decode.
+    std::set<int> sceneTracks;
+
+    for (const auto& clip : clips)
+    {
+        auto* player = getPlayerForTrack(clip.trackIndex);
+        if (player == nullptr)
+            continue;
+
+        sceneTracks.insert(clip.trackIndex);
+
+        // Set loop length (before loading, so streaming is sized for it)
+        player->setLoopLengthBeats(clip.loopLengthBeats);
+
+        if (auto cached = getCachedSample(clip.filePath))
+        {
+            if (armSampleBuffer(*player, clip.filePath, cached, clip.offset, clip.loopLengthBeats, -1))
+                continue;
+        }
+        else if (player->getCurrentFilePath() == clip.filePath
+                 || player->loadFile(clip.filePath, clip.offset))
+        {
+            player->queuePlay(clip.offset);
+            continue;
+        }
+
+        DBG("SamplePlayerManager: Failed to load " + clip.filePath +
+            " for track " + juce::String(clip.trackIndex));
+        player->queueStop();
+    }
+
+    // Then stop every other track that is playing or queued to play
     for (auto& pair : trackPlayers)
     {
-        if (pair.second != nullptr)
+        auto* player = pair.second;
+        if (player != nullptr && sceneTracks.count(pair.first) == 0
+            && (player->isCurrentlyPlaying() || player->isQueuedToPlay()))
+            player->queueStop();
+    }
+}
+
+void SamplePlayerManager::launchScene(const std::vector<SceneLaunchClip>& clips,
+                                       const std::function<int64_t()>& getTargetSample,
+                                       bool stopOtherTracks,
+                                       int prepareTimeoutMs)
+{
+    auto prepare = std::make_shared<ScenePrepare>(clips.size());
+    prepare->generation      = ++sceneLaunchGeneration;
+    prepare->getTargetSample = getTargetSample;
+    prepare->stopOtherTracks = stopOtherTracks;
+    prepare->startMs         = juce::Time::getMillisecondCounterHiRes();
+
+    // -------------------------------------------------------------------------
+    // Prepare: cache hits are taken here at once; only misses go to the scene
+    // prepare pool, where they decode through the SamplePool in parallel.  The
+    // jobs only touch their own slot.
+    const auto storage = getCacheStorage();
+    juce::WeakReference<SamplePlayerManager> weakThis(this);
+    std::vector<size_t> misses;
+
+    for (size_t i = 0; i < clips.size(); ++i)
+    {
+        auto& slot   = prepare->slots[i];
+        slot.clip    = clips[i];
+        slot.version = getSampleFileVersion(clips[i].filePath);
+        slot.buffer  = getCachedSample(clips[i].filePath);
+
+        if (slot.buffer != nullptr)
         {
-            // Only queue stop if playing or queued to play
-            if (pair.second->isCurrentlyPlaying() || pair.second->isQueuedToPlay())
-            {
-                pair.second->queueStop();
-            }
+            slot.fromCache = true;
+            slot.ready.store(true, std::memory_order_relaxed);
+        }
+        else
+        {
+            misses.push_back(i);
         }
     }
 
-    // Then queue all clips in the scene
-    for (const auto& clip : clips)
+    prepare->pendingDecodes = (int)misses.size();
+
+    if (misses.empty())
+    {
+        commitScene(prepare);
+        return;
+    }
+
+    for (auto i : misses)
+    {
+        scenePreparePool.addJob([weakThis, prepare, i, storage]
+        {
+            auto& job = prepare->slots[i];
+            job.buffer = decodeSampleFile(job.clip.filePath, storage);
+            job.ready.store(true, std::memory_order_release);
+
+            // Commits the scene if this was the last one outstanding, or
+            // joins late if the deadline has already committed it.
+            juce::MessageManager::callAsync([weakThis, prepare, i]
+            {
+                if (auto* manager = weakThis.get())
+                    manager->handleScenePrepared(prepare, i);
+            });
+        });
+    }
+
+    // Commit with what is ready once the deadline passes
+    juce::Timer::callAfterDelay(juce::jmax(1, prepareTimeoutMs), [weakThis, prepare]
     {
+        if (auto* manager = weakThis.get())
+            manager->commitScene(prepare);
+    });
+}
+
+void SamplePlayerManager::commitScene(const std::shared_ptr<ScenePrepare>& prepare)
+{
+    if (prepare->committed)
+        return;
+    prepare->committed = true;
+
+    // A newer launch owns the tracks now: nothing of this one is armed.
+    if (prepare->generation != sceneLaunchGeneration)
+    {
+        for (auto& slot : prepare->slots)
+            slot.handled = true;
+        DBG("SamplePlayerManager: Scene launch #" + juce::String((juce::int64)prepare->generation)
+            + " superseded before its commit");
+        return;
+    }
+
+    const double prepareMs = juce::Time::getMillisecondCounterHiRes() - prepare->startMs;
+    sceneLaunchStats.lastPrepareMs = prepareMs;
+    sceneLaunchStats.maxPrepareMs  = juce::jmax(sceneLaunchStats.maxPrepareMs, prepareMs);
+    ++sceneLaunchStats.scenesLaunched;
+
+    // The target is taken only now, so time spent waiting for decodes does
+    // not leave the scene aimed at a sample the audio thread has passed.
+    const int64_t targetSample = prepare->getTargetSample != nullptr ? prepare->getTargetSample() : -1;
+    prepare->targetSample = targetSample;
+    prepare->getTargetSample = nullptr;
+
+    // -------------------------------------------------------------------------
+    // Commit: one pass, every track armed for the same sample position.
+    juce::ScopedLock sl(lock);
+
+    std::set<int> sceneTracks;
+    int numArmed = 0, numLate = 0, numFailed = 0;
+
+    for (auto& slot : prepare->slots)
+    {
+        const auto& clip = slot.clip;
+        sceneTracks.insert(clip.trackIndex);
+
         auto* player = getPlayerForTrack(clip.trackIndex);
         if (player == nullptr)
+        {
+            slot.handled = true;
             continue;
+        }
 
-        // Load file if different
-        if (player->getCurrentFilePath() != clip.filePath)
+        if (!slot.ready.load(std::memory_order_acquire))
+        {
+            // Not ready in time: silence the old clip with the rest of the
+            // scene; handleScenePrepared() starts this one when it arrives.
+            ++numLate;
+            DBG("SamplePlayerManager: Scene clip not ready for track " + juce::String(clip.trackIndex)
+                + " - " + clip.filePath);
+        }
+        else
         {
-            if (!player->loadFile(clip.filePath))
+            slot.handled = true;
+
+            player->setLooping(clip.loop);
+            if (clip.loop && clip.loopLengthBeats > 0)
+                player->setLoopLengthBeats(clip.loopLengthBeats);
+
+            if (slot.buffer != nullptr
+                && armSampleBuffer(*player, clip.filePath, slot.buffer, clip.offset,
+                                   clip.loopLengthBeats, targetSample))
             {
-                DBG("SamplePlayerManager: Failed to load " + clip.filePath +
-                    " for track " + juce::String(clip.trackIndex));
+                ++numArmed;
                 continue;
             }
+
+            ++numFailed;
+            DBG("SamplePlayerManager: Failed to load " + clip.filePath +
+                " for track " + juce::String(clip.trackIndex));
         }
 
-        // Set loop length
-        player->setLoopLengthBeats(clip.loopLengthBeats);
+        if (targetSample == -1)
+            player->queueStop();
+        else
+            player->scheduleStop(targetSample);
+    }
+
+    if (prepare->stopOtherTracks)
+    {
+        for (auto& pair : trackPlayers)
+        {
+            auto* player = pair.second;
+            if (player == nullptr || sceneTracks.count(pair.first) > 0)
+                continue;
+
+            if (targetSample == -1)
+            {
+                if (player->isCurrentlyPlaying() || player->isQueuedToPlay())
+                    player->queueStop();
+            }
+            else
+            {
+                player->scheduleStop(targetSample);  // no-op if not playing by then
+            }
+        }
+    }
+
+    sceneLaunchStats.clipsArmed  += (juce::uint64)numArmed;
+    sceneLaunchStats.clipsLate   += (juce::uint64)numLate;
+    sceneLaunchStats.clipsFailed += (juce::uint64)numFailed;
+
+    DBG("SamplePlayerManager: Scene launch #" + juce::String((juce::int64)prepare->generation)
+        + " armed " + juce::String(numArmed) + "/" + juce::String((int)prepare->slots.size())
+        + " (late: " + juce::String(numLate) + ", failed: " + juce::String(numFailed)
+        + ") prepare " + juce::String(prepareMs, 1) + " ms, target " + juce::String(targetSample));
+}
+
+void SamplePlayerManager::handleScenePrepared(const std::shared_ptr<ScenePrepare>& prepare, size_t slotIndex)
+{
+    auto& slot = prepare->slots[slotIndex];
+
+    // Keep fresh decodes for the next launch, whether or not they made it.
+    if (slot.buffer != nullptr && !slot.fromCache)
+    {
+        const auto pathsInUse = getPathsInUse();
+        juce::ScopedLock sl(cacheLock);
+        insertIntoCache(slot.clip.filePath, slot.buffer, slot.version, pathsInUse);
+    }
+
+    // The last decode of a launch still waiting for its deadline commits it
+    if (!prepare->committed)
+    {
+        if (--prepare->pendingDecodes == 0)
+            commitScene(prepare);
+        return;
+    }
+
+    if (slot.handled)
+        return;
+    slot.handled = true;
+
+    // A newer launch owns the tracks now.
+    if (prepare->generation != sceneLaunchGeneration || slot.buffer == nullptr)
+        return;
+
+    juce::ScopedLock sl(lock);
+
+    auto* player = getPlayerForTrack(slot.clip.trackIndex);
+    if (player == nullptr)
+        return;
 
-        // Queue playback
-        player->queuePlay(clip.offset);
+    player->setLooping(slot.clip.loop);
+    if (slot.clip.loop && slot.clip.loopLengthBeats > 0)
+        player->setLoopLengthBeats(slot.clip.loopLengthBeats);
+
+    const int64_t target = prepare->targetSample == -1 ? -1 : SamplePlayerPlugin::atNextBoundary;
+    if (armSampleBuffer(*player, slot.clip.filePath, slot.buffer, slot.clip.offset,
+                        slot.clip.loopLengthBeats, target))
+    {
+        DBG("SamplePlayerManager: Late scene clip joins at the next boundary on track "
+            + juce::String(slot.clip.trackIndex) + " - " + slot.clip.filePath);
     }
 }
 
@@ -513,47 +752,29 @@ void SamplePlayerManager::stopScene()
 //==============================================================================
 // Transport Sync
 
-juce::AudioBuffer<float> SamplePlayerManager::fitBufferToLoopLength(const juce::AudioBuffer<float>& src,
-                                                                       double srcSampleRate,
-                                                                       double loopLengthBeats,
-                                                                       double bpm)
+juce::int64 SamplePlayerManager::getLoopFitLength(const SharedSampleBuffer& src,
+                                                  double loopLengthBeats,
+                                                  double bpm)
 {
-    const int numChannels = src.getNumChannels();
-    const int srcSamples  = src.getNumSamples();
+    const int srcSamples       = src.getNumSamples();
+    const double srcSampleRate = src.getSampleRate();
 
-    if (loopLengthBeats <= 0.0 || bpm <= 0.0 || srcSampleRate <= 0.0 || numChannels == 0)
-    {
-        // No valid loop spec — return a copy of the original buffer unchanged.
-        juce::AudioBuffer<float> copy(numChannels, srcSamples);
-        for (int ch = 0; ch < numChannels; ++ch)
-            copy.copyFrom(ch, 0, src, ch, 0, srcSamples);
-        return copy;
-    }
+    // No valid loop spec — play the whole buffer.
+    if (loopLengthBeats <= 0.0 || bpm <= 0.0 || srcSampleRate <= 0.0 || src.getNumChannels() == 0)
+        return -1;
 
-    const int targetSamples = (int)std::round(loopLengthBeats * (60.0 / bpm) * srcSampleRate);
+    const auto targetSamples = (juce::int64)std::round(loopLengthBeats * (60.0 / bpm) * srcSampleRate);
 
-    if (targetSamples == srcSamples)
+    if (targetSamples != srcSamples)
     {
-        juce::AudioBuffer<float> copy(numChannels, srcSamples);
-        for (int ch = 0; ch < numChannels; ++ch)
-            copy.copyFrom(ch, 0, src, ch, 0, srcSamples);
-        return copy;
+        DBG("[SPM] getLoopFitLength: src=" + juce::String(srcSamples)
+            + " target=" + juce::String(targetSamples)
+            + " (" + juce::String(targetSamples < srcSamples ? "truncated" : "padded") + ")"
+            + " loopBeats=" + juce::String(loopLengthBeats, 2)
+            + " bpm=" + juce::String(bpm, 1));
     }
 
-    juce::AudioBuffer<float> result(numChannels, targetSamples);
-    result.clear();  // zero-fill (handles padding automatically)
-
-    const int copyCount = std::min(srcSamples, targetSamples);
-    for (int ch = 0; ch < numChannels; ++ch)
-        result.copyFrom(ch, 0, src, ch, 0, copyCount);
-
-    DBG("[SPM] fitBufferToLoopLength: src=" + juce::String(srcSamples)
-        + " target=" + juce::String(targetSamples)
-        + " (" + juce::String(targetSamples < srcSamples ? "truncated" : "padded") + ")"
-        + " loopBeats=" + juce::String(loopLengthBeats, 2)
-        + " bpm=" + juce::String(bpm, 1));
-
-    return result;
+    return targetSamples;
 }
 
 void SamplePlayerManager::processTransportSync(double transportPositionBeats,
@@ -563,6 +784,8 @@ void SamplePlayerManager::processTransportSync(double transportPositionBeats,
 {
     currentBpm = bpm;
 
+    updateDeviceSampleRate();
+
     juce::ScopedLock sl(lock);
 
     currentQuantizeSteps = quantizeSteps;
@@ -624,66 +847,220 @@ std::vector<int> SamplePlayerManager::getTrackIndices() const
 //==============================================================================
 // Sample Caching for Live Mode
 
-void SamplePlayerManager::preloadSamplesForLiveMode(const juce::StringArray& samplePaths)
+int SamplePlayerManager::preloadSamplesAsync(const juce::StringArray& samplePaths,
+                                             PreloadProgressCallback progressCallback)
 {
-    juce::ScopedLock sl(cacheLock);
+    cancelPreload();
 
-    DBG("SamplePlayerManager: Preloading " + juce::String(samplePaths.size()) + " samples for Live Mode");
-
-    int loadedCount = 0;
-    int skippedCount = 0;
-    int failedCount = 0;
+    auto request      = std::make_shared<PreloadRequest>();
+    request->id       = nextPreloadId++;
+    request->callback = std::move(progressCallback);
 
+    juce::StringArray uniquePaths;
     for (const auto& filePath : samplePaths)
+        if (filePath.isNotEmpty())
+            uniquePaths.addIfNotAlreadyThere(filePath);
+
+    request->total = uniquePaths.size();
+    currentPreload = request;
+
+    DBG("SamplePlayerManager: Async preload #" + juce::String(request->id) +
+        " - " + juce::String(request->total) + " samples");
+
+    juce::WeakReference<SamplePlayerManager> weakThis(this);
+
+    for (const auto& filePath : uniquePaths)
     {
-        // Skip if already cached
-        if (sampleCache.find(filePath) != sampleCache.end())
+        const auto version = getSampleFileVersion(filePath);
+        bool isWarm = false;
         {
-            skippedCount++;
-            continue;
+            juce::ScopedLock sl(cacheLock);
+            if (auto* cached = findCurrentEntry(filePath, version))
+            {
+                cached->lastUsed = ++cacheUseCounter;
+                isWarm = true;
+            }
         }
 
-        juce::File file(filePath);
-        if (!file.existsAsFile())
+        if (isWarm)
         {
-            DBG("SamplePlayerManager: Cache - File not found: " + filePath);
-            failedCount++;
+            // Already warm and unchanged — counts as done straight away.
+            reportPreloadProgress(*request, filePath, true);
             continue;
         }
 
-        // Create reader for the file
-        std::unique_ptr<juce::AudioFormatReader> reader(cacheFormatManager.createReaderFor(file));
-        if (reader == nullptr)
+        preloadPool.addJob([weakThis, request, filePath, version, storage = getCacheStorage()]
         {
-            DBG("SamplePlayerManager: Cache - Could not create reader for: " + filePath);
-            failedCount++;
+            if (request->cancelled.load())
+                return;
+
+            auto buffer = decodeSampleFile(filePath, storage);
+
+            juce::MessageManager::callAsync([weakThis, request, filePath, buffer, version]
+            {
+                if (auto* manager = weakThis.get())
+                    manager->handlePreloadedSample(request, filePath, buffer, version);
+            });
+        });
+    }
+
+    // Nothing to decode (or nothing asked for): report completion now.
+    if (request->total == 0)
+        reportPreloadProgress(*request, {}, true);
+
+    return request->id;
+}
+
+void SamplePlayerManager::prefetchSamples(const juce::StringArray& samplePaths)
+{
+    juce::WeakReference<SamplePlayerManager> weakThis(this);
+    int numQueued = 0;
+
+    for (const auto& filePath : samplePaths)
+    {
+        if (filePath.isEmpty() || prefetchesInFlight.count(filePath) > 0)
             continue;
+
+        const auto version = getSampleFileVersion(filePath);
+        {
+            juce::ScopedLock sl(cacheLock);
+            if (auto* cached = findCurrentEntry(filePath, version))
+            {
+                cached->lastUsed = ++cacheUseCounter;
+                continue;
+            }
         }
 
-        // Create cached sample entry
-        auto cached = std::make_unique<CachedSample>();
-        cached->filePath = filePath;
-        cached->sampleRate = reader->sampleRate;
+        prefetchesInFlight.insert(filePath);
+        ++numQueued;
+
+        preloadPool.addJob([weakThis, filePath, version, storage = getCacheStorage()]
+        {
+            auto buffer = decodeSampleFile(filePath, storage);
+
+            juce::MessageManager::callAsync([weakThis, filePath, buffer, version]
+            {
+                if (auto* manager = weakThis.get())
+                    manager->handlePrefetchedSample(filePath, buffer, version);
+            });
+        });
+    }
 
-        // Allocate buffer and read entire file
-        int numSamples = static_cast<int>(reader->lengthInSamples);
-        int numChannels = static_cast<int>(reader->numChannels);
-        cached->buffer.setSize(numChannels, numSamples);
+    if (numQueued > 0)
+        DBG("SamplePlayerManager: Prefetching " + juce::String(numQueued) + " samples");
+}
 
-        reader->read(&cached->buffer, 0, numSamples, 0, true, true);
+void SamplePlayerManager::handlePrefetchedSample(const juce::String& filePath,
+                                                 SharedSampleBuffer::Ptr buffer,
+                                                 const SampleFileVersion& version)
+{
+    prefetchesInFlight.erase(filePath);
 
-        // Store in cache
-        sampleCache[filePath] = std::move(cached);
-        loadedCount++;
+    if (buffer == nullptr)
+    {
+        DBG("SamplePlayerManager: Prefetch failed for " + filePath);
+        return;
+    }
+
+    const auto pathsInUse = getPathsInUse();
+    juce::ScopedLock sl(cacheLock);
+    insertIntoCache(filePath, buffer, version, pathsInUse);
+}
+
+void SamplePlayerManager::cancelPreload()
+{
+    if (currentPreload == nullptr)
+        return;
 
-        DBG("SamplePlayerManager: Cached " + filePath +
-            " (" + juce::String(numSamples) + " samples, " +
-            juce::String(numChannels) + " channels)");
+    DBG("SamplePlayerManager: Cancelling preload #" + juce::String(currentPreload->id) +
+        " (" + juce::String(currentPreload->completed) + "/" + juce::String(currentPreload->total) + " done)");
+
+    auto request = std::move(currentPreload);
+    request->cancelled = true;
+
+    PreloadProgress progress;
+    progress.requestId = request->id;
+    progress.completed = request->completed;
+    progress.total     = request->total;
+    progress.finished  = true;
+    progress.cancelled = true;
+
+    if (request->callback)
+        request->callback(progress);
+}
+
+void SamplePlayerManager::handlePreloadedSample(const std::shared_ptr<PreloadRequest>& request,
+                                                const juce::String& filePath,
+                                                SharedSampleBuffer::Ptr buffer,
+                                                const SampleFileVersion& version)
+{
+    // Even for a cancelled request a finished decode is worth keeping.  If the
+    // file changed while it was decoding, the old version makes it a miss later.
+    if (buffer != nullptr)
+    {
+        const auto pathsInUse = getPathsInUse();
+        juce::ScopedLock sl(cacheLock);
+        insertIntoCache(filePath, buffer, version, pathsInUse);
+    }
+    else
+    {
+        DBG("SamplePlayerManager: Preload failed for " + filePath);
     }
 
-    DBG("SamplePlayerManager: Cache complete - loaded: " + juce::String(loadedCount) +
-        ", skipped (already cached): " + juce::String(skippedCount) +
-        ", failed: " + juce::String(failedCount));
+    if (!request->cancelled.load())
+        reportPreloadProgress(*request, filePath, buffer != nullptr);
+}
+
+void SamplePlayerManager::reportPreloadProgress(PreloadRequest& request,
+                                                const juce::String& filePath,
+                                                bool succeeded)
+{
+    if (filePath.isNotEmpty())
+        request.completed++;
+
+    PreloadProgress progress;
+    progress.requestId = request.id;
+    progress.filePath  = filePath;
+    progress.completed = request.completed;
+    progress.total     = request.total;
+    progress.succeeded = succeeded;
+    progress.finished  = request.completed >= request.total;
+
+    if (progress.finished && currentPreload.get() == &request)
+    {
+        DBG("SamplePlayerManager: Async preload #" + juce::String(request.id) + " complete");
+        currentPreload = nullptr;
+    }
+
+    if (request.callback)
+        request.callback(progress);
+}
+
+SharedSampleBuffer::Ptr SamplePlayerManager::decodeSampleFile(const juce::String& filePath,
+                                                              SharedSampleBuffer::Storage storage)
+{
+    juce::File file(filePath);
+    if (!file.existsAsFile())
+    {
+        DBG("SamplePlayerManager: Cache - File not found: " + filePath);
+        return nullptr;
+    }
+
+    // Drum kits, samplers and editors using the same file share this buffer.
+    juce::SharedResourcePointer<SamplePool> pool;
+    auto buffer = pool->get(filePath, storage);
+
+    if (buffer == nullptr)
+    {
+        DBG("SamplePlayerManager: Cache - Could not create reader for: " + filePath);
+        return nullptr;
+    }
+
+    DBG("SamplePlayerManager: Cached " + filePath +
+        " (" + juce::String(buffer->getNumSamples()) + " samples, " +
+        juce::String(buffer->getNumChannels()) + " channels)");
+
+    return buffer;
 }
 
 void SamplePlayerManager::clearSampleCache()
@@ -693,27 +1070,352 @@ void SamplePlayerManager::clearSampleCache()
     int count = static_cast<int>(sampleCache.size());
     juce::ignoreUnused(count);
     sampleCache.clear();
+    cacheResidentBytes = 0;
+    samplePool->purgeUnused();
 
     DBG("SamplePlayerManager: Cleared sample cache (" + juce::String(count) + " samples)");
 }
 
-juce::AudioBuffer<float>* SamplePlayerManager::getCachedSample(const juce::String& filePath)
+SharedSampleBuffer::Ptr SamplePlayerManager::getCachedSample(const juce::String& filePath)
 {
+    const auto version = getSampleFileVersion(filePath);
     juce::ScopedLock sl(cacheLock);
 
-    auto it = sampleCache.find(filePath);
-    if (it != sampleCache.end() && it->second != nullptr)
+    if (auto* entry = findCurrentEntry(filePath, version))
     {
-        return &(it->second->buffer);
+        entry->lastUsed = ++cacheUseCounter;
+        ++cacheHits;
+        return entry->deviceBuffer != nullptr ? entry->deviceBuffer : entry->buffer;
     }
 
+    ++cacheMisses;
     return nullptr;
 }
 
 bool SamplePlayerManager::isSampleCached(const juce::String& filePath) const
+{
+    const auto version = getSampleFileVersion(filePath);
+    juce::ScopedLock sl(cacheLock);
+
+    auto it = sampleCache.find(filePath);
+    return it != sampleCache.end() && it->second.version == version;
+}
+
+void SamplePlayerManager::markSampleFileEdited(const juce::String& filePath)
 {
     juce::ScopedLock sl(cacheLock);
-    return sampleCache.find(filePath) != sampleCache.end();
+    ++editGenerations[filePath];
+    samplePool->invalidate(filePath);
+}
+
+SamplePlayerManager::SampleFileVersion SamplePlayerManager::getSampleFileVersion(const juce::String& filePath) const
+{
+    juce::File file(filePath);
+
+    SampleFileVersion version;
+    if (file.existsAsFile())
+    {
+        version.sizeInBytes      = file.getSize();
+        version.modificationTime = file.getLastModificationTime().toMilliseconds();
+    }
+
+    juce::ScopedLock sl(cacheLock);
+    auto it = editGenerations.find(filePath);
+    if (it != editGenerations.end())
+        version.editGeneration = it->second;
+
+    return version;
+}
+
+SamplePlayerManager::CacheEntry* SamplePlayerManager::findCurrentEntry(const juce::String& filePath,
+                                                                       const SampleFileVersion& currentVersion)
+{
+    auto it = sampleCache.find(filePath);
+    if (it == sampleCache.end())
+        return nullptr;
+
+    if (it->second.version == currentVersion)
+        return &it->second;
+
+    // Players still holding the old buffer keep it alive; the cache lets go.
+    DBG("SamplePlayerManager: Cached sample is stale, dropping " + filePath);
+    cacheResidentBytes -= getEntrySizeInBytes(it->second);
+    sampleCache.erase(it);
+    ++cacheStaleReloads;
+    return nullptr;
+}
+
+//==============================================================================
+// Sample cache budget
+
+void SamplePlayerManager::setCacheBudgetBytes(size_t budgetBytes)
+{
+    const auto pathsInUse = getPathsInUse();
+    juce::ScopedLock sl(cacheLock);
+
+    cacheBudgetBytes = budgetBytes;
+    enforceCacheBudget(pathsInUse);
+
+    DBG("SamplePlayerManager: Cache budget set to " +
+        juce::String((juce::int64)(budgetBytes / (1024 * 1024))) + " MB");
+}
+
+size_t SamplePlayerManager::getCacheBudgetBytes() const
+{
+    juce::ScopedLock sl(cacheLock);
+    return cacheBudgetBytes;
+}
+
+void SamplePlayerManager::setPinnedSamples(const juce::StringArray& paths)
+{
+    const auto pathsInUse = getPathsInUse();
+    juce::ScopedLock sl(cacheLock);
+
+    pinnedPaths.clear();
+    for (const auto& path : paths)
+        if (path.isNotEmpty())
+            pinnedPaths.insert(path);
+
+    // Unpinning may have made room to get back under budget.
+    enforceCacheBudget(pathsInUse);
+}
+
+SamplePlayerManager::CacheStats SamplePlayerManager::getCacheStats() const
+{
+    juce::ScopedLock sl(cacheLock);
+
+    CacheStats stats;
+    stats.hits          = cacheHits;
+    stats.misses        = cacheMisses;
+    stats.evictions     = cacheEvictions;
+    stats.staleReloads  = cacheStaleReloads;
+    stats.residentBytes = cacheResidentBytes;
+    stats.budgetBytes   = cacheBudgetBytes;
+    stats.numEntries    = (int)sampleCache.size();
+
+    for (const auto& pair : sampleCache)
+        if (pair.second.deviceBuffer != nullptr)
+            stats.numConverted++;
+
+    for (const auto& path : pinnedPaths)
+        if (sampleCache.find(path) != sampleCache.end())
+            stats.numPinned++;
+
+    const auto poolStats = samplePool->getStats();
+    stats.pooledBuffers = poolStats.numBuffers;
+    stats.pooledBytes   = poolStats.sizeInBytes;
+
+    return stats;
+}
+
+void SamplePlayerManager::insertIntoCache(const juce::String& filePath,
+                                          SharedSampleBuffer::Ptr buffer,
+                                          const SampleFileVersion& version,
+                                          const std::set<juce::String>& pathsInUse)
+{
+    auto& entry = sampleCache[filePath];
+
+    cacheResidentBytes -= getEntrySizeInBytes(entry);
+
+    entry.buffer       = std::move(buffer);
+    entry.deviceBuffer = nullptr;
+    entry.version      = version;
+    entry.lastUsed     = ++cacheUseCounter;
+    cacheResidentBytes += entry.buffer->getSizeInBytes();
+
+    scheduleDeviceRateConversion(filePath, entry);
+    enforceCacheBudget(pathsInUse);
+}
+
+void SamplePlayerManager::enforceCacheBudget(const std::set<juce::String>& pathsInUse)
+{
+    while (cacheResidentBytes > cacheBudgetBytes)
+    {
+        // Least recently used entry that nobody depends on.  Any reference
+        // beyond the ones counted by getOwnReferences() means a player source,
+        // pad or instrument still holds it (evicting frees nothing).
+        auto victim = sampleCache.end();
+
+        for (auto it = sampleCache.begin(); it != sampleCache.end(); ++it)
+        {
+            if (pinnedPaths.count(it->first) > 0 || pathsInUse.count(it->first) > 0)
+                continue;
+            if (it->second.buffer->getReferenceCount() > getOwnReferences(*it->second.buffer))
+                continue;
+            if (it->second.deviceBuffer != nullptr
+                && it->second.deviceBuffer->getReferenceCount() > getOwnReferences(*it->second.deviceBuffer))
+                continue;
+            if (victim == sampleCache.end() || it->second.lastUsed < victim->second.lastUsed)
+                victim = it;
+        }
+
+        if (victim == sampleCache.end())
+        {
+            DBG("SamplePlayerManager: Cache over budget (" +
+                juce::String((juce::int64)(cacheResidentBytes / (1024 * 1024))) + " MB) but every entry is pinned or in use");
+            return;
+        }
+
+        DBG("SamplePlayerManager: Evicting " + victim->first);
+        cacheResidentBytes -= getEntrySizeInBytes(victim->second);
+        sampleCache.erase(victim);
+        samplePool->purgeUnused();
+        ++cacheEvictions;
+    }
+}
+
+int SamplePlayerManager::getOwnReferences(const SharedSampleBuffer& buffer) const
+{
+    // The cache entry's own, plus the SamplePool's if this is its copy of the
+    // file (device-rate copies and buffers the pool has since replaced are not).
+    return samplePool->contains(buffer) ? 2 : 1;
+}
+
+size_t SamplePlayerManager::getEntrySizeInBytes(const CacheEntry& entry)
+{
+    size_t bytes = 0;
+    if (entry.buffer != nullptr)
+        bytes += entry.buffer->getSizeInBytes();
+    if (entry.deviceBuffer != nullptr)
+        bytes += entry.deviceBuffer->getSizeInBytes();
+    return bytes;
+}
+
+//==============================================================================
+// Cache storage
+
+void SamplePlayerManager::setCacheStorage(SharedSampleBuffer::Storage storage)
+{
+    juce::ScopedLock sl(cacheLock);
+    cacheStorage = storage;
+
+    DBG("SamplePlayerManager: Cache storage set to " + SharedSampleBuffer::getStorageName(storage));
+}
+
+SharedSampleBuffer::Storage SamplePlayerManager::getCacheStorage() const
+{
+    juce::ScopedLock sl(cacheLock);
+    return cacheStorage;
+}
+
+//==============================================================================
+// Device-rate conversion
+
+void SamplePlayerManager::setDeviceSampleRate(double sampleRate)
+{
+    if (sampleRate <= 0.0)
+        return;
+
+    juce::ScopedLock sl(cacheLock);
+
+    if (std::abs(sampleRate - deviceSampleRate) < 0.01)
+        return;
+
+    DBG("SamplePlayerManager: Device rate " + juce::String(deviceSampleRate) + " -> " +
+        juce::String(sampleRate) + " Hz, converting " + juce::String((int)sampleCache.size()) + " cached samples");
+
+    deviceSampleRate = sampleRate;
+
+    // Copies made for the old rate are useless now.  Players still holding one
+    // keep it alive and have their transport correct for it.
+    for (auto& pair : sampleCache)
+    {
+        if (pair.second.deviceBuffer != nullptr)
+        {
+            cacheResidentBytes -= pair.second.deviceBuffer->getSizeInBytes();
+            pair.second.deviceBuffer = nullptr;
+        }
+
+        scheduleDeviceRateConversion(pair.first, pair.second);
+    }
+}
+
+double SamplePlayerManager::getDeviceSampleRate() const
+{
+    juce::ScopedLock sl(cacheLock);
+    return deviceSampleRate;
+}
+
+void SamplePlayerManager::updateDeviceSampleRate()
+{
+    double preparedRate = 0.0;
+    {
+        juce::ScopedLock sl(lock);
+        for (const auto& pair : trackPlayers)
+        {
+            if (pair.second != nullptr && pair.second->getPreparedSampleRate() > 0.0)
+            {
+                preparedRate = pair.second->getPreparedSampleRate();
+                break;
+            }
+        }
+    }
+
+    setDeviceSampleRate(preparedRate);
+}
+
+void SamplePlayerManager::scheduleDeviceRateConversion(const juce::String& filePath, const CacheEntry& entry)
+{
+    if (deviceSampleRate <= 0.0 || entry.buffer == nullptr || entry.buffer->getNumSamples() == 0)
+        return;
+
+    if (std::abs(entry.buffer->getSampleRate() - deviceSampleRate) < 0.01)
+        return;
+
+    juce::WeakReference<SamplePlayerManager> weakThis(this);
+    SharedSampleBuffer::Ptr original = entry.buffer;
+    const double targetRate = deviceSampleRate;
+
+    preloadPool.addJob([weakThis, filePath, original, targetRate]
+    {
+        juce::AudioBuffer<float> resampled;
+        SampleDSP::resample(original->toFloatBuffer(), resampled, original->getSampleRate(), targetRate);
+
+        SharedSampleBuffer::Ptr converted = new SharedSampleBuffer(std::move(resampled), targetRate, filePath,
+                                                                   original->getStorage());
+
+        juce::MessageManager::callAsync([weakThis, filePath, original, converted]
+        {
+            if (auto* manager = weakThis.get())
+                manager->handleDeviceRateConversion(filePath, original, converted);
+        });
+    });
+}
+
+void SamplePlayerManager::handleDeviceRateConversion(const juce::String& filePath,
+                                                     SharedSampleBuffer::Ptr original,
+                                                     SharedSampleBuffer::Ptr converted)
+{
+    const auto pathsInUse = getPathsInUse();
+    juce::ScopedLock sl(cacheLock);
+
+    // The entry may have been reloaded or evicted, or the rate changed again,
+    // while this was running.
+    auto it = sampleCache.find(filePath);
+    if (it == sampleCache.end() || it->second.buffer != original
+        || std::abs(converted->getSampleRate() - deviceSampleRate) >= 0.01)
+        return;
+
+    auto& entry = it->second;
+    if (entry.deviceBuffer != nullptr)
+        cacheResidentBytes -= entry.deviceBuffer->getSizeInBytes();
+
+    entry.deviceBuffer = std::move(converted);
+    cacheResidentBytes += entry.deviceBuffer->getSizeInBytes();
+
+    enforceCacheBudget(pathsInUse);
+}
+
+std::set<juce::String> SamplePlayerManager::getPathsInUse() const
+{
+    juce::ScopedLock sl(lock);
+
+    std::set<juce::String> paths;
+    for (const auto& pair : trackPlayers)
+        if (pair.second != nullptr)
+            paths.insert(pair.second->getCurrentFilePath());
+
+    return paths;
 }
 
 void SamplePlayerManager::consumeLiveEvents(const std::function<void(int, bool)>& callback)
@@ -726,6 +1428,9 @@ void SamplePlayerManager::consumeLiveEvents(const std::function<void(int, bool)>
             callback(pair.first, true);
         if (pair.second->consumeStopNotification())
             callback(pair.first, false);
+
+        // Sources swapped out on the audio thread are freed here, on the timer.
+        pair.second->releaseRetiredSources();
     }
 }
 
@@ -11,7 +11,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <set>
 #include "../Plugins/SamplePlayerPlugin.h"
+#include "../Audio/SamplePool.h"
 
 class SamplePlayerManager
 {
@@ -74,8 +76,9 @@ public:
      * This eliminates gaps between clips in Live Mode.
      *
      * @param targetStartSample  Absolute audio-thread sample position at which to
-     *                           start playback.  The SamplePlayerPlugin checks this
-     *                           in its processBlock() for sample-accurate triggering.
+     *                           start playback, or SamplePlayerPlugin::atNextBoundary
+     *                           to let the audio thread pick the next quantize boundary.
+     *                           Either way the start is a sample-accurate player event.
      *                           Pass -1 to fall back to the syncToTransport path.
      */
     void queueSampleFileSeamless(int trackIndex, const juce::String& filePath,
@@ -86,7 +89,8 @@ public:
      * Queue stop at next quantization boundary.
      *
      * @param targetStopSample  Absolute audio-thread sample position at which to
-     *                          stop playback.  Pass -1 to use syncToTransport path.
+     *                          stop playback, or SamplePlayerPlugin::atNextBoundary.
+     *                          Pass -1 to use syncToTransport path.
      */
     void queueStopSample(int trackIndex, int64_t targetStopSample = -1);
 
@@ -94,7 +98,8 @@ public:
     void cancelQueuedSample(int trackIndex);
 
     /**
-     * Queue a sample-accurate mute at the given boundary.
+     * Queue a sample-accurate mute at the given boundary (absolute sample
+     * position, or SamplePlayerPlugin::atNextBoundary).
      * The transport keeps running — loop wraps fire normally — but the output
      * is silenced.  Unmuting resumes audio from the correct loop position.
      */
@@ -107,6 +112,13 @@ public:
     /** Set loop length for a track in bars (assumes 4/4 time) */
     void setTrackLoopLengthBars(int trackIndex, double bars);
 
+    /**
+     * Make every player (including ones created later) follow tempo changes in
+     * real time with a pitch-preserving stretch.  On by default.
+     */
+    void setTempoFollow(bool shouldFollow);
+    bool isTempoFollowing() const { return tempoFollowEnabled; }
+
     //==============================================================================
     // Scene Triggering
 
@@ -125,20 +137,72 @@ public:
 
     /**
      * Trigger an entire scene - stops current samples and queues all clips in the scene.
+     * Cached clips are armed from the cache; the rest stream or map from disk,
+     * so this never waits for a full decode.
      * @param sceneIndex Scene number (for logging)
      * @param clips Vector of clip info for each track in the scene
      */
     void triggerScene(int sceneIndex, const std::vector<SceneClipInfo>& clips);
 
+    /** A sample clip in a scene launch (see launchScene()). */
+    struct SceneLaunchClip
+    {
+        int trackIndex = 0;
+        juce::String filePath;
+        double offset = 0.0;
+        bool loop = true;
+        double loopLengthBeats = 16.0;
+    };
+
+    /** How long a launchScene() prepare phase may take by default. */
+    static constexpr int defaultScenePrepareTimeoutMs = 100;
+
+    /**
+     * Launch several sample clips together, in two phases:
+     * - prepare: cached clips are taken from the cache on the calling thread;
+     *   the rest are decoded in parallel on the scene prepare pool (kept apart
+     *   from the preload pool, so bulk preloads never hold them up)
+     * - commit: a single pass that arms every ready track for the target sample
+     *   and, if stopOtherTracks, stops every other track at that same sample
+     * Neither phase blocks: with every clip cached the commit runs before this
+     * returns, otherwise on the message thread once the last decode is in or
+     * prepareTimeoutMs has passed, whichever is first.  A clip that is not
+     * ready by then is counted in SceneLaunchStats, its track stops at the
+     * target sample, and the clip joins at the next quantize boundary once its
+     * decode finishes.  A newer launch drops an older one not yet committed.
+     *
+     * @param getTargetSample  Called at the commit; returns the target as for
+     *                         queueSampleFileSeamless() (-1 = syncToTransport
+     *                         path).  Must stay valid until then.
+     */
+    void launchScene(const std::vector<SceneLaunchClip>& clips,
+                     const std::function<int64_t()>& getTargetSample,
+                     bool stopOtherTracks,
+                     int prepareTimeoutMs = defaultScenePrepareTimeoutMs);
+
+    /** Scene launch telemetry (message thread). */
+    struct SceneLaunchStats
+    {
+        juce::uint64 scenesLaunched = 0;
+        juce::uint64 clipsArmed = 0;      // armed in the commit
+        juce::uint64 clipsLate = 0;       // not ready by the deadline
+        juce::uint64 clipsFailed = 0;     // could not be loaded at all
+        double lastPrepareMs = 0.0;       // launch to commit of the last launch
+        double maxPrepareMs = 0.0;
+    };
+    SceneLaunchStats getSceneLaunchStats() const { return sceneLaunchStats; }
+
     /** Stop all samples in a scene (queue stop at next boundary) */
     void stopScene();
 
     //==============================================================================
-    // Transport Sync (call from audio thread)
+    // Transport Sync (message thread)
 
     /**
      * Sync all players with the transport.
-     * Should be called from the audio thread's processBlock.
+     * Called from MidiBridge's timer on the message thread, never from the
+     * audio thread: it takes the manager lock and cacheLock, and queues rate
+     * conversions on the preload pool when the device rate changed.
      *
      * @param transportPositionBeats Current position in quarter notes (ppq)
      * @param bpm Current tempo
@@ -171,11 +235,44 @@ public:
     //==============================================================================
     // Sample Caching for Live Mode
 
+    /** Progress of an asynchronous preload, reported on the message thread. */
+    struct PreloadProgress
+    {
+        int requestId = 0;
+        juce::String filePath;      // file that just finished (empty for the final report)
+        int completed = 0;          // files done so far, including failures and cache hits
+        int total = 0;
+        bool succeeded = true;      // false if filePath could not be decoded
+        bool finished = false;      // true once for the last report of the request
+        bool cancelled = false;     // the request was cancelled (finished is also true)
+    };
+
+    using PreloadProgressCallback = std::function<void(const PreloadProgress&)>;
+
     /**
-     * Preload samples into memory cache for instant Live Mode playback.
-     * Called when entering Live Mode to eliminate disk I/O delays.
+     * Decode samples into the cache on the preload pool without blocking.
+     * Each file is inserted as soon as it is decoded, so playback can use it
+     * right away.  Starting a new request cancels the previous one: its queued
+     * files are skipped and it gets a final report with cancelled = true (files
+     * already being decoded still finish and are cached, but are not reported).
+     * Message thread only.  Returns the request id passed to the callback.
      */
-    void preloadSamplesForLiveMode(const juce::StringArray& samplePaths);
+    int preloadSamplesAsync(const juce::StringArray& samplePaths,
+                            PreloadProgressCallback progressCallback = nullptr);
+
+    /**
+     * Decode samples into the cache on the preload pool in the background,
+     * without progress and without touching the current preloadSamplesAsync()
+     * request (e.g. the next song scene while the current one plays).  Paths
+     * that are already cached or being prefetched are skipped.  Message thread only.
+     */
+    void prefetchSamples(const juce::StringArray& samplePaths);
+
+    /** Cancel the current asynchronous preload, if any (sends its final, cancelled report). */
+    void cancelPreload();
+
+    /** True while an asynchronous preload has files outstanding. */
+    bool isPreloading() const { return currentPreload != nullptr; }
 
     /** Clear the sample cache (called when exiting Live Mode or to free memory) */
     void clearSampleCache();
@@ -184,16 +281,79 @@ public:
      * Reset all players for Live Mode (clears stale file paths and sources).
      * Also synchronises each player's internal sample-position counter to
      * currentAudioPosition so it matches the MidiClipScheduler's counter and
-     * targetStartSample comparisons work correctly.
+     * scheduled event times line up with it.
      */
     void resetAllPlayersForLiveMode(int64_t currentAudioPosition = 0);
 
-    /** Get a cached sample buffer, or nullptr if not cached */
-    juce::AudioBuffer<float>* getCachedSample(const juce::String& filePath);
+    /**
+     * Get a shared reference to a cached sample buffer, or nullptr if not cached.
+     * Returns the copy converted to the device rate once it is ready, otherwise
+     * the buffer at the file's own rate.
+     * Counts as a use for LRU eviction and is recorded as a cache hit or miss.
+     */
+    SharedSampleBuffer::Ptr getCachedSample(const juce::String& filePath);
 
-    /** Check if a sample is in the cache */
+    /** Check if a sample is in the cache and still matches the file on disk */
     bool isSampleCached(const juce::String& filePath) const;
 
+    /**
+     * Record that a sample file was rewritten by the editor.  Bumps the file's
+     * edit generation, so a cached decode of the old contents is treated as stale
+     * even if the file's size and modification time happen to be unchanged.
+     */
+    void markSampleFileEdited(const juce::String& filePath);
+
+    //==============================================================================
+    // Sample cache budget
+
+    /** Snapshot of the cache counters (for diagnostics / the JS UI). */
+    struct CacheStats
+    {
+        juce::uint64 hits = 0;
+        juce::uint64 misses = 0;
+        juce::uint64 evictions = 0;
+        juce::uint64 staleReloads = 0;   // entries dropped because the file had changed
+        int numConverted = 0;            // entries with a device-rate copy
+        size_t residentBytes = 0;
+        size_t budgetBytes = 0;
+        int numEntries = 0;
+        int numPinned = 0;
+        int pooledBuffers = 0;           // process-wide SamplePool (all consumers)
+        size_t pooledBytes = 0;
+    };
+
+    /**
+     * Set the memory budget for decoded samples.  Least-recently-used entries are
+     * evicted until the cache fits, skipping pinned samples and buffers that a
+     * player is still holding (playing or queued).  If only such entries are left,
+     * the cache stays over budget until they are released.
+     */
+    void setCacheBudgetBytes(size_t budgetBytes);
+    size_t getCacheBudgetBytes() const;
+
+    /**
+     * Set the rate the players run at.  Every cache entry at a different rate
+     * gets a copy converted to this rate on the preload pool; a new rate drops
+     * the old copies and rebuilds them.  Called automatically from
+     * processTransportSync() when the players are prepared at a new rate.
+     */
+    void setDeviceSampleRate(double sampleRate);
+    double getDeviceSampleRate() const;
+
+    /** Replace the set of pinned sample paths (e.g. the current and next song scene). */
+    void setPinnedSamples(const juce::StringArray& paths);
+
+    CacheStats getCacheStats() const;
+
+    /**
+     * Storage format for samples decoded into the cache from now on (entries
+     * already cached keep theirs).  int16 halves the memory of float32 and int24
+     * takes three quarters of it; players convert a block at a time just ahead
+     * of the play position.
+     */
+    void setCacheStorage(SharedSampleBuffer::Storage storage);
+    SharedSampleBuffer::Storage getCacheStorage() const;
+
     /** Poll for live-mode clip start/stop events. Called from the message thread (e.g. timer).
      *  Calls callback(trackIndex, isStart) for each pending event. */
     void consumeLiveEvents(const std::function<void(int, bool)>& callback);
@@ -208,25 +368,176 @@ private:
 
     int currentQuantizeSteps = 16;  // Default: 1 bar
     double currentBpm = 120.0;
+    bool tempoFollowEnabled = true;
+
+    // Play length (in buffer samples) that fits a buffer to a loop length:
+    // loopLengthBeats * (60/bpm) * sampleRate.  The player truncates or
+    // silence-pads to it without copying.  Returns -1 (play the whole buffer)
+    // when loopLengthBeats <= 0 or bpm <= 0.
+    static juce::int64 getLoopFitLength (const SharedSampleBuffer& src,
+                                         double loopLengthBeats,
+                                         double bpm);
+
+    // Identifies the contents a decode was made from.  Size and modification
+    // time catch changes made outside the app; the edit generation catches
+    // editor saves that land within the filesystem's timestamp resolution.
+    struct SampleFileVersion
+    {
+        juce::int64 sizeInBytes = -1;
+        juce::int64 modificationTime = 0;
+        juce::uint32 editGeneration = 0;
+
+        bool operator== (const SampleFileVersion& other) const
+        {
+            return sizeInBytes == other.sizeInBytes
+                && modificationTime == other.modificationTime
+                && editGeneration == other.editGeneration;
+        }
+
+        bool operator!= (const SampleFileVersion& other) const { return !(*this == other); }
+    };
 
-    // Resize (truncate or zero-pad) a buffer to exactly match a loop length.
-    // loopLengthBeats * (60/bpm) * sampleRate gives the target sample count.
-    // Returns a new buffer; if loopLengthBeats <= 0 or bpm <= 0, returns a copy unchanged.
-    static juce::AudioBuffer<float> fitBufferToLoopLength (const juce::AudioBuffer<float>& src,
-                                                            double srcSampleRate,
-                                                            double loopLengthBeats,
-                                                            double bpm);
-
-    // Sample cache for Live Mode - stores audio buffers keyed by file path
-    struct CachedSample
+    // Sample cache for Live Mode - immutable decoded buffers keyed by file path.
+    // Entries are shared with the players, so launching a cached clip copies nothing.
+    // An entry is only used while its version still matches the file on disk.
+    struct CacheEntry
     {
-        juce::AudioBuffer<float> buffer;
-        double sampleRate = 0.0;
-        juce::String filePath;
+        SharedSampleBuffer::Ptr buffer;        // at the file's own rate
+        SharedSampleBuffer::Ptr deviceBuffer;  // buffer converted to deviceSampleRate (nullptr until ready / if not needed)
+        SampleFileVersion version;
+        juce::uint64 lastUsed = 0;   // cacheUseCounter value at the last hit / insert
     };
-    std::map<juce::String, std::unique_ptr<CachedSample>> sampleCache;
+
+    static constexpr size_t defaultCacheBudgetBytes = (size_t)1024 * 1024 * 1024;  // 1 GB
+
+    std::map<juce::String, CacheEntry> sampleCache;
+    std::set<juce::String> pinnedPaths;
+    size_t cacheBudgetBytes = defaultCacheBudgetBytes;
+    size_t cacheResidentBytes = 0;
+    juce::uint64 cacheUseCounter = 0;
+    juce::uint64 cacheHits = 0;
+    juce::uint64 cacheMisses = 0;
+    juce::uint64 cacheEvictions = 0;
+    juce::uint64 cacheStaleReloads = 0;
+    std::map<juce::String, juce::uint32> editGenerations;
+    double deviceSampleRate = 0.0;   // 0 until a player has been prepared
+    SharedSampleBuffer::Storage cacheStorage = SharedSampleBuffer::Storage::float32;
     mutable juce::CriticalSection cacheLock;
-    juce::AudioFormatManager cacheFormatManager;
+    juce::SharedResourcePointer<SamplePool> samplePool;   // decoded buffers, shared process-wide
+
+    // Current version of a file on disk.  Takes cacheLock for the edit generation.
+    SampleFileVersion getSampleFileVersion(const juce::String& filePath) const;
+
+    // Called with cacheLock held: returns the entry for filePath if it matches
+    // currentVersion, otherwise drops a stale entry and returns nullptr.
+    CacheEntry* findCurrentEntry(const juce::String& filePath, const SampleFileVersion& currentVersion);
+
+    // Both called with cacheLock held.  pathsInUse comes from getPathsInUse(),
+    // collected before taking cacheLock (it needs the player lock).
+    // version must be taken before the file was decoded.
+    void insertIntoCache(const juce::String& filePath, SharedSampleBuffer::Ptr buffer,
+                         const SampleFileVersion& version,
+                         const std::set<juce::String>& pathsInUse);
+    void enforceCacheBudget(const std::set<juce::String>& pathsInUse);
+
+    // References to a cached buffer that do not mean it is in use.
+    int getOwnReferences(const SharedSampleBuffer& buffer) const;
+
+    // Bytes held by an entry, counting its device-rate copy.
+    static size_t getEntrySizeInBytes(const CacheEntry& entry);
+
+    // Called with cacheLock held: queue the conversion of entry's buffer to
+    // deviceSampleRate on the preload pool, if it is at a different rate.
+    void scheduleDeviceRateConversion(const juce::String& filePath, const CacheEntry& entry);
+
+    // Message thread: store a finished conversion if the entry and the device
+    // rate are still the ones it was made for.
+    void handleDeviceRateConversion(const juce::String& filePath,
+                                    SharedSampleBuffer::Ptr original,
+                                    SharedSampleBuffer::Ptr converted);
+
+    // Pick up a new prepared rate from the players.
+    void updateDeviceSampleRate();
+
+    // Files currently loaded into any player.
+    std::set<juce::String> getPathsInUse() const;
+
+    //==============================================================================
+    // Parallel preloading
+    struct PreloadRequest
+    {
+        int id = 0;
+        int total = 0;
+        int completed = 0;                      // message thread
+        std::atomic<bool> cancelled { false };  // read by pool jobs
+        PreloadProgressCallback callback;
+    };
+
+    // The file's buffer from the SamplePool, decoded if no one holds a current
+    // copy (any thread).  Returns nullptr on failure.
+    static SharedSampleBuffer::Ptr decodeSampleFile(const juce::String& filePath,
+                                                    SharedSampleBuffer::Storage storage);
+
+    // Message thread: cache a finished decode and report progress.
+    void handlePreloadedSample(const std::shared_ptr<PreloadRequest>& request,
+                               const juce::String& filePath,
+                               SharedSampleBuffer::Ptr buffer,
+                               const SampleFileVersion& version);
+    void reportPreloadProgress(PreloadRequest& request, const juce::String& filePath, bool succeeded);
+
+    // Message thread: cache a finished prefetchSamples() decode.
+    void handlePrefetchedSample(const juce::String& filePath,
+                                SharedSampleBuffer::Ptr buffer,
+                                const SampleFileVersion& version);
+
+    std::shared_ptr<PreloadRequest> currentPreload;
+    std::set<juce::String> prefetchesInFlight;  // message thread
+    int nextPreloadId = 1;
+    juce::ThreadPool preloadPool;
+
+    // Decodes for launchScene() only, so a scene never queues behind a preload
+    juce::ThreadPool scenePreparePool;
+
+    // A scene launch in flight, shared with its prepare jobs so a job that
+    // misses the deadline can still finish and hand its clip over late.
+    struct ScenePrepare
+    {
+        struct Slot
+        {
+            SceneLaunchClip clip;
+            SharedSampleBuffer::Ptr buffer;     // written by the job before ready is set
+            SampleFileVersion version;
+            bool fromCache = false;
+            std::atomic<bool> ready { false };
+            bool handled = false;               // message thread: armed or given up on
+        };
+
+        explicit ScenePrepare(size_t numSlots) : slots(numSlots) {}
+
+        std::vector<Slot> slots;
+        juce::uint64 generation = 0;
+        std::function<int64_t()> getTargetSample;
+        bool stopOtherTracks = false;
+        double startMs = 0.0;
+        int pendingDecodes = 0;                 // message thread: misses not yet handed back
+        bool committed = false;                 // message thread
+        int64_t targetSample = -1;              // set by the commit
+    };
+
+    // Message thread: the commit pass of launchScene() (at most once per launch).
+    void commitScene(const std::shared_ptr<ScenePrepare>& prepare);
+
+    // Message thread: arm a player with a buffer at targetStartSample (see queueSampleFileSeamless()).
+    bool armSampleBuffer(SamplePlayerPlugin& player, const juce::String& filePath,
+                         SharedSampleBuffer::Ptr buffer, double offset,
+                         double loopLengthBeats, int64_t targetStartSample);
+
+    // Message thread: a prepare job finished (before or after the commit).
+    void handleScenePrepared(const std::shared_ptr<ScenePrepare>& prepare, size_t slotIndex);
+
+    juce::uint64 sceneLaunchGeneration = 0;
+    SceneLaunchStats sceneLaunchStats;
 
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SamplePlayerManager)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePlayerManager)
 };
@@ -36,6 +36,7 @@
 #include "SequencerComponent.h"
 #include "GraphEditorPanel.h"
 #include "MainHostWindow.h"
+#include "../Audio/AnalysisCache.h"
 
 
 #ifdef DEBUG
@@ -408,6 +409,19 @@ auto SequencerComponent::CustomWebBrowser::getResource(const juce::String& url)
                     obj->setProperty("fullPath", child.getFullPathName());
                     obj->setProperty("relativePath",
                         child.getRelativePathFrom(samplesDir).replace("\\", "/"));
+
+                    // Tempo, length and loudness, for samples analysed before
+                    // (summary only: the stored peaks are not read)
+                    AnalysisCache::Entry analysis;
+                    if (AnalysisCache::loadForFile(child, analysis, false))
+                    {
+                        if (analysis.bpm > 0.0)
+                            obj->setProperty("bpm", analysis.bpm);
+                        obj->setProperty("duration", analysis.getDurationSeconds());
+                        if (analysis.loudness.lufs > -100.0)
+                            obj->setProperty("lufs", analysis.loudness.lufs);
+                    }
+
                     filesArray.add(juce::var(obj.get()));
                 }
             }
@@ -457,6 +471,33 @@ auto SequencerComponent::CustomWebBrowser::getResource(const juce::String& url)
             streamToVector(stream), juce::String{"application/json"} };
     }
 
+    // Handle waveform request from the sample editor:
+    // api/waveform.bin?track=&start=&end=&points=[&channel=]  (start/end in seconds)
+    if (resourceToRetrieve.startsWith("api/waveform.bin")) {
+        const juce::URL query{ "http://localhost/" + resourceToRetrieve };
+        const auto& names = query.getParameterNames();
+        const auto& values = query.getParameterValues();
+
+        auto param = [&](const char* name, const juce::String& fallback) {
+            const int index = names.indexOf(name);
+            return index >= 0 ? values[index] : fallback;
+        };
+
+        auto data = parentComponent.sampleEditorBridge.getWaveformBinary(
+            param("track", "0").getIntValue(),
+            param("start", "0").getDoubleValue(),
+            param("end", "0").getDoubleValue(),
+            param("points", "800").getIntValue(),
+            param("channel", "0").getIntValue());
+
+        if (data.isEmpty())
+            return std::nullopt;
+
+        juce::MemoryInputStream stream{ data, false };
+        return juce::WebBrowserComponent::Resource{
+            streamToVector(stream), juce::String{"application/octet-stream"} };
+    }
+
     // Handle sample file load request
     if (resourceToRetrieve.startsWith("api/loadSample")) {
         // Extract path parameter from URL
@@ -2105,6 +2146,9 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         if (sourceFile.copyFileTo(destFile))
         {
             DBG("copySampleToProject: Copied to " + destFile.getFullPathName());
+
+            // Whichever of the two gets analysed, the library browser sees it
+            AnalysisCache::linkSources(sourceFile, destFile);
             evaluateJavaScript(buildCallback(destFile.getFullPathName()));
         }
         else
@@ -2314,25 +2358,44 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
                 setupSamplePlayersForTracks(8);
             }
 
-            if (auto* manager = midiBridge.getSamplePlayerManager())
+            if (midiBridge.getSamplePlayerManager() != nullptr)
             {
-                // Flush any edited samples to disk so cache reads the edited versions
-                sampleEditorBridge.flushAllEditsToDisk();
-
-                // Clear stale cache so preload re-reads flushed files from disk
-                manager->clearSampleCache();
-
-                // Reset all players and synchronise their cumulative-sample counter
-                // with the MidiClipScheduler so targetStartSample comparisons work.
-                int64_t currentAudioPos = midiBridge.getLatestAudioPosition();
-                manager->resetAllPlayersForLiveMode(currentAudioPos);
+                // Flush any edited samples to disk so cache reads the edited versions.
+                // The cache is kept: entries whose file changed (size, mtime or edit
+                // generation) are re-read by the preload, the rest are reused as-is.
+                // Edit jobs still queued or running are waited for first, so the
+                // preload starts once their files are written.
+                sampleEditorBridge.flushAllEditsToDisk([this, samplePaths]
+                {
+                    auto* manager = midiBridge.getSamplePlayerManager();
+                    if (manager == nullptr)
+                        return;
+
+                    // Reset all players and synchronise their cumulative-sample counter
+                    // with the MidiClipScheduler so targetStartSample comparisons work.
+                    int64_t currentAudioPos = midiBridge.getLatestAudioPosition();
+                    manager->resetAllPlayersForLiveMode(currentAudioPos);
+
+                    // Then preload samples into cache (reads edited files from disk).
+                    // Decoding runs on the preload pool; each clip is playable as soon
+                    // as its own progress event arrives, and JS is told when all are done.
+                    manager->preloadSamplesAsync(samplePaths,
+                        [this](const SamplePlayerManager::PreloadProgress& progress)
+                        {
+                            sendSamplePreloadProgressToJS(progress);
 
-                // Then preload samples into cache (reads edited files from disk)
-                manager->preloadSamplesForLiveMode(samplePaths);
+                            // Also when cancelled by a newer request, so JS never waits
+                            // forever; uncached clips are read from disk at launch.
+                            if (progress.finished)
+                                evaluateJavaScript("if (typeof SongScreen !== 'undefined' && SongScreen.onSamplesPreloaded) { SongScreen.onSamplesPreloaded(); }");
+                        });
+                });
+            }
+            else
+            {
+                // Notify JavaScript that preloading is complete
+                evaluateJavaScript("if (typeof SongScreen !== 'undefined' && SongScreen.onSamplesPreloaded) { SongScreen.onSamplesPreloaded(); }");
             }
-
-            // Notify JavaScript that preloading is complete
-            evaluateJavaScript("if (typeof SongScreen !== 'undefined' && SongScreen.onSamplesPreloaded) { SongScreen.onSamplesPreloaded(); }");
         }
     }
     else if (command == "preloadSamplesForSong")
@@ -2356,7 +2419,9 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
                         paths.add(p);
                 }
                 DBG("preloadSamplesForSong: caching " + juce::String(paths.size()) + " file(s)");
-                manager->preloadSamplesForLiveMode(paths);  // additive, skips already-cached files
+                // Additive, skips already-cached files; runs beside a Live Mode
+                // preload still in flight instead of cancelling it
+                manager->prefetchSamples(paths);
             }
         }
     }
@@ -2369,6 +2434,72 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
             manager->clearSampleCache();
         }
     }
+    else if (command == "setSampleCacheBudget")
+    {
+        // Memory budget for decoded Live Mode / Song Mode samples, in megabytes
+        double megabytes = payload.getProperty("megabytes", 1024.0);
+        DBG("setSampleCacheBudget: " + juce::String(megabytes) + " MB");
+        if (auto* manager = midiBridge.getSamplePlayerManager())
+        {
+            manager->setCacheBudgetBytes((size_t)(juce::jmax(0.0, megabytes) * 1024.0 * 1024.0));
+        }
+    }
+    else if (command == "setSampleCacheStorage")
+    {
+        // Storage format for newly cached samples: "float32", "int16" or "int24"
+        juce::String format = payload.getProperty("format", "float32").toString();
+        DBG("setSampleCacheStorage: " + format);
+        if (auto* manager = midiBridge.getSamplePlayerManager())
+        {
+            auto storage = SharedSampleBuffer::Storage::float32;
+            if (format == "int16")
+                storage = SharedSampleBuffer::Storage::int16;
+            else if (format == "int24")
+                storage = SharedSampleBuffer::Storage::int24;
+
+            manager->setCacheStorage(storage);
+        }
+    }
+    else if (command == "setSampleTempoFollow")
+    {
+        // Real-time tempo following (pitch-preserving stretch) for sample clips
+        bool enabled = payload.getProperty("enabled", true);
+        DBG("setSampleTempoFollow: " + juce::String(enabled ? "on" : "off"));
+        if (auto* manager = midiBridge.getSamplePlayerManager())
+        {
+            manager->setTempoFollow(enabled);
+        }
+    }
+    else if (command == "getSampleCacheStats")
+    {
+        if (auto* manager = midiBridge.getSamplePlayerManager())
+        {
+            auto stats = manager->getCacheStats();
+            auto scenes = manager->getSceneLaunchStats();
+            juce::String json = "{"
+                "\"type\": \"sampleCacheStats\", "
+                "\"hits\": " + juce::String((juce::int64)stats.hits) + ", "
+                "\"misses\": " + juce::String((juce::int64)stats.misses) + ", "
+                "\"evictions\": " + juce::String((juce::int64)stats.evictions) + ", "
+                "\"staleReloads\": " + juce::String((juce::int64)stats.staleReloads) + ", "
+                "\"residentBytes\": " + juce::String((juce::int64)stats.residentBytes) + ", "
+                "\"budgetBytes\": " + juce::String((juce::int64)stats.budgetBytes) + ", "
+                "\"entries\": " + juce::String(stats.numEntries) + ", "
+                "\"converted\": " + juce::String(stats.numConverted) + ", "
+                "\"pooledBuffers\": " + juce::String(stats.pooledBuffers) + ", "
+                "\"pooledBytes\": " + juce::String((juce::int64)stats.pooledBytes) + ", "
+                "\"pinned\": " + juce::String(stats.numPinned) + ", "
+                "\"scenesLaunched\": " + juce::String((juce::int64)scenes.scenesLaunched) + ", "
+                "\"sceneClipsArmed\": " + juce::String((juce::int64)scenes.clipsArmed) + ", "
+                "\"sceneClipsLate\": " + juce::String((juce::int64)scenes.clipsLate) + ", "
+                "\"sceneClipsFailed\": " + juce::String((juce::int64)scenes.clipsFailed) + ", "
+                "\"lastScenePrepareMs\": " + juce::String(scenes.lastPrepareMs, 2) + ", "
+                "\"maxScenePrepareMs\": " + juce::String(scenes.maxPrepareMs, 2) + "}";
+
+            if (webBrowser)
+                webBrowser->emitEventIfBrowserIsVisible("juceBridgeEvents", json);
+        }
+    }
     else if (command == "syncProjectState")
     {
         // Receive initial project state from sequencer
@@ -2843,14 +2974,10 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
             " ratio=" + juce::String(ratio) +
             " targetLength=" + juce::String(targetLengthSeconds) + "s");
 
-        sampleEditorBridge.timeStretch(trackIndex, ratio, targetLengthSeconds);
-
-        // Notify JS of success and updated file path (may have changed extension to .wav)
-        juce::String updatedPath = sampleEditorBridge.getCurrentFilePath(trackIndex);
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true, '" +
-                          updatedPath.replace("\\", "\\\\").replace("'", "\\'") + "'); }";
-        evaluateJavaScript(js);
+        // Runs as a background job; JS gets the result and updated file path
+        // (may have changed extension to .wav) when it is committed
+        sampleEditorBridge.timeStretch(trackIndex, ratio, targetLengthSeconds,
+                                       makeSampleEditCallback(command, true));
     }
     else if (command == "cppApplyWarp")
     {
@@ -2864,14 +2991,10 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
             " targetBPM=" + juce::String(targetBPM) +
             " targetLength=" + juce::String(targetLengthSeconds) + "s");
 
-        sampleEditorBridge.applyWarp(trackIndex, sampleBPM, targetBPM, targetLengthSeconds);
-
-        // Notify JS of success and updated file path (may have changed extension to .wav)
-        juce::String updatedPath = sampleEditorBridge.getCurrentFilePath(trackIndex);
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true, '" +
-                          updatedPath.replace("\\", "\\\\").replace("'", "\\'") + "'); }";
-        evaluateJavaScript(js);
+        // Runs as a background job; JS gets the result and updated file path
+        // (may have changed extension to .wav) when it is committed
+        sampleEditorBridge.applyWarp(trackIndex, sampleBPM, targetBPM, targetLengthSeconds,
+                                     makeSampleEditCallback(command, true));
     }
     else if (command == "cppDetectBPM")
     {
@@ -2879,11 +3002,21 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
 
         DBG("cppDetectBPM: track=" + juce::String(trackIndex));
 
-        double detectedBPM = sampleEditorBridge.detectBPM(trackIndex);
+        // Queued behind the track's edits, so it measures their result
+        sampleEditorBridge.detectBPM(trackIndex,
+            [this, command](const SampleEditorBridge::EditProgress& progress)
+            {
+                sendSampleEditProgressToJS(command, progress);
+
+                if (!progress.finished)
+                    return;
+
+                double detectedBPM = sampleEditorBridge.getStoredBPM(progress.trackIndex);
 
-        juce::String js = "if (typeof handleCppBPMResult === 'function') { handleCppBPMResult(" +
-                          juce::String(trackIndex) + ", " + juce::String(detectedBPM, 1) + "); }";
-        evaluateJavaScript(js);
+                juce::String js = "if (typeof handleCppBPMResult === 'function') { handleCppBPMResult(" +
+                                  juce::String(progress.trackIndex) + ", " + juce::String(detectedBPM, 1) + "); }";
+                evaluateJavaScript(js);
+            });
     }
     else if (command == "cppGetTransients")
     {
@@ -2990,11 +3123,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppFadeIn: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.fadeIn(trackIndex, startSeconds, endSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.fadeIn(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppFadeOut")
     {
@@ -3005,11 +3134,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppFadeOut: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.fadeOut(trackIndex, startSeconds, endSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.fadeOut(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppSilence")
     {
@@ -3020,11 +3145,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppSilence: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.silence(trackIndex, startSeconds, endSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.silence(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppTrim")
     {
@@ -3035,11 +3156,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppTrim: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.trim(trackIndex, startSeconds, endSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.trim(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppCopy")
     {
@@ -3050,12 +3167,9 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppCopy: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.copyRange(trackIndex, startSeconds, endSeconds);
-
-        // Copy doesn't modify the waveform, so no need to request waveform update
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        // Copy doesn't modify the waveform, so no need to request waveform update.
+        // Still a job, so it copies from the result of the edits queued before it.
+        sampleEditorBridge.copyRange(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppCut")
     {
@@ -3066,11 +3180,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppCut: track=" + juce::String(trackIndex) +
             " range=" + juce::String(startSeconds) + "-" + juce::String(endSeconds));
 
-        sampleEditorBridge.cutRange(trackIndex, startSeconds, endSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.cutRange(trackIndex, startSeconds, endSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppPaste")
     {
@@ -3080,11 +3190,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
         DBG("cppPaste: track=" + juce::String(trackIndex) +
             " position=" + juce::String(positionSeconds));
 
-        sampleEditorBridge.paste(trackIndex, positionSeconds);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.paste(trackIndex, positionSeconds, makeSampleEditCallback(command));
     }
     else if (command == "cppReset")
     {
@@ -3092,11 +3198,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
 
         DBG("cppReset: track=" + juce::String(trackIndex));
 
-        sampleEditorBridge.reset(trackIndex);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.reset(trackIndex, makeSampleEditCallback(command));
     }
     else if (command == "cppUndo")
     {
@@ -3104,11 +3206,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
 
         DBG("cppUndo: track=" + juce::String(trackIndex));
 
-        sampleEditorBridge.undo(trackIndex);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.undo(trackIndex, makeSampleEditCallback(command));
     }
     else if (command == "cppRedo")
     {
@@ -3116,11 +3214,7 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
 
         DBG("cppRedo: track=" + juce::String(trackIndex));
 
-        sampleEditorBridge.redo(trackIndex);
-
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", true); }";
-        evaluateJavaScript(js);
+        sampleEditorBridge.redo(trackIndex, makeSampleEditCallback(command));
     }
     else if (command == "cppSaveEditedSample")
     {
@@ -3129,12 +3223,21 @@ void SequencerComponent::handleAudioBridgeMessage(const juce::var& message)
 
         DBG("cppSaveEditedSample: track=" + juce::String(trackIndex) + " file=" + filePath);
 
-        bool success = sampleEditorBridge.saveToFile(trackIndex, filePath);
+        sampleEditorBridge.saveToFile(trackIndex, filePath, makeSampleEditCallback(command));
+    }
+    else if (command == "cppCancelEdit")
+    {
+        // Cancel one edit job (jobId from its sampleEditProgress events), or
+        // every job queued or running for a track
+        int jobId = payload.getProperty("jobId", 0);
+        int trackIndex = payload.getProperty("trackIndex", -1);
+
+        DBG("cppCancelEdit: job=" + juce::String(jobId) + " track=" + juce::String(trackIndex));
 
-        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
-                          command + "', " + juce::String(trackIndex) + ", " +
-                          juce::String(success ? "true" : "false") + "); }";
-        evaluateJavaScript(js);
+        if (jobId > 0)
+            sampleEditorBridge.cancelJob(jobId);
+        else if (trackIndex >= 0)
+            sampleEditorBridge.cancelJobsForTrack(trackIndex);
     }
     else if (command == "getMidiInputDevices")
     {
@@ -3280,6 +3383,9 @@ void SequencerComponent::setupSamplePlayersForTracks(int numTracks)
 
         if (player != nullptr)
         {
+            // Wire the clip scheduler so clips queued at the next boundary share the MIDI grid
+            player->setClipScheduler(&midiBridge.getClipScheduler());
+
             // Add the player to the audio graph
             // The graph takes ownership via unique_ptr
             DBG("Adding player to graph...");
@@ -4928,6 +5034,66 @@ void SequencerComponent::sendPluginParametersToJS(int trackIndex, juce::AudioPro
     }
 }
 
+void SequencerComponent::sendSamplePreloadProgressToJS(const SamplePlayerManager::PreloadProgress& progress)
+{
+    juce::String escapedPath = progress.filePath.replace("\\", "\\\\").replace("\"", "\\\"");
+
+    juce::String json = "{"
+        "\"type\": \"samplePreloadProgress\", "
+        "\"requestId\": " + juce::String(progress.requestId) + ", "
+        "\"path\": \"" + escapedPath + "\", "
+        "\"completed\": " + juce::String(progress.completed) + ", "
+        "\"total\": " + juce::String(progress.total) + ", "
+        "\"ok\": " + juce::String(progress.succeeded ? "true" : "false") + ", "
+        "\"finished\": " + juce::String(progress.finished ? "true" : "false") + ", "
+        "\"cancelled\": " + juce::String(progress.cancelled ? "true" : "false") +
+        "}";
+
+    if (webBrowser)
+        webBrowser->emitEventIfBrowserIsVisible("juceBridgeEvents", json);
+}
+
+void SequencerComponent::sendSampleEditProgressToJS(const juce::String& command,
+                                                    const SampleEditorBridge::EditProgress& progress)
+{
+    juce::String state = progress.finished ? (progress.succeeded ? "done" : progress.cancelled ? "cancelled" : "failed")
+                                           : (progress.started ? "running" : "queued");
+
+    juce::String json = "{"
+        "\"type\": \"sampleEditProgress\", "
+        "\"jobId\": " + juce::String(progress.jobId) + ", "
+        "\"trackIndex\": " + juce::String(progress.trackIndex) + ", "
+        "\"command\": \"" + command + "\", "
+        "\"state\": \"" + state + "\", "
+        "\"progress\": " + juce::String(progress.progress, 3) +
+        "}";
+
+    if (webBrowser)
+        webBrowser->emitEventIfBrowserIsVisible("juceBridgeEvents", json);
+}
+
+SampleEditorBridge::EditProgressCallback SequencerComponent::makeSampleEditCallback(const juce::String& command,
+                                                                                    bool withFilePath)
+{
+    return [this, command, withFilePath](const SampleEditorBridge::EditProgress& progress)
+    {
+        sendSampleEditProgressToJS(command, progress);
+
+        if (!progress.finished)
+            return;
+
+        juce::String js = "if (typeof handleCppEditResult === 'function') { handleCppEditResult('" +
+                          command + "', " + juce::String(progress.trackIndex) + ", " +
+                          juce::String(progress.succeeded ? "true" : "false");
+
+        if (withFilePath)
+            js += ", '" + progress.filePath.replace("\\", "\\\\").replace("'", "\\'") + "'";
+
+        js += "); }";
+        evaluateJavaScript(js);
+    };
+}
+
 void SequencerComponent::applyMixerStateToTrack(int trackIndex)
 {
     const auto& state = trackMixerStates[trackIndex];
@@ -174,6 +174,18 @@ private:
     // Send plugin parameters to JavaScript for automation UI
     void sendPluginParametersToJS(int trackIndex, juce::AudioProcessorGraph::Node* node);
 
+    // Forward sample preload progress to JavaScript (samplePreloadProgress events)
+    void sendSamplePreloadProgressToJS(const SamplePlayerManager::PreloadProgress& progress);
+
+    // Forward sample edit job progress to JavaScript (sampleEditProgress events)
+    void sendSampleEditProgressToJS(const juce::String& command, const SampleEditorBridge::EditProgress& progress);
+
+    // Progress callback for a cpp* edit command: sends its sampleEditProgress
+    // events and, when it finishes, its handleCppEditResult (with the track's
+    // file path if withFilePath)
+    SampleEditorBridge::EditProgressCallback makeSampleEditCallback(const juce::String& command,
+                                                                    bool withFilePath = false);
+
     // Setup MIDI track outputs
     void setupMidiTrackOutputs(int numTracks);
 
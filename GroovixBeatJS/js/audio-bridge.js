@@ -687,7 +687,8 @@ const AudioBridge = {
             this.externalHandler({ command: 'stopLiveMode', payload: {}, timestamp: performance.now() });
             this.externalHandler({ command: 'stop', payload: {}, timestamp: performance.now() });
             this.externalHandler({ command: 'stopAllSamples', payload: {}, timestamp: performance.now() });
-            this.externalHandler({ command: 'clearSampleCache', payload: {}, timestamp: performance.now() });
+            // Sample cache is kept (bounded by its budget) so re-entering Live Mode
+            // only re-reads files that changed in the meantime.
         }
 
         if (typeof SongScreen !== 'undefined') {
@@ -2207,6 +2208,64 @@ const AudioBridge = {
         this.send('stopAll', {});
     },
 
+    // ==========================================
+    // Sample Cache
+    // ==========================================
+
+    /**
+     * Set the memory budget (in MB) for decoded Live Mode / Song Mode samples.
+     * JUCE evicts least-recently-used clips that are not playing, queued or pinned.
+     */
+    setSampleCacheBudget(megabytes) {
+        this.send('setSampleCacheBudget', { megabytes });
+    },
+
+    /**
+     * Storage format for samples cached from now on: 'float32' (default),
+     * 'int16' (half the memory) or 'int24' (three quarters).
+     */
+    setSampleCacheStorage(format) {
+        this.send('setSampleCacheStorage', { format });
+    },
+
+    /**
+     * Make sample clips follow tempo changes in real time (pitch-preserving
+     * stretch, 0.5x-2x of the tempo a clip was launched at). On by default.
+     */
+    setSampleTempoFollow(enabled) {
+        this.send('setSampleTempoFollow', { enabled: !!enabled });
+    },
+
+    /**
+     * Get sample cache counters from JUCE.
+     * Resolves to { hits, misses, evictions, staleReloads, residentBytes, budgetBytes,
+     *              entries, converted, pooledBuffers, pooledBytes, pinned,
+     *              scenesLaunched, sceneClipsArmed, sceneClipsLate, sceneClipsFailed,
+     *              lastScenePrepareMs, maxScenePrepareMs },
+     * or null if JUCE does not answer.  sceneClipsLate counts scene clips that
+     * were not prepared in time and joined a boundary late.
+     */
+    getSampleCacheStats() {
+        return new Promise((resolve) => {
+            if (!this.externalHandler) {
+                resolve(null);
+                return;
+            }
+
+            this._sampleCacheStatsResolve = resolve;
+
+            setTimeout(() => {
+                if (this._sampleCacheStatsResolve) {
+                    console.warn('[AudioBridge] getSampleCacheStats timed out');
+                    this._sampleCacheStatsResolve = null;
+                    resolve(null);
+                }
+            }, 5000);
+
+            this.send('getSampleCacheStats', {});
+        });
+    },
+
     // ==========================================
     // Graph State Serialization
     // ==========================================
@@ -2450,6 +2509,14 @@ const AudioBridge = {
                 }
                 break;
 
+            case 'sampleCacheStats':
+                if (this._sampleCacheStatsResolve) {
+                    const { type, ...stats } = message;
+                    this._sampleCacheStatsResolve(stats);
+                    this._sampleCacheStatsResolve = null;
+                }
+                break;
+
             case 'samplerLoadState':
                 // JUCE sends sampler instrument loading state
                 if (message.loading) {
@@ -2619,6 +2686,32 @@ const AudioBridge = {
                 break;
             }
 
+            case 'samplePreloadProgress': {
+                // JUCE decodes preload files in parallel and reports each one as it lands.
+                // Only the Live Mode preload shows progress; song preloads run silently.
+                if (this.liveModePreloading && !message.finished) {
+                    showBusy('Preloading samples\u2026 ' + message.completed + '/' + message.total);
+                }
+                if (!message.ok && message.path) {
+                    console.warn('[AudioBridge] Could not preload sample:', message.path);
+                }
+                break;
+            }
+
+            case 'sampleEditProgress': {
+                // Sample edits run as background jobs in JUCE (one queue per track).
+                // Long ones (stretch / warp) show a progress row that can cancel them,
+                // without blocking the rest of the UI; results still arrive through
+                // handleCppEditResult / handleCppBPMResult.
+                if (message.command === 'cppTimeStretch' || message.command === 'cppApplyWarp') {
+                    this.updateSampleEditJob(message);
+                }
+                if (message.state === 'failed') {
+                    console.warn('[AudioBridge] Sample edit failed:', message.command, 'track', message.trackIndex);
+                }
+                break;
+            }
+
             case 'songLoading': {
                 // C++ has started loading all scene samples — keep the spinner visible.
                 // (Usually the spinner is already showing from _playSong; this ensures
@@ -2993,6 +3086,63 @@ const AudioBridge = {
         }
     },
 
+    /**
+     * Show, update or remove the progress row of a background sample edit.
+     * Rows sit in a corner tray (one per job, labelled with the track) and
+     * carry a Cancel button that sends cppCancelEdit for that job.
+     */
+    updateSampleEditJob(message) {
+        const tray = document.getElementById('sampleEditJobs');
+        if (!tray) return;
+
+        let row = tray.querySelector(`[data-job-id="${message.jobId}"]`);
+
+        if (message.state !== 'queued' && message.state !== 'running') {
+            if (row) row.remove();
+            return;
+        }
+
+        if (!row) {
+            row = document.createElement('div');
+            row.className = 'sample-edit-job';
+            row.dataset.jobId = message.jobId;
+
+            const label = document.createElement('span');
+            label.className = 'sample-edit-job-label';
+
+            const bar = document.createElement('div');
+            bar.className = 'sample-edit-job-bar';
+            const fill = document.createElement('div');
+            fill.className = 'sample-edit-job-fill';
+            bar.appendChild(fill);
+
+            const cancelBtn = document.createElement('button');
+            cancelBtn.className = 'sample-edit-job-cancel';
+            cancelBtn.textContent = 'Cancel';
+            cancelBtn.title = 'Cancel this edit';
+            cancelBtn.addEventListener('click', () => {
+                cancelBtn.disabled = true; // the row goes once JUCE reports the job cancelled
+                this.send('cppCancelEdit', { jobId: message.jobId });
+            });
+
+            row.appendChild(label);
+            row.appendChild(bar);
+            row.appendChild(cancelBtn);
+            tray.appendChild(row);
+        }
+
+        const trackName = typeof AppState !== 'undefined'
+            ? AppState.getTrackName(message.trackIndex)
+            : 'Track ' + (message.trackIndex + 1);
+        const action = message.command === 'cppApplyWarp' ? 'Warp' : 'Stretch';
+        const percent = Math.round((message.progress || 0) * 100);
+
+        row.querySelector('.sample-edit-job-label').textContent = message.state === 'queued'
+            ? `${trackName} \u00b7 ${action} (queued)`
+            : `${trackName} \u00b7 ${action} ${percent}%`;
+        row.querySelector('.sample-edit-job-fill').style.width = `${percent}%`;
+    },
+
     /**
      * Log to JUCE debug console (useful when browser dev tools unavailable)
      */
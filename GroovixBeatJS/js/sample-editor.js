@@ -445,10 +445,55 @@ const SampleEditor = {
 
         console.log('[SampleEditor] Requesting waveform from C++, track:', trackIndex, 'scene:', sceneIndex, 'points:', numPoints);
 
-        AudioBridge.send('cppGetWaveform', {
-            trackIndex: trackIndex,
-            numPoints: numPoints
-        });
+        // Binary resource first; the JSON command is the fallback for older hosts
+        this.fetchWaveformFromCpp(trackIndex, 0, 0, numPoints)
+            .then(waveform => {
+                const peaks = new Array(waveform.numPoints);
+                for (let i = 0; i < waveform.numPoints; i++) {
+                    // Same [min, max] shape as the command result (range includes zero)
+                    peaks[i] = [Math.min(0, waveform.frames[i * 3]), Math.max(0, waveform.frames[i * 3 + 1])];
+                }
+                handleCppWaveformResult(trackIndex, peaks, waveform.duration, Array.from(waveform.transients));
+            })
+            .catch(error => {
+                console.warn('[SampleEditor] waveform.bin failed, using cppGetWaveform:', error);
+                AudioBridge.send('cppGetWaveform', {
+                    trackIndex: trackIndex,
+                    numPoints: numPoints
+                });
+            });
+    },
+
+    // Fetch packed waveform frames for a range (seconds; endSeconds <= 0 = end of sample).
+    // Resolves to { numPoints, channel, duration, startSeconds, endSeconds, sampleRate,
+    //               frames: Float32Array [min, max, rms, ...], transients: Float64Array (seconds) }
+    fetchWaveformFromCpp: async function(trackIndex, startSeconds, endSeconds, numPoints, channel = 0) {
+        const query = 'track=' + trackIndex + '&start=' + startSeconds + '&end=' + endSeconds +
+                      '&points=' + numPoints + '&channel=' + channel;
+        const response = await fetch('/api/waveform.bin?' + query);
+        if (!response.ok) throw new Error('HTTP ' + response.status);
+
+        // Layout documented at SampleEditorBridge::getWaveformBinary
+        const buffer = await response.arrayBuffer();
+        const view = new DataView(buffer);
+        const version = view.getUint32(0, true);
+        if (version !== 1) throw new Error('Unknown waveform.bin version ' + version);
+
+        const count = view.getUint32(4, true);
+        const numTransients = view.getUint32(8, true);
+        const framesOffset = 48;
+        const transientsOffset = framesOffset + Math.ceil(count * 12 / 8) * 8;
+
+        return {
+            numPoints: count,
+            channel: view.getUint32(12, true),
+            duration: view.getFloat64(16, true),
+            startSeconds: view.getFloat64(24, true),
+            endSeconds: view.getFloat64(32, true),
+            sampleRate: view.getFloat64(40, true),
+            frames: new Float32Array(buffer, framesOffset, count * 3),
+            transients: new Float64Array(buffer, transientsOffset, numTransients)
+        };
     },
 
     // Handle file selection
@@ -1047,10 +1092,8 @@ const SampleEditor = {
                 targetLengthSeconds: 0
             });
 
-            // Refresh waveform after C++ finishes stretching
-            setTimeout(() => {
-                this.requestWaveformFromCpp(AppState.currentTrack);
-            }, 50);
+            // Runs as a background job in C++; handleCppEditResult requests the
+            // updated waveform once the result has been committed.
         };
     },
 
@@ -1725,10 +1768,8 @@ const SampleEditor = {
                 targetLengthSeconds: 0
             });
 
-            // Request updated waveform after a short delay
-            setTimeout(() => {
-                this.requestWaveformFromCpp(trackIndex);
-            }, 50);
+            // Runs as a background job in C++; handleCppEditResult requests the
+            // updated waveform once the result has been committed.
             return;
         }
 
@@ -1819,10 +1860,8 @@ const SampleEditor = {
                 targetLengthSeconds: 0
             });
 
-            // Request updated waveform after a short delay
-            setTimeout(() => {
-                this.requestWaveformFromCpp(trackIndex);
-            }, 50);
+            // Runs as a background job in C++; handleCppEditResult requests the
+            // updated waveform once the result has been committed.
             return;
         }
 
@@ -2188,6 +2227,18 @@ const SampleEditor = {
             item.appendChild(icon);
             item.appendChild(name);
 
+            // Tempo / length / loudness from the analysis cache, when the sample was analysed before
+            const meta = [];
+            if (file.bpm) meta.push(`${file.bpm.toFixed(1)} BPM`);
+            if (file.duration) meta.push(`${file.duration.toFixed(1)}s`);
+            if (file.lufs !== undefined) meta.push(`${file.lufs.toFixed(1)} LUFS`);
+            if (meta.length > 0) {
+                const info = document.createElement('span');
+                info.className = 'file-meta';
+                info.textContent = meta.join(' · ');
+                item.appendChild(info);
+            }
+
             // Click to select
             item.addEventListener('click', () => {
                 document.querySelectorAll('#sampleFileBrowserFiles .file-item.selected').forEach(el => {